@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "OpenMPClauseCache.h"
+#include "OpenMPIR.h"
+#include "OpenMPParserInternal.h"
+
+namespace ompparser {
+
+double ClauseCacheStats::hitRate() const {
+  const uint64_t lookups = hits + misses;
+  return lookups == 0 ? 0.0 : static_cast<double>(hits) / lookups;
+}
+
+ClauseCache::ClauseCache()
+    : state(std::make_unique<detail::ClauseCacheState>()) {}
+
+ClauseCache::~ClauseCache() = default;
+
+ClauseCacheStats ClauseCache::stats() const {
+  ClauseCacheStats result;
+  result.hits = state->hits;
+  result.misses = state->misses;
+  result.entries = state->clauses.size();
+  result.headers = state->headers.size();
+  return result;
+}
+
+void ClauseCache::clear() {
+  state = std::make_unique<detail::ClauseCacheState>();
+}
+
+} // namespace ompparser
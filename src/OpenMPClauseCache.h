@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPCLAUSECACHE_H
+#define OMPPARSER_OPENMPCLAUSECACHE_H
+
+#include "OpenMPParser.h"
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+
+namespace ompparser {
+
+namespace detail {
+struct ClauseCacheState;
+}
+
+struct ClauseCacheStats {
+  // Clause lookups: a hit reuses a clause built before, a miss is parsed.
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // Distinct clauses and directive headers held.
+  uint64_t entries = 0;
+  uint64_t headers = 0;
+
+  // hits / (hits + misses), or 0 before any lookup.
+  double hitRate() const;
+};
+
+// Clauses built while parsing one batch, such as the directives of one
+// generated file, for parseDirective to copy instead of parsing them again.
+// A clause is keyed by the kind of the directive it belongs to and its exact
+// text, and a directive's header, its text before the first clause, by that
+// text; both also by the language and extension policy. Entries are never
+// dropped, so a cache is meant to live as long as its batch. A cache is used
+// by one thread at a time.
+class ClauseCache {
+public:
+  ClauseCache();
+  ~ClauseCache();
+  ClauseCache(const ClauseCache &) = delete;
+  ClauseCache &operator=(const ClauseCache &) = delete;
+
+  ClauseCacheStats stats() const;
+  void clear();
+
+private:
+  friend ParseResult parseDirective(std::string_view input,
+                                    const ParseOptions &options,
+                                    ClauseCache &clauses);
+
+  std::unique_ptr<detail::ClauseCacheState> state;
+};
+
+// parseDirective, copying the clauses of input that clauses holds. When the
+// header of input is known, only the header and the clauses not in the
+// cache are parsed, and the copies are placed around them at their
+// positions in input; the directive is then validated as a whole. Anything
+// that does not fit that shape is parsed in full, and what a successful
+// parse builds is added to the cache. The result matches parseDirective
+// without a cache. Input parsed with host hooks, and continued Fortran
+// directives, bypass the cache.
+ParseResult parseDirective(std::string_view input, const ParseOptions &options,
+                           ClauseCache &clauses);
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPCLAUSECACHE_H
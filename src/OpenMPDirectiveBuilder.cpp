@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "OpenMPDirectiveBuilder.h"
+#include "OpenMPIR.h"
+#include "OpenMPParserInternal.h"
+#include "OpenMPSchema.h"
+
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Kinds the grammar builds through a dedicated directive class.
+bool needsDedicatedDirectiveNode(OpenMPDirectiveKind kind) {
+  switch (kind) {
+#define OPENMP_DIRECTIVE_NODE(Name, Class) case OMPD_##Name:
+#include "OpenMPIRNodes.def"
+#undef OPENMP_DIRECTIVE_NODE
+    return true;
+  default:
+    return false;
+  }
+}
+
+void addBuilderDiagnostic(std::vector<ompparser::Diagnostic> &diagnostics,
+                          ompparser::DiagnosticCode code,
+                          const std::string &message) {
+  ompparser::Diagnostic diagnostic;
+  diagnostic.code = code;
+  diagnostic.severity = ompparser::DiagnosticSeverity::Error;
+  diagnostic.message = message;
+  diagnostics.push_back(std::move(diagnostic));
+}
+
+// The grammar's list actions: the first item follows the opening parenthesis
+// and every later item follows a comma.
+OpenMPClauseSeparator itemSeparator(bool first) {
+  return first ? OMPC_CLAUSE_SEP_space : OMPC_CLAUSE_SEP_comma;
+}
+
+} // namespace
+
+namespace ompparser {
+
+DirectiveBuilder::DirectiveBuilder(OpenMPDirectiveKind kind,
+                                   BaseLanguage language) {
+  if (kind == OMPD_unknown || needsDedicatedDirectiveNode(kind)) {
+    throw std::invalid_argument(
+        std::string("directive '") + getDirectiveName(kind) +
+        "' cannot be built without a dedicated directive node");
+  }
+  directive = std::make_unique<OpenMPDirective>(kind);
+  directive->setBaseLang(detail::convertLanguage(language));
+}
+
+DirectiveBuilder::~DirectiveBuilder() = default;
+DirectiveBuilder::DirectiveBuilder(DirectiveBuilder &&) noexcept = default;
+DirectiveBuilder &
+DirectiveBuilder::operator=(DirectiveBuilder &&) noexcept = default;
+
+OpenMPDirective &DirectiveBuilder::target() {
+  if (directive == nullptr) {
+    throw std::logic_error("directive builder has already been built");
+  }
+  return *directive;
+}
+
+bool DirectiveBuilder::admitClause(OpenMPClauseKind kind) {
+  OpenMPDirective &current = target();
+  if (!isClauseAllowedOnDirective(current.getKind(), kind)) {
+    addBuilderDiagnostic(diagnostics, DiagnosticCode::InvalidClause,
+                         std::string("clause '") + getClauseName(kind) +
+                             "' is not allowed on directive '" +
+                             getDirectiveName(current.getKind()) + "'");
+    return false;
+  }
+  if (getClauseCardinality(kind) == ClauseCardinality::Unique &&
+      !current.getClauses(kind)->empty()) {
+    addBuilderDiagnostic(diagnostics, DiagnosticCode::DuplicateClause,
+                         std::string("duplicate unique clause '") +
+                             getClauseName(kind) + "'");
+    return false;
+  }
+  return true;
+}
+
+DirectiveBuilder &DirectiveBuilder::clause(OpenMPClauseKind kind) {
+  if (admitClause(kind)) {
+    directive->addOpenMPClause(kind);
+  }
+  return *this;
+}
+
+DirectiveBuilder &DirectiveBuilder::expression(OpenMPClauseKind kind,
+                                               std::string_view expression) {
+  if (admitClause(kind)) {
+    OpenMPClause *new_clause = directive->addOpenMPClause(kind);
+    new_clause->addLangExpr(std::string(expression).c_str(),
+                            OMPC_CLAUSE_SEP_space, 0, 0,
+                            OMP_EXPR_PARSE_expression);
+  }
+  return *this;
+}
+
+template <typename Iterator>
+DirectiveBuilder &DirectiveBuilder::addVariables(OpenMPClauseKind kind,
+                                                 Iterator begin,
+                                                 Iterator end) {
+  if (admitClause(kind)) {
+    OpenMPClause *new_clause = directive->addOpenMPClause(kind);
+    for (Iterator item = begin; item != end; ++item) {
+      new_clause->addLangExpr(std::string(*item).c_str(),
+                              itemSeparator(item == begin), 0, 0,
+                              OMP_EXPR_PARSE_variable_list);
+    }
+  }
+  return *this;
+}
+
+DirectiveBuilder &DirectiveBuilder::variables(OpenMPClauseKind kind,
+                                              Items items) {
+  return addVariables(kind, items.begin(), items.end());
+}
+
+DirectiveBuilder &
+DirectiveBuilder::variables(OpenMPClauseKind kind,
+                            const std::vector<std::string> &items) {
+  return addVariables(kind, items.begin(), items.end());
+}
+
+template <typename Iterator>
+DirectiveBuilder &DirectiveBuilder::addMap(OpenMPMapClauseType type,
+                                           OpenMPMapClauseModifier modifier,
+                                           Iterator begin, Iterator end) {
+  if (admitClause(OMPC_map)) {
+    auto *map_clause =
+        static_cast<OpenMPMapClause *>(directive->addOpenMPClause(
+            OMPC_map, modifier, OMPC_MAP_MODIFIER_unspecified,
+            OMPC_MAP_MODIFIER_unspecified, type,
+            OMPC_MAP_REF_MODIFIER_unspecified));
+    for (Iterator item = begin; item != end; ++item) {
+      map_clause->addItem(std::string(*item), itemSeparator(item == begin));
+    }
+  }
+  return *this;
+}
+
+DirectiveBuilder &DirectiveBuilder::map(OpenMPMapClauseType type,
+                                        Items locators,
+                                        OpenMPMapClauseModifier modifier) {
+  return addMap(type, modifier, locators.begin(), locators.end());
+}
+
+DirectiveBuilder &
+DirectiveBuilder::map(OpenMPMapClauseType type,
+                      const std::vector<std::string> &locators,
+                      OpenMPMapClauseModifier modifier) {
+  return addMap(type, modifier, locators.begin(), locators.end());
+}
+
+template <typename Iterator>
+DirectiveBuilder &
+DirectiveBuilder::addReduction(OpenMPReductionClauseIdentifier identifier,
+                               OpenMPReductionClauseModifier modifier,
+                               Iterator begin, Iterator end) {
+  if (admitClause(OMPC_reduction)) {
+    OpenMPClause *new_clause =
+        directive->addOpenMPClause(OMPC_reduction, modifier, identifier);
+    for (Iterator item = begin; item != end; ++item) {
+      new_clause->addLangExpr(std::string(*item).c_str(),
+                              itemSeparator(item == begin), 0, 0,
+                              OMP_EXPR_PARSE_variable_list);
+    }
+  }
+  return *this;
+}
+
+DirectiveBuilder &
+DirectiveBuilder::reduction(OpenMPReductionClauseIdentifier identifier,
+                            Items operands,
+                            OpenMPReductionClauseModifier modifier) {
+  return addReduction(identifier, modifier, operands.begin(), operands.end());
+}
+
+DirectiveBuilder &
+DirectiveBuilder::reduction(OpenMPReductionClauseIdentifier identifier,
+                            const std::vector<std::string> &operands,
+                            OpenMPReductionClauseModifier modifier) {
+  return addReduction(identifier, modifier, operands.begin(), operands.end());
+}
+
+DirectiveBuilder &
+DirectiveBuilder::condition(std::string_view expression,
+                            OpenMPIfClauseModifier modifier) {
+  if (admitClause(OMPC_if)) {
+    OpenMPClause *new_clause = directive->addOpenMPClause(OMPC_if, modifier);
+    new_clause->addLangExpr(std::string(expression).c_str(),
+                            OMPC_CLAUSE_SEP_space, 0, 0,
+                            OMP_EXPR_PARSE_expression);
+  }
+  return *this;
+}
+
+DirectiveBuilder &DirectiveBuilder::collapse(std::string_view expression) {
+  return this->expression(OMPC_collapse, expression);
+}
+
+DirectiveBuilder &DirectiveBuilder::numThreads(std::string_view expression) {
+  return this->expression(OMPC_num_threads, expression);
+}
+
+DirectiveBuilder &DirectiveBuilder::nowait() { return clause(OMPC_nowait); }
+
+ParseResult DirectiveBuilder::build() {
+  target();
+  ParseResult result;
+  result.directive = std::move(directive);
+  result.diagnostics = std::move(diagnostics);
+  diagnostics.clear();
+
+  ValidationResult validation = validate(*result.directive);
+  result.diagnostics.insert(
+      result.diagnostics.end(),
+      std::make_move_iterator(validation.diagnostics.begin()),
+      std::make_move_iterator(validation.diagnostics.end()));
+  if (!result.success()) {
+    result.directive.reset();
+  }
+  return result;
+}
+
+} // namespace ompparser
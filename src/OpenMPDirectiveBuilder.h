@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPDIRECTIVEBUILDER_H
+#define OMPPARSER_OPENMPDIRECTIVEBUILDER_H
+
+#include "OpenMPKinds.h"
+#include "OpenMPParser.h"
+
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ompparser {
+
+// Builds the same IR parseDirective produces for the equivalent pragma text,
+// without lexing or parsing. Each clause is checked against the schema as it
+// is added: a clause that is not allowed on the directive, or a second copy
+// of a unique clause, is dropped and reported by build(). Directives that
+// need a dedicated IR node (critical, atomic, flush, declare_*, ...) and
+// clause kinds whose arguments do not match the method used throw
+// std::invalid_argument.
+class DirectiveBuilder {
+public:
+  using Items = std::initializer_list<std::string_view>;
+
+  explicit DirectiveBuilder(OpenMPDirectiveKind kind,
+                            BaseLanguage language = BaseLanguage::C);
+  ~DirectiveBuilder();
+  DirectiveBuilder(DirectiveBuilder &&) noexcept;
+  DirectiveBuilder &operator=(DirectiveBuilder &&) noexcept;
+  DirectiveBuilder(const DirectiveBuilder &) = delete;
+  DirectiveBuilder &operator=(const DirectiveBuilder &) = delete;
+
+  // Clause without a parenthesized argument, e.g. nowait or untied.
+  DirectiveBuilder &clause(OpenMPClauseKind kind);
+  // Clause taking one host expression, e.g. collapse(2) or final(x).
+  DirectiveBuilder &expression(OpenMPClauseKind kind,
+                               std::string_view expression);
+  // Clause taking a variable list, e.g. private(a, b).
+  DirectiveBuilder &variables(OpenMPClauseKind kind, Items items);
+  DirectiveBuilder &variables(OpenMPClauseKind kind,
+                              const std::vector<std::string> &items);
+
+  DirectiveBuilder &
+  map(OpenMPMapClauseType type, Items locators,
+      OpenMPMapClauseModifier modifier = OMPC_MAP_MODIFIER_unspecified);
+  DirectiveBuilder &
+  map(OpenMPMapClauseType type, const std::vector<std::string> &locators,
+      OpenMPMapClauseModifier modifier = OMPC_MAP_MODIFIER_unspecified);
+  DirectiveBuilder &reduction(
+      OpenMPReductionClauseIdentifier identifier, Items operands,
+      OpenMPReductionClauseModifier modifier =
+          OMPC_REDUCTION_MODIFIER_unspecified);
+  DirectiveBuilder &reduction(
+      OpenMPReductionClauseIdentifier identifier,
+      const std::vector<std::string> &operands,
+      OpenMPReductionClauseModifier modifier =
+          OMPC_REDUCTION_MODIFIER_unspecified);
+  DirectiveBuilder &
+  condition(std::string_view expression,
+            OpenMPIfClauseModifier modifier = OMPC_IF_MODIFIER_unspecified);
+  DirectiveBuilder &collapse(std::string_view expression);
+  DirectiveBuilder &numThreads(std::string_view expression);
+  DirectiveBuilder &nowait();
+
+  // Validates the directive like parseDirective does and hands it over. The
+  // directive is null when any error was reported. A builder builds once.
+  ParseResult build();
+
+private:
+  bool admitClause(OpenMPClauseKind kind);
+  template <typename Iterator>
+  DirectiveBuilder &addVariables(OpenMPClauseKind kind, Iterator begin,
+                                 Iterator end);
+  template <typename Iterator>
+  DirectiveBuilder &addMap(OpenMPMapClauseType type,
+                           OpenMPMapClauseModifier modifier, Iterator begin,
+                           Iterator end);
+  template <typename Iterator>
+  DirectiveBuilder &addReduction(OpenMPReductionClauseIdentifier identifier,
+                                 OpenMPReductionClauseModifier modifier,
+                                 Iterator begin, Iterator end);
+  OpenMPDirective &target();
+
+  std::unique_ptr<OpenMPDirective> directive;
+  std::vector<Diagnostic> diagnostics;
+};
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPDIRECTIVEBUILDER_H
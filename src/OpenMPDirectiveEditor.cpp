@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "OpenMPDirectiveEditor.h"
+#include "OpenMPIR.h"
+#include "OpenMPParserInternal.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// Moves offset back over any of the characters in skipped.
+std::size_t skipBackOver(std::string_view source, std::size_t offset,
+                         std::string_view skipped) {
+  while (offset > 0 &&
+         skipped.find(source[offset - 1]) != std::string_view::npos) {
+    --offset;
+  }
+  return offset;
+}
+
+// Whitespace, including line continuations, and list commas.
+constexpr std::string_view ClauseSeparators = " \t\r\n\\,";
+constexpr std::string_view TrailingWhitespace = " \t\r\n\\";
+
+} // namespace
+
+namespace ompparser {
+
+SourceEditResult::SourceEditResult() = default;
+SourceEditResult::~SourceEditResult() = default;
+SourceEditResult::SourceEditResult(SourceEditResult &&) noexcept = default;
+SourceEditResult &
+SourceEditResult::operator=(SourceEditResult &&) noexcept = default;
+
+bool SourceEditResult::success() const {
+  return directive != nullptr &&
+         std::none_of(diagnostics.begin(), diagnostics.end(),
+                      [](const Diagnostic &diagnostic) {
+                        return diagnostic.severity == DiagnosticSeverity::Error;
+                      });
+}
+
+DirectiveEditor::DirectiveEditor(const OpenMPDirective &directive,
+                                 std::string_view source)
+    : directive(directive), source(source) {
+  const std::vector<OpenMPClause *> &order =
+      directive.getClausesInOriginalOrder();
+  clauses.assign(order.begin(), order.end());
+  insertion_offset = skipBackOver(source, source.size(), TrailingWhitespace);
+  const std::vector<std::size_t> starts =
+      detail::locateClauseKeywords(order, source, insertion_offset);
+
+  spans.resize(starts.size());
+  for (std::size_t index = 0; index < starts.size(); ++index) {
+    ClauseSpan &span = spans[index];
+    span.begin = starts[index];
+    if (index + 1 < starts.size()) {
+      span.end = skipBackOver(source, starts[index + 1], ClauseSeparators);
+      span.remove_begin = span.begin;
+      span.remove_end = starts[index + 1];
+    } else {
+      span.end = insertion_offset;
+      span.remove_begin = skipBackOver(source, span.begin, " \t,");
+      span.remove_end = span.end;
+    }
+  }
+}
+
+std::size_t DirectiveEditor::clauseIndex(const OpenMPClause &clause) const {
+  auto found = std::find(clauses.begin(), clauses.end(), &clause);
+  if (found == clauses.end()) {
+    throw std::invalid_argument(
+        "clause does not belong to the directive being edited");
+  }
+  return static_cast<std::size_t>(found - clauses.begin());
+}
+
+void DirectiveEditor::reportEdit(const std::string &message) {
+  Diagnostic diagnostic;
+  diagnostic.code = DiagnosticCode::InvalidEdit;
+  diagnostic.severity = DiagnosticSeverity::Error;
+  diagnostic.message = message;
+  diagnostics.push_back(std::move(diagnostic));
+}
+
+void DirectiveEditor::record(std::size_t offset, std::size_t length,
+                             std::string_view text) {
+  auto overlaps = [&](const SourceEdit &edit) {
+    return offset < edit.offset + edit.length && edit.offset < offset + length;
+  };
+  // Overlapping deletions, such as removing a clause and the last clause
+  // after it, delete their union; any other overlap is a conflict.
+  for (const SourceEdit &edit : edits) {
+    if (overlaps(edit) && (!text.empty() || !edit.text.empty())) {
+      reportEdit("edit overlaps an earlier edit of the same text");
+      return;
+    }
+  }
+  for (auto edit = edits.begin(); edit != edits.end();) {
+    if (overlaps(*edit)) {
+      const std::size_t end =
+          std::max(offset + length, edit->offset + edit->length);
+      offset = std::min(offset, edit->offset);
+      length = end - offset;
+      edit = edits.erase(edit);
+    } else {
+      ++edit;
+    }
+  }
+  auto position = std::upper_bound(
+      edits.begin(), edits.end(), offset,
+      [](std::size_t value, const SourceEdit &edit) {
+        return value < edit.offset;
+      });
+  edits.insert(position, SourceEdit{offset, length, std::string(text)});
+}
+
+DirectiveEditor &DirectiveEditor::addClause(std::string_view clause_text) {
+  std::string text(" ");
+  text += clause_text;
+  record(insertion_offset, 0, text);
+  return *this;
+}
+
+DirectiveEditor &DirectiveEditor::removeClause(const OpenMPClause &clause) {
+  const std::size_t index = clauseIndex(clause);
+  if (spans.empty()) {
+    reportEdit("clause positions do not match the edited source");
+    return *this;
+  }
+  const ClauseSpan &span = spans[index];
+  record(span.remove_begin, span.remove_end - span.remove_begin, {});
+  return *this;
+}
+
+DirectiveEditor &DirectiveEditor::replaceClause(const OpenMPClause &clause,
+                                                std::string_view clause_text) {
+  const std::size_t index = clauseIndex(clause);
+  if (spans.empty()) {
+    reportEdit("clause positions do not match the edited source");
+    return *this;
+  }
+  const ClauseSpan &span = spans[index];
+  record(span.begin, span.end - span.begin, clause_text);
+  return *this;
+}
+
+DirectiveEditor &DirectiveEditor::replaceFragment(const HostFragment &fragment,
+                                                  std::string_view spelling) {
+  bool owned = false;
+  directive.visitHostFragments([&](const HostFragment &candidate) {
+    owned = owned || &candidate == &fragment;
+  });
+  if (!owned) {
+    throw std::invalid_argument(
+        "fragment does not belong to the directive being edited");
+  }
+  const std::size_t begin = fragment.range.begin.offset;
+  const std::size_t end = fragment.range.end.offset;
+  if (end < begin || end > source.size() ||
+      source.substr(begin, end - begin) != fragment.spelling) {
+    reportEdit("fragment '" + fragment.spelling +
+               "' does not match its range in the edited source");
+    return *this;
+  }
+  record(begin, end - begin, spelling);
+  return *this;
+}
+
+SourceEditResult DirectiveEditor::finish(const ParseOptions &options) const {
+  SourceEditResult result;
+  result.edits = edits;
+  result.text = applySourceEdits(source, edits);
+  result.diagnostics = diagnostics;
+
+  ParseResult parsed = parseDirective(result.text, options);
+  result.diagnostics.insert(result.diagnostics.end(),
+                            std::make_move_iterator(parsed.diagnostics.begin()),
+                            std::make_move_iterator(parsed.diagnostics.end()));
+  result.directive = std::move(parsed.directive);
+  if (!result.success()) {
+    result.directive.reset();
+  }
+  return result;
+}
+
+std::string applySourceEdits(std::string_view source,
+                             const std::vector<SourceEdit> &edits) {
+  std::size_t size = source.size();
+  for (const SourceEdit &edit : edits) {
+    size = size - edit.length + edit.text.size();
+  }
+  std::string result;
+  result.reserve(size);
+  std::size_t copied = 0;
+  for (const SourceEdit &edit : edits) {
+    if (edit.offset < copied || edit.offset + edit.length > source.size()) {
+      throw std::invalid_argument(
+          "source edits must be sorted, non-overlapping and in range");
+    }
+    result.append(source, copied, edit.offset - copied);
+    result += edit.text;
+    copied = edit.offset + edit.length;
+  }
+  result.append(source, copied, std::string_view::npos);
+  return result;
+}
+
+} // namespace ompparser
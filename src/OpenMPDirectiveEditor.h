@@ -0,0 +1,99 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPDIRECTIVEEDITOR_H
+#define OMPPARSER_OPENMPDIRECTIVEEDITOR_H
+
+#include "OpenMPParser.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ompparser {
+
+struct SourceEditResult {
+  // Sorted by offset and non-overlapping; edits at one offset keep the order
+  // they were requested in.
+  std::vector<SourceEdit> edits;
+  // The source with every edit applied.
+  std::string text;
+  // text parsed again; null when any error was reported.
+  std::unique_ptr<OpenMPDirective> directive;
+  std::vector<Diagnostic> diagnostics;
+
+  SourceEditResult();
+  ~SourceEditResult();
+  SourceEditResult(SourceEditResult &&) noexcept;
+  SourceEditResult &operator=(SourceEditResult &&) noexcept;
+  SourceEditResult(const SourceEditResult &) = delete;
+  SourceEditResult &operator=(const SourceEditResult &) = delete;
+
+  bool success() const;
+};
+
+// Records clause and fragment edits on a parsed directive as replacements of
+// the text it was parsed from, so a tool rewrites only the bytes it changes
+// and keeps the surrounding formatting. Clauses are located by the keyword
+// positions the parser records and fragments by their source ranges; an edit
+// that cannot be located, or that overlaps an earlier one, is dropped and
+// reported by finish(). Neither the directive nor the source is modified, and
+// both must outlive the editor. A clause or fragment the directive does not
+// own throws std::invalid_argument.
+class DirectiveEditor {
+public:
+  DirectiveEditor(const OpenMPDirective &directive, std::string_view source);
+
+  // Inserts clause_text after the last clause, separated by a space.
+  DirectiveEditor &addClause(std::string_view clause_text);
+  // Deletes the clause with the separator that follows it, or with the one
+  // that precedes it when it is the last clause.
+  DirectiveEditor &removeClause(const OpenMPClause &clause);
+  DirectiveEditor &replaceClause(const OpenMPClause &clause,
+                                 std::string_view clause_text);
+  DirectiveEditor &replaceFragment(const HostFragment &fragment,
+                                   std::string_view spelling);
+
+  // Applies the edits and parses the result with options, which should be
+  // the ones the directive was parsed with. The edits are returned even when
+  // the edited text does not parse.
+  SourceEditResult finish(const ParseOptions &options = {}) const;
+
+private:
+  struct ClauseSpan {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    // Where a removal of the clause starts and stops.
+    std::size_t remove_begin = 0;
+    std::size_t remove_end = 0;
+  };
+
+  std::size_t clauseIndex(const OpenMPClause &clause) const;
+  void record(std::size_t offset, std::size_t length, std::string_view text);
+  void reportEdit(const std::string &message);
+
+  const OpenMPDirective &directive;
+  std::string_view source;
+  std::vector<const OpenMPClause *> clauses;
+  // Empty when the clause positions do not match the source.
+  std::vector<ClauseSpan> spans;
+  std::size_t insertion_offset = 0;
+  std::vector<SourceEdit> edits;
+  std::vector<Diagnostic> diagnostics;
+};
+
+// Returns source with edits, sorted and non-overlapping as finish() returns
+// them, applied.
+std::string applySourceEdits(std::string_view source,
+                             const std::vector<SourceEdit> &edits);
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPDIRECTIVEEDITOR_H
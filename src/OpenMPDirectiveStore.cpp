@@ -0,0 +1,382 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// Columnar directive store: writer and in-place reader.
+
+#include "OpenMPDirectiveStore.h"
+#include "OpenMPIR.h"
+#include "OpenMPIRVisitor.h"
+#include "OpenMPParserInternal.h"
+#include "OpenMPSchema.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace {
+
+using namespace ompparser;
+
+constexpr char StoreMagic[4] = {'O', 'M', 'P', 'C'};
+// Written in host order; a reader on a host of the other byte order sees it
+// reversed.
+constexpr uint32_t StoreByteOrderMark = 0x01020304;
+// Magic, version, byte order mark, then the directive, clause, item and
+// string counts and the size of the string bytes.
+constexpr std::size_t StoreHeaderWords = 8;
+constexpr std::size_t StoreAlignment = 8;
+
+constexpr std::size_t alignedSize(std::size_t size) {
+  return (size + StoreAlignment - 1) / StoreAlignment * StoreAlignment;
+}
+
+// Fills the modifier slots of one clause; clauses without modifiers keep
+// NoClauseModifier in every slot.
+class ModifierCollector
+    : public ompparser::ConstOpenMPIRVisitor<ModifierCollector> {
+public:
+  explicit ModifierCollector(uint16_t *slots) : slots(slots) {
+    std::fill(slots, slots + ClauseModifierSlots, NoClauseModifier);
+  }
+
+  bool visitIfClause(const OpenMPIfClause &clause) {
+    return set(clause.getModifier());
+  }
+  bool visitDefaultClause(const OpenMPDefaultClause &clause) {
+    return set(clause.getDefaultClauseKind(), clause.getCategory());
+  }
+  bool visitReductionClause(const OpenMPReductionClause &clause) {
+    return set(clause.getIdentifier(), clause.getModifier());
+  }
+  bool visitProcBindClause(const OpenMPProcBindClause &clause) {
+    return set(clause.getProcBindClauseKind());
+  }
+  bool visitAllocateClause(const OpenMPAllocateClause &clause) {
+    return set(clause.getAllocator());
+  }
+  bool visitLastprivateClause(const OpenMPLastprivateClause &clause) {
+    return set(clause.getModifier());
+  }
+  bool visitOrderClause(const OpenMPOrderClause &clause) {
+    return set(clause.getOrderClauseKind(), clause.getOrderClauseModifier());
+  }
+  bool visitLinearClause(const OpenMPLinearClause &clause) {
+    return set(clause.getModifier());
+  }
+  bool visitScheduleClause(const OpenMPScheduleClause &clause) {
+    return set(clause.getKind(), clause.getModifier1(),
+               clause.getModifier2());
+  }
+  bool visitDistScheduleClause(const OpenMPDistScheduleClause &clause) {
+    return set(clause.getKind());
+  }
+  bool visitBindClause(const OpenMPBindClause &clause) {
+    return set(clause.getBindClauseBinding());
+  }
+  bool visitAllocatorClause(const OpenMPAllocatorClause &clause) {
+    return set(clause.getAllocator());
+  }
+  bool visitInitializerClause(const OpenMPInitializerClause &clause) {
+    return set(clause.getPriv());
+  }
+  bool visitInReductionClause(const OpenMPInReductionClause &clause) {
+    return set(clause.getIdentifier());
+  }
+  bool visitTaskReductionClause(const OpenMPTaskReductionClause &clause) {
+    return set(clause.getIdentifier());
+  }
+  bool visitDependClause(const OpenMPDependClause &clause) {
+    return set(clause.getType(), clause.getModifier());
+  }
+  bool visitDoacrossClause(const OpenMPDoacrossClause &clause) {
+    return set(clause.getType());
+  }
+  bool visitAffinityClause(const OpenMPAffinityClause &clause) {
+    return set(clause.getModifier());
+  }
+  bool visitGrainsizeClause(const OpenMPGrainsizeClause &clause) {
+    return set(clause.getModifier());
+  }
+  bool visitNumTasksClause(const OpenMPNumTasksClause &clause) {
+    return set(clause.getModifier());
+  }
+  bool visitAtomicDefaultMemOrderClause(
+      const OpenMPAtomicDefaultMemOrderClause &clause) {
+    return set(clause.getKind());
+  }
+  bool visitDeviceClause(const OpenMPDeviceClause &clause) {
+    return set(clause.getModifier());
+  }
+  bool visitMapClause(const OpenMPMapClause &clause) {
+    return set(clause.getType(), clause.getModifier1(), clause.getModifier2(),
+               clause.getModifier3());
+  }
+  bool visitDefaultmapClause(const OpenMPDefaultmapClause &clause) {
+    return set(clause.getBehavior(), clause.getCategory());
+  }
+  bool visitToClause(const OpenMPToClause &clause) {
+    return set(clause.getKind());
+  }
+  bool visitFromClause(const OpenMPFromClause &clause) {
+    return set(clause.getKind());
+  }
+  bool visitDeviceTypeClause(const OpenMPDeviceTypeClause &clause) {
+    return set(clause.getDeviceTypeClauseKind());
+  }
+  bool visitDepobjUpdateClause(const OpenMPDepobjUpdateClause &clause) {
+    return set(clause.getType());
+  }
+  bool visitFailClause(const OpenMPFailClause &clause) {
+    return set(clause.getMemoryOrder());
+  }
+  bool visitAtClause(const OpenMPAtClause &clause) {
+    return set(clause.getAtKind());
+  }
+  bool visitSeverityClause(const OpenMPSeverityClause &clause) {
+    return set(clause.getSeverityKind());
+  }
+  bool visitMemscopeClause(const OpenMPMemscopeClause &clause) {
+    return set(clause.getScope());
+  }
+  bool visitAdjustArgsClause(const OpenMPAdjustArgsClause &clause) {
+    return set(clause.getModifier());
+  }
+
+private:
+  template <typename... Values> bool set(Values... values) {
+    static_assert(sizeof...(Values) <= ClauseModifierSlots);
+    std::size_t slot = 0;
+    ((slots[slot++] = static_cast<uint16_t>(values)), ...);
+    return true;
+  }
+
+  uint16_t *slots;
+};
+
+template <typename T>
+void appendColumn(TextSink &sink, const T *data, std::size_t count) {
+  static const char padding[StoreAlignment] = {};
+  std::size_t size = count * sizeof(T);
+  if (size != 0) {
+    sink.append(std::string_view(reinterpret_cast<const char *>(data), size));
+  }
+  sink.append(std::string_view(padding, alignedSize(size) - size));
+}
+
+template <typename T>
+void appendColumn(TextSink &sink, const std::vector<T> &column) {
+  appendColumn(sink, column.data(), column.size());
+}
+
+// Checks an offset column: starts at zero, never decreases, ends at total.
+bool monotone(const uint32_t *offsets, std::size_t count, uint32_t total) {
+  if (offsets[0] != 0 || offsets[count] != total) {
+    return false;
+  }
+  for (std::size_t i = 0; i < count; ++i) {
+    if (offsets[i] > offsets[i + 1]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool allBelow(const uint32_t *ids, std::size_t count, std::size_t bound) {
+  return std::all_of(ids, ids + count,
+                     [bound](uint32_t id) { return id < bound; });
+}
+
+} // namespace
+
+namespace ompparser {
+
+namespace detail {
+
+void collectClauseModifiers(const OpenMPClause &clause, uint16_t *slots) {
+  ModifierCollector(slots).dispatch(clause);
+}
+
+} // namespace detail
+
+uint32_t DirectiveStoreWriter::intern(std::string_view text) {
+  auto found = string_ids.find(std::string(text));
+  if (found != string_ids.end()) {
+    return found->second;
+  }
+  if (string_bytes.size() + text.size() >
+      std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("directive store string table exceeds 4 GiB");
+  }
+  uint32_t id = static_cast<uint32_t>(string_offsets.size() - 1);
+  string_bytes.append(text);
+  string_offsets.push_back(static_cast<uint32_t>(string_bytes.size()));
+  string_ids.emplace(std::string(text), id);
+  return id;
+}
+
+void DirectiveStoreWriter::add(const OpenMPDirective &directive,
+                               std::string_view file) {
+  const std::vector<OpenMPClause *> &clauses =
+      directive.getClausesInOriginalOrder();
+  std::size_t items = 0;
+  for (const OpenMPClause *clause : clauses) {
+    items += clause->getExpressionItems().size();
+  }
+  if (clause_kinds.size() + clauses.size() >
+          std::numeric_limits<uint32_t>::max() ||
+      item_spellings.size() + items > std::numeric_limits<uint32_t>::max()) {
+    throw std::length_error("directive store exceeds 2^32 clauses or items");
+  }
+
+  directive_kinds.push_back(static_cast<uint16_t>(directive.getKind()));
+  directive_files.push_back(intern(file));
+  directive_lines.push_back(
+      static_cast<uint32_t>(std::max(directive.getLine(), 0)));
+  uint16_t modifiers[ClauseModifierSlots];
+  for (const OpenMPClause *clause : clauses) {
+    clause_kinds.push_back(
+        static_cast<uint16_t>(clause->OpenMPClause::getKind()));
+    detail::collectClauseModifiers(*clause, modifiers);
+    for (std::size_t slot = 0; slot < ClauseModifierSlots; ++slot) {
+      clause_modifiers[slot].push_back(modifiers[slot]);
+    }
+    for (const OpenMPExpressionItem &item : clause->getExpressionItems()) {
+      item_spellings.push_back(intern(item.fragment.spelling));
+    }
+    item_offsets.push_back(static_cast<uint32_t>(item_spellings.size()));
+  }
+  clause_offsets.push_back(static_cast<uint32_t>(clause_kinds.size()));
+}
+
+void DirectiveStoreWriter::finish(TextSink &sink) {
+  uint32_t header[StoreHeaderWords] = {
+      0,
+      DirectiveStoreVersion,
+      StoreByteOrderMark,
+      static_cast<uint32_t>(directive_kinds.size()),
+      static_cast<uint32_t>(clause_kinds.size()),
+      static_cast<uint32_t>(item_spellings.size()),
+      static_cast<uint32_t>(string_offsets.size() - 1),
+      static_cast<uint32_t>(string_bytes.size())};
+  std::memcpy(&header[0], StoreMagic, sizeof(StoreMagic));
+  appendColumn(sink, header, StoreHeaderWords);
+  appendColumn(sink, directive_kinds);
+  appendColumn(sink, directive_files);
+  appendColumn(sink, directive_lines);
+  appendColumn(sink, clause_offsets);
+  appendColumn(sink, clause_kinds);
+  for (const std::vector<uint16_t> &column : clause_modifiers) {
+    appendColumn(sink, column);
+  }
+  appendColumn(sink, item_offsets);
+  appendColumn(sink, item_spellings);
+  appendColumn(sink, string_offsets);
+  appendColumn(sink, string_bytes.data(), string_bytes.size());
+  *this = DirectiveStoreWriter();
+}
+
+bool DirectiveStoreResult::success() const {
+  return std::none_of(diagnostics.begin(), diagnostics.end(),
+                      [](const Diagnostic &diagnostic) {
+                        return diagnostic.severity == DiagnosticSeverity::Error;
+                      });
+}
+
+DirectiveStoreResult openDirectiveStore(std::string_view bytes) {
+  DirectiveStoreResult result;
+  auto reject = [&result](const std::string &message) {
+    Diagnostic diagnostic;
+    diagnostic.code = DiagnosticCode::MalformedSerialization;
+    diagnostic.severity = DiagnosticSeverity::Error;
+    diagnostic.message = message;
+    result.diagnostics.push_back(std::move(diagnostic));
+    return std::move(result);
+  };
+  if (reinterpret_cast<std::uintptr_t>(bytes.data()) % StoreAlignment != 0) {
+    return reject("directive store is not 8-byte aligned");
+  }
+  uint32_t header[StoreHeaderWords];
+  if (bytes.size() < sizeof(header) ||
+      std::memcmp(bytes.data(), StoreMagic, sizeof(StoreMagic)) != 0) {
+    return reject("input is not an OpenMP directive store");
+  }
+  std::memcpy(header, bytes.data(), sizeof(header));
+  if (header[2] != StoreByteOrderMark) {
+    return reject("directive store was written with another byte order");
+  }
+  if (header[1] != DirectiveStoreVersion) {
+    return reject("directive store version " + std::to_string(header[1]) +
+                  " is not supported");
+  }
+
+  std::size_t directives = header[3];
+  std::size_t clauses = header[4];
+  std::size_t items = header[5];
+  std::size_t strings = header[6];
+  std::size_t string_size = header[7];
+  std::size_t expected =
+      sizeof(header) + alignedSize(directives * sizeof(uint16_t)) +
+      2 * alignedSize(directives * sizeof(uint32_t)) +
+      alignedSize((directives + 1) * sizeof(uint32_t)) +
+      (1 + ClauseModifierSlots) * alignedSize(clauses * sizeof(uint16_t)) +
+      alignedSize((clauses + 1) * sizeof(uint32_t)) +
+      alignedSize(items * sizeof(uint32_t)) +
+      alignedSize((strings + 1) * sizeof(uint32_t)) + alignedSize(string_size);
+  if (bytes.size() != expected) {
+    return reject("directive store size does not match its header");
+  }
+
+  const char *cursor = bytes.data() + sizeof(header);
+  auto column = [&cursor](auto &pointer, std::size_t count) {
+    using T = std::remove_const_t<
+        std::remove_pointer_t<std::remove_reference_t<decltype(pointer)>>>;
+    pointer = reinterpret_cast<const T *>(cursor);
+    cursor += alignedSize(count * sizeof(T));
+  };
+  DirectiveStore &store = result.store;
+  column(store.directive_kinds, directives);
+  column(store.directive_files, directives);
+  column(store.directive_lines, directives);
+  column(store.clause_offsets, directives + 1);
+  column(store.clause_kinds, clauses);
+  for (const uint16_t *&modifiers : store.clause_modifiers) {
+    column(modifiers, clauses);
+  }
+  column(store.item_offsets, clauses + 1);
+  column(store.item_spellings, items);
+  column(store.string_offsets, strings + 1);
+  store.string_bytes = cursor;
+
+  if (!monotone(store.clause_offsets, directives,
+                static_cast<uint32_t>(clauses)) ||
+      !monotone(store.item_offsets, clauses, static_cast<uint32_t>(items)) ||
+      !monotone(store.string_offsets, strings,
+                static_cast<uint32_t>(string_size)) ||
+      !allBelow(store.directive_files, directives, strings) ||
+      !allBelow(store.item_spellings, items, strings)) {
+    result.store = DirectiveStore();
+    return reject("directive store has out-of-range offsets or string ids");
+  }
+  if (std::any_of(store.directive_kinds, store.directive_kinds + directives,
+                  [](uint16_t kind) { return kind >= DirectiveKindCount; }) ||
+      std::any_of(store.clause_kinds, store.clause_kinds + clauses,
+                  [](uint16_t kind) { return kind >= ClauseKindCount; })) {
+    result.store = DirectiveStore();
+    return reject("directive store has unknown directive or clause kinds");
+  }
+  store.directive_count = directives;
+  store.clause_count = clauses;
+  store.item_count = items;
+  store.string_count = strings;
+  return result;
+}
+
+} // namespace ompparser
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPDIRECTIVESTORE_H
+#define OMPPARSER_OPENMPDIRECTIVESTORE_H
+
+#include "OpenMPKinds.h"
+#include "OpenMPParser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ompparser {
+
+// Version of the directive store layout; stores of another version are
+// rejected by openDirectiveStore.
+inline constexpr uint32_t DirectiveStoreVersion = 1;
+
+// Number of modifier columns per clause. Slot 0 holds the value that says
+// what the clause does (map type, schedule kind, reduction identifier,
+// default kind, proc_bind kind, ...) and slots 1 to 3 its modifiers in the
+// order the clause class declares them, e.g. map-type modifiers 1 to 3.
+inline constexpr std::size_t ClauseModifierSlots = 4;
+// Modifier slot value of a clause that has no value in that slot.
+inline constexpr uint16_t NoClauseModifier = 0xFFFF;
+
+// Accumulates directives as columns: one array per field, indexed by
+// directive, clause or list item, with host fragment spellings and file
+// names interned into one string table. Only the columns are kept, so a
+// batch of parsed directives can be added one at a time and discarded.
+// Directives nested in clauses, and fragments outside a clause's list items,
+// are not recorded.
+class DirectiveStoreWriter {
+public:
+  // Appends directive, parsed from line directive.getLine() of file.
+  void add(const OpenMPDirective &directive, std::string_view file);
+  std::size_t directiveCount() const { return directive_kinds.size(); }
+
+  // Writes the store into sink and empties the writer. The image is laid out
+  // for openDirectiveStore to use in place: every column starts on an
+  // 8-byte boundary of it.
+  void finish(TextSink &sink);
+
+private:
+  uint32_t intern(std::string_view text);
+
+  std::vector<uint16_t> directive_kinds;
+  std::vector<uint32_t> directive_files;
+  std::vector<uint32_t> directive_lines;
+  std::vector<uint32_t> clause_offsets{0};
+  std::vector<uint16_t> clause_kinds;
+  std::vector<uint16_t> clause_modifiers[ClauseModifierSlots];
+  std::vector<uint32_t> item_offsets{0};
+  std::vector<uint32_t> item_spellings;
+  std::vector<uint32_t> string_offsets{0};
+  std::string string_bytes;
+  std::unordered_map<std::string, uint32_t> string_ids;
+};
+
+struct DirectiveStoreResult;
+
+// Read-only view of a store written by DirectiveStoreWriter. Columns are
+// plain arrays into the image, so a query is a scan over them, e.g. the
+// target directives with a map(tofrom:) of more than three items:
+//
+//   for (std::size_t d = 0; d < store.directiveCount(); ++d) {
+//     if (store.directiveKinds()[d] != OMPD_target) continue;
+//     for (uint32_t c = store.clauseOffsets()[d];
+//          c < store.clauseOffsets()[d + 1]; ++c) {
+//       if (store.clauseKinds()[c] == OMPC_map &&
+//           store.clauseModifiers(0)[c] == OMPC_MAP_TYPE_tofrom &&
+//           store.itemOffsets()[c + 1] - store.itemOffsets()[c] > 3) ...
+//     }
+//   }
+class DirectiveStore {
+public:
+  std::size_t directiveCount() const { return directive_count; }
+  std::size_t clauseCount() const { return clause_count; }
+  std::size_t itemCount() const { return item_count; }
+  std::size_t stringCount() const { return string_count; }
+
+  // Indexed by directive. Files are string ids.
+  const uint16_t *directiveKinds() const { return directive_kinds; }
+  const uint32_t *directiveFiles() const { return directive_files; }
+  const uint32_t *directiveLines() const { return directive_lines; }
+  // directiveCount() + 1 entries; the clauses of directive d, in source
+  // order, are [clauseOffsets()[d], clauseOffsets()[d + 1]).
+  const uint32_t *clauseOffsets() const { return clause_offsets; }
+
+  // Indexed by clause.
+  const uint16_t *clauseKinds() const { return clause_kinds; }
+  // slot < ClauseModifierSlots.
+  const uint16_t *clauseModifiers(std::size_t slot) const {
+    return clause_modifiers[slot];
+  }
+  // clauseCount() + 1 entries, delimiting each clause's list items.
+  const uint32_t *itemOffsets() const { return item_offsets; }
+
+  // Indexed by list item: the string id of its spelling.
+  const uint32_t *itemSpellings() const { return item_spellings; }
+
+  std::string_view string(uint32_t id) const {
+    return std::string_view(string_bytes + string_offsets[id],
+                            string_offsets[id + 1] - string_offsets[id]);
+  }
+
+private:
+  friend DirectiveStoreResult openDirectiveStore(std::string_view bytes);
+
+  std::size_t directive_count = 0;
+  std::size_t clause_count = 0;
+  std::size_t item_count = 0;
+  std::size_t string_count = 0;
+  const uint16_t *directive_kinds = nullptr;
+  const uint32_t *directive_files = nullptr;
+  const uint32_t *directive_lines = nullptr;
+  const uint32_t *clause_offsets = nullptr;
+  const uint16_t *clause_kinds = nullptr;
+  const uint16_t *clause_modifiers[ClauseModifierSlots] = {};
+  const uint32_t *item_offsets = nullptr;
+  const uint32_t *item_spellings = nullptr;
+  const uint32_t *string_offsets = nullptr;
+  const char *string_bytes = nullptr;
+};
+
+struct DirectiveStoreResult {
+  DirectiveStore store;
+  std::vector<Diagnostic> diagnostics;
+
+  bool success() const;
+};
+
+// Views bytes, such as a mapping of a file finish() wrote, as a store; bytes
+// must start on an 8-byte boundary and outlive the store. The offset columns
+// and string ids are checked once here, so scans need no bounds checks. A
+// store that does not match the layout, this version or the host byte order
+// yields an empty store and a MalformedSerialization diagnostic.
+DirectiveStoreResult openDirectiveStore(std::string_view bytes);
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPDIRECTIVESTORE_H
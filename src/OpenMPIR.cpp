@@ -14,6 +14,8 @@
 #include <cstring>
 #include <memory>
 #include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 
 extern thread_local bool clause_separator_comma;
@@ -1525,13 +1527,16 @@ bool parseOpenMPIteratorDefinitions(const char *spelling,
 }
 
 void OpenMPApplyClause::setLabel(const char *value) {
+  noteModified();
   label = makeHostFragment(value, ompparser::HostFragmentRole::Verbatim,
                            OMP_EXPR_PARSE_openmp_syntax);
+  label.clause_kind = kind;
 }
 
 void OpenMPApplyClause::addTransformation(OpenMPApplyTransformKind kind,
                                           const char *argument,
                                           OpenMPClauseSeparator sep) {
+  noteModified();
   ApplyTransform t;
   t.kind = kind;
   t.argument = makeHostFragment(argument,
@@ -1541,12 +1546,14 @@ void OpenMPApplyClause::addTransformation(OpenMPApplyTransformKind kind,
                                 kind == OMPC_APPLY_TRANSFORM_unknown
                                     ? OMP_EXPR_PARSE_openmp_syntax
                                     : OMP_EXPR_PARSE_expression);
+  t.argument.clause_kind = getKind();
   t.separator = sep;
   transforms.push_back(std::move(t));
 }
 
 void OpenMPApplyClause::addNestedApply(OpenMPApplyClause *nested,
                                        OpenMPClauseSeparator sep) {
+  noteModified();
   if (nested == nullptr) {
     throw std::invalid_argument("nested apply transformation is null");
   }
@@ -1557,19 +1564,30 @@ void OpenMPApplyClause::addNestedApply(OpenMPApplyClause *nested,
   transforms.push_back(std::move(t));
 }
 
+void OpenMPClause::noteModified() {
+  ++modification_generation;
+  if (owner_directive != nullptr) {
+    owner_directive->noteClauseModified();
+  }
+}
+
 OpenMPClause *
 OpenMPDirective::registerClause(std::unique_ptr<OpenMPClause> clause) {
+  noteModified();
   if (clause == nullptr) {
     throw std::invalid_argument("cannot register a null clause");
   }
   clause->setDirectiveKind(this->kind);
   clause->setBaseLang(this->lang);
+  clause->owner_directive = this;
   OpenMPClause *raw_ptr = clause.get();
   clause_storage.push_back(std::move(clause));
+  parser_constructed = false;
   return raw_ptr;
 }
 
 void OpenMPDirective::setBaseLang(OpenMPBaseLang value) {
+  noteModified();
   lang = value;
   for (const std::unique_ptr<OpenMPClause> &clause : clause_storage) {
     if (clause == nullptr) {
@@ -1580,6 +1598,8 @@ void OpenMPDirective::setBaseLang(OpenMPBaseLang value) {
 }
 
 void OpenMPDirective::adoptClausesFrom(OpenMPDirective &source) {
+  noteModified();
+  source.noteModified();
   if (lang != Lang_unknown && source.lang != Lang_unknown &&
       lang != source.lang) {
     throw std::logic_error(
@@ -1588,6 +1608,8 @@ void OpenMPDirective::adoptClausesFrom(OpenMPDirective &source) {
   if (lang == Lang_unknown && source.lang != Lang_unknown) {
     setBaseLang(source.lang);
   }
+  parser_constructed = false;
+  source.parser_constructed = false;
   for (auto &entry : source.clauses) {
     auto &destination = clauses[entry.first];
     destination.insert(destination.end(), entry.second.begin(),
@@ -1595,13 +1617,13 @@ void OpenMPDirective::adoptClausesFrom(OpenMPDirective &source) {
   }
   source.clauses.clear();
 
+  std::unordered_set<const OpenMPClause *> ordered(
+      clauses_in_original_order.begin(), clauses_in_original_order.end());
   for (OpenMPClause *clause : source.clauses_in_original_order) {
     if (clause == nullptr) {
       throw std::logic_error("cannot adopt a null clause-order entry");
     }
-    if (std::find(clauses_in_original_order.begin(),
-                  clauses_in_original_order.end(),
-                  clause) != clauses_in_original_order.end()) {
+    if (!ordered.insert(clause).second) {
       throw std::logic_error("cannot adopt a duplicate clause-order entry");
     }
     clause->setClausePosition(
@@ -1614,53 +1636,72 @@ void OpenMPDirective::adoptClausesFrom(OpenMPDirective &source) {
     if (clause == nullptr) {
       throw std::logic_error("cannot adopt a null owned clause");
     }
+    clause->owner_directive = this;
     clause->setBaseLang(lang);
     clause_storage.push_back(std::move(clause));
   }
   source.clause_storage.clear();
 }
 
+bool OpenMPDirective::collectConstructionErrors(
+    std::vector<std::string> &errors) const {
+  const std::size_t initial_error_count = errors.size();
+  errors.insert(errors.end(), construction_errors.begin(),
+                construction_errors.end());
+  for (const auto &clause : clause_storage) {
+    if (clause) {
+      errors.insert(errors.end(), clause->getConstructionErrors().begin(),
+                    clause->getConstructionErrors().end());
+    }
+  }
+  return errors.size() == initial_error_count;
+}
+
 bool OpenMPDirective::validateInvariants(
     std::vector<std::string> &errors) const {
   errors.insert(errors.end(), construction_errors.begin(),
                 construction_errors.end());
-  std::vector<const OpenMPClause *> owned;
+  std::unordered_set<const OpenMPClause *> owned;
   owned.reserve(clause_storage.size());
   for (const auto &clause : clause_storage) {
     if (!clause) {
       errors.push_back("directive owns a null clause");
       continue;
     }
-    if (std::find(owned.begin(), owned.end(), clause.get()) != owned.end()) {
+    if (!owned.insert(clause.get()).second) {
       errors.push_back("directive owns the same clause more than once");
       continue;
     }
     errors.insert(errors.end(), clause->getConstructionErrors().begin(),
                   clause->getConstructionErrors().end());
-    owned.push_back(clause.get());
   }
 
+  // Maps each indexed clause to whether it appears under its own kind.
+  std::unordered_map<const OpenMPClause *, bool> indexed;
+  indexed.reserve(clauses_in_original_order.size());
   for (const auto &entry : clauses) {
-    std::vector<const OpenMPClause *> indexed;
     for (const OpenMPClause *clause : entry.second) {
       if (!clause) {
         errors.push_back("clause index contains a null entry");
         continue;
       }
-      if (clause->getKind() != entry.first) {
+      const bool matches_kind = clause->getKind() == entry.first;
+      if (!matches_kind) {
         errors.push_back("clause index kind does not match clause payload");
       }
-      if (std::find(owned.begin(), owned.end(), clause) == owned.end()) {
+      if (owned.count(clause) == 0) {
         errors.push_back("clause index references an unowned clause");
       }
-      if (std::find(indexed.begin(), indexed.end(), clause) != indexed.end()) {
+      auto inserted = indexed.emplace(clause, matches_kind);
+      if (!inserted.second) {
         errors.push_back("clause index contains a duplicate pointer");
+        inserted.first->second = inserted.first->second || matches_kind;
       }
-      indexed.push_back(clause);
     }
   }
 
-  std::vector<const OpenMPClause *> ordered;
+  std::unordered_set<const OpenMPClause *> ordered;
+  ordered.reserve(clauses_in_original_order.size());
   for (std::size_t index = 0; index < clauses_in_original_order.size();
        ++index) {
     const OpenMPClause *clause = clauses_in_original_order[index];
@@ -1668,26 +1709,23 @@ bool OpenMPDirective::validateInvariants(
       errors.push_back("source-order sequence contains a null clause");
       continue;
     }
-    if (std::find(owned.begin(), owned.end(), clause) == owned.end()) {
+    if (owned.count(clause) == 0) {
       errors.push_back("source-order sequence references an unowned clause");
     }
-    if (std::find(ordered.begin(), ordered.end(), clause) != ordered.end()) {
+    if (!ordered.insert(clause).second) {
       errors.push_back("source-order sequence contains a duplicate pointer");
     }
     if (clause->getClausePosition() != static_cast<int>(index)) {
       errors.push_back("clause position does not match source-order index");
     }
-    const auto kind_iter = clauses.find(clause->getKind());
-    if (kind_iter == clauses.end() ||
-        std::find(kind_iter->second.begin(), kind_iter->second.end(), clause) ==
-            kind_iter->second.end()) {
+    const auto indexed_iter = indexed.find(clause);
+    if (indexed_iter == indexed.end() || !indexed_iter->second) {
       errors.push_back("source-order clause is absent from its kind index");
     }
-    ordered.push_back(clause);
   }
 
-  for (const OpenMPClause *clause : owned) {
-    if (std::find(ordered.begin(), ordered.end(), clause) == ordered.end()) {
+  for (const auto &clause : clause_storage) {
+    if (clause && ordered.count(clause.get()) == 0) {
       errors.push_back("owned clause is absent from source order");
     }
   }
@@ -1696,6 +1734,7 @@ bool OpenMPDirective::validateInvariants(
 }
 
 void OpenMPDeclareReductionDirective::setCombiner(const char *_combiner) {
+  noteModified();
   combiner =
       makeHostFragment(_combiner, ompparser::HostFragmentRole::Expression);
   ompparser::SourceRange source_range;
@@ -1706,11 +1745,13 @@ void OpenMPDeclareReductionDirective::setCombiner(const char *_combiner) {
 }
 
 void OpenMPDeclareVariantDirective::setVariantFuncID(const char *identifier) {
+  noteModified();
   variant_func_id =
       makeHostFragment(identifier, ompparser::HostFragmentRole::Declarator);
 }
 
 void OpenMPAllocateDirective::addAllocateList(const char *item) {
+  noteModified();
   if (item != nullptr) {
     allocate_list.push_back(
         makeHostFragment(item, ompparser::HostFragmentRole::Variable));
@@ -1718,6 +1759,7 @@ void OpenMPAllocateDirective::addAllocateList(const char *item) {
 }
 
 void OpenMPThreadprivateDirective::addThreadprivateList(const char *item) {
+  noteModified();
   if (item != nullptr) {
     threadprivate_list.push_back(
         makeHostFragment(item, ompparser::HostFragmentRole::Variable));
@@ -1725,6 +1767,7 @@ void OpenMPThreadprivateDirective::addThreadprivateList(const char *item) {
 }
 
 void OpenMPGroupprivateDirective::addGroupprivateList(const char *item) {
+  noteModified();
   if (item != nullptr) {
     groupprivate_list.push_back(
         makeHostFragment(item, ompparser::HostFragmentRole::Variable));
@@ -1732,10 +1775,12 @@ void OpenMPGroupprivateDirective::addGroupprivateList(const char *item) {
 }
 
 void OpenMPDeclareSimdDirective::addProcName(const char *name) {
+  noteModified();
   proc_name = makeHostFragment(name, ompparser::HostFragmentRole::Expression);
 }
 
 void OpenMPDeclareTargetDirective::addExtendedList(const char *item) {
+  noteModified();
   if (item != nullptr) {
     extended_list.push_back(
         makeHostFragment(item, ompparser::HostFragmentRole::Locator));
@@ -1743,6 +1788,7 @@ void OpenMPDeclareTargetDirective::addExtendedList(const char *item) {
 }
 
 void OpenMPFlushDirective::addFlushList(const char *item) {
+  noteModified();
   if (item != nullptr) {
     flush_list.push_back(
         makeHostFragment(item, ompparser::HostFragmentRole::Variable));
@@ -1750,22 +1796,28 @@ void OpenMPFlushDirective::addFlushList(const char *item) {
 }
 
 void OpenMPDepobjDirective::addDepobj(const char *item) {
+  noteModified();
   depobj = makeHostFragment(item, ompparser::HostFragmentRole::Expression);
 }
 
 void OpenMPDependClause::addDependenceVector(const char *dependence) {
+  noteModified();
   dependence_vector =
       makeHostFragment(dependence, ompparser::HostFragmentRole::Expression);
+  dependence_vector.clause_kind = kind;
 }
 
 void OpenMPReductionClause::setUserDefinedIdentifier(const char *identifier) {
+  noteModified();
   user_defined_identifier =
       makeHostFragment(identifier, ompparser::HostFragmentRole::Declarator,
                        OMP_EXPR_PARSE_openmp_syntax);
+  user_defined_identifier.clause_kind = kind;
 }
 
 void OpenMPReductionClause::setUserDefinedIdentifierSourceRange(
     const ompparser::SourceRange &source_range) {
+  noteModified();
   if (user_defined_identifier.spelling.empty() ||
       source_range.end.offset <= source_range.begin.offset) {
     throw std::invalid_argument(
@@ -1775,24 +1827,31 @@ void OpenMPReductionClause::setUserDefinedIdentifierSourceRange(
 }
 
 void OpenMPIfClause::setUserDefinedModifier(const char *modifier) {
+  noteModified();
   user_defined_modifier =
       makeHostFragment(modifier, ompparser::HostFragmentRole::Declarator);
+  user_defined_modifier.clause_kind = kind;
 }
 
 void OpenMPInReductionClause::setUserDefinedIdentifier(const char *identifier) {
+  noteModified();
   user_defined_identifier =
       makeHostFragment(identifier, ompparser::HostFragmentRole::Declarator,
                        OMP_EXPR_PARSE_openmp_syntax);
+  user_defined_identifier.clause_kind = kind;
 }
 
 void OpenMPTaskReductionClause::setUserDefinedIdentifier(
     const char *identifier) {
+  noteModified();
   user_defined_identifier =
       makeHostFragment(identifier, ompparser::HostFragmentRole::Declarator,
                        OMP_EXPR_PARSE_openmp_syntax);
+  user_defined_identifier.clause_kind = kind;
 }
 
 void OpenMPAllocateClause::setUserDefinedAllocator(const char *_allocator) {
+  noteModified();
   if (_allocator == nullptr || *_allocator == '\0' ||
       !user_defined_allocator.spelling.empty()) {
     construction_errors.push_back(
@@ -1805,6 +1864,7 @@ void OpenMPAllocateClause::setUserDefinedAllocator(const char *_allocator) {
 }
 
 void OpenMPAllocateClause::setAllocatorModifier(const char *allocator) {
+  noteModified();
   if (allocator == nullptr || *allocator == '\0' ||
       this->allocator != OMPC_ALLOCATE_ALLOCATOR_unspecified ||
       !user_defined_allocator.spelling.empty() ||
@@ -1826,6 +1886,7 @@ void OpenMPAllocateClause::setAllocatorModifier(const char *allocator) {
 }
 
 void OpenMPAllocateClause::setAlignModifier(const char *value) {
+  noteModified();
   const bool has_legacy_allocator =
       allocator != OMPC_ALLOCATE_ALLOCATOR_unspecified &&
       allocator != OMPC_ALLOCATE_ALLOCATOR_user;
@@ -1847,34 +1908,47 @@ bool OpenMPAllocateClause::usesAllocatorModifierSyntax() const {
 }
 
 void OpenMPAllocatorClause::setUserDefinedAllocator(const char *allocator) {
+  noteModified();
   user_defined_allocator =
       makeHostFragment(allocator, ompparser::HostFragmentRole::Expression);
+  user_defined_allocator.clause_kind = kind;
 }
 
 void OpenMPLinearClause::setUserDefinedStep(const char *step) {
+  noteModified();
   user_defined_step =
       makeHostFragment(step, ompparser::HostFragmentRole::Expression);
+  user_defined_step.clause_kind = kind;
 }
 
 void OpenMPAlignedClause::setUserDefinedAlignment(const char *alignment) {
+  noteModified();
   user_defined_alignment =
       makeHostFragment(alignment, ompparser::HostFragmentRole::Expression);
+  user_defined_alignment.clause_kind = kind;
 }
 
 void OpenMPDistScheduleClause::setChunkSize(const char *size) {
+  noteModified();
   chunk_size = makeHostFragment(size, ompparser::HostFragmentRole::Expression);
+  chunk_size.clause_kind = kind;
 }
 
 void OpenMPScheduleClause::setUserDefinedKind(const char *kind) {
+  noteModified();
   user_defined_kind =
       makeHostFragment(kind, ompparser::HostFragmentRole::Declarator);
+  user_defined_kind.clause_kind = OpenMPClause::getKind();
 }
 
 void OpenMPScheduleClause::setChunkSize(const char *size) {
+  noteModified();
   chunk_size = makeHostFragment(size, ompparser::HostFragmentRole::Expression);
+  chunk_size.clause_kind = kind;
 }
 
 void OpenMPToClause::setMapperIdentifier(const char *_identifier) {
+  noteModified();
   if (_identifier == nullptr) {
     mapper_identifier = {};
     return;
@@ -1882,9 +1956,11 @@ void OpenMPToClause::setMapperIdentifier(const char *_identifier) {
   mapper_identifier =
       makeHostFragment(_identifier, ompparser::HostFragmentRole::Declarator,
                        OMP_EXPR_PARSE_verbatim);
+  mapper_identifier.clause_kind = kind;
 }
 
 void OpenMPFromClause::setMapperIdentifier(const char *_identifier) {
+  noteModified();
   if (_identifier == nullptr) {
     mapper_identifier = {};
     return;
@@ -1892,9 +1968,11 @@ void OpenMPFromClause::setMapperIdentifier(const char *_identifier) {
   mapper_identifier =
       makeHostFragment(_identifier, ompparser::HostFragmentRole::Declarator,
                        OMP_EXPR_PARSE_verbatim);
+  mapper_identifier.clause_kind = kind;
 }
 
 void OpenMPMapClause::setMapperIdentifier(const char *_identifier) {
+  noteModified();
   if (_identifier == nullptr) {
     mapper_identifier = {};
     return;
@@ -1902,10 +1980,12 @@ void OpenMPMapClause::setMapperIdentifier(const char *_identifier) {
   mapper_identifier =
       makeHostFragment(_identifier, ompparser::HostFragmentRole::Declarator,
                        OMP_EXPR_PARSE_verbatim);
+  mapper_identifier.clause_kind = kind;
 }
 
 void OpenMPDeclareReductionDirective::addTypenameList(
     const char *_typename_list) {
+  noteModified();
   if (_typename_list == nullptr) {
     return;
   }
@@ -1914,6 +1994,7 @@ void OpenMPDeclareReductionDirective::addTypenameList(
 }
 
 void OpenMPInitializerClause::setUserDefinedPriv(const char *_priv) {
+  noteModified();
   if (_priv != nullptr && expressions.empty()) {
     addLangExpr(_priv, OMPC_CLAUSE_SEP_space, 0, 0, OMP_EXPR_PARSE_expression);
   }
@@ -1921,6 +2002,7 @@ void OpenMPInitializerClause::setUserDefinedPriv(const char *_priv) {
 
 void OpenMPDeclareMapperDirective::setUserDefinedIdentifier(
     const char *_user_defined_identifier) {
+  noteModified();
   user_defined_identifier = makeHostFragment(
       _user_defined_identifier, ompparser::HostFragmentRole::Declarator,
       OMP_EXPR_PARSE_openmp_declare_mapper_identifier);
@@ -1928,6 +2010,7 @@ void OpenMPDeclareMapperDirective::setUserDefinedIdentifier(
 
 void OpenMPDeclareMapperDirective::setDeclareMapperType(
     const char *_declare_mapper_type) {
+  noteModified();
   type =
       makeHostFragment(_declare_mapper_type, ompparser::HostFragmentRole::Type,
                        OMP_EXPR_PARSE_openmp_declare_mapper_type);
@@ -1935,6 +2018,7 @@ void OpenMPDeclareMapperDirective::setDeclareMapperType(
 
 void OpenMPDeclareMapperDirective::setDeclareMapperVar(
     const char *_declare_mapper_variable) {
+  noteModified();
   var = makeHostFragment(_declare_mapper_variable,
                          ompparser::HostFragmentRole::Variable,
                          OMP_EXPR_PARSE_openmp_declare_mapper_variable);
@@ -1943,6 +2027,7 @@ void OpenMPDeclareMapperDirective::setDeclareMapperVar(
 bool OpenMPDeclareMapperDirective::setSpecification(
     const char *specification, OpenMPBaseLang language,
     OpenMPBaseLang &resolved_language, std::string &error) {
+  noteModified();
   resolved_language = Lang_unknown;
   error.clear();
   if (specification == nullptr ||
@@ -2116,6 +2201,7 @@ OpenMPVariantClause::activeTraitSelector(const char *operation) {
 
 void OpenMPVariantClause::beginTraitSet(
     OpenMPContextSelectorSequenceKind kind) {
+  noteModified();
   if (active_trait_set) {
     recordVariantError("context selector sets cannot be nested");
     return;
@@ -2128,6 +2214,7 @@ void OpenMPVariantClause::beginTraitSet(
 }
 
 void OpenMPVariantClause::endTraitSet() {
+  noteModified();
   if (!active_trait_set) {
     recordVariantError("context selector set terminator has no matching set");
     return;
@@ -2142,6 +2229,7 @@ void OpenMPVariantClause::endTraitSet() {
 void OpenMPVariantClause::beginTraitSelector(
     OpenMPContextTraitSelectorKind kind, const char *score,
     const char *implementation_defined_name) {
+  noteModified();
   TraitSetSelector *set = activeTraitSet("trait selector");
   if (set == nullptr) {
     return;
@@ -2166,6 +2254,7 @@ void OpenMPVariantClause::beginTraitSelector(
 
 void OpenMPVariantClause::addExpressionProperty(
     const char *expression, OpenMPExprParseMode parse_mode) {
+  noteModified();
   TraitSelector *selector = activeTraitSelector("trait property");
   if (selector == nullptr || expression == nullptr) {
     if (expression == nullptr) {
@@ -2184,6 +2273,7 @@ void OpenMPVariantClause::addExpressionProperty(
 }
 
 void OpenMPVariantClause::addContextKindProperty(OpenMPClauseContextKind kind) {
+  noteModified();
   TraitSelector *selector = activeTraitSelector("kind property");
   if (selector == nullptr) {
     return;
@@ -2195,6 +2285,7 @@ void OpenMPVariantClause::addContextKindProperty(OpenMPClauseContextKind kind) {
 
 void OpenMPVariantClause::addContextVendorProperty(
     OpenMPClauseContextVendor vendor) {
+  noteModified();
   TraitSelector *selector = activeTraitSelector("vendor property");
   if (selector == nullptr) {
     return;
@@ -2206,6 +2297,7 @@ void OpenMPVariantClause::addContextVendorProperty(
 
 void OpenMPVariantClause::addAtomicDefaultMemOrderProperty(
     OpenMPAtomicDefaultMemOrderClauseKind kind) {
+  noteModified();
   requireAtomicDefaultMemOrder(kind);
   TraitSelector *selector =
       activeTraitSelector("atomic_default_mem_order property");
@@ -2219,6 +2311,7 @@ void OpenMPVariantClause::addAtomicDefaultMemOrderProperty(
 
 void OpenMPVariantClause::addRequiresProperty(OpenMPClauseKind kind,
                                               const char *required_expression) {
+  noteModified();
   TraitSelector *selector = activeTraitSelector("requires property");
   if (selector == nullptr) {
     return;
@@ -2254,6 +2347,7 @@ void OpenMPVariantClause::addRequiresProperty(OpenMPClauseKind kind,
 
 void OpenMPVariantClause::addRequiresAtomicDefaultMemOrderProperty(
     OpenMPAtomicDefaultMemOrderClauseKind kind) {
+  noteModified();
   requireAtomicDefaultMemOrder(kind);
   TraitSelector *selector = activeTraitSelector("requires property");
   if (selector == nullptr) {
@@ -2267,6 +2361,7 @@ void OpenMPVariantClause::addRequiresAtomicDefaultMemOrderProperty(
 }
 
 void OpenMPVariantClause::addRequiresExtensionProperty(const char *identifier) {
+  noteModified();
   TraitSelector *selector = activeTraitSelector("requires property");
   if (selector == nullptr || identifier == nullptr) {
     if (identifier == nullptr) {
@@ -2285,6 +2380,7 @@ void OpenMPVariantClause::addRequiresExtensionProperty(const char *identifier) {
 }
 
 void OpenMPVariantClause::endTraitSelector() {
+  noteModified();
   if (activeTraitSelector("trait selector terminator") == nullptr) {
     return;
   }
@@ -2293,6 +2389,7 @@ void OpenMPVariantClause::endTraitSelector() {
 
 void OpenMPVariantClause::addConstructDirective(
     const char *score, std::unique_ptr<OpenMPDirective> construct_directive) {
+  noteModified();
   TraitSetSelector *set = activeTraitSet("construct selector");
   if (set == nullptr) {
     return;
@@ -2307,16 +2404,16 @@ void OpenMPVariantClause::addConstructDirective(
   set->selectors.push_back(std::move(selector));
 }
 
-void OpenMPVariantClause::visitHostFragments(
-    const ompparser::HostFragmentVisitor &visitor) {
-  for (TraitSetSelector &set : trait_sets) {
-    for (TraitSelector &selector : set.selectors) {
+void OpenMPVariantClause::walkHostFragments(
+    ompparser::ConstHostFragmentVisitorRef visitor) const {
+  for (const TraitSetSelector &set : trait_sets) {
+    for (const TraitSelector &selector : set.selectors) {
       if (!selector.score.spelling.empty()) {
-        visitOwnedHostFragment(visitor, selector.score);
+        visitor(selector.score);
       }
-      for (TraitProperty &property : selector.properties) {
+      for (const TraitProperty &property : selector.properties) {
         if (!property.fragment.spelling.empty()) {
-          visitOwnedHostFragment(visitor, property.fragment);
+          visitor(property.fragment);
         }
         if (property.requirement != nullptr) {
           property.requirement->visitHostFragments(visitor);
@@ -2327,28 +2424,28 @@ void OpenMPVariantClause::visitHostFragments(
       }
     }
   }
-  OpenMPClause::visitHostFragments(visitor);
+  OpenMPClause::walkHostFragments(visitor);
 }
 
-void OpenMPWhenClause::visitHostFragments(
-    const ompparser::HostFragmentVisitor &visitor) {
-  OpenMPVariantClause::visitHostFragments(visitor);
+void OpenMPWhenClause::walkHostFragments(
+    ompparser::ConstHostFragmentVisitorRef visitor) const {
+  OpenMPVariantClause::walkHostFragments(visitor);
   if (variant_directive != nullptr) {
     variant_directive->visitHostFragments(visitor);
   }
 }
 
-void OpenMPOtherwiseClause::visitHostFragments(
-    const ompparser::HostFragmentVisitor &visitor) {
-  OpenMPVariantClause::visitHostFragments(visitor);
+void OpenMPOtherwiseClause::walkHostFragments(
+    ompparser::ConstHostFragmentVisitorRef visitor) const {
+  OpenMPVariantClause::walkHostFragments(visitor);
   if (variant_directive != nullptr) {
     variant_directive->visitHostFragments(visitor);
   }
 }
 
-void OpenMPDefaultClause::visitHostFragments(
-    const ompparser::HostFragmentVisitor &visitor) {
-  OpenMPClause::visitHostFragments(visitor);
+void OpenMPDefaultClause::walkHostFragments(
+    ompparser::ConstHostFragmentVisitorRef visitor) const {
+  OpenMPClause::walkHostFragments(visitor);
   if (variant_directive != nullptr) {
     variant_directive->visitHostFragments(visitor);
   }
@@ -2654,6 +2751,7 @@ bool OpenMPVariantClause::validateSelectorInvariants(
 void OpenMPClause::addLangExpr(const char *expression,
                                OpenMPClauseSeparator sep, int line, int col,
                                OpenMPExprParseMode parse_mode) {
+  noteModified();
   if (expression == nullptr) {
     throw std::invalid_argument("cannot add a null host expression");
   }
@@ -2703,44 +2801,47 @@ void OpenMPClause::addLangExpr(const char *expression,
 };
 
 void OpenMPInductionClause::addStepExpression(const char *expression) {
+  noteModified();
   if (expression == nullptr) {
     return;
   }
   if (step_expression.spelling.empty()) {
-    step_expression =
-        makeHostFragment(expression, ompparser::HostFragmentRole::Expression);
+    step_expression = ownHostFragment(
+        makeHostFragment(expression, ompparser::HostFragmentRole::Expression));
     sequence.push_back({ItemStep, 0});
     return;
   }
 
-  passthrough_items.push_back(
-      makeHostFragment(expression, ompparser::HostFragmentRole::Expression));
+  passthrough_items.push_back(ownHostFragment(
+      makeHostFragment(expression, ompparser::HostFragmentRole::Expression)));
   sequence.push_back({ItemPassthrough, passthrough_items.size() - 1});
 }
 
 void OpenMPInductionClause::addBinding(const char *label,
                                        const char *expression) {
+  noteModified();
   if (expression == nullptr) {
     return;
   }
   Binding binding;
   if (label != nullptr) {
-    binding.label =
+    binding.label = ownHostFragment(
         makeHostFragment(label, ompparser::HostFragmentRole::Verbatim,
-                         OMP_EXPR_PARSE_openmp_syntax);
+                         OMP_EXPR_PARSE_openmp_syntax));
   }
-  binding.expression =
-      makeHostFragment(expression, ompparser::HostFragmentRole::Expression);
+  binding.expression = ownHostFragment(
+      makeHostFragment(expression, ompparser::HostFragmentRole::Expression));
   bindings.push_back(std::move(binding));
   sequence.push_back({ItemBinding, bindings.size() - 1});
 }
 
 void OpenMPInductionClause::addPassthroughItem(const char *expression) {
+  noteModified();
   if (expression == nullptr) {
     return;
   }
-  passthrough_items.push_back(
-      makeHostFragment(expression, ompparser::HostFragmentRole::Expression));
+  passthrough_items.push_back(ownHostFragment(
+      makeHostFragment(expression, ompparser::HostFragmentRole::Expression)));
   sequence.push_back({ItemPassthrough, passthrough_items.size() - 1});
 }
 
@@ -2780,15 +2881,15 @@ void OpenMPInductionClause::visitSpecificationItems(
   }
 }
 
-void OpenMPInductionClause::visitHostFragments(
-    const ompparser::HostFragmentVisitor &visitor) {
+void OpenMPInductionClause::walkHostFragments(
+    ompparser::ConstHostFragmentVisitorRef visitor) const {
   for (const ItemRef &item : sequence) {
     switch (item.kind) {
     case ItemStep:
       if (item.index != 0 || step_expression.spelling.empty()) {
         throw std::logic_error("invalid induction step sequence reference");
       }
-      visitOwnedHostFragment(visitor, step_expression);
+      visitor(step_expression);
       break;
     case ItemBinding:
       if (item.index >= bindings.size() ||
@@ -2796,8 +2897,8 @@ void OpenMPInductionClause::visitHostFragments(
           bindings[item.index].expression.spelling.empty()) {
         throw std::logic_error("invalid induction binding sequence reference");
       }
-      visitOwnedHostFragment(visitor, bindings[item.index].label);
-      visitOwnedHostFragment(visitor, bindings[item.index].expression);
+      visitor(bindings[item.index].label);
+      visitor(bindings[item.index].expression);
       break;
     case ItemPassthrough:
       if (item.index >= passthrough_items.size() ||
@@ -2805,14 +2906,16 @@ void OpenMPInductionClause::visitHostFragments(
         throw std::logic_error(
             "invalid induction expression sequence reference");
       }
-      visitOwnedHostFragment(visitor, passthrough_items[item.index]);
+      visitor(passthrough_items[item.index]);
       break;
     }
   }
-  OpenMPClause::visitHostFragments(visitor);
+  OpenMPClause::walkHostFragments(visitor);
 }
 
 void OpenMPMapClause::addItem(const char *expr, OpenMPClauseSeparator sep) {
+  noteModified();
+  noteModified();
   if (expr == nullptr) {
     return;
   }
@@ -2824,12 +2927,15 @@ void OpenMPMapClause::addItem(const char *expr, OpenMPClauseSeparator sep) {
 
 void OpenMPMapClause::addItem(const std::string &expr,
                               OpenMPClauseSeparator sep) {
+  noteModified();
+  noteModified();
   addItemWithRange(expr, sep, nullptr);
 }
 
 void OpenMPMapClause::addItemWithRange(
     const std::string &expr, OpenMPClauseSeparator sep,
     const ompparser::SourceRange *source_range) {
+  noteModified();
   std::string array_section_expression;
   std::string dist_data_arguments;
   bool has_dist_data = splitMapExpressionDistDataSuffix(
@@ -2920,6 +3026,7 @@ void OpenMPMapClause::addItemWithRange(
 
       policy.argument.spelling = policy_argument;
       policy.argument.role = ompparser::HostFragmentRole::Expression;
+      policy.argument.clause_kind = kind;
       if (!policy_argument.empty()) {
         policy.argument.semantic.reset();
         if (source_range != nullptr && policy_begin != std::string::npos) {
@@ -2940,13 +3047,14 @@ void OpenMPMapClause::addItemWithRange(
 }
 
 void OpenMPAdjustArgsClause::addArgument(const char *arg) {
-  arguments.push_back(
-      makeHostFragment(arg, ompparser::HostFragmentRole::Variable));
+  noteModified();
+  arguments.push_back(ownHostFragment(
+      makeHostFragment(arg, ompparser::HostFragmentRole::Variable)));
 }
 
-std::string OpenMPAdjustArgsClause::toString() {
-  std::string result = "adjust_args(";
-  std::string modifier_string;
+void OpenMPAdjustArgsClause::writeString(std::string &result) const {
+  result = "adjust_args(";
+  std::string_view modifier_string;
   switch (modifier) {
   case OMPC_ADJUST_ARGS_need_device_addr:
     modifier_string = "need_device_addr";
@@ -2978,37 +3086,45 @@ std::string OpenMPAdjustArgsClause::toString() {
 
   result += ")";
   result += " ";
-  return result;
 }
 
 void OpenMPAppendArgsClause::addInteropOperation() {
-  operations.push_back({OMPC_APPEND_ARGS_interop, {}});
+  noteModified();
+  Operation operation;
+  operation.kind = OMPC_APPEND_ARGS_interop;
+  operations.push_back(std::move(operation));
 }
 
 OpenMPInitModifierList *OpenMPAppendArgsClause::getCurrentOperationModifiers() {
+  noteModified();
   return operations.empty() ? nullptr : &operations.back().modifiers;
 }
 
-std::string OpenMPAppendArgsClause::toString() {
-  std::string result = "append_args(";
+void OpenMPAppendArgsClause::writeString(std::string &result) const {
+  result = "append_args(";
   for (size_t i = 0; i < operations.size(); ++i) {
     if (i > 0) {
       result += ", ";
     }
     if (operations[i].kind == OMPC_APPEND_ARGS_interop) {
-      result += "interop(" + operations[i].modifiers.toString() + ")";
+      result += "interop(";
+      operations[i].modifiers.appendModifiers(result);
+      result += ')';
     }
   }
-  return result + ") ";
+  result += ") ";
 }
 
 void OpenMPUsesAllocatorsClause::addUsesAllocatorsAllocatorSequence(
     OpenMPUsesAllocatorsClauseAllocator allocator, const char *traits_array,
     const char *user_allocator) {
-  auto usesAllocatorsAllocator = std::make_unique<usesAllocatorParameter>(
-      allocator,
-      makeHostFragment(traits_array, ompparser::HostFragmentRole::Expression),
+  noteModified();
+  ompparser::HostFragment traits = ownHostFragment(
+      makeHostFragment(traits_array, ompparser::HostFragmentRole::Expression));
+  ompparser::HostFragment user = ownHostFragment(
       makeHostFragment(user_allocator, ompparser::HostFragmentRole::Variable));
+  auto usesAllocatorsAllocator = std::make_unique<usesAllocatorParameter>(
+      allocator, std::move(traits), std::move(user));
   usesAllocatorsAllocatorSequenceView.push_back(usesAllocatorsAllocator.get());
   usesAllocatorsAllocatorSequenceStorage.push_back(
       std::move(usesAllocatorsAllocator));
@@ -3034,6 +3150,7 @@ void OpenMPInitModifierList::addPreferType(const char *specification) {
   modifier.argument =
       makeHostFragment(specification, ompparser::HostFragmentRole::Verbatim,
                        OMP_EXPR_PARSE_openmp_source);
+  modifier.argument.clause_kind = owner_clause;
   modifiers.push_back(std::move(modifier));
 }
 
@@ -3043,6 +3160,7 @@ void OpenMPInitModifierList::addPreferType(const std::string &specification) {
   modifier.argument.spelling = specification;
   modifier.argument.role = ompparser::HostFragmentRole::Verbatim;
   modifier.argument.parse_mode = OMP_EXPR_PARSE_openmp_source;
+  modifier.argument.clause_kind = owner_clause;
   modifiers.push_back(std::move(modifier));
 }
 
@@ -3053,6 +3171,7 @@ void OpenMPInitModifierList::addDepinfo(OpenMPDependClauseType type,
   modifier.dependence_type = type;
   modifier.argument =
       makeHostFragment(locator, ompparser::HostFragmentRole::Locator);
+  modifier.argument.clause_kind = owner_clause;
   modifiers.push_back(std::move(modifier));
 }
 
@@ -3064,86 +3183,103 @@ void OpenMPInitModifierList::addDepinfo(OpenMPDependClauseType type,
   modifier.argument.spelling = locator;
   modifier.argument.role = ompparser::HostFragmentRole::Locator;
   modifier.argument.parse_mode = OMP_EXPR_PARSE_array_section;
+  modifier.argument.clause_kind = owner_clause;
   modifiers.push_back(std::move(modifier));
 }
 
 void OpenMPInitClause::setOperand(const char *value) {
+  noteModified();
+  noteModified();
   operand = makeHostFragment(value, ompparser::HostFragmentRole::Variable);
+  operand.clause_kind = kind;
 }
 
 void OpenMPInitClause::setOperand(const std::string &value) {
+  noteModified();
+  noteModified();
   operand = {};
   operand.spelling = value;
   operand.role = ompparser::HostFragmentRole::Variable;
   operand.parse_mode = OMP_EXPR_PARSE_variable_list;
+  operand.clause_kind = kind;
 }
 
 std::string OpenMPInitModifierList::toString() const {
   std::string result;
+  appendModifiers(result);
+  return result;
+}
+
+void OpenMPInitModifierList::appendModifiers(std::string &result) const {
+  const size_t start = result.size();
   for (const OpenMPInitModifier &modifier : modifiers) {
-    std::string text;
+    const size_t separator = result.size();
+    if (separator != start) {
+      result += ", ";
+    }
+    const size_t text = result.size();
     switch (modifier.category) {
     case OpenMPInitModifierCategory::InteropType:
       if (modifier.interop_type == OMPC_INIT_KIND_target) {
-        text = "target";
+        result += "target";
       } else if (modifier.interop_type == OMPC_INIT_KIND_targetsync) {
-        text = "targetsync";
+        result += "targetsync";
       }
       break;
     case OpenMPInitModifierCategory::DirectiveName:
       if (modifier.directive_name == OMPD_depobj) {
-        text = "depobj";
+        result += "depobj";
       } else if (modifier.directive_name == OMPD_interop) {
-        text = "interop";
+        result += "interop";
       }
       break;
     case OpenMPInitModifierCategory::PreferType:
-      text = "prefer_type(" + modifier.argument.spelling + ")";
+      result += "prefer_type(";
+      result += modifier.argument.spelling;
+      result += ')';
       break;
     case OpenMPInitModifierCategory::Depinfo:
       switch (modifier.dependence_type) {
       case OMPC_DEPENDENCE_TYPE_in:
-        text = "in";
+        result += "in";
         break;
       case OMPC_DEPENDENCE_TYPE_out:
-        text = "out";
+        result += "out";
         break;
       case OMPC_DEPENDENCE_TYPE_inout:
-        text = "inout";
+        result += "inout";
         break;
       case OMPC_DEPENDENCE_TYPE_inoutset:
-        text = "inoutset";
+        result += "inoutset";
         break;
       case OMPC_DEPENDENCE_TYPE_mutexinoutset:
-        text = "mutexinoutset";
+        result += "mutexinoutset";
         break;
       default:
         break;
       }
-      if (!text.empty()) {
-        text += "(" + modifier.argument.spelling + ")";
+      if (result.size() != text) {
+        result += '(';
+        result += modifier.argument.spelling;
+        result += ')';
       }
       break;
     }
-    if (text.empty()) {
-      continue;
+    if (result.size() == text) {
+      result.resize(separator);
     }
-    if (!result.empty()) {
-      result += ", ";
-    }
-    result += text;
   }
-  return result;
 }
 
-std::string OpenMPInitClause::toString() {
-  std::string result = "init(";
-  const std::string modifier_text = modifiers.toString();
-  if (!modifier_text.empty()) {
-    result += modifier_text + ": ";
+void OpenMPInitClause::writeString(std::string &result) const {
+  result = "init(";
+  const size_t modifiers_begin = result.size();
+  modifiers.appendModifiers(result);
+  if (result.size() != modifiers_begin) {
+    result += ": ";
   }
   result += operand.spelling;
-  return result + ") ";
+  result += ") ";
 }
 
 /**
@@ -3156,6 +3292,7 @@ std::string OpenMPInitClause::toString() {
  */
 OpenMPClause *OpenMPDirective::addOpenMPClauseWithArguments(
     OpenMPClauseKind kind, const std::vector<ClauseArgument> &arguments) {
+  parser_constructed = false;
   enum class ExpectedArgument { Integer, String };
   std::vector<ExpectedArgument> expected_arguments;
   expected_arguments.reserve(6);
@@ -4538,105 +4675,62 @@ OpenMPClause *OpenMPUsesAllocatorsClause::addUsesAllocatorsClause(
   return new_clause;
 };
 
-// Helper function to convert OpenMPDirectiveKind to string without trailing
-// space.
-static std::string OpenMPDirectiveKindToString(OpenMPDirectiveKind kind) {
-  OpenMPDirective temp(kind);
-  std::string result = temp.toString();
-  // Trim trailing space if present
-  if (!result.empty() && result.back() == ' ') {
-    result.pop_back();
-  }
-  return result;
-}
-
-std::string OpenMPAbsentClause::toString() {
-  std::string result = "absent(";
-  bool first = true;
-  for (auto kind : directive_list) {
-    if (!first) {
-      result += ", ";
-    }
-    result += OpenMPDirectiveKindToString(kind);
-    first = false;
-  }
-  result += ") ";
-  return result;
-}
-
-std::string OpenMPContainsClause::toString() {
-  std::string result = "contains(";
-  bool first = true;
-  for (auto kind : directive_list) {
-    if (!first) {
-      result += ", ";
-    }
-    result += OpenMPDirectiveKindToString(kind);
-    first = false;
+// "name(expressions) ", or "name " for an optional argument that is absent.
+static void writeExpressionClause(const OpenMPClause &clause, const char *name,
+                                  bool argument_is_optional,
+                                  std::string &result) {
+  result = name;
+  const size_t open = result.size();
+  result += '(';
+  clause.appendExpressions(result);
+  if (argument_is_optional && result.size() == open + 1) {
+    result.back() = ' ';
+    return;
   }
   result += ") ";
-  return result;
 }
 
-std::string OpenMPGraphIdClause::toString() {
-  return "graph_id(" + expressionToString() + ") ";
+void OpenMPGraphIdClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "graph_id", false, result);
 }
 
-std::string OpenMPGraphResetClause::toString() {
-  std::string str = expressionToString();
-  if (str.empty())
-    return "graph_reset ";
-  return "graph_reset(" + str + ") ";
+void OpenMPGraphResetClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "graph_reset", true, result);
 }
 
-std::string OpenMPTransparentClause::toString() {
-  std::string str = expressionToString();
-  if (str.empty())
-    return "transparent ";
-  return "transparent(" + str + ") ";
+void OpenMPTransparentClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "transparent", true, result);
 }
 
-std::string OpenMPReplayableClause::toString() {
-  const std::string expression = expressionToString();
-  return expression.empty() ? "replayable " : "replayable(" + expression + ") ";
+void OpenMPReplayableClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "replayable", true, result);
 }
 
-std::string OpenMPThreadsetClause::toString() {
-  return "threadset(" + expressionToString() + ") ";
+void OpenMPThreadsetClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "threadset", false, result);
 }
 
-std::string OpenMPIndirectClause::toString() {
-  std::string str = expressionToString();
-  if (str.empty())
-    return "indirect ";
-  return "indirect(" + str + ") ";
+void OpenMPIndirectClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "indirect", true, result);
 }
 
-std::string OpenMPLocalClause::toString() {
-  return "local(" + expressionToString() + ") ";
+void OpenMPLocalClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "local", false, result);
 }
 
-std::string OpenMPInitCompleteClause::toString() {
-  const std::string expression = expressionToString();
-  return expression.empty() ? "init_complete "
-                            : "init_complete(" + expression + ") ";
+void OpenMPInitCompleteClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "init_complete", true, result);
 }
 
-std::string OpenMPSafesyncClause::toString() {
-  std::string str = expressionToString();
-  if (str.empty())
-    return "safesync ";
-  return "safesync(" + str + ") ";
+void OpenMPSafesyncClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "safesync", true, result);
 }
 
-std::string OpenMPDeviceSafesyncClause::toString() {
-  std::string str = expressionToString();
-  if (str.empty())
-    return "device_safesync ";
-  return "device_safesync(" + str + ") ";
+void OpenMPDeviceSafesyncClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "device_safesync", true, result);
 }
 
-std::string OpenMPMemscopeClause::toString() {
+void OpenMPMemscopeClause::writeString(std::string &result) const {
   const char *value = "device";
   switch (scope) {
   case OMPC_MEMSCOPE_all:
@@ -4652,64 +4746,67 @@ std::string OpenMPMemscopeClause::toString() {
     break;
   }
 
-  return std::string("memscope(") + value + ") ";
+  result = "memscope(";
+  result += value;
+  result += ") ";
 }
 
-std::string OpenMPLooprangeClause::toString() {
-  return "looprange(" + expressionToString() + ") ";
+void OpenMPLooprangeClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "looprange", false, result);
 }
 
-std::string OpenMPPermutationClause::toString() {
-  return "permutation(" + expressionToString() + ") ";
+void OpenMPPermutationClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "permutation", false, result);
 }
 
-std::string OpenMPCountsClause::toString() {
-  return "counts(" + expressionToString() + ") ";
+void OpenMPCountsClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "counts", false, result);
 }
 
-std::string OpenMPInductorClause::toString() {
-  return "inductor(" + expressionToString() + ") ";
+void OpenMPInductorClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "inductor", false, result);
 }
 
-std::string OpenMPCollectorClause::toString() {
-  return "collector(" + expressionToString() + ") ";
+void OpenMPCollectorClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "collector", false, result);
 }
 
-std::string OpenMPCombinerClause::toString() {
-  return "combiner(" + expressionToString() + ") ";
+void OpenMPCombinerClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "combiner", false, result);
 }
 
-std::string OpenMPNoOpenmpClause::toString() { return "no_openmp "; }
+void OpenMPNoOpenmpClause::writeString(std::string &result) const {
+  result = "no_openmp ";
+}
 
-std::string OpenMPNoOpenmpConstructsClause::toString() {
-  std::string str = expressionToString();
-  if (str.empty())
-    return "no_openmp_constructs ";
-  return "no_openmp_constructs(" + str + ") ";
+void OpenMPNoOpenmpConstructsClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "no_openmp_constructs", true, result);
 }
 
-std::string OpenMPNoOpenmpRoutinesClause::toString() {
-  return "no_openmp_routines ";
+void OpenMPNoOpenmpRoutinesClause::writeString(std::string &result) const {
+  result = "no_openmp_routines ";
 }
 
-std::string OpenMPNoParallelismClause::toString() { return "no_parallelism "; }
+void OpenMPNoParallelismClause::writeString(std::string &result) const {
+  result = "no_parallelism ";
+}
 
-std::string OpenMPNocontextClause::toString() {
-  return "nocontext(" + expressionToString() + ") ";
+void OpenMPNocontextClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "nocontext", false, result);
 }
 
-std::string OpenMPNovariantsClause::toString() {
-  return "novariants(" + expressionToString() + ") ";
+void OpenMPNovariantsClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "novariants", false, result);
 }
 
-std::string OpenMPEnterClause::toString() {
-  return "enter(" + expressionToString() + ") ";
+void OpenMPEnterClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "enter", false, result);
 }
 
-std::string OpenMPUseClause::toString() {
-  return "use(" + expressionToString() + ") ";
+void OpenMPUseClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "use", false, result);
 }
 
-std::string OpenMPHoldsClause::toString() {
-  return "holds(" + expressionToString() + ") ";
+void OpenMPHoldsClause::writeString(std::string &result) const {
+  writeExpressionClause(*this, "holds", false, result);
 }
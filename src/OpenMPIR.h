@@ -14,7 +14,9 @@
 #include <iostream>
 
 #include "OpenMPKinds.h"
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <optional>
@@ -22,6 +24,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <string>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 #include <variant>
@@ -38,6 +41,10 @@ int openmpGetCurrentTokenColumn();
 bool openmpGetLexemeSourceRange(const char *lexeme,
                                 ompparser::SourceRange &range);
 
+// Rebuilds the nodes ompparser::deserialize reads; every node class whose
+// fields it restores befriends it.
+class OpenMPStructureReader;
+
 class SourceLocation {
   int line;
   int column;
@@ -110,13 +117,16 @@ struct OpenMPIterator {
     step.role = ompparser::HostFragmentRole::Expression;
   }
 
-  void visitHostFragments(const ompparser::HostFragmentVisitor &visitor,
-                          OpenMPClauseKind owner_clause = OMPC_unknown) {
+  void setOwnerClause(OpenMPClauseKind owner_clause) {
     qualifier.clause_kind = owner_clause;
     variable.clause_kind = owner_clause;
     begin.clause_kind = owner_clause;
     end.clause_kind = owner_clause;
     step.clause_kind = owner_clause;
+  }
+
+  void
+  visitHostFragments(ompparser::ConstHostFragmentVisitorRef visitor) const {
     if (!qualifier.spelling.empty()) {
       visitor(qualifier);
     }
@@ -155,17 +165,21 @@ protected:
   std::vector<OpenMPExpressionItem> expressions;
   std::vector<std::string> construction_errors;
 
-  void visitOwnedHostFragment(const ompparser::HostFragmentVisitor &visitor,
-                              ompparser::HostFragment &fragment) {
-    fragment.clause_kind = kind;
-    visitor(fragment);
-  }
+  // Directive whose clause storage owns this clause; set on registration.
+  OpenMPDirective *owner_directive = nullptr;
+  friend class OpenMPDirective;
+  friend class OpenMPStructureReader;
 
-  ompparser::HostFragmentVisitor
-  owningHostFragmentVisitor(const ompparser::HostFragmentVisitor &visitor) {
-    return [this, visitor](ompparser::HostFragment &fragment) {
-      visitOwnedHostFragment(visitor, fragment);
-    };
+  // Advanced by noteModified. Verbatim unparsing copies the clause's input
+  // text only while it is unchanged since parsing.
+  uint64_t modification_generation = 0;
+
+  // Stamps a fragment with this clause's kind when it is stored, so that
+  // traversals never have to write to the IR.
+  ompparser::HostFragment
+  ownHostFragment(ompparser::HostFragment fragment) const {
+    fragment.clause_kind = kind;
+    return fragment;
   }
 
 public:
@@ -174,12 +188,29 @@ public:
 
   virtual ~OpenMPClause() = default;
 
+  // Deep copy of this clause, including nested directives and clauses.
+  // Semantic nodes attached to host fragments are shared with the original.
+  // The copy has no owning directive until one registers it.
+  std::unique_ptr<OpenMPClause> clone() const;
+
+  // Advances the clause's and the owning directive's modification
+  // generations. Every mutating member calls it; code that edits a clause
+  // through a reference it kept from an earlier call must call it too.
+  void noteModified();
+  uint64_t getModificationGeneration() const {
+    return modification_generation;
+  }
+
   OpenMPClauseKind getKind() const { return kind; };
   OpenMPDirectiveKind getDirectiveKind() const { return directive_kind; }
-  void setDirectiveKind(OpenMPDirectiveKind value) { directive_kind = value; }
+  void setDirectiveKind(OpenMPDirectiveKind value) {
+    noteModified();
+    directive_kind = value;
+  }
   OpenMPBaseLang getBaseLang() const { return base_lang; }
-  void setBaseLang(OpenMPBaseLang value) { base_lang = value; }
+  void setBaseLang(OpenMPBaseLang value) { noteModified(); base_lang = value; }
   void setDirectiveNameModifier(OpenMPDirectiveKind value) {
+    noteModified();
     has_directive_name_modifier = true;
     directive_name_modifier = value;
   }
@@ -189,9 +220,13 @@ public:
   }
   int getClausePosition() const { return clause_position; };
   void setClausePosition(int _clause_position) {
+    noteModified();
     clause_position = _clause_position;
   };
-  void setPrecedingSeparator(OpenMPClauseSeparator sep) { separator = sep; }
+  void setPrecedingSeparator(OpenMPClauseSeparator sep) {
+    noteModified();
+    separator = sep;
+  }
   OpenMPClauseSeparator getPrecedingSeparator() const { return separator; }
   const std::vector<std::string> &getConstructionErrors() const {
     return construction_errors;
@@ -209,12 +244,30 @@ public:
     return expressions;
   }
   std::vector<OpenMPExpressionItem> &getExpressionItems() {
+    noteModified();
     return expressions;
   }
+  // Visits every host fragment owned by this clause and by its nested
+  // clauses and directives. The const overload performs no writes, so a
+  // shared clause may be visited from several threads at once.
+  void visitHostFragments(ompparser::HostFragmentVisitorRef visitor) {
+    noteModified();
+    // The fragments of a non-const clause are not const objects.
+    auto forward = [visitor](const ompparser::HostFragment &fragment) {
+      visitor(const_cast<ompparser::HostFragment &>(fragment));
+    };
+    walkHostFragments(forward);
+  }
+  void
+  visitHostFragments(ompparser::ConstHostFragmentVisitorRef visitor) const {
+    walkHostFragments(visitor);
+  }
+  // Traversal hook behind visitHostFragments; subclasses that own fragments
+  // outside the expression list override it.
   virtual void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) {
-    for (OpenMPExpressionItem &expression : expressions) {
-      visitOwnedHostFragment(visitor, expression.fragment);
+  walkHostFragments(ompparser::ConstHostFragmentVisitorRef visitor) const {
+    for (const OpenMPExpressionItem &expression : expressions) {
+      visitor(expression.fragment);
     }
   }
   std::shared_ptr<const ompparser::HostSemanticNode>
@@ -224,21 +277,54 @@ public:
   void setExpressionNode(
       size_t index,
       std::shared_ptr<const ompparser::HostSemanticNode> semantic) {
+    noteModified();
     expressions.at(index).fragment.semantic = std::move(semantic);
   }
   OpenMPExprParseMode getExpressionParseMode(size_t index) const {
     return expressions.at(index).parse_mode;
   }
 
-  virtual std::string toString();
-  std::string expressionToString();
-  virtual void generateDOT(std::ostream &, int, int, std::string) const;
+  // Replaces the contents of result with the clause text, so a caller that
+  // renders many clauses reuses one buffer instead of a string per clause.
+  virtual void writeString(std::string &result) const;
+  std::string toString() const;
+  // True when the clause text includes a directive that keeps its own
+  // generation, so the clause's generation alone does not tell whether its
+  // text has changed.
+  virtual bool rendersNestedDirective() const { return false; }
+  std::string expressionToString() const;
+  void appendExpressions(std::string &result) const;
+  virtual void generateDOT(std::ostream &, int, int, std::string_view) const;
+};
+
+// Input a directive was parsed from, kept by ParseOptions::retain_source for
+// verbatim unparsing, with the span of each clause in it. Spans exclude the
+// separators around a clause, which belong to the gap before the next one.
+struct OpenMPRetainedSource {
+  struct Clause {
+    const OpenMPClause *clause = nullptr;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    // The clause's modification generation when the input was retained.
+    uint64_t generation = 0;
+  };
+
+  std::string text;
+  // End of the text before the first clause, and of the last clause.
+  std::size_t header_end = 0;
+  std::size_t end = 0;
+  // The directive's generations when the input was retained.
+  uint64_t generation = 0;
+  uint64_t header_generation = 0;
+  std::vector<Clause> clauses;
 };
 
 /**
  * The class for all the OpenMP directives
  */
 class OpenMPDirective : public SourceLocation {
+  friend class OpenMPClause;
+  friend class OpenMPStructureReader;
 protected:
   OpenMPDirectiveKind kind;
   OpenMPBaseLang lang;
@@ -258,23 +344,51 @@ protected:
   std::vector<std::unique_ptr<OpenMPClause>> clause_storage;
   std::vector<std::string> construction_errors;
 
+  // Set once the grammar has finished building this directive and cleared by
+  // any mutable access to the clause containers above.
+  bool parser_constructed = false;
+
+  // Advanced by every mutation of the directive or of a clause it owns.
+  uint64_t modification_generation = 0;
+  // One past the generation at which validation last accepted the directive,
+  // or 0. Atomic because unparse records it on directives shared by readers.
+  mutable std::atomic<uint64_t> validated_generation{0};
+  // Advanced like modification_generation, except by edits made inside a
+  // clause, which leave the header and the clause list as they were.
+  uint64_t header_generation = 0;
+  // Not copied: a copy's clauses are not the ones the spans describe.
+  std::unique_ptr<const OpenMPRetainedSource> retained_source;
+
+  void noteClauseModified() { ++modification_generation; }
+
   // Checked compatibility entry point used by the legacy grammar actions.
   OpenMPClause *addOpenMPClause(OpenMPClauseKind kind, int *parameters);
   using ClauseArgument = std::variant<int, std::string>;
   OpenMPClause *
   addOpenMPClauseWithArguments(OpenMPClauseKind kind,
                                const std::vector<ClauseArgument> &arguments);
+  // DOT nodes for the directive's own lists and its clauses, hanging off the
+  // node named node.
+  void generateDOTBody(std::ostream &, int depth, std::string_view node) const;
 
 public:
   OpenMPDirective(OpenMPDirectiveKind k, OpenMPBaseLang _lang = Lang_unknown,
                   int _line = 0, int _col = 0)
       : SourceLocation(_line, _col), kind(k), lang(_lang) {};
+  // Copies every clause and rebuilds the clause indexes over the copies.
+  OpenMPDirective(const OpenMPDirective &other);
+  OpenMPDirective &operator=(const OpenMPDirective &) = delete;
 
   virtual ~OpenMPDirective() = default;
 
+  // Deep copy of this directive; see OpenMPClause::clone.
+  std::unique_ptr<OpenMPDirective> clone() const;
+
   OpenMPDirectiveKind getKind() const { return kind; };
 
   std::map<OpenMPClauseKind, std::vector<OpenMPClause *>> &getAllClauses() {
+    noteModified();
+    parser_constructed = false;
     return clauses;
   };
   const std::map<OpenMPClauseKind, std::vector<OpenMPClause *>> &
@@ -283,6 +397,8 @@ public:
   }
 
   std::vector<OpenMPClause *> *getClauses(OpenMPClauseKind kind) {
+    noteModified();
+    parser_constructed = false;
     return &clauses[kind];
   };
   const std::vector<OpenMPClause *> *findClauses(OpenMPClauseKind kind) const {
@@ -290,6 +406,8 @@ public:
     return iter == clauses.end() ? nullptr : &iter->second;
   }
   std::vector<OpenMPClause *> *getClausesInOriginalOrder() {
+    noteModified();
+    parser_constructed = false;
     return &clauses_in_original_order;
   };
   const std::vector<OpenMPClause *> &getClausesInOriginalOrder() const {
@@ -299,10 +417,20 @@ public:
   std::string toString() const;
 
   /* generate DOT representation of the directive */
-  void generateDOT(std::ostream &, int, int, std::string, std::string) const;
+  void generateDOT(std::ostream &, int, int, std::string_view,
+                   std::string_view) const;
   std::string generateDOTString() const;
   void generateDOT() const;
+  // Writes the directive as subgraph cluster_<index> of a graph holding
+  // several directives; its node names start with d<index>, so clusters never
+  // share a node.
+  void generateDOTCluster(std::ostream &, std::size_t index) const;
   std::string generatePragmaString(std::string _prefix = "#pragma omp ") const;
+  // Writes the generatePragmaString text into result, rendering each clause
+  // through clause_buffer, so a caller that keeps both strings between calls
+  // unparses without allocating once they have grown.
+  void writePragmaString(std::string &result, std::string &clause_buffer,
+                         std::string_view prefix = "#pragma omp ") const;
   std::string generateContextTraitString() const;
   template <typename... Args>
   OpenMPClause *addOpenMPClause(int raw_kind, Args &&...raw_arguments) {
@@ -338,22 +466,31 @@ public:
   void setBaseLang(OpenMPBaseLang _lang);
   OpenMPBaseLang getBaseLang() const { return lang; };
   void setDeclareTargetUnderscore(bool use_underscore) {
+    noteModified();
     use_declare_target_underscore = use_underscore;
   }
   bool getDeclareTargetUnderscore() const {
     return use_declare_target_underscore;
   }
-  void setCompactParallelDo(bool compact) { compact_parallel_do = compact; }
+  void setCompactParallelDo(bool compact) {
+    noteModified();
+    compact_parallel_do = compact;
+  }
   bool getCompactParallelDo() const { return compact_parallel_do; }
-  void setRequiresExplicitEnd(bool value) { requires_explicit_end = value; }
+  void setRequiresExplicitEnd(bool value) {
+    noteModified();
+    requires_explicit_end = value;
+  }
   bool getRequiresExplicitEnd() const { return requires_explicit_end; }
   void setFortranSentinel(OpenMPFortranSentinelKind sentinel) {
+    noteModified();
     fortran_sentinel = sentinel;
   }
   OpenMPFortranSentinelKind getFortranSentinel() const {
     return fortran_sentinel;
   }
   void setImplementationDefinedPayload(const std::string &payload) {
+    noteModified();
     implementation_defined_payload = payload;
   }
   const std::string &getImplementationDefinedPayload() const {
@@ -364,15 +501,72 @@ public:
   // Takes ownership of the clause and returns a raw pointer for use
   OpenMPClause *registerClause(std::unique_ptr<OpenMPClause> clause);
   void adoptClausesFrom(OpenMPDirective &source);
-  virtual void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) {
+  // See OpenMPClause::visitHostFragments. Every clause is marked modified; a
+  // directive nested in a clause keeps its generation, as with any edit made
+  // through it.
+  void visitHostFragments(ompparser::HostFragmentVisitorRef visitor) {
+    noteModified();
     for (OpenMPClause *clause : clauses_in_original_order) {
+      if (clause != nullptr) {
+        clause->noteModified();
+      }
+    }
+    auto forward = [visitor](const ompparser::HostFragment &fragment) {
+      visitor(const_cast<ompparser::HostFragment &>(fragment));
+    };
+    walkHostFragments(forward);
+  }
+  void
+  visitHostFragments(ompparser::ConstHostFragmentVisitorRef visitor) const {
+    walkHostFragments(visitor);
+  }
+  virtual void
+  walkHostFragments(ompparser::ConstHostFragmentVisitorRef visitor) const {
+    for (const OpenMPClause *clause : clauses_in_original_order) {
       if (clause != nullptr) {
         clause->visitHostFragments(visitor);
       }
     }
   }
+  // Checks that clause ownership, the kind index and the source order agree,
+  // in time linear in the number of clauses, and reports construction errors.
   bool validateInvariants(std::vector<std::string> &errors) const;
+  // Reports only the construction errors of the directive and its clauses.
+  bool collectConstructionErrors(std::vector<std::string> &errors) const;
+
+  // Marks a directive whose clause containers were built by the grammar and
+  // have not been handed out mutably since, so validateInvariants has
+  // nothing to find beyond construction errors.
+  void markParserConstructed() { parser_constructed = true; }
+  bool isParserConstructed() const { return parser_constructed; }
+
+  // See OpenMPClause::noteModified. Nested directives keep their own
+  // generation.
+  void noteModified() {
+    ++modification_generation;
+    ++header_generation;
+  }
+  uint64_t getModificationGeneration() const {
+    return modification_generation;
+  }
+  uint64_t getHeaderGeneration() const { return header_generation; }
+  // Keeping the input is not a modification.
+  void retainSource(std::unique_ptr<const OpenMPRetainedSource> source) {
+    retained_source = std::move(source);
+  }
+  const OpenMPRetainedSource *getRetainedSource() const {
+    return retained_source.get();
+  }
+  // Records that ompparser::validate accepted the directive as it is now;
+  // unparse and toDot skip validation while the generation is unchanged.
+  void markValidated() const {
+    validated_generation.store(modification_generation + 1,
+                               std::memory_order_relaxed);
+  }
+  bool isValidated() const {
+    return validated_generation.load(std::memory_order_relaxed) ==
+           modification_generation + 1;
+  }
 };
 
 // atomic directive
@@ -387,7 +581,9 @@ protected:
 
 public:
   OpenMPAtomicDirective() : OpenMPDirective(OMPD_atomic) {};
+  OpenMPAtomicDirective(const OpenMPAtomicDirective &other);
   std::vector<OpenMPClause *> *getClausesAtomicAfter(OpenMPClauseKind kind) {
+    noteModified();
     if (clauses_atomic_after.count(kind) == 0) {
       auto vec = std::make_unique<std::vector<OpenMPClause *>>();
       clauses_atomic_after[kind] = vec.get();
@@ -396,6 +592,7 @@ public:
     return clauses_atomic_after[kind];
   };
   std::vector<OpenMPClause *> *getAtomicClauses(OpenMPClauseKind kind) {
+    noteModified();
     if (clauses_atomic_clauses.count(kind) == 0) {
       auto vec = std::make_unique<std::vector<OpenMPClause *>>();
       clauses_atomic_clauses[kind] = vec.get();
@@ -405,16 +602,19 @@ public:
   };
   std::map<OpenMPClauseKind, std::vector<OpenMPClause *> *> *
   getAllClausesAtomicAfter() {
+    noteModified();
     return &clauses_atomic_after;
   };
   std::map<OpenMPClauseKind, std::vector<OpenMPClause *> *> *
   getAllAtomicClauses() {
+    noteModified();
     return &clauses_atomic_clauses;
   };
 };
 
 // fail clause for atomic compare (OpenMP 5.1)
 class OpenMPFailClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPFailClauseMemoryOrder memory_order;
 
@@ -422,12 +622,13 @@ public:
   OpenMPFailClause(OpenMPFailClauseMemoryOrder _memory_order)
       : OpenMPClause(OMPC_fail), memory_order(_memory_order) {};
 
-  OpenMPFailClauseMemoryOrder getMemoryOrder() { return memory_order; };
+  OpenMPFailClauseMemoryOrder getMemoryOrder() const { return memory_order; };
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 class OpenMPSeverityClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPSeverityClauseKind severity_kind;
 
@@ -435,12 +636,13 @@ public:
   OpenMPSeverityClause(OpenMPSeverityClauseKind _severity_kind)
       : OpenMPClause(OMPC_severity), severity_kind(_severity_kind) {};
 
-  OpenMPSeverityClauseKind getSeverityKind() { return severity_kind; };
+  OpenMPSeverityClauseKind getSeverityKind() const { return severity_kind; };
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 class OpenMPAtClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPAtClauseKind at_kind;
 
@@ -448,9 +650,9 @@ public:
   OpenMPAtClause(OpenMPAtClauseKind _at_kind)
       : OpenMPClause(OMPC_at), at_kind(_at_kind) {};
 
-  OpenMPAtClauseKind getAtKind() { return at_kind; };
+  OpenMPAtClauseKind getAtKind() const { return at_kind; };
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // Suffix-form ends own a complete parsed directive. Standalone end markers
@@ -459,6 +661,7 @@ public:
 enum class OpenMPPairedDirectiveRole { Complete, KindOnly };
 
 class OpenMPEndDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPDirective *paired_directive = nullptr;
   std::unique_ptr<OpenMPDirective> paired_directive_storage;
@@ -469,9 +672,11 @@ protected:
 
 public:
   OpenMPEndDirective() : OpenMPDirective(OMPD_end) {};
+  OpenMPEndDirective(const OpenMPEndDirective &other);
   void setPairedDirective(
       std::unique_ptr<OpenMPDirective> _paired_directive,
       OpenMPPairedDirectiveRole role = OpenMPPairedDirectiveRole::Complete) {
+    noteModified();
     paired_directive_storage = std::move(_paired_directive);
     paired_directive = paired_directive_storage.get();
     paired_directive_role = role;
@@ -479,6 +684,7 @@ public:
   void setPairedDirective(
       OpenMPDirective *_paired_directive,
       OpenMPPairedDirectiveRole role = OpenMPPairedDirectiveRole::Complete) {
+    noteModified();
     paired_directive_storage.reset();
     paired_directive = _paired_directive;
     paired_directive_role = role;
@@ -489,17 +695,21 @@ public:
     return paired_directive_role;
   }
   void setEndArgument(const ompparser::HostFragment &argument) {
+    noteModified();
     end_argument = argument;
   }
   const ompparser::HostFragment &getEndArgument() const { return end_argument; }
-  void setUseCompactEndDo(bool compact) { use_compact_enddo = compact; }
+  void setUseCompactEndDo(bool compact) {
+    noteModified();
+    use_compact_enddo = compact;
+  }
   bool getUseCompactEndDo() const { return use_compact_enddo; }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!end_argument.spelling.empty()) {
       visitor(end_argument);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
     if (paired_directive != nullptr &&
         paired_directive_role == OpenMPPairedDirectiveRole::Complete) {
       paired_directive->visitHostFragments(visitor);
@@ -515,6 +725,7 @@ public:
 
 // declare variant directive
 class OpenMPDeclareVariantDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   ompparser::HostFragment variant_func_id;
 
@@ -527,17 +738,18 @@ public:
   const ompparser::HostFragment &getVariantFuncFragment() const {
     return variant_func_id;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!variant_func_id.spelling.empty()) {
       visitor(variant_func_id);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // allocate directive
 class OpenMPAllocateDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   std::vector<ompparser::HostFragment> allocate_list;
 
@@ -547,17 +759,18 @@ public:
   const std::vector<ompparser::HostFragment> &getAllocateList() const {
     return allocate_list;
   };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (ompparser::HostFragment &item : allocate_list) {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const ompparser::HostFragment &item : allocate_list) {
       visitor(item);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // threadprivate directive
 class OpenMPThreadprivateDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   std::vector<ompparser::HostFragment> threadprivate_list;
 
@@ -567,17 +780,18 @@ public:
   const std::vector<ompparser::HostFragment> &getThreadprivateList() const {
     return threadprivate_list;
   };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (ompparser::HostFragment &item : threadprivate_list) {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const ompparser::HostFragment &item : threadprivate_list) {
       visitor(item);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // groupprivate directive
 class OpenMPGroupprivateDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   std::vector<ompparser::HostFragment> groupprivate_list;
 
@@ -587,17 +801,18 @@ public:
   const std::vector<ompparser::HostFragment> &getGroupprivateList() const {
     return groupprivate_list;
   };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (ompparser::HostFragment &item : groupprivate_list) {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const ompparser::HostFragment &item : groupprivate_list) {
       visitor(item);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // declare simd directive
 class OpenMPDeclareSimdDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   ompparser::HostFragment proc_name;
 
@@ -608,17 +823,18 @@ public:
   const ompparser::HostFragment &getProcNameFragment() const {
     return proc_name;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!proc_name.spelling.empty()) {
       visitor(proc_name);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // declare reduction directive
 class OpenMPDeclareReductionDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   std::vector<ompparser::HostFragment> typename_list;
   std::string identifier;
@@ -631,27 +847,31 @@ public:
   const std::vector<ompparser::HostFragment> &getTypenameList() const {
     return typename_list;
   }
-  void setIdentifier(std::string _identifier) { identifier = _identifier; }
+  void setIdentifier(std::string _identifier) {
+    noteModified();
+    identifier = _identifier;
+  }
   const std::string &getIdentifier() const { return identifier; }
   void setCombiner(const char *_combiner);
   const ompparser::HostFragment &getCombinerFragment() const {
     return combiner;
   }
   const std::string &getCombiner() const { return combiner.spelling; }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (ompparser::HostFragment &type : typename_list) {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const ompparser::HostFragment &type : typename_list) {
       visitor(type);
     }
     if (!combiner.spelling.empty()) {
       visitor(combiner);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // declare mapper directive
 class OpenMPDeclareMapperDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPDeclareMapperDirectiveIdentifier identifier =
       OMPD_DECLARE_MAPPER_IDENTIFIER_unspecified; // modifier
@@ -668,6 +888,7 @@ public:
     identifier = _identifier;
   };
   void setIdentifier(OpenMPDeclareMapperDirectiveIdentifier _identifier) {
+    noteModified();
     identifier = _identifier;
   };
   OpenMPDeclareMapperDirectiveIdentifier getIdentifier() const {
@@ -693,10 +914,13 @@ public:
   void setDeclareMapperVar(const char *_declare_mapper_variable);
   bool setSpecification(const char *specification, OpenMPBaseLang language,
                         OpenMPBaseLang &resolved_language, std::string &error);
-  void setTypeVarHasSpace(bool has_space) { type_var_has_space = has_space; }
+  void setTypeVarHasSpace(bool has_space) {
+    noteModified();
+    type_var_has_space = has_space;
+  }
   bool hasTypeVarSpace() const { return type_var_has_space; }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_identifier.spelling.empty()) {
       visitor(user_defined_identifier);
     }
@@ -706,12 +930,13 @@ public:
     if (!var.spelling.empty()) {
       visitor(var);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // reduction clause
 class OpenMPReductionClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPReductionClauseModifier modifier =
@@ -749,27 +974,28 @@ public:
   const std::vector<OpenMPExpressionItem> &getOperands() const {
     return expressions;
   }
-  void clearOperands() { expressions.clear(); }
+  void clearOperands() { noteModified(); expressions.clear(); }
 
   static OpenMPClause *addReductionClause(OpenMPDirective *,
                                           OpenMPReductionClauseModifier,
                                           OpenMPReductionClauseIdentifier,
                                           const char *);
 
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_identifier.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_identifier);
+      visitor(user_defined_identifier);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
 
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // ext_implementation_defined_requirement clause
 class OpenMPExtImplementationDefinedRequirementClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   std::string implementation_defined_requirement;
@@ -780,6 +1006,7 @@ public:
 
   void setImplementationDefinedRequirement(
       const char *_implementation_defined_requirement) {
+    noteModified();
     implementation_defined_requirement = _implementation_defined_requirement;
   };
   const std::string &getImplementationDefinedRequirement() const {
@@ -788,11 +1015,12 @@ public:
 
   static OpenMPClause *
   addExtImplementationDefinedRequirementClause(OpenMPDirective *);
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // initializer clause
 class OpenMPInitializerClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPInitializerClausePriv priv; // initializer priv
 public:
@@ -810,11 +1038,12 @@ public:
   static OpenMPClause *addInitializerClause(OpenMPDirective *,
                                             OpenMPInitializerClausePriv,
                                             const char *);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 class OpenMPApplyClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 public:
   struct ApplyTransform {
     OpenMPApplyTransformKind kind = OMPC_APPLY_TRANSFORM_unknown;
@@ -829,6 +1058,7 @@ protected:
 
 public:
   OpenMPApplyClause() : OpenMPClause(OMPC_apply) {};
+  OpenMPApplyClause(const OpenMPApplyClause &other);
 
   void setLabel(const char *value);
   void addTransformation(OpenMPApplyTransformKind kind,
@@ -837,28 +1067,30 @@ public:
   void addNestedApply(OpenMPApplyClause *nested,
                       OpenMPClauseSeparator sep = OMPC_CLAUSE_SEP_comma);
   const std::string &getLabel() const { return label.spelling; }
+  const ompparser::HostFragment &getLabelFragment() const { return label; }
   const std::vector<ApplyTransform> &getTransformations() const {
     return transforms;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!label.spelling.empty()) {
-      visitOwnedHostFragment(visitor, label);
+      visitor(label);
     }
-    for (ApplyTransform &transform : transforms) {
+    for (const ApplyTransform &transform : transforms) {
       if (!transform.argument.spelling.empty()) {
-        visitOwnedHostFragment(visitor, transform.argument);
+        visitor(transform.argument);
       }
       if (transform.nested_apply != nullptr) {
         transform.nested_apply->visitHostFragments(visitor);
       }
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 class OpenMPInductionClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 public:
   struct Binding {
     ompparser::HostFragment label;
@@ -896,10 +1128,10 @@ public:
     return passthrough_items;
   }
   void visitSpecificationItems(const SpecificationItemVisitor &visitor) const;
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override;
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override;
   std::string specificationToString() const;
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 enum class OpenMPInitModifierCategory {
@@ -918,10 +1150,16 @@ struct OpenMPInitModifier {
 };
 
 class OpenMPInitModifierList {
+  friend class OpenMPStructureReader;
 private:
   std::vector<OpenMPInitModifier> modifiers;
+  // Clause kind stamped on the argument fragments of added modifiers.
+  OpenMPClauseKind owner_clause = OMPC_unknown;
 
 public:
+  explicit OpenMPInitModifierList(OpenMPClauseKind owner = OMPC_unknown)
+      : owner_clause(owner) {}
+
   void addInteropType(OpenMPInitClauseKind value);
   void addDirectiveName(OpenMPDirectiveKind value);
   void addPreferType(const char *specification);
@@ -932,42 +1170,47 @@ public:
   const std::vector<OpenMPInitModifier> &getModifiers() const {
     return modifiers;
   }
-  void visitHostFragments(const ompparser::HostFragmentVisitor &visitor) {
-    for (OpenMPInitModifier &modifier : modifiers) {
+  void
+  visitHostFragments(ompparser::ConstHostFragmentVisitorRef visitor) const {
+    for (const OpenMPInitModifier &modifier : modifiers) {
       if (!modifier.argument.spelling.empty()) {
         visitor(modifier.argument);
       }
     }
   }
   std::string toString() const;
+  void appendModifiers(std::string &result) const;
 };
 
 class OpenMPInitClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 private:
-  OpenMPInitModifierList modifiers;
+  OpenMPInitModifierList modifiers{OMPC_init};
   ompparser::HostFragment operand;
 
 public:
   OpenMPInitClause() : OpenMPClause(OMPC_init) {}
 
-  OpenMPInitModifierList &getModifiers() { return modifiers; }
+  OpenMPInitModifierList &getModifiers() { noteModified(); return modifiers; }
   const OpenMPInitModifierList &getModifiers() const { return modifiers; }
 
   void setOperand(const char *value);
   void setOperand(const std::string &value);
   const std::string &getOperand() const { return operand.spelling; }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    modifiers.visitHostFragments(owningHostFragmentVisitor(visitor));
+  const ompparser::HostFragment &getOperandFragment() const { return operand; }
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    modifiers.visitHostFragments(visitor);
     if (!operand.spelling.empty()) {
-      visitOwnedHostFragment(visitor, operand);
+      visitor(operand);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 class OpenMPAdjustArgsClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 private:
   OpenMPAdjustArgsModifier modifier = OMPC_ADJUST_ARGS_unknown;
   std::vector<ompparser::HostFragment> arguments;
@@ -975,27 +1218,31 @@ private:
 public:
   OpenMPAdjustArgsClause() : OpenMPClause(OMPC_adjust_args) {}
 
-  void setModifier(OpenMPAdjustArgsModifier value) { modifier = value; }
+  void setModifier(OpenMPAdjustArgsModifier value) {
+    noteModified();
+    modifier = value;
+  }
   OpenMPAdjustArgsModifier getModifier() const { return modifier; }
   void addArgument(const char *arg);
   const std::vector<ompparser::HostFragment> &getArguments() const {
     return arguments;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (ompparser::HostFragment &argument : arguments) {
-      visitOwnedHostFragment(visitor, argument);
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const ompparser::HostFragment &argument : arguments) {
+      visitor(argument);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 class OpenMPAppendArgsClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 public:
   struct Operation {
     OpenMPAppendArgsModifier kind = OMPC_APPEND_ARGS_unknown;
-    OpenMPInitModifierList modifiers;
+    OpenMPInitModifierList modifiers{OMPC_append_args};
   };
 
 private:
@@ -1008,19 +1255,20 @@ public:
   OpenMPInitModifierList *getCurrentOperationModifiers();
   std::size_t getOperationCount() const { return operations.size(); }
   const std::vector<Operation> &getOperations() const { return operations; }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (Operation &operation : operations) {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const Operation &operation : operations) {
       operation.modifiers.visitHostFragments(
-          owningHostFragmentVisitor(visitor));
+          visitor);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // allocate clause
 class OpenMPAllocateClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 public:
   enum class ModifierKind { Allocator, Align };
 
@@ -1055,25 +1303,26 @@ public:
   const std::vector<ModifierKind> &getModifierOrder() const {
     return modifier_order;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_allocator.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_allocator);
+      visitor(user_defined_allocator);
     }
     if (!alignment.spelling.empty()) {
-      visitOwnedHostFragment(visitor, alignment);
+      visitor(alignment);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
 
   static OpenMPClause *addAllocateClause(OpenMPDirective *,
                                          OpenMPAllocateClauseAllocator,
                                          const char *);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // allocator
 class OpenMPAllocatorClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPAllocatorClauseAllocator allocator; // Allocate allocator
   ompparser::HostFragment user_defined_allocator;
@@ -1089,23 +1338,27 @@ public:
   const std::string &getUserDefinedAllocator() const {
     return user_defined_allocator.spelling;
   };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  const ompparser::HostFragment &getUserDefinedAllocatorFragment() const {
+    return user_defined_allocator;
+  }
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_allocator.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_allocator);
+      visitor(user_defined_allocator);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
 
   static OpenMPClause *addAllocatorClause(OpenMPDirective *,
                                           OpenMPAllocatorClauseAllocator,
                                           const char *);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // lastprivate Clause
 class OpenMPLastprivateClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPLastprivateClauseModifier modifier =
       OMPC_LASTPRIVATE_MODIFIER_unspecified; // lastprivate modifier
@@ -1121,12 +1374,13 @@ public:
   static OpenMPClause *addLastprivateClause(OpenMPDirective *,
                                             OpenMPLastprivateClauseModifier);
 
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // linear Clause
 class OpenMPLinearClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPLinearClauseModifier modifier; // linear modifier
 
@@ -1141,6 +1395,7 @@ public:
   OpenMPLinearClauseModifier getModifier() const { return modifier; };
 
   void setModifier(OpenMPLinearClauseModifier _modifier) {
+    noteModified();
     modifier = _modifier;
   };
 
@@ -1149,27 +1404,34 @@ public:
   const std::string &getUserDefinedStep() const {
     return user_defined_step.spelling;
   };
+  const ompparser::HostFragment &getUserDefinedStepFragment() const {
+    return user_defined_step;
+  }
 
-  void setModifierFirstSyntax(bool value) { modifier_first_syntax = value; };
+  void setModifierFirstSyntax(bool value) {
+    noteModified();
+    modifier_first_syntax = value;
+  };
 
-  bool isModifierFirstSyntax() { return modifier_first_syntax; };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  bool isModifierFirstSyntax() const { return modifier_first_syntax; };
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_step.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_step);
+      visitor(user_defined_step);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
 
   static OpenMPClause *addLinearClause(OpenMPDirective *,
                                        OpenMPLinearClauseModifier);
 
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // aligned Clause
 class OpenMPAlignedClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   ompparser::HostFragment user_defined_alignment;
 
@@ -1181,20 +1443,24 @@ public:
   const std::string &getUserDefinedAlignment() const {
     return user_defined_alignment.spelling;
   };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  const ompparser::HostFragment &getUserDefinedAlignmentFragment() const {
+    return user_defined_alignment;
+  }
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_alignment.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_alignment);
+      visitor(user_defined_alignment);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
   static OpenMPClause *addAlignedClause(OpenMPDirective *);
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // dist_schedule Clause
 class OpenMPDistScheduleClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPDistScheduleClauseKind dist_schedule_kind =
@@ -1213,24 +1479,28 @@ public:
   void setChunkSize(const char *_chunk_size);
 
   const std::string &getChunkSize() const { return chunk_size.spelling; };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  const ompparser::HostFragment &getChunkSizeFragment() const {
+    return chunk_size;
+  }
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!chunk_size.spelling.empty()) {
-      visitOwnedHostFragment(visitor, chunk_size);
+      visitor(chunk_size);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
 
   static OpenMPClause *addDistScheduleClause(OpenMPDirective *,
                                              OpenMPDistScheduleClauseKind);
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // schedule Clause
 class OpenMPScheduleClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPScheduleClauseModifier modifier1 =
@@ -1260,6 +1530,9 @@ public:
   const std::string &getUserDefinedKind() const {
     return user_defined_kind.spelling;
   };
+  const ompparser::HostFragment &getUserDefinedKindFragment() const {
+    return user_defined_kind;
+  }
 
   static OpenMPClause *addScheduleClause(OpenMPDirective *,
                                          OpenMPScheduleClauseModifier,
@@ -1270,22 +1543,26 @@ public:
   void setChunkSize(const char *_step);
 
   const std::string &getChunkSize() const { return chunk_size.spelling; };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  const ompparser::HostFragment &getChunkSizeFragment() const {
+    return chunk_size;
+  }
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_kind.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_kind);
+      visitor(user_defined_kind);
     }
     if (!chunk_size.spelling.empty()) {
-      visitOwnedHostFragment(visitor, chunk_size);
+      visitor(chunk_size);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // grainsize clause with optional strict modifier (OpenMP 5.1)
 class OpenMPGrainsizeClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPGrainsizeClauseModifier modifier;
 
@@ -1299,11 +1576,12 @@ public:
 
   OpenMPGrainsizeClauseModifier getModifier() const { return modifier; };
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // num_tasks clause with optional strict modifier (OpenMP 5.1)
 class OpenMPNumTasksClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPNumTasksClauseModifier modifier;
 
@@ -1317,23 +1595,25 @@ public:
 
   OpenMPNumTasksClauseModifier getModifier() const { return modifier; };
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // num_threads clause with optional strict modifier (OpenMP 5.2)
 class OpenMPNumThreadsClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   bool strict = false;
 
 public:
   OpenMPNumThreadsClause() : OpenMPClause(OMPC_num_threads) {};
-  void setStrict(bool v) { strict = v; }
+  void setStrict(bool v) { noteModified(); strict = v; }
   bool isStrict() const { return strict; }
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // OpenMP clauses with variant directives, such as WHEN and MATCH clauses.
 class OpenMPVariantClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 public:
   struct TraitProperty {
     ompparser::HostFragment fragment;
@@ -1368,6 +1648,8 @@ protected:
 
 public:
   OpenMPVariantClause(OpenMPClauseKind _kind) : OpenMPClause(_kind) {};
+  OpenMPVariantClause(const OpenMPVariantClause &other);
+  bool rendersNestedDirective() const override { return true; }
   void beginTraitSet(OpenMPContextSelectorSequenceKind kind);
   void endTraitSet();
   void beginTraitSelector(OpenMPContextTraitSelectorKind kind,
@@ -1391,15 +1673,16 @@ public:
   const std::vector<TraitSetSelector> &getTraitSets() const {
     return trait_sets;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override;
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override;
   bool validateSelectorInvariants(std::vector<std::string> &errors) const;
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // When Clause
 class OpenMPWhenClause : public OpenMPVariantClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPDirective *variant_directive =
       NULL; // variant directive inside the WHEN clause
@@ -1407,28 +1690,32 @@ protected:
 
 public:
   OpenMPWhenClause() : OpenMPVariantClause(OMPC_when) {};
+  OpenMPWhenClause(const OpenMPWhenClause &other);
   OpenMPDirective *getVariantDirective() { return variant_directive; };
   const OpenMPDirective *getVariantDirective() const {
     return variant_directive;
   }
   void
   setVariantDirective(std::unique_ptr<OpenMPDirective> _variant_directive) {
+    noteModified();
     variant_directive_storage = std::move(_variant_directive);
     variant_directive = variant_directive_storage.get();
   };
   void setVariantDirective(OpenMPDirective *_variant_directive) {
+    noteModified();
     variant_directive_storage.reset();
     variant_directive = _variant_directive;
   };
 
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override;
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override;
 
   static OpenMPClause *addWhenClause(OpenMPDirective *directive);
 };
 
 // Otherwise Clause
 class OpenMPOtherwiseClause : public OpenMPVariantClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPDirective *variant_directive =
       NULL; // variant directive inside the OTHERWISE clause
@@ -1436,22 +1723,25 @@ protected:
 
 public:
   OpenMPOtherwiseClause() : OpenMPVariantClause(OMPC_otherwise) {};
+  OpenMPOtherwiseClause(const OpenMPOtherwiseClause &other);
   OpenMPDirective *getVariantDirective() { return variant_directive; };
   const OpenMPDirective *getVariantDirective() const {
     return variant_directive;
   }
   void
   setVariantDirective(std::unique_ptr<OpenMPDirective> _variant_directive) {
+    noteModified();
     variant_directive_storage = std::move(_variant_directive);
     variant_directive = variant_directive_storage.get();
   };
   void setVariantDirective(OpenMPDirective *_variant_directive) {
+    noteModified();
     variant_directive_storage.reset();
     variant_directive = _variant_directive;
   };
 
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override;
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override;
 
   static OpenMPClause *addOtherwiseClause(OpenMPDirective *directive);
 };
@@ -1467,6 +1757,7 @@ public:
 
 // ProcBind Clause
 class OpenMPProcBindClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPProcBindClauseKind proc_bind_kind; // proc_bind
@@ -1475,14 +1766,17 @@ public:
   OpenMPProcBindClause(OpenMPProcBindClauseKind _proc_bind_kind)
       : OpenMPClause(OMPC_proc_bind), proc_bind_kind(_proc_bind_kind) {};
 
-  OpenMPProcBindClauseKind getProcBindClauseKind() { return proc_bind_kind; };
+  OpenMPProcBindClauseKind getProcBindClauseKind() const {
+    return proc_bind_kind;
+  };
   static OpenMPClause *addProcBindClause(OpenMPDirective *,
                                          OpenMPProcBindClauseKind);
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // Bind Clause
 class OpenMPBindClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPBindClauseBinding bind_binding;
@@ -1491,14 +1785,15 @@ public:
   OpenMPBindClause(OpenMPBindClauseBinding _bind_binding)
       : OpenMPClause(OMPC_bind), bind_binding(_bind_binding) {};
 
-  OpenMPBindClauseBinding getBindClauseBinding() { return bind_binding; };
+  OpenMPBindClauseBinding getBindClauseBinding() const { return bind_binding; };
   static OpenMPClause *addBindClause(OpenMPDirective *,
                                      OpenMPBindClauseBinding);
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // Default Clause
 class OpenMPDefaultClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPDefaultClauseKind default_kind = OMPC_DEFAULT_unknown;
@@ -1514,6 +1809,7 @@ public:
                           OMPC_DEFAULTMAP_CATEGORY_unspecified)
       : OpenMPClause(OMPC_default), default_kind(_default_kind),
         category(_category) {};
+  OpenMPDefaultClause(const OpenMPDefaultClause &other);
 
   OpenMPDefaultClauseKind getDefaultClauseKind() const { return default_kind; };
   OpenMPDefaultmapClauseCategory getCategory() const { return category; }
@@ -1524,26 +1820,32 @@ public:
   }
   void
   setVariantDirective(std::unique_ptr<OpenMPDirective> _variant_directive) {
+    noteModified();
     variant_directive_storage = std::move(_variant_directive);
     variant_directive = variant_directive_storage.get();
   };
   void setVariantDirective(OpenMPDirective *_variant_directive) {
+    noteModified();
     variant_directive_storage.reset();
     variant_directive = _variant_directive;
   };
+  bool rendersNestedDirective() const override {
+    return variant_directive != nullptr;
+  }
 
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override;
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override;
 
   static OpenMPClause *addDefaultClause(OpenMPDirective *,
                                         OpenMPDefaultClauseKind,
                                         OpenMPDefaultmapClauseCategory);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // Order Clause
 class OpenMPOrderClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPOrderClauseModifier order_modifier = OMPC_ORDER_MODIFIER_unspecified;
@@ -1558,8 +1860,10 @@ public:
   OpenMPOrderClause(OpenMPOrderClauseKind _order_kind)
       : OpenMPClause(OMPC_order), order_kind(_order_kind) {};
 
-  OpenMPOrderClauseModifier getOrderClauseModifier() { return order_modifier; };
-  OpenMPOrderClauseKind getOrderClauseKind() { return order_kind; };
+  OpenMPOrderClauseModifier getOrderClauseModifier() const {
+    return order_modifier;
+  };
+  OpenMPOrderClauseKind getOrderClauseKind() const { return order_kind; };
   void addOperand(const char *expr,
                   OpenMPClauseSeparator sep = OMPC_CLAUSE_SEP_comma) {
     addLangExpr(expr, sep, 0, 0, OMP_EXPR_PARSE_variable_list);
@@ -1567,14 +1871,14 @@ public:
   const std::vector<OpenMPExpressionItem> &getOperands() const {
     return expressions;
   }
-  void clearOperands() { expressions.clear(); }
+  void clearOperands() { noteModified(); expressions.clear(); }
 
   static OpenMPClause *addOrderClause(OpenMPDirective *,
                                       OpenMPOrderClauseModifier,
                                       OpenMPOrderClauseKind);
   static OpenMPClause *addOrderClause(OpenMPDirective *, OpenMPOrderClauseKind);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // inclusive/exclusive scan clauses
@@ -1591,12 +1895,13 @@ public:
     return expressions;
   }
 
-  void clearOperands() { expressions.clear(); }
+  void clearOperands() { noteModified(); expressions.clear(); }
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 class OpenMPFirstprivateClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
   bool saved = false;
   bool has_directive_name_modifier = false;
   OpenMPDirectiveKind directive_name_modifier = OMPD_unknown;
@@ -1604,12 +1909,14 @@ class OpenMPFirstprivateClause : public OpenMPClause {
 public:
   OpenMPFirstprivateClause() : OpenMPClause(OMPC_firstprivate) {}
 
-  void setSaved(bool value = true) { saved = value; }
+  void setSaved(bool value = true) { noteModified(); saved = value; }
   void setCurrentDirectiveNameModifier(OpenMPDirectiveKind value) {
+    noteModified();
     has_directive_name_modifier = true;
     directive_name_modifier = value;
   }
   void clearCurrentDirectiveNameModifier() {
+    noteModified();
     has_directive_name_modifier = false;
     directive_name_modifier = OMPD_unknown;
   }
@@ -1619,11 +1926,12 @@ public:
     return directive_name_modifier;
   }
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // if Clause
 class OpenMPIfClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPIfClauseModifier modifier; // linear modifier
@@ -1640,25 +1948,29 @@ public:
   const std::string &getUserDefinedModifier() const {
     return user_defined_modifier.spelling;
   };
+  const ompparser::HostFragment &getUserDefinedModifierFragment() const {
+    return user_defined_modifier;
+  }
 
   static OpenMPClause *addIfClause(OpenMPDirective *directive,
                                    OpenMPIfClauseModifier modifier,
                                    const char *user_defined_modifier);
 
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_modifier.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_modifier);
+      visitor(user_defined_modifier);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // in_reduction clause
 class OpenMPInReductionClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPInReductionClauseIdentifier identifier =
@@ -1691,23 +2003,24 @@ public:
   const std::vector<OpenMPExpressionItem> &getOperands() const {
     return expressions;
   }
-  void clearOperands() { expressions.clear(); }
+  void clearOperands() { noteModified(); expressions.clear(); }
 
   static OpenMPClause *addInReductionClause(OpenMPDirective *,
                                             OpenMPInReductionClauseIdentifier,
                                             const char *);
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_identifier.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_identifier);
+      visitor(user_defined_identifier);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // depend clause
 class OpenMPDependClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPDependClauseModifier modifier =
@@ -1728,11 +2041,19 @@ public:
   const std::string &getDependenceVector() const {
     return dependence_vector.spelling;
   }
-  void addIterator(const OpenMPIterator &it) { iterators.push_back(it); }
+  const ompparser::HostFragment &getDependenceVectorFragment() const {
+    return dependence_vector;
+  }
+  void addIterator(const OpenMPIterator &it) {
+    noteModified();
+    iterators.push_back(it);
+    iterators.back().setOwnerClause(kind);
+  }
   const std::vector<OpenMPIterator> &getIterators() const { return iterators; }
-  void clearIterators() { iterators.clear(); }
+  void clearIterators() { noteModified(); iterators.clear(); }
   void setDependIteratorsDefinitionClass(
       const std::vector<std::vector<const char *>> &definition_class) {
+    noteModified();
     iterators.clear();
     for (const auto &vec : definition_class) {
       if (vec.size() < 4) {
@@ -1744,27 +2065,29 @@ public:
           vec[2] ? std::string(vec[2]) : "", vec[3] ? std::string(vec[3]) : "",
           (vec.size() > 4 && vec[4]) ? std::string(vec[4]) : "");
       iterators.push_back(it);
+      iterators.back().setOwnerClause(kind);
     }
   };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!dependence_vector.spelling.empty()) {
-      visitOwnedHostFragment(visitor, dependence_vector);
+      visitor(dependence_vector);
     }
-    for (OpenMPIterator &iterator : iterators) {
-      iterator.visitHostFragments(visitor, kind);
+    for (const OpenMPIterator &iterator : iterators) {
+      iterator.visitHostFragments(visitor);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
   static OpenMPClause *addDependClause(OpenMPDirective *,
                                        OpenMPDependClauseModifier,
                                        OpenMPDependClauseType);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // doacross clause (OpenMP 5.2)
 class OpenMPDoacrossClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPDoacrossClauseType type = OMPC_DOACROSS_TYPE_unknown; // source or sink
@@ -1778,6 +2101,7 @@ public:
   OpenMPDoacrossClauseType getType() const { return type; };
   void setSourceExpression(const std::string &expr,
                            OpenMPClauseSeparator sep = OMPC_CLAUSE_SEP_space) {
+    noteModified();
     if (expressions.size() != 1 ||
         expressions.front().fragment.spelling != expr ||
         expressions.front().separator != sep ||
@@ -1797,13 +2121,14 @@ public:
   const std::vector<OpenMPExpressionItem> &getSinkArgs() const {
     return expressions;
   }
-  void clearSinkArgs() { expressions.clear(); }
+  void clearSinkArgs() { noteModified(); expressions.clear(); }
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // affinity clause
 class OpenMPAffinityClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPAffinityClauseModifier modifier =
@@ -1816,11 +2141,14 @@ public:
   OpenMPAffinityClause(OpenMPAffinityClauseModifier _modifier)
       : OpenMPClause(OMPC_affinity), modifier(_modifier) {};
   void addIterator(const OpenMPIterator &iterator) {
+    noteModified();
     iterators.push_back(iterator);
+    iterators.back().setOwnerClause(kind);
   }
-  void clearIterators() { iterators.clear(); }
+  void clearIterators() { noteModified(); iterators.clear(); }
   void addIteratorsDefinitionClass(
       const std::vector<const char *> &iterator_definition) {
+    noteModified();
     if (iterator_definition.size() < 4) {
       return;
     }
@@ -1833,26 +2161,28 @@ public:
                ? std::string(iterator_definition[4])
                : "");
     iterators.push_back(it);
+    iterators.back().setOwnerClause(kind);
   };
   const std::vector<OpenMPIterator> &getIterators() const { return iterators; };
   const std::vector<OpenMPIterator> &getIteratorsDefinitionClass() const {
     return getIterators();
   };
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (OpenMPIterator &iterator : iterators) {
-      iterator.visitHostFragments(visitor, kind);
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const OpenMPIterator &iterator : iterators) {
+      iterator.visitHostFragments(visitor);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
   OpenMPAffinityClauseModifier getModifier() const { return modifier; };
   static OpenMPClause *addAffinityClause(OpenMPDirective *,
                                          OpenMPAffinityClauseModifier);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // atomic_default_mem_order clause
 class OpenMPAtomicDefaultMemOrderClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPAtomicDefaultMemOrderClauseKind kind;
@@ -1867,12 +2197,13 @@ public:
   addAtomicDefaultMemOrderClause(OpenMPDirective *directive,
                                  OpenMPAtomicDefaultMemOrderClauseKind kind);
 
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // device clause
 class OpenMPDeviceClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPDeviceClauseModifier modifier =
@@ -1888,12 +2219,13 @@ public:
 
   static OpenMPClause *addDeviceClause(OpenMPDirective *directive,
                                        OpenMPDeviceClauseModifier modifier);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // to clause
 class OpenMPToClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPToClauseKind to_kind = OMPC_TO_unspecified;
@@ -1919,14 +2251,18 @@ public:
   void addIterator(const std::string &qualifier, const std::string &var,
                    const std::string &begin, const std::string &end,
                    const std::string &step = std::string()) {
+    noteModified();
     OpenMPIterator it;
     it.set(qualifier, var, begin, end, step);
     iterators.push_back(it);
+    iterators.back().setOwnerClause(kind);
   }
   const std::vector<OpenMPIterator> &getIterators() const { return iterators; }
-  void clearIterators() { iterators.clear(); }
+  void clearIterators() { noteModified(); iterators.clear(); }
   void addIterator(const OpenMPIterator &iterator) {
+    noteModified();
     iterators.push_back(iterator);
+    iterators.back().setOwnerClause(kind);
   }
   void addItem(const char *expr,
                OpenMPClauseSeparator sep = OMPC_CLAUSE_SEP_comma) {
@@ -1939,23 +2275,24 @@ public:
   const std::vector<OpenMPExpressionItem> &getItems() const {
     return expressions;
   }
-  void clearItems() { expressions.clear(); }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (OpenMPIterator &iterator : iterators) {
-      iterator.visitHostFragments(visitor, kind);
+  void clearItems() { noteModified(); expressions.clear(); }
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const OpenMPIterator &iterator : iterators) {
+      iterator.visitHostFragments(visitor);
     }
     if (!mapper_identifier.spelling.empty()) {
-      visitOwnedHostFragment(visitor, mapper_identifier);
+      visitor(mapper_identifier);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
   static OpenMPClause *addToClause(OpenMPDirective *, OpenMPToClauseKind);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // from clause
 class OpenMPFromClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPFromClauseKind from_kind = OMPC_FROM_unspecified;
@@ -1982,14 +2319,18 @@ public:
   void addIterator(const std::string &qualifier, const std::string &var,
                    const std::string &begin, const std::string &end,
                    const std::string &step = std::string()) {
+    noteModified();
     OpenMPIterator it;
     it.set(qualifier, var, begin, end, step);
     iterators.push_back(it);
+    iterators.back().setOwnerClause(kind);
   }
   const std::vector<OpenMPIterator> &getIterators() const { return iterators; }
-  void clearIterators() { iterators.clear(); }
+  void clearIterators() { noteModified(); iterators.clear(); }
   void addIterator(const OpenMPIterator &iterator) {
+    noteModified();
     iterators.push_back(iterator);
+    iterators.back().setOwnerClause(kind);
   }
   void addItem(const char *expr,
                OpenMPClauseSeparator sep = OMPC_CLAUSE_SEP_comma) {
@@ -2002,23 +2343,24 @@ public:
   const std::vector<OpenMPExpressionItem> &getItems() const {
     return expressions;
   }
-  void clearItems() { expressions.clear(); }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (OpenMPIterator &iterator : iterators) {
-      iterator.visitHostFragments(visitor, kind);
+  void clearItems() { noteModified(); expressions.clear(); }
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const OpenMPIterator &iterator : iterators) {
+      iterator.visitHostFragments(visitor);
     }
     if (!mapper_identifier.spelling.empty()) {
-      visitOwnedHostFragment(visitor, mapper_identifier);
+      visitor(mapper_identifier);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
   static OpenMPClause *addFromClause(OpenMPDirective *, OpenMPFromClauseKind);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // defaultmap Clause
 class OpenMPDefaultmapClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   OpenMPDefaultmapClauseBehavior behavior; // defaultmap behavior
   OpenMPDefaultmapClauseCategory category; // defaultmap category
@@ -2035,11 +2377,12 @@ public:
   static OpenMPClause *addDefaultmapClause(OpenMPDirective *,
                                            OpenMPDefaultmapClauseBehavior,
                                            OpenMPDefaultmapClauseCategory);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // device type Clause
 class OpenMPDeviceTypeClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPDeviceTypeClauseKind device_type_kind = OMPC_DEVICE_TYPE_unknown;
@@ -2055,10 +2398,11 @@ public:
   static OpenMPClause *
   addDeviceTypeClause(OpenMPDirective *directive,
                       OpenMPDeviceTypeClauseKind devicetypeKind);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 class OpenMPTaskReductionClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
   // task reduction clause
 protected:
   OpenMPTaskReductionClauseIdentifier identifier =
@@ -2091,24 +2435,25 @@ public:
   const std::vector<OpenMPExpressionItem> &getOperands() const {
     return expressions;
   }
-  void clearOperands() { expressions.clear(); }
+  void clearOperands() { noteModified(); expressions.clear(); }
 
   static OpenMPClause *
   addTaskReductionClause(OpenMPDirective *, OpenMPTaskReductionClauseIdentifier,
                          const char *);
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!user_defined_identifier.spelling.empty()) {
-      visitOwnedHostFragment(visitor, user_defined_identifier);
+      visitor(user_defined_identifier);
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // map clause
 class OpenMPMapClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 public:
   enum DistDataPolicyKind {
     DIST_DATA_duplicate,
@@ -2150,6 +2495,7 @@ public:
   OpenMPMapClauseType getType() const { return type; };
   OpenMPMapClauseRefModifier getRefModifier() const { return ref_modifier; }
   void setRefModifier(OpenMPMapClauseRefModifier value) {
+    noteModified();
     ref_modifier = value;
   }
   const std::string &getMapperIdentifier() const {
@@ -2159,16 +2505,22 @@ public:
     return mapper_identifier;
   }
   void setMapperIdentifier(const char *_identifier);
-  void addIterator(const OpenMPIterator &it) { iterators.push_back(it); }
+  void addIterator(const OpenMPIterator &it) {
+    noteModified();
+    iterators.push_back(it);
+    iterators.back().setOwnerClause(kind);
+  }
   void addIterator(const std::string &qualifier, const std::string &var,
                    const std::string &begin, const std::string &end,
                    const std::string &step = std::string()) {
+    noteModified();
     OpenMPIterator it;
     it.set(qualifier, var, begin, end, step);
     iterators.push_back(it);
+    iterators.back().setOwnerClause(kind);
   }
   const std::vector<OpenMPIterator> &getIterators() const { return iterators; }
-  void clearIterators() { iterators.clear(); }
+  void clearIterators() { noteModified(); iterators.clear(); }
   void addItem(const char *expr,
                OpenMPClauseSeparator sep = OMPC_CLAUSE_SEP_comma);
   void addItem(const std::string &expr,
@@ -2180,37 +2532,39 @@ public:
     return dist_data_policies;
   }
   void clearItems() {
+    noteModified();
     expressions.clear();
     dist_data_policies.clear();
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (OpenMPIterator &iterator : iterators) {
-      iterator.visitHostFragments(visitor, kind);
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const OpenMPIterator &iterator : iterators) {
+      iterator.visitHostFragments(visitor);
     }
     if (!mapper_identifier.spelling.empty()) {
-      visitOwnedHostFragment(visitor, mapper_identifier);
+      visitor(mapper_identifier);
     }
-    for (auto &policy_list : dist_data_policies) {
-      for (DistDataPolicy &policy : policy_list) {
+    for (const auto &policy_list : dist_data_policies) {
+      for (const DistDataPolicy &policy : policy_list) {
         if (!policy.argument.spelling.empty()) {
-          visitOwnedHostFragment(visitor, policy.argument);
+          visitor(policy.argument);
         }
       }
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
   static OpenMPClause *addMapClause(OpenMPDirective *, OpenMPMapClauseModifier,
                                     OpenMPMapClauseModifier,
                                     OpenMPMapClauseModifier,
                                     OpenMPMapClauseType,
                                     OpenMPMapClauseRefModifier);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 
 // declare target directive
 class OpenMPDeclareTargetDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   std::vector<ompparser::HostFragment> extended_list;
 
@@ -2220,17 +2574,18 @@ public:
   const std::vector<ompparser::HostFragment> &getExtendedList() const {
     return extended_list;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (ompparser::HostFragment &item : extended_list) {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const ompparser::HostFragment &item : extended_list) {
       visitor(item);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // flush directive
 class OpenMPFlushDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 protected:
   std::vector<ompparser::HostFragment> flush_list;
 
@@ -2240,17 +2595,18 @@ public:
   const std::vector<ompparser::HostFragment> &getFlushList() const {
     return flush_list;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (ompparser::HostFragment &item : flush_list) {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const ompparser::HostFragment &item : flush_list) {
       visitor(item);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 
 // critical directive
 class OpenMPCriticalDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 
 protected:
   ompparser::HostFragment critical_name;
@@ -2258,6 +2614,7 @@ protected:
 public:
   OpenMPCriticalDirective() : OpenMPDirective(OMPD_critical) {}
   void setCriticalName(const char *_name) {
+    noteModified();
     critical_name.spelling =
         _name != nullptr ? std::string(_name) : std::string();
     critical_name.role = ompparser::HostFragmentRole::Declarator;
@@ -2269,16 +2626,17 @@ public:
   const ompparser::HostFragment &getCriticalNameFragment() const {
     return critical_name;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!critical_name.spelling.empty()) {
       visitor(critical_name);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
 };
 // DepobjUpdate clause
 class OpenMPDepobjUpdateClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 
 protected:
   OpenMPDepobjUpdateClauseDependeceType type =
@@ -2294,11 +2652,12 @@ public:
   static OpenMPClause *
   addDepobjUpdateClause(OpenMPDirective *,
                         OpenMPDepobjUpdateClauseDependeceType);
-  std::string toString() override;
-  void generateDOT(std::ostream &, int, int, std::string) const override;
+  void writeString(std::string &result) const override;
+  void generateDOT(std::ostream &, int, int, std::string_view) const override;
 };
 // depobj directive
 class OpenMPDepobjDirective : public OpenMPDirective {
+  friend class OpenMPStructureReader;
 
 protected:
   ompparser::HostFragment depobj;
@@ -2308,14 +2667,14 @@ public:
   void addDepobj(const char *_depobj);
   const std::string &getDepobj() const { return depobj.spelling; };
   const ompparser::HostFragment &getDepobjFragment() const { return depobj; }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
     if (!depobj.spelling.empty()) {
       visitor(depobj);
     }
-    OpenMPDirective::visitHostFragments(visitor);
+    OpenMPDirective::walkHostFragments(visitor);
   }
-  void generateDOT(std::ostream &, int, int, std::string) const;
+  void generateDOT(std::ostream &, int, int, std::string_view) const;
 };
 // ordered directive
 class OpenMPOrderedDirective : public OpenMPDirective {
@@ -2323,7 +2682,7 @@ class OpenMPOrderedDirective : public OpenMPDirective {
 protected:
 public:
   OpenMPOrderedDirective() : OpenMPDirective(OMPD_ordered) {}
-  void generateDOT(std::ostream &, int, int, std::string) const;
+  void generateDOT(std::ostream &, int, int, std::string_view) const;
 };
 // uses_allocators clause_parameters
 class usesAllocatorParameter {
@@ -2348,7 +2707,14 @@ public:
   const std::string &getAllocatorUser() const {
     return allocator_user.spelling;
   }
-  void visitHostFragments(const ompparser::HostFragmentVisitor &visitor) {
+  const ompparser::HostFragment &getAllocatorTraitsArrayFragment() const {
+    return allocator_traits_array;
+  }
+  const ompparser::HostFragment &getAllocatorUserFragment() const {
+    return allocator_user;
+  }
+  void
+  visitHostFragments(ompparser::ConstHostFragmentVisitorRef visitor) const {
     if (!allocator_traits_array.spelling.empty()) {
       visitor(allocator_traits_array);
     }
@@ -2359,6 +2725,7 @@ public:
 };
 // uses_allocators clause
 class OpenMPUsesAllocatorsClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   // Owned storage for allocator parameters
   std::vector<std::unique_ptr<usesAllocatorParameter>>
@@ -2368,32 +2735,35 @@ protected:
 
 public:
   OpenMPUsesAllocatorsClause() : OpenMPClause(OMPC_uses_allocators) {};
+  OpenMPUsesAllocatorsClause(const OpenMPUsesAllocatorsClause &other);
   void addUsesAllocatorsAllocatorSequence(
       OpenMPUsesAllocatorsClauseAllocator _allocator,
       const char *_allocator_traits_array, const char *_allocator_user);
   std::vector<usesAllocatorParameter *> *getUsesAllocatorsAllocatorSequence() {
+    noteModified();
     return &usesAllocatorsAllocatorSequenceView;
   };
   const std::vector<usesAllocatorParameter *> &
   getUsesAllocatorsAllocatorSequence() const {
     return usesAllocatorsAllocatorSequenceView;
   }
-  void
-  visitHostFragments(const ompparser::HostFragmentVisitor &visitor) override {
-    for (usesAllocatorParameter *parameter :
+  void walkHostFragments(
+      ompparser::ConstHostFragmentVisitorRef visitor) const override {
+    for (const usesAllocatorParameter *parameter :
          usesAllocatorsAllocatorSequenceView) {
       if (parameter != nullptr) {
-        parameter->visitHostFragments(owningHostFragmentVisitor(visitor));
+        parameter->visitHostFragments(visitor);
       }
     }
-    OpenMPClause::visitHostFragments(visitor);
+    OpenMPClause::walkHostFragments(visitor);
   }
   static OpenMPClause *addUsesAllocatorsClause(OpenMPDirective *directive);
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // absent clause
 class OpenMPAbsentClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   std::vector<OpenMPDirectiveKind> directive_list;
 
@@ -2401,6 +2771,7 @@ public:
   OpenMPAbsentClause() : OpenMPClause(OMPC_absent) {};
 
   void addDirective(OpenMPDirectiveKind kind) {
+    noteModified();
     directive_list.push_back(kind);
   }
 
@@ -2408,11 +2779,12 @@ public:
     return directive_list;
   }
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // contains clause
 class OpenMPContainsClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
 protected:
   std::vector<OpenMPDirectiveKind> directive_list;
 
@@ -2420,6 +2792,7 @@ public:
   OpenMPContainsClause() : OpenMPClause(OMPC_contains) {};
 
   void addDirective(OpenMPDirectiveKind kind) {
+    noteModified();
     directive_list.push_back(kind);
   }
 
@@ -2427,193 +2800,197 @@ public:
     return directive_list;
   }
 
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // graph_id clause
 class OpenMPGraphIdClause : public OpenMPClause {
 public:
   OpenMPGraphIdClause() : OpenMPClause(OMPC_graph_id) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // graph_reset clause
 class OpenMPGraphResetClause : public OpenMPClause {
 public:
   OpenMPGraphResetClause() : OpenMPClause(OMPC_graph_reset) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // transparent clause
 class OpenMPTransparentClause : public OpenMPClause {
 public:
   OpenMPTransparentClause() : OpenMPClause(OMPC_transparent) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // replayable clause
 class OpenMPReplayableClause : public OpenMPClause {
 public:
   OpenMPReplayableClause() : OpenMPClause(OMPC_replayable) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // threadset clause
 class OpenMPThreadsetClause : public OpenMPClause {
 public:
   OpenMPThreadsetClause() : OpenMPClause(OMPC_threadset) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // indirect clause
 class OpenMPIndirectClause : public OpenMPClause {
 public:
   OpenMPIndirectClause() : OpenMPClause(OMPC_indirect) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // local clause
 class OpenMPLocalClause : public OpenMPClause {
 public:
   OpenMPLocalClause() : OpenMPClause(OMPC_local) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // init_complete clause
 class OpenMPInitCompleteClause : public OpenMPClause {
 public:
   OpenMPInitCompleteClause() : OpenMPClause(OMPC_init_complete) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // safesync clause
 class OpenMPSafesyncClause : public OpenMPClause {
 public:
   OpenMPSafesyncClause() : OpenMPClause(OMPC_safesync) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // device_safesync clause
 class OpenMPDeviceSafesyncClause : public OpenMPClause {
 public:
   OpenMPDeviceSafesyncClause() : OpenMPClause(OMPC_device_safesync) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // memscope clause
 class OpenMPMemscopeClause : public OpenMPClause {
+  friend class OpenMPStructureReader;
   OpenMPMemscopeClauseKind scope = OMPC_MEMSCOPE_unknown;
 
 public:
   OpenMPMemscopeClause() : OpenMPClause(OMPC_memscope) {}
-  void setScope(OpenMPMemscopeClauseKind value) { scope = value; }
+  void setScope(OpenMPMemscopeClauseKind value) {
+    noteModified();
+    scope = value;
+  }
   OpenMPMemscopeClauseKind getScope() const { return scope; }
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // looprange clause
 class OpenMPLooprangeClause : public OpenMPClause {
 public:
   OpenMPLooprangeClause() : OpenMPClause(OMPC_looprange) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // permutation clause
 class OpenMPPermutationClause : public OpenMPClause {
 public:
   OpenMPPermutationClause() : OpenMPClause(OMPC_permutation) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // counts clause
 class OpenMPCountsClause : public OpenMPClause {
 public:
   OpenMPCountsClause() : OpenMPClause(OMPC_counts) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // inductor clause
 class OpenMPInductorClause : public OpenMPClause {
 public:
   OpenMPInductorClause() : OpenMPClause(OMPC_inductor) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // collector clause
 class OpenMPCollectorClause : public OpenMPClause {
 public:
   OpenMPCollectorClause() : OpenMPClause(OMPC_collector) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // combiner clause
 class OpenMPCombinerClause : public OpenMPClause {
 public:
   OpenMPCombinerClause() : OpenMPClause(OMPC_combiner) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // no_openmp clause
 class OpenMPNoOpenmpClause : public OpenMPClause {
 public:
   OpenMPNoOpenmpClause() : OpenMPClause(OMPC_no_openmp) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // no_openmp_constructs clause
 class OpenMPNoOpenmpConstructsClause : public OpenMPClause {
 public:
   OpenMPNoOpenmpConstructsClause() : OpenMPClause(OMPC_no_openmp_constructs) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // no_openmp_routines clause
 class OpenMPNoOpenmpRoutinesClause : public OpenMPClause {
 public:
   OpenMPNoOpenmpRoutinesClause() : OpenMPClause(OMPC_no_openmp_routines) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // no_parallelism clause
 class OpenMPNoParallelismClause : public OpenMPClause {
 public:
   OpenMPNoParallelismClause() : OpenMPClause(OMPC_no_parallelism) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // nocontext clause
 class OpenMPNocontextClause : public OpenMPClause {
 public:
   OpenMPNocontextClause() : OpenMPClause(OMPC_nocontext) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // novariants clause
 class OpenMPNovariantsClause : public OpenMPClause {
 public:
   OpenMPNovariantsClause() : OpenMPClause(OMPC_novariants) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // enter clause
 class OpenMPEnterClause : public OpenMPClause {
 public:
   OpenMPEnterClause() : OpenMPClause(OMPC_enter) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // use clause
 class OpenMPUseClause : public OpenMPClause {
 public:
   OpenMPUseClause() : OpenMPClause(OMPC_use) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 // holds clause
 class OpenMPHoldsClause : public OpenMPClause {
 public:
   OpenMPHoldsClause() : OpenMPClause(OMPC_holds) {}
-  std::string toString() override;
+  void writeString(std::string &result) const override;
 };
 
 #endif // OMPPARSER_OPENMPAST_H
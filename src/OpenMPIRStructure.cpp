@@ -0,0 +1,1716 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// Deep copies, structural equality, structural hashing and binary
+// serialization of the OpenMP IR.
+
+#include "OpenMPIR.h"
+#include "OpenMPIRVisitor.h"
+#include "OpenMPKindNames.h"
+#include "OpenMPParserInternal.h"
+#include "OpenMPSchema.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Copies a node through the copy constructor of its concrete class.
+class CloningVisitor : public ompparser::ConstOpenMPIRVisitor<CloningVisitor> {
+public:
+  std::unique_ptr<OpenMPDirective> directive;
+  std::unique_ptr<OpenMPClause> clause;
+
+  bool visitDirective(const OpenMPDirective &node) {
+    directive = std::make_unique<OpenMPDirective>(node);
+    return true;
+  }
+  bool visitClause(const OpenMPClause &node) {
+    clause = std::make_unique<OpenMPClause>(node);
+    return true;
+  }
+
+#define OPENMP_DIRECTIVE_NODE(Name, Class)                                     \
+  bool visit##Class(const OpenMP##Class &node) {                               \
+    directive = std::make_unique<OpenMP##Class>(node);                         \
+    return true;                                                               \
+  }
+#define OPENMP_CLAUSE_NODE(Class, Parent)                                      \
+  bool visit##Class(const OpenMP##Class &node) {                               \
+    clause = std::make_unique<OpenMP##Class>(node);                            \
+    return true;                                                               \
+  }
+#include "OpenMPIRNodes.def"
+#undef OPENMP_CLAUSE_NODE
+#undef OPENMP_DIRECTIVE_NODE
+};
+
+std::unique_ptr<OpenMPDirective>
+cloneOwnedDirective(const std::unique_ptr<OpenMPDirective> &directive) {
+  return directive != nullptr ? directive->clone() : nullptr;
+}
+
+// Emits the structure of a node as a prefix-decodable stream of integers and
+// strings. Every node starts with its kind, which fixes the concrete class,
+// and every sequence or optional child is preceded by its length or presence.
+// The stream is also the serialized form of a directive, so a change to it
+// must be mirrored in OpenMPStructureReader and bump
+// ompparser::SerializationFormatVersion.
+template <typename Sink>
+class StructureWriter
+    : public ompparser::ConstOpenMPIRVisitor<StructureWriter<Sink>> {
+public:
+  StructureWriter(Sink &sink, const ompparser::StructuralOptions &options)
+      : sink(sink), options(options) {}
+
+  void writeDirective(const OpenMPDirective &directive) {
+    value(directive.getKind());
+    this->dispatch(directive);
+  }
+
+  void writeClause(const OpenMPClause &clause) {
+    value(clause.OpenMPClause::getKind());
+    this->dispatch(clause);
+  }
+
+  bool visitDirective(const OpenMPDirective &directive) {
+    value(directive.getBaseLang());
+    value(directive.getDeclareTargetUnderscore());
+    value(directive.getCompactParallelDo());
+    value(directive.getRequiresExplicitEnd());
+    value(directive.getFortranSentinel());
+    sink.text(directive.getImplementationDefinedPayload());
+    location(directive);
+    const std::vector<OpenMPClause *> &clauses =
+        directive.getClausesInOriginalOrder();
+    value(clauses.size());
+    for (const OpenMPClause *clause : clauses) {
+      optionalClause(clause);
+    }
+    return true;
+  }
+
+  bool visitClause(const OpenMPClause &clause) {
+    value(clause.getDirectiveKind());
+    value(clause.getBaseLang());
+    value(clause.hasDirectiveNameModifier());
+    value(clause.getDirectiveNameModifier());
+    value(clause.getPrecedingSeparator());
+    const std::vector<OpenMPExpressionItem> &expressions =
+        clause.getExpressionItems();
+    value(expressions.size());
+    for (const OpenMPExpressionItem &expression : expressions) {
+      fragment(expression.fragment);
+      value(expression.separator);
+      value(expression.parse_mode);
+    }
+    location(clause);
+    return true;
+  }
+
+  // Directives.
+  bool visitEndDirective(const OpenMPEndDirective &directive) {
+    value(directive.getPairedDirectiveRole());
+    optionalDirective(directive.getPairedDirective());
+    fragment(directive.getEndArgument());
+    value(directive.getUseCompactEndDo());
+    return visitDirective(directive);
+  }
+  bool visitDeclareVariantDirective(
+      const OpenMPDeclareVariantDirective &directive) {
+    fragment(directive.getVariantFuncFragment());
+    return visitDirective(directive);
+  }
+  bool visitAllocateDirective(const OpenMPAllocateDirective &directive) {
+    fragments(directive.getAllocateList());
+    return visitDirective(directive);
+  }
+  bool
+  visitThreadprivateDirective(const OpenMPThreadprivateDirective &directive) {
+    fragments(directive.getThreadprivateList());
+    return visitDirective(directive);
+  }
+  bool
+  visitGroupprivateDirective(const OpenMPGroupprivateDirective &directive) {
+    fragments(directive.getGroupprivateList());
+    return visitDirective(directive);
+  }
+  bool visitDeclareSimdDirective(const OpenMPDeclareSimdDirective &directive) {
+    fragment(directive.getProcNameFragment());
+    return visitDirective(directive);
+  }
+  bool visitDeclareReductionDirective(
+      const OpenMPDeclareReductionDirective &directive) {
+    fragments(directive.getTypenameList());
+    sink.text(directive.getIdentifier());
+    fragment(directive.getCombinerFragment());
+    return visitDirective(directive);
+  }
+  bool
+  visitDeclareMapperDirective(const OpenMPDeclareMapperDirective &directive) {
+    value(directive.getIdentifier());
+    value(directive.hasExplicitIdentifier());
+    fragment(directive.getUserDefinedIdentifierFragment());
+    fragment(directive.getDeclareMapperTypeFragment());
+    fragment(directive.getDeclareMapperVarFragment());
+    value(directive.hasTypeVarSpace());
+    return visitDirective(directive);
+  }
+  bool
+  visitDeclareTargetDirective(const OpenMPDeclareTargetDirective &directive) {
+    fragments(directive.getExtendedList());
+    return visitDirective(directive);
+  }
+  bool visitFlushDirective(const OpenMPFlushDirective &directive) {
+    fragments(directive.getFlushList());
+    return visitDirective(directive);
+  }
+  bool visitCriticalDirective(const OpenMPCriticalDirective &directive) {
+    fragment(directive.getCriticalNameFragment());
+    return visitDirective(directive);
+  }
+  bool visitDepobjDirective(const OpenMPDepobjDirective &directive) {
+    fragment(directive.getDepobjFragment());
+    return visitDirective(directive);
+  }
+
+  // Clauses.
+  bool visitIfClause(const OpenMPIfClause &clause) {
+    value(clause.getModifier());
+    fragment(clause.getUserDefinedModifierFragment());
+    return visitClause(clause);
+  }
+  bool visitNumThreadsClause(const OpenMPNumThreadsClause &clause) {
+    value(clause.isStrict());
+    return visitClause(clause);
+  }
+  bool visitDefaultClause(const OpenMPDefaultClause &clause) {
+    value(clause.getDefaultClauseKind());
+    value(clause.getCategory());
+    optionalDirective(clause.getVariantDirective());
+    return visitClause(clause);
+  }
+  bool visitFirstprivateClause(const OpenMPFirstprivateClause &clause) {
+    value(clause.isSaved());
+    value(clause.hasDirectiveNameModifier());
+    value(clause.getDirectiveNameModifier());
+    return visitClause(clause);
+  }
+  bool visitReductionClause(const OpenMPReductionClause &clause) {
+    value(clause.getModifier());
+    value(clause.getIdentifier());
+    fragment(clause.getUserDefinedIdentifierFragment());
+    return visitClause(clause);
+  }
+  bool visitProcBindClause(const OpenMPProcBindClause &clause) {
+    value(clause.getProcBindClauseKind());
+    return visitClause(clause);
+  }
+  bool visitAllocateClause(const OpenMPAllocateClause &clause) {
+    value(clause.getAllocator());
+    fragment(clause.getUserDefinedAllocatorFragment());
+    fragment(clause.getAlignmentFragment());
+    const std::vector<OpenMPAllocateClause::ModifierKind> &modifiers =
+        clause.getModifierOrder();
+    value(modifiers.size());
+    for (OpenMPAllocateClause::ModifierKind modifier : modifiers) {
+      value(modifier);
+    }
+    return visitClause(clause);
+  }
+  bool visitLastprivateClause(const OpenMPLastprivateClause &clause) {
+    value(clause.getModifier());
+    return visitClause(clause);
+  }
+  bool visitOrderClause(const OpenMPOrderClause &clause) {
+    value(clause.getOrderClauseModifier());
+    value(clause.getOrderClauseKind());
+    return visitClause(clause);
+  }
+  bool visitLinearClause(const OpenMPLinearClause &clause) {
+    value(clause.getModifier());
+    fragment(clause.getUserDefinedStepFragment());
+    value(clause.isModifierFirstSyntax());
+    return visitClause(clause);
+  }
+  bool visitScheduleClause(const OpenMPScheduleClause &clause) {
+    value(clause.getModifier1());
+    value(clause.getModifier2());
+    value(clause.getKind());
+    fragment(clause.getUserDefinedKindFragment());
+    fragment(clause.getChunkSizeFragment());
+    return visitClause(clause);
+  }
+  bool visitAlignedClause(const OpenMPAlignedClause &clause) {
+    fragment(clause.getUserDefinedAlignmentFragment());
+    return visitClause(clause);
+  }
+  bool visitDistScheduleClause(const OpenMPDistScheduleClause &clause) {
+    value(clause.getKind());
+    fragment(clause.getChunkSizeFragment());
+    return visitClause(clause);
+  }
+  bool visitBindClause(const OpenMPBindClause &clause) {
+    value(clause.getBindClauseBinding());
+    return visitClause(clause);
+  }
+  bool visitAllocatorClause(const OpenMPAllocatorClause &clause) {
+    value(clause.getAllocator());
+    fragment(clause.getUserDefinedAllocatorFragment());
+    return visitClause(clause);
+  }
+  bool visitInitializerClause(const OpenMPInitializerClause &clause) {
+    value(clause.getPriv());
+    return visitClause(clause);
+  }
+  bool visitInReductionClause(const OpenMPInReductionClause &clause) {
+    value(clause.getIdentifier());
+    fragment(clause.getUserDefinedIdentifierFragment());
+    return visitClause(clause);
+  }
+  bool visitDependClause(const OpenMPDependClause &clause) {
+    value(clause.getModifier());
+    value(clause.getType());
+    fragment(clause.getDependenceVectorFragment());
+    iterators(clause.getIterators());
+    return visitClause(clause);
+  }
+  bool visitAffinityClause(const OpenMPAffinityClause &clause) {
+    value(clause.getModifier());
+    iterators(clause.getIterators());
+    return visitClause(clause);
+  }
+  bool visitGrainsizeClause(const OpenMPGrainsizeClause &clause) {
+    value(clause.getModifier());
+    return visitClause(clause);
+  }
+  bool visitNumTasksClause(const OpenMPNumTasksClause &clause) {
+    value(clause.getModifier());
+    return visitClause(clause);
+  }
+  bool visitAtomicDefaultMemOrderClause(
+      const OpenMPAtomicDefaultMemOrderClause &clause) {
+    value(clause.getKind());
+    return visitClause(clause);
+  }
+  bool visitExtImplementationDefinedRequirementClause(
+      const OpenMPExtImplementationDefinedRequirementClause &clause) {
+    sink.text(clause.getImplementationDefinedRequirement());
+    return visitClause(clause);
+  }
+  bool visitDeviceClause(const OpenMPDeviceClause &clause) {
+    value(clause.getModifier());
+    return visitClause(clause);
+  }
+  bool visitMapClause(const OpenMPMapClause &clause) {
+    value(clause.getModifier1());
+    value(clause.getModifier2());
+    value(clause.getModifier3());
+    value(clause.getType());
+    value(clause.getRefModifier());
+    fragment(clause.getMapperIdentifierFragment());
+    iterators(clause.getIterators());
+    const auto &policy_lists = clause.getDistDataPolicies();
+    value(policy_lists.size());
+    for (const auto &policies : policy_lists) {
+      value(policies.size());
+      for (const OpenMPMapClause::DistDataPolicy &policy : policies) {
+        value(policy.kind);
+        fragment(policy.argument);
+      }
+    }
+    return visitClause(clause);
+  }
+  bool visitDefaultmapClause(const OpenMPDefaultmapClause &clause) {
+    value(clause.getBehavior());
+    value(clause.getCategory());
+    return visitClause(clause);
+  }
+  bool visitToClause(const OpenMPToClause &clause) {
+    value(clause.getKind());
+    fragment(clause.getMapperIdentifierFragment());
+    iterators(clause.getIterators());
+    return visitClause(clause);
+  }
+  bool visitFromClause(const OpenMPFromClause &clause) {
+    value(clause.getKind());
+    fragment(clause.getMapperIdentifierFragment());
+    iterators(clause.getIterators());
+    return visitClause(clause);
+  }
+  bool visitUsesAllocatorsClause(const OpenMPUsesAllocatorsClause &clause) {
+    const std::vector<usesAllocatorParameter *> &parameters =
+        clause.getUsesAllocatorsAllocatorSequence();
+    value(parameters.size());
+    for (const usesAllocatorParameter *parameter : parameters) {
+      value(parameter != nullptr);
+      if (parameter != nullptr) {
+        value(parameter->getUsesAllocatorsAllocator());
+        fragment(parameter->getAllocatorTraitsArrayFragment());
+        fragment(parameter->getAllocatorUserFragment());
+      }
+    }
+    return visitClause(clause);
+  }
+  bool visitVariantClause(const OpenMPVariantClause &clause) {
+    const auto &sets = clause.getTraitSets();
+    value(sets.size());
+    for (const OpenMPVariantClause::TraitSetSelector &set : sets) {
+      value(set.kind);
+      value(set.selectors.size());
+      for (const OpenMPVariantClause::TraitSelector &selector : set.selectors) {
+        value(selector.kind);
+        fragment(selector.score);
+        sink.text(selector.implementation_defined_name);
+        value(selector.properties.size());
+        for (const OpenMPVariantClause::TraitProperty &property :
+             selector.properties) {
+          fragment(property.fragment);
+          optionalValue(property.context_kind);
+          optionalValue(property.context_vendor);
+          optionalValue(property.atomic_default_mem_order);
+          optionalClause(property.requirement.get());
+        }
+        optionalDirective(selector.construct_directive.get());
+      }
+    }
+    return visitClause(clause);
+  }
+  bool visitWhenClause(const OpenMPWhenClause &clause) {
+    optionalDirective(clause.getVariantDirective());
+    return visitVariantClause(clause);
+  }
+  bool visitOtherwiseClause(const OpenMPOtherwiseClause &clause) {
+    optionalDirective(clause.getVariantDirective());
+    return visitVariantClause(clause);
+  }
+  bool visitDeviceTypeClause(const OpenMPDeviceTypeClause &clause) {
+    value(clause.getDeviceTypeClauseKind());
+    return visitClause(clause);
+  }
+  bool visitTaskReductionClause(const OpenMPTaskReductionClause &clause) {
+    value(clause.getIdentifier());
+    fragment(clause.getUserDefinedIdentifierFragment());
+    return visitClause(clause);
+  }
+  bool visitDepobjUpdateClause(const OpenMPDepobjUpdateClause &clause) {
+    value(clause.getType());
+    return visitClause(clause);
+  }
+  bool visitFailClause(const OpenMPFailClause &clause) {
+    value(clause.getMemoryOrder());
+    return visitClause(clause);
+  }
+  bool visitAtClause(const OpenMPAtClause &clause) {
+    value(clause.getAtKind());
+    return visitClause(clause);
+  }
+  bool visitSeverityClause(const OpenMPSeverityClause &clause) {
+    value(clause.getSeverityKind());
+    return visitClause(clause);
+  }
+  bool visitDoacrossClause(const OpenMPDoacrossClause &clause) {
+    value(clause.getType());
+    return visitClause(clause);
+  }
+  bool visitAbsentClause(const OpenMPAbsentClause &clause) {
+    directiveKinds(clause.getDirectives());
+    return visitClause(clause);
+  }
+  bool visitContainsClause(const OpenMPContainsClause &clause) {
+    directiveKinds(clause.getDirectives());
+    return visitClause(clause);
+  }
+  bool visitMemscopeClause(const OpenMPMemscopeClause &clause) {
+    value(clause.getScope());
+    return visitClause(clause);
+  }
+  bool visitInitClause(const OpenMPInitClause &clause) {
+    initModifiers(clause.getModifiers());
+    fragment(clause.getOperandFragment());
+    return visitClause(clause);
+  }
+  bool visitInductionClause(const OpenMPInductionClause &clause) {
+    clause.visitSpecificationItems(
+        [this](OpenMPInductionClause::SpecificationItemKind kind,
+               const ompparser::HostFragment *label,
+               const ompparser::HostFragment &expression) {
+          value(true);
+          value(kind);
+          value(label != nullptr);
+          if (label != nullptr) {
+            fragment(*label);
+          }
+          fragment(expression);
+        });
+    value(false);
+    return visitClause(clause);
+  }
+  bool visitAdjustArgsClause(const OpenMPAdjustArgsClause &clause) {
+    value(clause.getModifier());
+    fragments(clause.getArguments());
+    return visitClause(clause);
+  }
+  bool visitAppendArgsClause(const OpenMPAppendArgsClause &clause) {
+    const auto &operations = clause.getOperations();
+    value(operations.size());
+    for (const OpenMPAppendArgsClause::Operation &operation : operations) {
+      value(operation.kind);
+      initModifiers(operation.modifiers);
+    }
+    return visitClause(clause);
+  }
+  bool visitApplyClause(const OpenMPApplyClause &clause) {
+    fragment(clause.getLabelFragment());
+    const auto &transforms = clause.getTransformations();
+    value(transforms.size());
+    for (const OpenMPApplyClause::ApplyTransform &transform : transforms) {
+      value(transform.kind);
+      fragment(transform.argument);
+      value(transform.separator);
+      optionalClause(transform.nested_apply.get());
+    }
+    return visitClause(clause);
+  }
+
+private:
+  template <typename T> void value(T number) {
+    sink.integer(static_cast<std::uint64_t>(number));
+  }
+
+  template <typename T> void optionalValue(const std::optional<T> &number) {
+    value(number.has_value());
+    if (number.has_value()) {
+      value(*number);
+    }
+  }
+
+  void location(const SourceLocation &node) {
+    if (!options.ignore_source_ranges) {
+      value(node.getLine());
+      value(node.getColumn());
+    }
+  }
+
+  // The owning clause kind is derived bookkeeping and is left out.
+  void fragment(const ompparser::HostFragment &host_fragment) {
+    sink.text(host_fragment.spelling);
+    value(host_fragment.role);
+    value(host_fragment.parse_mode);
+    if (!options.ignore_source_ranges) {
+      for (const ompparser::SourcePosition &position :
+           {host_fragment.range.begin, host_fragment.range.end}) {
+        value(position.offset);
+        value(position.line);
+        value(position.column);
+      }
+    }
+  }
+
+  void fragments(const std::vector<ompparser::HostFragment> &host_fragments) {
+    value(host_fragments.size());
+    for (const ompparser::HostFragment &host_fragment : host_fragments) {
+      fragment(host_fragment);
+    }
+  }
+
+  void iterators(const std::vector<OpenMPIterator> &iterator_list) {
+    value(iterator_list.size());
+    for (const OpenMPIterator &iterator : iterator_list) {
+      fragment(iterator.qualifier);
+      fragment(iterator.variable);
+      fragment(iterator.begin);
+      fragment(iterator.end);
+      fragment(iterator.step);
+    }
+  }
+
+  void initModifiers(const OpenMPInitModifierList &list) {
+    const std::vector<OpenMPInitModifier> &modifiers = list.getModifiers();
+    value(modifiers.size());
+    for (const OpenMPInitModifier &modifier : modifiers) {
+      value(modifier.category);
+      value(modifier.interop_type);
+      value(modifier.directive_name);
+      value(modifier.dependence_type);
+      fragment(modifier.argument);
+    }
+  }
+
+  void directiveKinds(const std::vector<OpenMPDirectiveKind> &kinds) {
+    value(kinds.size());
+    for (OpenMPDirectiveKind kind : kinds) {
+      value(kind);
+    }
+  }
+
+  void optionalDirective(const OpenMPDirective *directive) {
+    value(directive != nullptr);
+    if (directive != nullptr) {
+      writeDirective(*directive);
+    }
+  }
+
+  void optionalClause(const OpenMPClause *clause) {
+    value(clause != nullptr);
+    if (clause != nullptr) {
+      writeClause(*clause);
+    }
+  }
+
+  Sink &sink;
+  const ompparser::StructuralOptions &options;
+};
+
+// Two independently seeded multiply-rotate lanes over 64-bit words. Strings
+// are packed byte by byte so the digest does not depend on host endianness.
+class HashSink {
+public:
+  void integer(std::uint64_t number) {
+    mix(1);
+    mix(number);
+  }
+
+  void text(std::string_view characters) {
+    mix(2);
+    mix(characters.size());
+    std::uint64_t word = 0;
+    unsigned shift = 0;
+    for (unsigned char character : characters) {
+      word |= static_cast<std::uint64_t>(character) << shift;
+      shift += 8;
+      if (shift == 64) {
+        mix(word);
+        word = 0;
+        shift = 0;
+      }
+    }
+    if (shift != 0) {
+      mix(word);
+    }
+  }
+
+  ompparser::StructuralHash finish() const {
+    ompparser::StructuralHash digest;
+    digest.low = avalanche(low ^ rotate(high, 17));
+    digest.high = avalanche(high ^ rotate(low, 43));
+    return digest;
+  }
+
+private:
+  static std::uint64_t rotate(std::uint64_t word, unsigned bits) {
+    return (word << bits) | (word >> (64 - bits));
+  }
+
+  static std::uint64_t avalanche(std::uint64_t word) {
+    word ^= word >> 30;
+    word *= 0xBF58476D1CE4E5B9ULL;
+    word ^= word >> 27;
+    word *= 0x94D049BB133111EBULL;
+    return word ^ (word >> 31);
+  }
+
+  void mix(std::uint64_t word) {
+    low = rotate(low ^ avalanche(word), 27) * 0x9E3779B97F4A7C15ULL +
+          0x52DCE729ULL;
+    high = rotate(high ^ avalanche(word ^ 0xA0761D6478BD642FULL), 31) *
+               0xC2B2AE3D27D4EB4FULL +
+           0x38495AB5ULL;
+  }
+
+  std::uint64_t low = 0x243F6A8885A308D3ULL;
+  std::uint64_t high = 0x13198A2E03707344ULL;
+};
+
+struct StructureToken {
+  bool is_text;
+  std::uint64_t number;
+  std::string_view characters;
+};
+
+// Records the structure of the left-hand side. Strings are viewed in place,
+// so the recorded node must outlive the comparison.
+class RecordingSink {
+public:
+  std::vector<StructureToken> tokens;
+
+  void integer(std::uint64_t number) { tokens.push_back({false, number, {}}); }
+  void text(std::string_view characters) {
+    tokens.push_back({true, 0, characters});
+  }
+};
+
+// Matches the structure of the right-hand side against a recording.
+class ComparingSink {
+public:
+  explicit ComparingSink(const std::vector<StructureToken> &expected)
+      : expected(expected) {}
+
+  void integer(std::uint64_t number) {
+    const StructureToken *token = next();
+    if (token != nullptr && (token->is_text || token->number != number)) {
+      equal = false;
+    }
+  }
+  void text(std::string_view characters) {
+    const StructureToken *token = next();
+    if (token != nullptr &&
+        (!token->is_text || token->characters != characters)) {
+      equal = false;
+    }
+  }
+
+  bool matched() const { return equal && position == expected.size(); }
+
+private:
+  const StructureToken *next() {
+    if (!equal || position == expected.size()) {
+      equal = false;
+      return nullptr;
+    }
+    return &expected[position++];
+  }
+
+  const std::vector<StructureToken> &expected;
+  std::size_t position = 0;
+  bool equal = true;
+};
+
+template <typename Node>
+bool structurallyEqualImpl(const Node &lhs, const Node &rhs,
+                           const ompparser::StructuralOptions &options) {
+  if (&lhs == &rhs) {
+    return true;
+  }
+  RecordingSink recording;
+  StructureWriter<RecordingSink> recorder(recording, options);
+  ComparingSink comparing(recording.tokens);
+  StructureWriter<ComparingSink> comparer(comparing, options);
+  if constexpr (std::is_base_of_v<OpenMPDirective, Node>) {
+    recorder.writeDirective(lhs);
+    comparer.writeDirective(rhs);
+  } else {
+    recorder.writeClause(lhs);
+    comparer.writeClause(rhs);
+  }
+  return comparing.matched();
+}
+
+// Appends the structure as ompparser::serialize stores it: integers as
+// little-endian base-128 groups and strings as a length and their bytes.
+class ByteSink {
+public:
+  explicit ByteSink(std::string &bytes) : bytes(bytes) {}
+
+  void integer(std::uint64_t number) {
+    while (number >= 0x80) {
+      bytes.push_back(static_cast<char>((number & 0x7F) | 0x80));
+      number >>= 7;
+    }
+    bytes.push_back(static_cast<char>(number));
+  }
+  void text(std::string_view characters) {
+    integer(characters.size());
+    bytes.append(characters);
+  }
+
+private:
+  std::string &bytes;
+};
+
+class MalformedImage : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+// Reads ByteSink output in place; strings are views into the image.
+class ByteSource {
+public:
+  explicit ByteSource(std::string_view bytes) : bytes(bytes) {}
+
+  std::uint64_t integer() {
+    std::uint64_t number = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      if (position == bytes.size()) {
+        throw MalformedImage("serialized directive is truncated");
+      }
+      const auto byte = static_cast<unsigned char>(bytes[position++]);
+      number |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return number;
+      }
+    }
+    throw MalformedImage("serialized integer is too long");
+  }
+  std::string_view text() {
+    const std::uint64_t size = integer();
+    if (size > remaining()) {
+      throw MalformedImage("serialized directive is truncated");
+    }
+    std::string_view characters = bytes.substr(position, size);
+    position += size;
+    return characters;
+  }
+  std::size_t remaining() const { return bytes.size() - position; }
+
+private:
+  std::string_view bytes;
+  std::size_t position = 0;
+};
+
+constexpr std::string_view SerializationMagic = "OMPS";
+
+} // namespace
+
+// Rebuilds nodes from the stream StructureWriter emits, field for field in
+// the same order. Every node is built through the constructor of the class
+// its kind selects and its fields are then assigned directly, so no setter
+// consults the lexer for positions.
+class OpenMPStructureReader
+    : public ompparser::OpenMPIRVisitor<OpenMPStructureReader> {
+public:
+  explicit OpenMPStructureReader(ByteSource &source) : source(source) {}
+
+  // Directives read so far, nested ones included.
+  std::vector<const OpenMPDirective *> directives;
+
+  std::unique_ptr<OpenMPDirective> readDirective() {
+    const std::uint64_t kind = source.integer();
+    if (kind >= ompparser::DirectiveKindCount) {
+      throw MalformedImage("serialized directive kind is out of range");
+    }
+    if (++depth > MaxDepth) {
+      throw MalformedImage("serialized directives are nested too deeply");
+    }
+    std::unique_ptr<OpenMPDirective> directive;
+    switch (static_cast<OpenMPDirectiveKind>(kind)) {
+#define OPENMP_DIRECTIVE_NODE(Name, Class)                                     \
+  case OMPD_##Name:                                                            \
+    directive = construct<OpenMP##Class>(OMPD_##Name);                         \
+    break;
+#include "OpenMPIRNodes.def"
+#undef OPENMP_DIRECTIVE_NODE
+    default:
+      directive = std::make_unique<OpenMPDirective>(
+          static_cast<OpenMPDirectiveKind>(kind));
+    }
+    const OpenMPClauseKind enclosing_clause = fragment_owner;
+    fragment_owner = OMPC_unknown;
+    dispatch(*directive);
+    fragment_owner = enclosing_clause;
+    --depth;
+    return directive;
+  }
+
+  std::unique_ptr<OpenMPClause> readClause() {
+    const std::uint64_t kind = source.integer();
+    if (kind >= ompparser::ClauseKindCount) {
+      throw MalformedImage("serialized clause kind is out of range");
+    }
+    if (++depth > MaxDepth) {
+      throw MalformedImage("serialized clauses are nested too deeply");
+    }
+    std::unique_ptr<OpenMPClause> clause;
+    switch (static_cast<OpenMPClauseKind>(kind)) {
+#define OPENMP_CLAUSE_NODE_KIND(Name, Class)                                   \
+  case OMPC_##Name:                                                            \
+    clause = construct<OpenMP##Class>(OMPC_##Name);                            \
+    break;
+#include "OpenMPIRNodes.def"
+#undef OPENMP_CLAUSE_NODE_KIND
+    default:
+      clause =
+          std::make_unique<OpenMPClause>(static_cast<OpenMPClauseKind>(kind));
+    }
+    const OpenMPClauseKind enclosing_clause = fragment_owner;
+    fragment_owner = clause->kind;
+    dispatch(*clause);
+    fragment_owner = enclosing_clause;
+    --depth;
+    return clause;
+  }
+
+  bool visitDirective(OpenMPDirective &directive) {
+    value(directive.lang);
+    value(directive.use_declare_target_underscore);
+    value(directive.compact_parallel_do);
+    value(directive.requires_explicit_end);
+    value(directive.fortran_sentinel);
+    directive.implementation_defined_payload = source.text();
+    location(directive);
+    const std::size_t count = length();
+    directive.clauses_in_original_order.reserve(count);
+    directive.clause_storage.reserve(count);
+    for (std::size_t index = 0; index < count; ++index) {
+      std::unique_ptr<OpenMPClause> clause = optionalClause();
+      if (clause == nullptr) {
+        directive.clauses_in_original_order.push_back(nullptr);
+        continue;
+      }
+      clause->owner_directive = &directive;
+      clause->clause_position = static_cast<int>(index);
+      directive.clauses[clause->kind].push_back(clause.get());
+      directive.clauses_in_original_order.push_back(clause.get());
+      directive.clause_storage.push_back(std::move(clause));
+    }
+    // The containers are as consistent as the grammar leaves them.
+    directive.parser_constructed = true;
+    directives.push_back(&directive);
+    return true;
+  }
+
+  bool visitClause(OpenMPClause &clause) {
+    value(clause.directive_kind);
+    value(clause.base_lang);
+    value(clause.has_directive_name_modifier);
+    value(clause.directive_name_modifier);
+    value(clause.separator);
+    const std::size_t count = length();
+    clause.expressions.resize(count);
+    for (OpenMPExpressionItem &expression : clause.expressions) {
+      fragment(expression.fragment);
+      value(expression.separator);
+      value(expression.parse_mode);
+    }
+    location(clause);
+    return true;
+  }
+
+  // Directives.
+  bool visitEndDirective(OpenMPEndDirective &directive) {
+    value(directive.paired_directive_role);
+    directive.paired_directive_storage = optionalDirective();
+    directive.paired_directive = directive.paired_directive_storage.get();
+    fragment(directive.end_argument);
+    value(directive.use_compact_enddo);
+    return visitDirective(directive);
+  }
+  bool visitDeclareVariantDirective(OpenMPDeclareVariantDirective &directive) {
+    fragment(directive.variant_func_id);
+    return visitDirective(directive);
+  }
+  bool visitAllocateDirective(OpenMPAllocateDirective &directive) {
+    fragments(directive.allocate_list);
+    return visitDirective(directive);
+  }
+  bool visitThreadprivateDirective(OpenMPThreadprivateDirective &directive) {
+    fragments(directive.threadprivate_list);
+    return visitDirective(directive);
+  }
+  bool visitGroupprivateDirective(OpenMPGroupprivateDirective &directive) {
+    fragments(directive.groupprivate_list);
+    return visitDirective(directive);
+  }
+  bool visitDeclareSimdDirective(OpenMPDeclareSimdDirective &directive) {
+    fragment(directive.proc_name);
+    return visitDirective(directive);
+  }
+  bool
+  visitDeclareReductionDirective(OpenMPDeclareReductionDirective &directive) {
+    fragments(directive.typename_list);
+    directive.identifier = source.text();
+    fragment(directive.combiner);
+    return visitDirective(directive);
+  }
+  bool visitDeclareMapperDirective(OpenMPDeclareMapperDirective &directive) {
+    value(directive.identifier);
+    value(directive.identifier_explicit);
+    fragment(directive.user_defined_identifier);
+    fragment(directive.type);
+    fragment(directive.var);
+    value(directive.type_var_has_space);
+    return visitDirective(directive);
+  }
+  bool visitDeclareTargetDirective(OpenMPDeclareTargetDirective &directive) {
+    fragments(directive.extended_list);
+    return visitDirective(directive);
+  }
+  bool visitFlushDirective(OpenMPFlushDirective &directive) {
+    fragments(directive.flush_list);
+    return visitDirective(directive);
+  }
+  bool visitCriticalDirective(OpenMPCriticalDirective &directive) {
+    fragment(directive.critical_name);
+    return visitDirective(directive);
+  }
+  bool visitDepobjDirective(OpenMPDepobjDirective &directive) {
+    fragment(directive.depobj);
+    return visitDirective(directive);
+  }
+
+  // Clauses.
+  bool visitIfClause(OpenMPIfClause &clause) {
+    value(clause.modifier);
+    fragment(clause.user_defined_modifier);
+    return visitClause(clause);
+  }
+  bool visitNumThreadsClause(OpenMPNumThreadsClause &clause) {
+    value(clause.strict);
+    return visitClause(clause);
+  }
+  bool visitDefaultClause(OpenMPDefaultClause &clause) {
+    value(clause.default_kind);
+    value(clause.category);
+    clause.variant_directive_storage = optionalDirective();
+    clause.variant_directive = clause.variant_directive_storage.get();
+    return visitClause(clause);
+  }
+  bool visitFirstprivateClause(OpenMPFirstprivateClause &clause) {
+    value(clause.saved);
+    value(clause.has_directive_name_modifier);
+    value(clause.directive_name_modifier);
+    return visitClause(clause);
+  }
+  bool visitReductionClause(OpenMPReductionClause &clause) {
+    value(clause.modifier);
+    value(clause.identifier);
+    fragment(clause.user_defined_identifier);
+    return visitClause(clause);
+  }
+  bool visitProcBindClause(OpenMPProcBindClause &clause) {
+    value(clause.proc_bind_kind);
+    return visitClause(clause);
+  }
+  bool visitAllocateClause(OpenMPAllocateClause &clause) {
+    value(clause.allocator);
+    fragment(clause.user_defined_allocator);
+    fragment(clause.alignment);
+    clause.modifier_order.resize(length());
+    for (OpenMPAllocateClause::ModifierKind &modifier : clause.modifier_order) {
+      value(modifier);
+    }
+    return visitClause(clause);
+  }
+  bool visitLastprivateClause(OpenMPLastprivateClause &clause) {
+    value(clause.modifier);
+    return visitClause(clause);
+  }
+  bool visitOrderClause(OpenMPOrderClause &clause) {
+    value(clause.order_modifier);
+    value(clause.order_kind);
+    return visitClause(clause);
+  }
+  bool visitLinearClause(OpenMPLinearClause &clause) {
+    value(clause.modifier);
+    fragment(clause.user_defined_step);
+    value(clause.modifier_first_syntax);
+    return visitClause(clause);
+  }
+  bool visitScheduleClause(OpenMPScheduleClause &clause) {
+    value(clause.modifier1);
+    value(clause.modifier2);
+    value(clause.schedulekind);
+    fragment(clause.user_defined_kind);
+    fragment(clause.chunk_size);
+    return visitClause(clause);
+  }
+  bool visitAlignedClause(OpenMPAlignedClause &clause) {
+    fragment(clause.user_defined_alignment);
+    return visitClause(clause);
+  }
+  bool visitDistScheduleClause(OpenMPDistScheduleClause &clause) {
+    value(clause.dist_schedule_kind);
+    fragment(clause.chunk_size);
+    return visitClause(clause);
+  }
+  bool visitBindClause(OpenMPBindClause &clause) {
+    value(clause.bind_binding);
+    return visitClause(clause);
+  }
+  bool visitAllocatorClause(OpenMPAllocatorClause &clause) {
+    value(clause.allocator);
+    fragment(clause.user_defined_allocator);
+    return visitClause(clause);
+  }
+  bool visitInitializerClause(OpenMPInitializerClause &clause) {
+    value(clause.priv);
+    return visitClause(clause);
+  }
+  bool visitInReductionClause(OpenMPInReductionClause &clause) {
+    value(clause.identifier);
+    fragment(clause.user_defined_identifier);
+    return visitClause(clause);
+  }
+  bool visitDependClause(OpenMPDependClause &clause) {
+    value(clause.modifier);
+    value(clause.type);
+    fragment(clause.dependence_vector);
+    iterators(clause.iterators);
+    return visitClause(clause);
+  }
+  bool visitAffinityClause(OpenMPAffinityClause &clause) {
+    value(clause.modifier);
+    iterators(clause.iterators);
+    return visitClause(clause);
+  }
+  bool visitGrainsizeClause(OpenMPGrainsizeClause &clause) {
+    value(clause.modifier);
+    return visitClause(clause);
+  }
+  bool visitNumTasksClause(OpenMPNumTasksClause &clause) {
+    value(clause.modifier);
+    return visitClause(clause);
+  }
+  bool
+  visitAtomicDefaultMemOrderClause(OpenMPAtomicDefaultMemOrderClause &clause) {
+    value(clause.kind);
+    return visitClause(clause);
+  }
+  bool visitExtImplementationDefinedRequirementClause(
+      OpenMPExtImplementationDefinedRequirementClause &clause) {
+    clause.implementation_defined_requirement = source.text();
+    return visitClause(clause);
+  }
+  bool visitDeviceClause(OpenMPDeviceClause &clause) {
+    value(clause.modifier);
+    return visitClause(clause);
+  }
+  bool visitMapClause(OpenMPMapClause &clause) {
+    value(clause.modifier1);
+    value(clause.modifier2);
+    value(clause.modifier3);
+    value(clause.type);
+    value(clause.ref_modifier);
+    fragment(clause.mapper_identifier);
+    iterators(clause.iterators);
+    clause.dist_data_policies.resize(length());
+    for (auto &policies : clause.dist_data_policies) {
+      policies.resize(length());
+      for (OpenMPMapClause::DistDataPolicy &policy : policies) {
+        value(policy.kind);
+        fragment(policy.argument);
+      }
+    }
+    return visitClause(clause);
+  }
+  bool visitDefaultmapClause(OpenMPDefaultmapClause &clause) {
+    value(clause.behavior);
+    value(clause.category);
+    return visitClause(clause);
+  }
+  bool visitToClause(OpenMPToClause &clause) {
+    value(clause.to_kind);
+    fragment(clause.mapper_identifier);
+    iterators(clause.iterators);
+    return visitClause(clause);
+  }
+  bool visitFromClause(OpenMPFromClause &clause) {
+    value(clause.from_kind);
+    fragment(clause.mapper_identifier);
+    iterators(clause.iterators);
+    return visitClause(clause);
+  }
+  bool visitUsesAllocatorsClause(OpenMPUsesAllocatorsClause &clause) {
+    const std::size_t count = length();
+    for (std::size_t index = 0; index < count; ++index) {
+      if (!flag()) {
+        clause.usesAllocatorsAllocatorSequenceView.push_back(nullptr);
+        continue;
+      }
+      OpenMPUsesAllocatorsClauseAllocator allocator;
+      ompparser::HostFragment traits_array;
+      ompparser::HostFragment user;
+      value(allocator);
+      fragment(traits_array);
+      fragment(user);
+      clause.usesAllocatorsAllocatorSequenceStorage.push_back(
+          std::make_unique<usesAllocatorParameter>(
+              allocator, std::move(traits_array), std::move(user)));
+      clause.usesAllocatorsAllocatorSequenceView.push_back(
+          clause.usesAllocatorsAllocatorSequenceStorage.back().get());
+    }
+    return visitClause(clause);
+  }
+  bool visitVariantClause(OpenMPVariantClause &clause) {
+    clause.trait_sets.resize(length());
+    for (OpenMPVariantClause::TraitSetSelector &set : clause.trait_sets) {
+      value(set.kind);
+      set.selectors.resize(length());
+      for (OpenMPVariantClause::TraitSelector &selector : set.selectors) {
+        value(selector.kind);
+        fragment(selector.score);
+        selector.implementation_defined_name = source.text();
+        selector.properties.resize(length());
+        for (OpenMPVariantClause::TraitProperty &property :
+             selector.properties) {
+          fragment(property.fragment);
+          optionalValue(property.context_kind);
+          optionalValue(property.context_vendor);
+          optionalValue(property.atomic_default_mem_order);
+          property.requirement = optionalClause();
+        }
+        selector.construct_directive = optionalDirective();
+      }
+    }
+    return visitClause(clause);
+  }
+  bool visitWhenClause(OpenMPWhenClause &clause) {
+    clause.variant_directive_storage = optionalDirective();
+    clause.variant_directive = clause.variant_directive_storage.get();
+    return visitVariantClause(clause);
+  }
+  bool visitOtherwiseClause(OpenMPOtherwiseClause &clause) {
+    clause.variant_directive_storage = optionalDirective();
+    clause.variant_directive = clause.variant_directive_storage.get();
+    return visitVariantClause(clause);
+  }
+  bool visitDeviceTypeClause(OpenMPDeviceTypeClause &clause) {
+    value(clause.device_type_kind);
+    return visitClause(clause);
+  }
+  bool visitTaskReductionClause(OpenMPTaskReductionClause &clause) {
+    value(clause.identifier);
+    fragment(clause.user_defined_identifier);
+    return visitClause(clause);
+  }
+  bool visitDepobjUpdateClause(OpenMPDepobjUpdateClause &clause) {
+    value(clause.type);
+    return visitClause(clause);
+  }
+  bool visitFailClause(OpenMPFailClause &clause) {
+    value(clause.memory_order);
+    return visitClause(clause);
+  }
+  bool visitAtClause(OpenMPAtClause &clause) {
+    value(clause.at_kind);
+    return visitClause(clause);
+  }
+  bool visitSeverityClause(OpenMPSeverityClause &clause) {
+    value(clause.severity_kind);
+    return visitClause(clause);
+  }
+  bool visitDoacrossClause(OpenMPDoacrossClause &clause) {
+    value(clause.type);
+    return visitClause(clause);
+  }
+  bool visitAbsentClause(OpenMPAbsentClause &clause) {
+    directiveKinds(clause.directive_list);
+    return visitClause(clause);
+  }
+  bool visitContainsClause(OpenMPContainsClause &clause) {
+    directiveKinds(clause.directive_list);
+    return visitClause(clause);
+  }
+  bool visitMemscopeClause(OpenMPMemscopeClause &clause) {
+    value(clause.scope);
+    return visitClause(clause);
+  }
+  bool visitInitClause(OpenMPInitClause &clause) {
+    initModifiers(clause.modifiers);
+    fragment(clause.operand);
+    return visitClause(clause);
+  }
+  bool visitInductionClause(OpenMPInductionClause &clause) {
+    using ItemKind = OpenMPInductionClause::SpecificationItemKind;
+    while (flag()) {
+      ItemKind kind = ItemKind::Expression;
+      value(kind);
+      ompparser::HostFragment label;
+      const bool has_label = flag();
+      if (has_label) {
+        fragment(label);
+      }
+      ompparser::HostFragment expression;
+      fragment(expression);
+      switch (kind) {
+      case ItemKind::Step:
+        clause.step_expression = std::move(expression);
+        clause.sequence.push_back({OpenMPInductionClause::ItemStep, 0});
+        break;
+      case ItemKind::Binding:
+        clause.bindings.push_back({std::move(label), std::move(expression)});
+        clause.sequence.push_back(
+            {OpenMPInductionClause::ItemBinding, clause.bindings.size() - 1});
+        break;
+      case ItemKind::Expression:
+        clause.passthrough_items.push_back(std::move(expression));
+        clause.sequence.push_back({OpenMPInductionClause::ItemPassthrough,
+                                   clause.passthrough_items.size() - 1});
+        break;
+      default:
+        throw MalformedImage("serialized induction item is out of range");
+      }
+    }
+    return visitClause(clause);
+  }
+  bool visitAdjustArgsClause(OpenMPAdjustArgsClause &clause) {
+    value(clause.modifier);
+    fragments(clause.arguments);
+    return visitClause(clause);
+  }
+  bool visitAppendArgsClause(OpenMPAppendArgsClause &clause) {
+    const std::size_t count = length();
+    for (std::size_t index = 0; index < count; ++index) {
+      OpenMPAppendArgsClause::Operation &operation =
+          clause.operations.emplace_back();
+      value(operation.kind);
+      initModifiers(operation.modifiers);
+    }
+    return visitClause(clause);
+  }
+  bool visitApplyClause(OpenMPApplyClause &clause) {
+    fragment(clause.label);
+    clause.transforms.resize(length());
+    for (OpenMPApplyClause::ApplyTransform &transform : clause.transforms) {
+      value(transform.kind);
+      fragment(transform.argument);
+      value(transform.separator);
+      std::unique_ptr<OpenMPClause> nested = optionalClause();
+      if (nested != nullptr && nested->kind != OMPC_apply) {
+        throw MalformedImage("serialized nested apply is another clause");
+      }
+      transform.nested_apply.reset(
+          static_cast<OpenMPApplyClause *>(nested.release()));
+    }
+    return visitClause(clause);
+  }
+
+private:
+  static constexpr unsigned MaxDepth = 256;
+
+  // Builds an empty node of the class a kind selects; the fields a
+  // constructor takes are read into the node afterwards.
+  template <typename Node, typename Kind>
+  static std::unique_ptr<Node> construct(Kind kind) {
+    if constexpr (std::is_default_constructible_v<Node>) {
+      return std::make_unique<Node>();
+    } else if constexpr (std::is_constructible_v<Node, Kind>) {
+      return std::make_unique<Node>(kind);
+    } else if constexpr (std::is_constructible_v<Node, Unset>) {
+      return std::make_unique<Node>(Unset());
+    } else if constexpr (std::is_constructible_v<Node, Unset, Unset>) {
+      return std::make_unique<Node>(Unset(), Unset());
+    } else if constexpr (std::is_constructible_v<Node, Unset, Unset, Unset>) {
+      return std::make_unique<Node>(Unset(), Unset(), Unset());
+    } else {
+      return std::make_unique<Node>(Unset(), Unset(), Unset(), Unset(),
+                                    Unset());
+    }
+  }
+
+  // Stands in for any enumeration a constructor takes.
+  struct Unset {
+    template <typename T, typename = std::enable_if_t<std::is_enum_v<T>>>
+    operator T() const {
+      return T();
+    }
+  };
+
+  template <typename T> void value(T &field) {
+    const std::uint64_t number = source.integer();
+    if constexpr (std::is_same_v<T, bool>) {
+      field = number != 0;
+    } else if constexpr (std::is_enum_v<T>) {
+      if (number >= ompparser::detail::kindCount(T())) {
+        throw MalformedImage("serialized enumeration value is out of range");
+      }
+      field = static_cast<T>(number);
+    } else {
+      field = static_cast<T>(number);
+    }
+  }
+
+  bool flag() { return source.integer() != 0; }
+
+  // A count of items that each take at least one byte, so a corrupt count
+  // fails before anything is allocated for it.
+  std::size_t length() {
+    const std::uint64_t count = source.integer();
+    if (count > source.remaining()) {
+      throw MalformedImage("serialized directive is truncated");
+    }
+    return static_cast<std::size_t>(count);
+  }
+
+  template <typename T> void optionalValue(std::optional<T> &number) {
+    if (flag()) {
+      value(number.emplace());
+    } else {
+      number.reset();
+    }
+  }
+
+  void location(SourceLocation &node) {
+    int line = 0;
+    int column = 0;
+    value(line);
+    value(column);
+    node.setLine(line);
+    node.setColumn(column);
+  }
+
+  void fragment(ompparser::HostFragment &host_fragment) {
+    host_fragment.spelling = source.text();
+    value(host_fragment.role);
+    value(host_fragment.parse_mode);
+    for (ompparser::SourcePosition *position :
+         {&host_fragment.range.begin, &host_fragment.range.end}) {
+      value(position->offset);
+      value(position->line);
+      value(position->column);
+    }
+    host_fragment.clause_kind = fragment_owner;
+  }
+
+  void fragments(std::vector<ompparser::HostFragment> &host_fragments) {
+    host_fragments.resize(length());
+    for (ompparser::HostFragment &host_fragment : host_fragments) {
+      fragment(host_fragment);
+    }
+  }
+
+  void iterators(std::vector<OpenMPIterator> &iterator_list) {
+    iterator_list.resize(length());
+    for (OpenMPIterator &iterator : iterator_list) {
+      fragment(iterator.qualifier);
+      fragment(iterator.variable);
+      fragment(iterator.begin);
+      fragment(iterator.end);
+      fragment(iterator.step);
+    }
+  }
+
+  void initModifiers(OpenMPInitModifierList &list) {
+    list.modifiers.resize(length());
+    for (OpenMPInitModifier &modifier : list.modifiers) {
+      value(modifier.category);
+      value(modifier.interop_type);
+      value(modifier.directive_name);
+      value(modifier.dependence_type);
+      fragment(modifier.argument);
+    }
+  }
+
+  void directiveKinds(std::vector<OpenMPDirectiveKind> &kinds) {
+    kinds.resize(length());
+    for (OpenMPDirectiveKind &kind : kinds) {
+      value(kind);
+    }
+  }
+
+  std::unique_ptr<OpenMPDirective> optionalDirective() {
+    return flag() ? readDirective() : nullptr;
+  }
+
+  std::unique_ptr<OpenMPClause> optionalClause() {
+    return flag() ? readClause() : nullptr;
+  }
+
+  ByteSource &source;
+  // Clause whose kind is stamped on the fragments being read.
+  OpenMPClauseKind fragment_owner = OMPC_unknown;
+  unsigned depth = 0;
+};
+
+std::unique_ptr<OpenMPClause> OpenMPClause::clone() const {
+  CloningVisitor visitor;
+  visitor.dispatch(*this);
+  visitor.clause->owner_directive = nullptr;
+  return std::move(visitor.clause);
+}
+
+std::unique_ptr<OpenMPDirective> OpenMPDirective::clone() const {
+  CloningVisitor visitor;
+  visitor.dispatch(*this);
+  return std::move(visitor.directive);
+}
+
+OpenMPDirective::OpenMPDirective(const OpenMPDirective &other)
+    : SourceLocation(other), kind(other.kind), lang(other.lang),
+      use_declare_target_underscore(other.use_declare_target_underscore),
+      compact_parallel_do(other.compact_parallel_do),
+      requires_explicit_end(other.requires_explicit_end),
+      fortran_sentinel(other.fortran_sentinel),
+      implementation_defined_payload(other.implementation_defined_payload),
+      construction_errors(other.construction_errors) {
+  std::unordered_map<const OpenMPClause *, OpenMPClause *> copies;
+  copies.reserve(other.clause_storage.size());
+  auto copy_of = [&](const OpenMPClause *clause) -> OpenMPClause * {
+    if (clause == nullptr) {
+      return nullptr;
+    }
+    auto found = copies.find(clause);
+    if (found != copies.end()) {
+      return found->second;
+    }
+    // Indexed clauses owned elsewhere still get a copy owned by this one.
+    clause_storage.push_back(clause->clone());
+    clause_storage.back()->owner_directive = this;
+    copies.emplace(clause, clause_storage.back().get());
+    return clause_storage.back().get();
+  };
+
+  clause_storage.reserve(other.clause_storage.size());
+  for (const std::unique_ptr<OpenMPClause> &clause : other.clause_storage) {
+    if (clause == nullptr) {
+      throw std::logic_error("cannot copy a null clause");
+    }
+    copy_of(clause.get());
+  }
+  clauses_in_original_order.reserve(other.clauses_in_original_order.size());
+  for (const OpenMPClause *clause : other.clauses_in_original_order) {
+    clauses_in_original_order.push_back(copy_of(clause));
+  }
+  for (const auto &entry : other.clauses) {
+    std::vector<OpenMPClause *> &copied = clauses[entry.first];
+    copied.reserve(entry.second.size());
+    for (const OpenMPClause *clause : entry.second) {
+      copied.push_back(copy_of(clause));
+    }
+  }
+}
+
+OpenMPAtomicDirective::OpenMPAtomicDirective(
+    const OpenMPAtomicDirective &other)
+    : OpenMPDirective(other) {
+  // The base copy preserves storage and source order positions.
+  std::unordered_map<const OpenMPClause *, OpenMPClause *> copies;
+  for (std::size_t index = 0; index < other.clause_storage.size(); ++index) {
+    copies.emplace(other.clause_storage[index].get(),
+                   clause_storage[index].get());
+  }
+  for (std::size_t index = 0; index < other.clauses_in_original_order.size();
+       ++index) {
+    copies.emplace(other.clauses_in_original_order[index],
+                   clauses_in_original_order[index]);
+  }
+  auto copy_index =
+      [&](const std::map<OpenMPClauseKind, std::vector<OpenMPClause *> *>
+              &source,
+          std::vector<OpenMPClause *> *(OpenMPAtomicDirective::*lookup)(
+              OpenMPClauseKind)) {
+        for (const auto &entry : source) {
+          std::vector<OpenMPClause *> *copied = (this->*lookup)(entry.first);
+          if (entry.second == nullptr) {
+            continue;
+          }
+          for (const OpenMPClause *clause : *entry.second) {
+            auto found = copies.find(clause);
+            copied->push_back(found != copies.end() ? found->second : nullptr);
+          }
+        }
+      };
+  copy_index(other.clauses_atomic_after,
+             &OpenMPAtomicDirective::getClausesAtomicAfter);
+  copy_index(other.clauses_atomic_clauses,
+             &OpenMPAtomicDirective::getAtomicClauses);
+}
+
+OpenMPEndDirective::OpenMPEndDirective(const OpenMPEndDirective &other)
+    : OpenMPDirective(other), paired_directive(other.paired_directive),
+      paired_directive_storage(
+          cloneOwnedDirective(other.paired_directive_storage)),
+      paired_directive_role(other.paired_directive_role),
+      end_argument(other.end_argument),
+      use_compact_enddo(other.use_compact_enddo) {
+  if (paired_directive_storage != nullptr) {
+    paired_directive = paired_directive_storage.get();
+  }
+}
+
+OpenMPApplyClause::OpenMPApplyClause(const OpenMPApplyClause &other)
+    : OpenMPClause(other), label(other.label) {
+  transforms.reserve(other.transforms.size());
+  for (const ApplyTransform &source : other.transforms) {
+    ApplyTransform &transform = transforms.emplace_back();
+    transform.kind = source.kind;
+    transform.argument = source.argument;
+    if (source.nested_apply != nullptr) {
+      transform.nested_apply =
+          std::make_unique<OpenMPApplyClause>(*source.nested_apply);
+    }
+    transform.separator = source.separator;
+  }
+}
+
+OpenMPVariantClause::OpenMPVariantClause(const OpenMPVariantClause &other)
+    : OpenMPClause(other), active_trait_set(other.active_trait_set),
+      active_trait_selector(other.active_trait_selector) {
+  trait_sets.reserve(other.trait_sets.size());
+  for (const TraitSetSelector &source_set : other.trait_sets) {
+    TraitSetSelector &set = trait_sets.emplace_back();
+    set.kind = source_set.kind;
+    set.selectors.reserve(source_set.selectors.size());
+    for (const TraitSelector &source_selector : source_set.selectors) {
+      TraitSelector &selector = set.selectors.emplace_back();
+      selector.kind = source_selector.kind;
+      selector.score = source_selector.score;
+      selector.implementation_defined_name =
+          source_selector.implementation_defined_name;
+      selector.properties.reserve(source_selector.properties.size());
+      for (const TraitProperty &source_property : source_selector.properties) {
+        TraitProperty &property = selector.properties.emplace_back();
+        property.fragment = source_property.fragment;
+        property.context_kind = source_property.context_kind;
+        property.context_vendor = source_property.context_vendor;
+        property.atomic_default_mem_order =
+            source_property.atomic_default_mem_order;
+        if (source_property.requirement != nullptr) {
+          property.requirement = source_property.requirement->clone();
+        }
+      }
+      selector.construct_directive =
+          cloneOwnedDirective(source_selector.construct_directive);
+    }
+  }
+}
+
+OpenMPWhenClause::OpenMPWhenClause(const OpenMPWhenClause &other)
+    : OpenMPVariantClause(other), variant_directive(other.variant_directive),
+      variant_directive_storage(
+          cloneOwnedDirective(other.variant_directive_storage)) {
+  if (variant_directive_storage != nullptr) {
+    variant_directive = variant_directive_storage.get();
+  }
+}
+
+OpenMPOtherwiseClause::OpenMPOtherwiseClause(const OpenMPOtherwiseClause &other)
+    : OpenMPVariantClause(other), variant_directive(other.variant_directive),
+      variant_directive_storage(
+          cloneOwnedDirective(other.variant_directive_storage)) {
+  if (variant_directive_storage != nullptr) {
+    variant_directive = variant_directive_storage.get();
+  }
+}
+
+OpenMPDefaultClause::OpenMPDefaultClause(const OpenMPDefaultClause &other)
+    : OpenMPClause(other), default_kind(other.default_kind),
+      category(other.category), variant_directive(other.variant_directive),
+      variant_directive_storage(
+          cloneOwnedDirective(other.variant_directive_storage)) {
+  if (variant_directive_storage != nullptr) {
+    variant_directive = variant_directive_storage.get();
+  }
+}
+
+OpenMPUsesAllocatorsClause::OpenMPUsesAllocatorsClause(
+    const OpenMPUsesAllocatorsClause &other)
+    : OpenMPClause(other) {
+  usesAllocatorsAllocatorSequenceStorage.reserve(
+      other.usesAllocatorsAllocatorSequenceView.size());
+  usesAllocatorsAllocatorSequenceView.reserve(
+      other.usesAllocatorsAllocatorSequenceView.size());
+  for (const usesAllocatorParameter *parameter :
+       other.usesAllocatorsAllocatorSequenceView) {
+    if (parameter == nullptr) {
+      usesAllocatorsAllocatorSequenceView.push_back(nullptr);
+      continue;
+    }
+    usesAllocatorsAllocatorSequenceStorage.push_back(
+        std::make_unique<usesAllocatorParameter>(*parameter));
+    usesAllocatorsAllocatorSequenceView.push_back(
+        usesAllocatorsAllocatorSequenceStorage.back().get());
+  }
+}
+
+namespace ompparser {
+
+bool structurallyEqual(const OpenMPDirective &lhs, const OpenMPDirective &rhs,
+                       const StructuralOptions &options) {
+  return structurallyEqualImpl(lhs, rhs, options);
+}
+
+bool structurallyEqual(const OpenMPClause &lhs, const OpenMPClause &rhs,
+                       const StructuralOptions &options) {
+  return structurallyEqualImpl(lhs, rhs, options);
+}
+
+StructuralHash hash(const OpenMPDirective &directive,
+                    const StructuralOptions &options) {
+  HashSink sink;
+  StructureWriter<HashSink>(sink, options).writeDirective(directive);
+  return sink.finish();
+}
+
+StructuralHash hash(const OpenMPClause &clause,
+                    const StructuralOptions &options) {
+  HashSink sink;
+  StructureWriter<HashSink>(sink, options).writeClause(clause);
+  return sink.finish();
+}
+
+std::string serialize(const OpenMPDirective &directive) {
+  std::vector<std::string> errors;
+  if (!directive.collectConstructionErrors(errors)) {
+    throw std::invalid_argument("cannot serialize a directive with "
+                                "construction errors: " +
+                                errors.front());
+  }
+  std::string bytes(SerializationMagic);
+  ByteSink sink(bytes);
+  sink.integer(SerializationFormatVersion);
+  sink.integer(DirectiveKindCount);
+  sink.integer(ClauseKindCount);
+  sink.integer(detail::isValidatedTree(directive));
+  StructureWriter<ByteSink>(sink, StructuralOptions())
+      .writeDirective(directive);
+  return bytes;
+}
+
+ParseResult deserialize(std::string_view bytes) {
+  ParseResult result;
+  auto reject = [&result](const std::string &message) {
+    Diagnostic diagnostic;
+    diagnostic.code = DiagnosticCode::MalformedSerialization;
+    diagnostic.severity = DiagnosticSeverity::Error;
+    diagnostic.message = message;
+    result.diagnostics.push_back(std::move(diagnostic));
+    return std::move(result);
+  };
+  if (bytes.substr(0, SerializationMagic.size()) != SerializationMagic) {
+    return reject("input is not a serialized OpenMP directive");
+  }
+  ByteSource source(bytes.substr(SerializationMagic.size()));
+  try {
+    const std::uint64_t version = source.integer();
+    if (version != SerializationFormatVersion) {
+      return reject("serialized directive has format version " +
+                    std::to_string(version) + ", expected " +
+                    std::to_string(SerializationFormatVersion));
+    }
+    if (source.integer() != DirectiveKindCount ||
+        source.integer() != ClauseKindCount) {
+      return reject("serialized directive was written for other directive "
+                    "and clause kinds");
+    }
+    const bool validated = source.integer() != 0;
+    OpenMPStructureReader reader(source);
+    std::unique_ptr<OpenMPDirective> directive = reader.readDirective();
+    if (source.remaining() != 0) {
+      return reject("serialized directive is followed by trailing bytes");
+    }
+    if (validated) {
+      // The flag says validation accepted the tree the image was written
+      // from. Enumerations were range-checked while reading; a tree that
+      // also breaks an IR invariant cannot be that tree.
+      std::vector<std::string> errors;
+      for (const OpenMPDirective *read : reader.directives) {
+        if (!read->validateInvariants(errors)) {
+          return reject("serialized directive is marked validated but " +
+                        errors.front());
+        }
+      }
+      for (const OpenMPDirective *read : reader.directives) {
+        read->markValidated();
+      }
+    }
+    result.directive = std::move(directive);
+  } catch (const MalformedImage &error) {
+    return reject(error.what());
+  }
+  return result;
+}
+
+} // namespace ompparser
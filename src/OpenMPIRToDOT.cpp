@@ -32,6 +32,22 @@ std::string equivalenceReductionSpelling(OpenMPBaseLang language,
   return equivalent ? ".eqv." : ".neqv.";
 }
 
+// Writes the node of a clause below parent_node and returns its name, which
+// starts with parent_node so clauses of different directives never collide.
+std::string writeClauseNode(std::ostream &dot_file, const std::string &indent,
+                            std::string_view parent_node,
+                            std::string_view clause_name, int depth,
+                            int index) {
+  std::string node(parent_node);
+  node += "_";
+  node += clause_name;
+  node += "_" + std::to_string(depth) + "_" + std::to_string(index);
+  dot_file << indent << parent_node << " -- " << node << "\n";
+  dot_file << indent << '\t' << node << " [label = \"" << clause_name
+           << "\"]\n";
+  return node;
+}
+
 void generateExpressionNodes(
     std::ostream &dot_file, const std::string &indent,
     const std::string &clause_kind,
@@ -50,15 +66,13 @@ void generateExpressionNodes(
 
 void OpenMPAtomicDefaultMemOrderClause::generateDOT(
     std::ostream &dot_file, int depth, int index,
-    std::string parent_node) const {
+    std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
-  std::string clause_kind = "atomic_default_mem_order_" +
-                            std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  std::string clause_kind = writeClauseNode(
+      dot_file, indent, parent_node, "atomic_default_mem_order", depth, index);
   indent += "\t";
   OpenMPAtomicDefaultMemOrderClauseKind kind = this->getKind();
   std::string parameter_string;
@@ -93,15 +107,13 @@ void OpenMPAtomicDefaultMemOrderClause::generateDOT(
 
 void OpenMPInReductionClause::generateDOT(std::ostream &dot_file, int depth,
                                           int index,
-                                          std::string parent_node) const {
+                                          std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
-  std::string clause_kind =
-      "in_reduction_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  std::string clause_kind = writeClauseNode(
+      dot_file, indent, parent_node, "in_reduction", depth, index);
   indent += "\t";
   OpenMPInReductionClauseIdentifier identifier = this->getIdentifier();
   std::string parameter_string;
@@ -162,15 +174,13 @@ void OpenMPInReductionClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPDepobjUpdateClause::generateDOT(std::ostream &dot_file, int depth,
                                            int index,
-                                           std::string parent_node) const {
+                                           std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "update_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "update", depth, index);
   indent += "\t";
   OpenMPDepobjUpdateClauseDependeceType type = this->getType();
   std::string parameter_string;
@@ -194,15 +204,14 @@ void OpenMPDepobjUpdateClause::generateDOT(std::ostream &dot_file, int depth,
 };
 
 void OpenMPDependClause::generateDOT(std::ostream &dot_file, int depth,
-                                     int index, std::string parent_node) const {
+                                     int index,
+                                     std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "depend_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "depend", depth, index);
   indent += "\t";
   OpenMPDependClauseModifier modifier = this->getModifier();
   OpenMPDependClauseType type = this->getType();
@@ -264,15 +273,13 @@ void OpenMPDependClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPAffinityClause::generateDOT(std::ostream &dot_file, int depth,
                                        int index,
-                                       std::string parent_node) const {
+                                       std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "affinity_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "affinity", depth, index);
   indent += "\t";
   OpenMPAffinityClauseModifier modifier = this->getModifier();
   std::string parameter_string;
@@ -295,15 +302,13 @@ void OpenMPAffinityClause::generateDOT(std::ostream &dot_file, int depth,
 };
 
 void OpenMPToClause::generateDOT(std::ostream &dot_file, int depth, int index,
-                                 std::string parent_node) const {
+                                 std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "to_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "to", depth, index);
   indent += "\t";
   OpenMPToClauseKind kind = this->getKind();
   std::string parameter_string;
@@ -338,15 +343,13 @@ void OpenMPToClause::generateDOT(std::ostream &dot_file, int depth, int index,
 };
 
 void OpenMPFromClause::generateDOT(std::ostream &dot_file, int depth, int index,
-                                   std::string parent_node) const {
+                                   std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "from_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "from", depth, index);
   indent += "\t";
   OpenMPFromClauseKind kind = this->getKind();
   std::string parameter_string;
@@ -381,15 +384,13 @@ void OpenMPFromClause::generateDOT(std::ostream &dot_file, int depth, int index,
 
 void OpenMPDefaultmapClause::generateDOT(std::ostream &dot_file, int depth,
                                          int index,
-                                         std::string parent_node) const {
+                                         std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
-  std::string clause_kind =
-      "defaultmap_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  std::string clause_kind = writeClauseNode(
+      dot_file, indent, parent_node, "defaultmap", depth, index);
   indent += "\t";
   OpenMPDefaultmapClauseBehavior behavior = this->getBehavior();
   OpenMPDefaultmapClauseCategory category = this->getCategory();
@@ -459,15 +460,14 @@ void OpenMPDefaultmapClause::generateDOT(std::ostream &dot_file, int depth,
 };
 
 void OpenMPDeviceClause::generateDOT(std::ostream &dot_file, int depth,
-                                     int index, std::string parent_node) const {
+                                     int index,
+                                     std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "device_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "device", depth, index);
   indent += "\t";
   OpenMPDeviceClauseModifier modifier = this->getModifier();
   std::string parameter_string;
@@ -494,15 +494,13 @@ void OpenMPDeviceClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPDeviceTypeClause::generateDOT(std::ostream &dot_file, int depth,
                                          int index,
-                                         std::string parent_node) const {
+                                         std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
-  std::string clause_kind =
-      "device_type_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  std::string clause_kind = writeClauseNode(
+      dot_file, indent, parent_node, "device_type", depth, index);
   indent += "\t";
   OpenMPDeviceTypeClauseKind device_type_kind = this->getDeviceTypeClauseKind();
   std::string parameter_string;
@@ -529,17 +527,15 @@ void OpenMPDeviceTypeClause::generateDOT(std::ostream &dot_file, int depth,
   };
 };
 
-void OpenMPTaskReductionClause::generateDOT(std::ostream &dot_file, int depth,
-                                            int index,
-                                            std::string parent_node) const {
+void OpenMPTaskReductionClause::generateDOT(
+    std::ostream &dot_file, int depth, int index,
+    std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
-  std::string clause_kind =
-      "task_reduction_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  std::string clause_kind = writeClauseNode(
+      dot_file, indent, parent_node, "task_reduction", depth, index);
   indent += "\t";
   OpenMPTaskReductionClauseIdentifier identifier = this->getIdentifier();
   std::string parameter_string;
@@ -599,15 +595,13 @@ void OpenMPTaskReductionClause::generateDOT(std::ostream &dot_file, int depth,
 };
 
 void OpenMPMapClause::generateDOT(std::ostream &dot_file, int depth, int index,
-                                  std::string parent_node) const {
+                                  std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "map_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "map", depth, index);
   indent += "\t";
   OpenMPMapClauseModifier modifier1 = this->getModifier1();
   OpenMPMapClauseModifier modifier2 = this->getModifier2();
@@ -713,290 +707,74 @@ void OpenMPMapClause::generateDOT(std::ostream &dot_file, int depth, int index,
   generateExpressionNodes(dot_file, indent, clause_kind, getExpressionItems());
 };
 
-// 2 or more combined directive
-std::string OpenMPDirective::generateDOTString() const {
-  std::string directive_kind;
-  OpenMPDirectiveKind kind = this->getKind();
-  switch (kind) {
-  case OMPD_cancellation_point:
-    directive_kind = "cancellation_point ";
-    break;
-  case OMPD_for_simd:
-    directive_kind = "for_simd ";
-    break;
-  case OMPD_do_simd:
-    directive_kind = "do_simd ";
-    break;
-  case OMPD_parallel_for_simd:
-    directive_kind = "parallel_for_simd ";
-    break;
-  case OMPD_declare_simd:
-    directive_kind = "declare_simd ";
-    break;
-  case OMPD_distribute_simd:
-    directive_kind = "distribute_simd ";
-    break;
-  case OMPD_distribute_parallel_for:
-    directive_kind = "distribute_parallel_for ";
-    break;
-  case OMPD_distribute_parallel_do:
-    directive_kind = "distribute_parallel_do ";
-    break;
-  case OMPD_distribute_parallel_for_simd:
-    directive_kind = "distribute_parallel_for_simd ";
-    break;
-  case OMPD_distribute_parallel_do_simd:
-    directive_kind = "distribute_parallel_do_simd ";
-    break;
-  case OMPD_parallel_for:
-    directive_kind = "parallel_for ";
-    break;
-  case OMPD_parallel_do:
-    directive_kind = "parallel_do ";
-    break;
-  case OMPD_parallel_loop:
-    directive_kind = "parallel_loop ";
-    break;
-  case OMPD_parallel_sections:
-    directive_kind = "parallel_sections ";
-    break;
-  case OMPD_parallel_workshare:
-    directive_kind += "parallel_workshare ";
-    break;
-  case OMPD_parallel_master:
-    directive_kind += "parallel_master ";
-    break;
-  case OMPD_master_taskloop:
-    directive_kind += "master_taskloop ";
-    break;
-  case OMPD_master_taskloop_simd:
-    directive_kind += "master_taskloop_simd ";
-    break;
-  case OMPD_parallel_master_taskloop:
-    directive_kind += "parallel_master_taskloop ";
-    break;
-  case OMPD_parallel_master_taskloop_simd:
-    directive_kind += "parallel_master_taskloop_simd ";
-    break;
-  case OMPD_declare_reduction:
-    directive_kind = "declare_reduction ";
-    break;
-  case OMPD_declare_mapper:
-    directive_kind = "declare_mapper ";
-    break;
-  case OMPD_taskloop_simd:
-    directive_kind = "taskloop_simd ";
-    break;
-  case OMPD_target_data:
-    directive_kind = "target_data ";
-    break;
-  case OMPD_target_data_composite:
-    directive_kind = "target_data_composite ";
-    break;
-  case OMPD_target_enter_data:
-    directive_kind = "target_enter_data ";
-    break;
-  case OMPD_target_exit_data:
-    directive_kind = "target_exit_data ";
-    break;
-  case OMPD_target_update:
-    directive_kind = "target_update ";
-    break;
-  case OMPD_declare_target:
-    directive_kind = "declare_target ";
-    break;
-  case OMPD_end_declare_target:
-    directive_kind = "end_declare_target ";
-    break;
-  case OMPD_teams_distribute:
-    directive_kind += "teams_distribute ";
-    break;
-  case OMPD_teams_distribute_simd:
-    directive_kind += "teams_distribute_simd ";
-    break;
-  case OMPD_teams_distribute_parallel_for:
-    directive_kind += "teams_distribute_parallel_for ";
-    break;
-  case OMPD_teams_distribute_parallel_for_simd:
-    directive_kind += "teams_distribute_parallel_for_simd ";
-    break;
-  case OMPD_teams_loop:
-    directive_kind += "teams_loop ";
-    break;
-  case OMPD_target_parallel:
-    directive_kind += "target_parallel ";
-    break;
-  case OMPD_target_parallel_for:
-    directive_kind += "target_parallel_for ";
-    break;
-  case OMPD_target_parallel_for_simd:
-    directive_kind += "target_parallel_for_simd ";
-    break;
-  case OMPD_target_parallel_loop:
-    directive_kind += "target_parallel_loop ";
-    break;
-  case OMPD_target_simd:
-    directive_kind += "target_simd ";
-    break;
-  case OMPD_target_teams:
-    directive_kind += "target_teams ";
-    break;
-  case OMPD_target_teams_distribute:
-    directive_kind += "target_teams_distribute ";
-    break;
-  case OMPD_target_teams_distribute_simd:
-    directive_kind += "target_teams_distribute_simd ";
-    break;
-  case OMPD_target_teams_loop:
-    directive_kind += "target_teams_loop ";
-    break;
-  case OMPD_target_teams_distribute_parallel_for:
-    directive_kind += "target_teams_distribute_parallel_for ";
-    break;
-  case OMPD_target_teams_distribute_parallel_for_simd:
-    directive_kind += "target_teams_distribute_parallel_for simd ";
-    break;
-  case OMPD_teams_distribute_parallel_do:
-    directive_kind += "teams distribute parallel do ";
-    break;
-  case OMPD_teams_distribute_parallel_do_simd:
-    directive_kind += "teams distribute parallel do simd ";
-    break;
-  case OMPD_target_parallel_do:
-    directive_kind += "target parallel do ";
-    break;
-  case OMPD_target_parallel_do_simd:
-    directive_kind += "target parallel do simd ";
-    break;
-  case OMPD_target_teams_distribute_parallel_do:
-    directive_kind += "target teams distribute parallel do ";
-    break;
-  case OMPD_target_teams_distribute_parallel_do_simd:
-    directive_kind += "target teams distribute parallel do simd ";
-    break;
-  default:
-    directive_kind = this->toString();
-  }
-  std::string current_line;
-
-  current_line = "graph OpenMPIR_" + directive_kind + " {\n";
-
-  std::ostringstream output;
-
-  output << current_line.c_str();
-  output << "\t" << directive_kind.c_str() << "\n";
-  std::string node_id = "";
-  switch (kind) {
-  case OMPD_allocate: {
-    std::string indent = std::string(1, '\t');
-    const auto &list =
-        static_cast<const OpenMPAllocateDirective *>(this)->getAllocateList();
-    int list_index = 0;
-    std::string list_name;
-    std::string expr_name;
-    std::string tkind = "allocate";
-    list_name = tkind + "_directive_list_" + std::to_string(list_index);
-    current_line = indent + tkind + " -- " + list_name + "\n";
-    output << current_line.c_str();
-    for (auto it = list.begin(); it != list.end(); ++it) {
-      expr_name = list_name + "_expr" + std::to_string(list_index);
-      list_index += 1;
-      current_line = indent + indent + list_name + " -- " + expr_name + "\n";
-      output << current_line.c_str();
-      current_line = indent + indent + "\t" + expr_name + " [label = \"" +
-                     expr_name + "\\n " + it->spelling + "\"]\n";
-      output << current_line.c_str();
+void OpenMPDirective::generateDOTBody(std::ostream &dot_file, int depth,
+                                      std::string_view node) const {
+  const std::string indent(static_cast<std::size_t>(depth), '\t');
+  const std::string_view kind_name = ompparser::getDirectiveName(getKind());
+  // Node names carry node so directives can share a graph; labels carry the
+  // directive name, as they do when the directive is the whole graph.
+  auto writeValue = [&](std::string_view suffix, const std::string &value) {
+    dot_file << indent << node << " -- " << node << suffix << "\n";
+    dot_file << indent << '\t' << node << suffix << " [label = \"" << kind_name
+             << suffix << "\\n " << value << "\"]\n";
+  };
+  auto writeList = [&](std::string_view suffix,
+                       const std::vector<ompparser::HostFragment> &list) {
+    dot_file << indent << node << " -- " << node << suffix << "\n";
+    for (std::size_t index = 0; index < list.size(); ++index) {
+      const std::string item = "_expr" + std::to_string(index);
+      dot_file << indent << '\t' << node << suffix << " -- " << node << suffix
+               << item << "\n";
+      dot_file << indent << "\t\t" << node << suffix << item << " [label = \""
+               << kind_name << suffix << item << "\\n " << list[index].spelling
+               << "\"]\n";
     }
+  };
+
+  switch (getKind()) {
+  case OMPD_allocate:
+    writeList("_directive_list_0",
+              static_cast<const OpenMPAllocateDirective *>(this)
+                  ->getAllocateList());
     break;
-  }
-  case OMPD_threadprivate: {
-    std::string indent = std::string(1, '\t');
-    const auto &list = static_cast<const OpenMPThreadprivateDirective *>(this)
-                           ->getThreadprivateList();
-    int list_index = 0;
-    std::string list_name;
-    std::string expr_name;
-    std::string tkind = "threadprivate";
-    list_name = tkind + "_directive_list_" + std::to_string(list_index);
-    current_line = indent + tkind + " -- " + list_name + "\n";
-    output << current_line.c_str();
-    for (auto it = list.begin(); it != list.end(); ++it) {
-      expr_name = list_name + "_expr" + std::to_string(list_index);
-      list_index += 1;
-      current_line = indent + indent + list_name + " -- " + expr_name + "\n";
-      output << current_line.c_str();
-      current_line = indent + indent + "\t" + expr_name + " [label = \"" +
-                     expr_name + "\\n " + it->spelling + "\"]\n";
-      output << current_line.c_str();
-    }
+  case OMPD_threadprivate:
+    writeList("_directive_list_0",
+              static_cast<const OpenMPThreadprivateDirective *>(this)
+                  ->getThreadprivateList());
     break;
-  }
   case OMPD_declare_reduction: {
-    std::string indent = std::string(1, '\t');
     const auto *declaration =
         static_cast<const OpenMPDeclareReductionDirective *>(this);
-    const auto &list = declaration->getTypenameList();
-    const std::string &id = declaration->getIdentifier();
-    const std::string &combiner = declaration->getCombiner();
-    int list_index = 0;
-    std::string list_name;
-    std::string expr_name;
-    std::string tkind = "declare_reduction";
-    std::string node_id = tkind + "_reduction_identifier";
-    current_line = indent + tkind + " -- " + node_id + "\n";
-    output << current_line.c_str();
-    current_line = indent + "\t" + node_id + " [label = \"" + node_id + "\\n " +
-                   id + "\"]\n";
-    output << current_line.c_str();
-    list_name = tkind + "_typename_list_" + std::to_string(list_index);
-    current_line = indent + tkind + " -- " + list_name + "\n";
-    output << current_line.c_str();
-    for (const ompparser::HostFragment &list_item : list) {
-      expr_name = list_name + "_expr" + std::to_string(list_index);
-      list_index += 1;
-      current_line = indent + indent + list_name + " -- " + expr_name + "\n";
-      output << current_line.c_str();
-      current_line = indent + indent + "\t" + expr_name + " [label = \"" +
-                     expr_name + "\\n " + list_item.spelling + "\"]\n";
-      output << current_line.c_str();
-    }
-    node_id = tkind + "_combiner";
-    current_line = indent + tkind + " -- " + node_id + "\n";
-    output << current_line.c_str();
-    current_line = indent + "\t" + node_id + " [label = \"" + node_id + "\\n " +
-                   combiner + "\"]\n";
-    output << current_line.c_str();
+    writeValue("_reduction_identifier", declaration->getIdentifier());
+    writeList("_typename_list_0", declaration->getTypenameList());
+    writeValue("_combiner", declaration->getCombiner());
     break;
   }
   case OMPD_declare_simd: {
-    std::string indent = std::string(1, '\t');
     const std::string &proc_name =
         static_cast<const OpenMPDeclareSimdDirective *>(this)->getProcName();
-    std::string tkind = "declare_simd";
-    std::string node_id = tkind + "_proc_name";
-    if (proc_name != "") {
-      current_line = indent + tkind + " -- " + node_id + "\n";
-      output << current_line.c_str();
-      current_line = indent + "\t" + node_id + " [label = \"" + node_id +
-                     "\\n " + proc_name + "\"]\n";
-      output << current_line.c_str();
+    if (!proc_name.empty()) {
+      writeValue("_proc_name", proc_name);
     }
     break;
   }
-  default: {
-    node_id = directive_kind.substr(0, directive_kind.size() - 1);
+  default:
+    break;
   }
-  };
 
-  const auto &clauses = this->getClausesInOriginalOrder();
-  if (!clauses.empty()) {
-    int clause_index = 0;
-    for (OpenMPClause *clause : clauses) {
-      clause->generateDOT(output, 1, clause_index, node_id);
-      clause_index += 1;
-    };
-  };
+  int clause_index = 0;
+  for (const OpenMPClause *clause : getClausesInOriginalOrder()) {
+    clause->generateDOT(dot_file, depth, clause_index, node);
+    clause_index += 1;
+  }
+}
 
+std::string OpenMPDirective::generateDOTString() const {
+  const std::string_view node = ompparser::getDirectiveName(getKind());
+  std::ostringstream output;
+  output << "graph OpenMPIR_" << node << " {\n";
+  output << "\t" << node << "\n";
+  generateDOTBody(output, 1, node);
   output << "}\n";
   return output.str();
 };
@@ -1012,468 +790,51 @@ void OpenMPDirective::generateDOT() const {
 };
 
 void OpenMPDirective::generateDOT(std::ostream &dot_file, int depth, int index,
-                                  std::string parent_node,
-                                  std::string trait_score) const {
-
-  std::string directive_kind;
-  OpenMPDirectiveKind kind = this->getKind();
-  switch (kind) {
-  case OMPD_cancellation_point:
-    directive_kind = "cancellation_point";
-    break;
-  case OMPD_for_simd:
-    directive_kind = "for_simd";
-    break;
-  case OMPD_distribute_simd:
-    directive_kind = "distribute_simd";
-    break;
-  case OMPD_distribute_parallel_for:
-    directive_kind = "distribute_parallel_for";
-    break;
-  case OMPD_distribute_parallel_do:
-    directive_kind = "distribute_parallel_do";
-    break;
-  case OMPD_distribute_parallel_for_simd:
-    directive_kind = "distribute_parallel_for_simd";
-    break;
-  case OMPD_distribute_parallel_do_simd:
-    directive_kind = "distribute_parallel_do_simd";
-    break;
-  case OMPD_declare_reduction:
-    directive_kind = "declare_reduction";
-    break;
-  case OMPD_declare_mapper:
-    directive_kind = "declare_mapper";
-    break;
-  case OMPD_taskloop_simd:
-    directive_kind = "taskloop_simd";
-    break;
-  case OMPD_target_data:
-    directive_kind = "target_data";
-    break;
-  case OMPD_target_data_composite:
-    directive_kind = "target_data_composite";
-    break;
-  case OMPD_target_enter_data:
-    directive_kind = "target_enter_data";
-    break;
-  case OMPD_target_exit_data:
-    directive_kind = "target_exit_data";
-    break;
-  case OMPD_target_update:
-    directive_kind = "target_update";
-    break;
-  case OMPD_declare_target:
-    directive_kind = "declare_target";
-    break;
-  case OMPD_end_declare_target:
-    directive_kind = "end_declare_target";
-    break;
-  case OMPD_depobj:
-    directive_kind = "depobj ";
-    break;
-  case OMPD_teams_distribute:
-    directive_kind += "teams_distribute ";
-    break;
-  case OMPD_teams_distribute_simd:
-    directive_kind += "teams_distribute_simd ";
-    break;
-  case OMPD_teams_distribute_parallel_for:
-    directive_kind += "teams_distribute_parallel_for ";
-    break;
-  case OMPD_teams_distribute_parallel_for_simd:
-    directive_kind += "teams_distribute_parallel_for_simd ";
-    break;
-  case OMPD_teams_loop:
-    directive_kind += "teams_loop ";
-    break;
-  case OMPD_target_parallel:
-    directive_kind += "target_parallel ";
-    break;
-  case OMPD_target_parallel_for:
-    directive_kind += "target_parallel_for ";
-    break;
-  case OMPD_target_parallel_for_simd:
-    directive_kind += "target_parallel_for_simd ";
-    break;
-  case OMPD_target_parallel_loop:
-    directive_kind += "target_parallel_loop ";
-    break;
-  case OMPD_target_simd:
-    directive_kind += "target_simd ";
-    break;
-  case OMPD_target_teams:
-    directive_kind += "target_teams ";
-    break;
-  case OMPD_target_teams_distribute:
-    directive_kind += "target_teams_distribute ";
-    break;
-  case OMPD_target_teams_distribute_simd:
-    directive_kind += "target_teams_distribute_simd ";
-    break;
-  case OMPD_target_teams_loop:
-    directive_kind += "target_teams_loop ";
-    break;
-  case OMPD_target_teams_distribute_parallel_for:
-    directive_kind += "target_teams_distribute_parallel_for ";
-    break;
-  case OMPD_target_teams_distribute_parallel_for_simd:
-    directive_kind += "target_teams_distribute_parallel_for_simd ";
-    break;
-  case OMPD_teams_distribute_parallel_do:
-    directive_kind += "teams distribute parallel do ";
-    break;
-  case OMPD_teams_distribute_parallel_do_simd:
-    directive_kind += "teams distribute parallel do simd ";
-    break;
-  case OMPD_target_parallel_do:
-    directive_kind += "target parallel do ";
-    break;
-  case OMPD_target_parallel_do_simd:
-    directive_kind += "target parallel do simd ";
-    break;
-  case OMPD_target_teams_distribute_parallel_do:
-    directive_kind += "target teams distribute parallel do ";
-    break;
-  case OMPD_target_teams_distribute_parallel_do_simd:
-    directive_kind += "target teams distribute parallel do simd ";
-    break;
-  default:
-    directive_kind = this->toString().substr(0, this->toString().size() - 1);
+                                  std::string_view parent_node,
+                                  std::string_view trait_score) const {
+  const std::string_view directive_kind =
+      ompparser::getDirectiveName(getKind());
+  std::string directive_id(parent_node);
+  directive_id += "_";
+  directive_id += directive_kind;
+  directive_id += "_" + std::to_string(index);
+  const std::string indent(static_cast<std::size_t>(depth), '\t');
+  dot_file << indent << parent_node << " -- " << directive_id << "\n";
+  dot_file << indent << '\t' << directive_id << " [label = \"" << directive_kind
+           << "\"]\n";
+
+  if (!trait_score.empty()) {
+    dot_file << indent << '\t' << directive_id << " -- " << directive_id
+             << "_score\n";
+    dot_file << indent << "\t\t" << directive_id
+             << "_score [label = \"score\\n " << trait_score << "\"]\n";
   }
-  std::string current_line;
-  std::string indent = std::string(depth, '\t');
-  std::string directive_id =
-      parent_node + "_" + directive_kind + "_" + std::to_string(index);
-  current_line = indent + parent_node + " -- " + directive_id + "\n";
-  dot_file << current_line.c_str();
-  indent += "\t";
-  dot_file << indent << directive_id.c_str()
-           << " [label = \"" + directive_kind + "\"]\n";
-
-  // output score
-  if (trait_score != "") {
-    current_line =
-        indent + directive_id + " -- " + directive_id + "_score" + "\n";
-    dot_file << current_line.c_str();
-    current_line = indent + "\t" + directive_id + "_score" +
-                   " [label = \"score\\n " + trait_score + "\"]\n";
-    dot_file << current_line.c_str();
-  };
 
-  switch (kind) {
-  case OMPD_allocate: {
-    const auto &list =
-        static_cast<const OpenMPAllocateDirective *>(this)->getAllocateList();
-    int list_index = 0;
-    std::string list_name;
-    std::string expr_name;
-    std::string tkind = "allocate";
-    list_name = tkind + "_directive_list_" + std::to_string(list_index);
-    current_line = indent + tkind + " -- " + list_name + "\n";
-    dot_file << current_line.c_str();
-    for (auto it = list.begin(); it != list.end(); ++it) {
-      expr_name = list_name + "_expr" + std::to_string(list_index);
-      list_index += 1;
-      current_line = indent + indent + list_name + " -- " + expr_name + "\n";
-      dot_file << current_line.c_str();
-      current_line = indent + indent + "\t" + expr_name + " [label = \"" +
-                     expr_name + "\\n " + it->spelling + "\"]\n";
-      dot_file << current_line.c_str();
-    }
-    break;
-  }
-  case OMPD_threadprivate: {
-    const auto &list = static_cast<const OpenMPThreadprivateDirective *>(this)
-                           ->getThreadprivateList();
-    int list_index = 0;
-    std::string list_name;
-    std::string expr_name;
-    std::string tkind = "threadprivate";
-    list_name = tkind + "_directive_list_" + std::to_string(list_index);
-    current_line = indent + tkind + " -- " + list_name + "\n";
-    dot_file << current_line.c_str();
-    for (auto it = list.begin(); it != list.end(); ++it) {
-      expr_name = list_name + "_expr" + std::to_string(list_index);
-      list_index += 1;
-      current_line = indent + indent + list_name + " -- " + expr_name + "\n";
-      dot_file << current_line.c_str();
-      current_line = indent + indent + "\t" + expr_name + " [label = \"" +
-                     expr_name + "\\n " + it->spelling + "\"]\n";
-      dot_file << current_line.c_str();
-    }
-    break;
-  }
-  case OMPD_declare_reduction: {
-    auto *declaration =
-        static_cast<const OpenMPDeclareReductionDirective *>(this);
-    const auto &list = declaration->getTypenameList();
-    const std::string &id = declaration->getIdentifier();
-    const std::string &combiner = declaration->getCombiner();
-    int list_index = 0;
-    std::string list_name;
-    std::string expr_name;
-    std::string tkind = "declare_reduction";
-    std::string node_id = tkind + "_reduction_identifier";
-    current_line = indent + tkind + " -- " + node_id + "\n";
-    dot_file << current_line.c_str();
-    current_line = indent + "\t" + node_id + " [label = \"" + node_id + "\\n " +
-                   id + "\"]\n";
-    dot_file << current_line.c_str();
-    list_name = tkind + "_typename_list_" + std::to_string(list_index);
-    current_line = indent + tkind + " -- " + list_name + "\n";
-    dot_file << current_line.c_str();
-    for (const ompparser::HostFragment &list_item : list) {
-      expr_name = list_name + "_expr" + std::to_string(list_index);
-      list_index += 1;
-      current_line = indent + indent + list_name + " -- " + expr_name + "\n";
-      dot_file << current_line.c_str();
-      current_line = indent + indent + "\t" + expr_name + " [label = \"" +
-                     expr_name + "\\n " + list_item.spelling + "\"]\n";
-      dot_file << current_line.c_str();
-    }
-    node_id = tkind + "_combiner";
-    current_line = indent + tkind + " -- " + node_id + "\n";
-    dot_file << current_line.c_str();
-    current_line = indent + "\t" + node_id + " [label = \"" + node_id + "\\n " +
-                   combiner + "\"]\n";
-    dot_file << current_line.c_str();
-    break;
-  }
-  default: {
-    ;
-  }
-  };
+  generateDOTBody(dot_file, depth + 1, directive_id);
+}
 
-  const auto &clauses = this->getClausesInOriginalOrder();
-  if (!clauses.empty()) {
-    int clause_index = 0;
-    for (const OpenMPClause *clause : clauses) {
-      clause->generateDOT(dot_file, depth + 1, clause_index, directive_id);
-      clause_index += 1;
-    }
+void OpenMPDirective::generateDOTCluster(std::ostream &dot_file,
+                                         std::size_t index) const {
+  const std::string node = "d" + std::to_string(index);
+  const char *name = ompparser::getDirectiveName(getKind());
+  dot_file << "\tsubgraph cluster_" << index << " {\n";
+  dot_file << "\t\tlabel = \"" << name;
+  if (getLine() > 0) {
+    dot_file << "\\nline " << getLine();
   }
+  dot_file << "\"\n";
+  dot_file << "\t\t" << node << " [label = \"" << name << "\"]\n";
+  generateDOTBody(dot_file, 2, node);
+  dot_file << "\t}\n";
 }
 
 void OpenMPClause::generateDOT(std::ostream &dot_file, int depth, int index,
-                               std::string parent_node) const {
-
-  std::string current_line;
-  std::string clause_kind;
+                               std::string_view parent_node) const {
   std::string indent = std::string(depth, '\t');
-
-  switch (this->getKind()) {
-  case OMPC_private:
-    clause_kind += "private";
-    break;
-  case OMPC_firstprivate:
-    clause_kind += "firstprivate";
-    break;
-  case OMPC_shared:
-    clause_kind += "shared";
-    break;
-  case OMPC_initializer:
-    clause_kind += "initializer";
-    break;
-  case OMPC_num_threads:
-    clause_kind += "num_threads";
-    break;
-  case OMPC_align:
-    clause_kind += "align";
-    break;
-  case OMPC_num_teams:
-    clause_kind += "num_teams";
-    break;
-  case OMPC_thread_limit:
-    clause_kind += "thread_limit";
-    break;
-  case OMPC_default:
-    clause_kind += "default";
-    break;
-  case OMPC_collapse:
-    clause_kind += "collapse";
-    break;
-  case OMPC_ordered:
-    clause_kind += "ordered";
-    break;
-  case OMPC_nowait:
-    clause_kind += "nowait";
-    break;
-  case OMPC_allocate:
-    clause_kind += "allocate";
-    break;
-  case OMPC_order:
-    clause_kind += "order";
-    break;
-  case OMPC_safelen:
-    clause_kind += "safelen";
-    break;
-  case OMPC_simdlen:
-    clause_kind += "simdlen";
-    break;
-  case OMPC_aligned:
-    clause_kind += "aligned";
-    break;
-  case OMPC_nontemporal:
-    clause_kind += "nontemporal";
-    break;
-  case OMPC_uniform:
-    clause_kind += "uniform";
-    break;
-  case OMPC_inbranch:
-    clause_kind += "inbranch";
-    break;
-  case OMPC_notinbranch:
-    clause_kind += "notinbranch";
-    break;
-  case OMPC_proc_bind:
-    clause_kind += "proc_bind";
-    break;
-  case OMPC_bind:
-    clause_kind += "bind";
-    break;
-  case OMPC_inclusive:
-    clause_kind += "inclusive";
-    break;
-  case OMPC_exclusive:
-    clause_kind += "exclusive";
-    break;
-  case OMPC_copyprivate:
-    clause_kind += "copyprivate";
-    break;
-  case OMPC_parallel:
-    clause_kind += "parallel";
-    break;
-  case OMPC_sections:
-    clause_kind += "sections";
-    break;
-  case OMPC_for:
-    clause_kind += "for";
-    break;
-  case OMPC_do:
-    clause_kind += "do";
-    break;
-  case OMPC_taskgroup:
-    clause_kind += "taskgroup";
-    break;
-  case OMPC_if:
-    clause_kind += "if";
-    break;
-  case OMPC_reverse_offload:
-    clause_kind += "reverse_offload";
-    break;
-  case OMPC_unified_address:
-    clause_kind += "unified_address";
-    break;
-  case OMPC_unified_shared_memory:
-    clause_kind += "unified_shared_memory";
-    break;
-  case OMPC_dynamic_allocators:
-    clause_kind += "dynamic_allocators";
-    break;
-  case OMPC_final:
-    clause_kind += "final";
-    break;
-  case OMPC_untied:
-    clause_kind += "untied";
-    break;
-  case OMPC_mergeable:
-    clause_kind += "mergeable";
-    break;
-  case OMPC_priority:
-    clause_kind += "priority";
-    break;
-  case OMPC_detach:
-    clause_kind += "detach";
-    break;
-  case OMPC_grainsize:
-    clause_kind += "grainsize";
-    break;
-  case OMPC_num_tasks:
-    clause_kind += "num_tasks";
-    break;
-  case OMPC_nogroup:
-    clause_kind += "nogroup";
-    break;
-  case OMPC_map:
-    clause_kind += "map";
-    break;
-  case OMPC_use_device_ptr:
-    clause_kind += "use_device_ptr";
-    break;
-  case OMPC_use_device_addr:
-    clause_kind += "use_device_addr";
-    break;
-  case OMPC_is_device_ptr:
-    clause_kind += "is_device_ptr";
-    break;
-  case OMPC_has_device_addr:
-    clause_kind += "has_device_addr";
-    break;
-  case OMPC_link:
-    clause_kind += "link";
-    break;
-  case OMPC_enter:
-    clause_kind += "enter";
-    break;
-  case OMPC_device_type:
-    clause_kind += "device_type";
-    break;
-  case OMPC_acq_rel:
-    clause_kind += "acq_rel";
-    break;
-  case OMPC_release:
-    clause_kind += "release";
-    break;
-  case OMPC_acquire:
-    clause_kind += "acquire";
-    break;
-  case OMPC_read:
-    clause_kind += "read";
-    break;
-  case OMPC_write:
-    clause_kind += "write";
-    break;
-  case OMPC_update:
-    clause_kind += "update";
-    break;
-  case OMPC_capture:
-    clause_kind += "capture";
-    break;
-  case OMPC_seq_cst:
-    clause_kind += "seq_cst";
-    break;
-  case OMPC_relaxed:
-    clause_kind += "relaxed";
-    break;
-  case OMPC_hint:
-    clause_kind += "hint";
-    break;
-  case OMPC_destroy:
-    clause_kind += "destroy";
-    break;
-  case OMPC_threads:
-    clause_kind += "threads";
-    break;
-  case OMPC_simd:
-    clause_kind += "simd";
-    break;
-  case OMPC_uses_allocators:
-    clause_kind += "uses_allocators";
-    break;
-  default:
-    break;
-  }
-  // parent_node = parent_node.substr(0, parent_node.size()-1);
-  std::string clause_label = clause_kind;
-  clause_kind = parent_node + "_" + clause_kind + "_" + std::to_string(depth) +
-                "_" + std::to_string(index);
-  current_line = indent + parent_node + " -- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  const std::string clause_kind =
+      writeClauseNode(dot_file, indent, parent_node,
+                      ompparser::getClauseName(getKind()), depth, index);
   indent += "\t";
-  current_line =
-      indent + clause_kind + " [label = \"" + clause_label + +"\"]\n";
-  dot_file << current_line.c_str();
 
   if (this->getKind() == OMPC_default) {
     OpenMPDirective *variant_directive =
@@ -1486,25 +847,21 @@ void OpenMPClause::generateDOT(std::ostream &dot_file, int depth, int index,
   const auto &expressions = getExpressionItems();
   for (std::size_t index = 0; index < expressions.size(); ++index) {
     const std::string expr_name = clause_kind + "_expr" + std::to_string(index);
-    current_line = indent + clause_kind + " -- " + expr_name + "\n";
-    dot_file << current_line.c_str();
-    current_line = indent + "\t" + expr_name + " [label = \"" + "expr" +
-                   "\\n " + expressions[index].fragment.spelling + "\"]\n";
-    dot_file << current_line.c_str();
+    dot_file << indent << clause_kind << " -- " << expr_name << "\n";
+    dot_file << indent << '\t' << expr_name << " [label = \"expr\\n "
+             << expressions[index].fragment.spelling << "\"]\n";
   }
 };
 
 void OpenMPReductionClause::generateDOT(std::ostream &dot_file, int depth,
                                         int index,
-                                        std::string parent_node) const {
+                                        std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "reduction_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "reduction", depth, index);
   indent += "\t";
   OpenMPReductionClauseModifier modifier = this->getModifier();
   OpenMPReductionClauseIdentifier identifier = this->getIdentifier();
@@ -1590,7 +947,7 @@ void OpenMPReductionClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPVariantClause::generateDOT(std::ostream &dot_file, int depth,
                                       int index,
-                                      std::string parent_node) const {
+                                      std::string_view parent_node) const {
   auto escape = [](const std::string &text) {
     std::string result;
     for (char character : text) {
@@ -1602,16 +959,10 @@ void OpenMPVariantClause::generateDOT(std::ostream &dot_file, int depth,
     return result;
   };
 
-  if (!parent_node.empty()) {
-    parent_node.pop_back();
-  }
-  const std::string clause_node = parent_node + "_variant_" +
-                                  std::to_string(depth) + "_" +
-                                  std::to_string(index);
   const std::string indent(static_cast<std::size_t>(depth), '\t');
-  dot_file << indent << parent_node << " -- " << clause_node << "\n";
-  dot_file << indent << '\t' << clause_node << " [label = \""
-           << ompparser::getClauseName(getKind()) << "\"]\n";
+  const std::string clause_node = writeClauseNode(
+      dot_file, indent, parent_node, ompparser::getClauseName(getKind()),
+      depth, index);
 
   for (std::size_t set_index = 0; set_index < trait_sets.size(); ++set_index) {
     const TraitSetSelector &set = trait_sets[set_index];
@@ -1690,58 +1041,31 @@ void OpenMPVariantClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPDefaultClause::generateDOT(std::ostream &dot_file, int depth,
                                       int index,
-                                      std::string parent_node) const {
-
-  std::string parameter_string;
-  const OpenMPDirective *variant_directive = NULL;
-  std::string current_line;
-  std::string indent = std::string(depth, '\t');
-  std::string clause_string;
-  parent_node = parent_node.substr(0, parent_node.size() - 1);
-
-  clause_string = "default";
-
-  clause_string = parent_node + "_" + clause_string + "_" +
-                  std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + " -- " + clause_string + "\n";
-  dot_file << current_line.c_str();
-  indent += "\t";
-  variant_directive =
-      static_cast<const OpenMPDefaultClause *>(this)->getVariantDirective();
-  if (variant_directive != NULL) {
-    variant_directive->generateDOT(dot_file, depth + 1, 0, clause_string, "");
-  };
+                                      std::string_view parent_node) const {
+  const std::string indent(static_cast<std::size_t>(depth), '\t');
+  const std::string clause_node =
+      writeClauseNode(dot_file, indent, parent_node, "default", depth, index);
+  if (const OpenMPDirective *variant_directive = getVariantDirective()) {
+    variant_directive->generateDOT(dot_file, depth + 1, 0, clause_node, "");
+  }
 };
 
 void OpenMPOrderClause::generateDOT(std::ostream &dot_file, int depth,
-                                    int index, std::string parent_node) const {
-
-  std::string parameter_string;
-  std::string current_line;
-  std::string indent = std::string(depth, '\t');
-  std::string clause_string;
-  parent_node = parent_node.substr(0, parent_node.size() - 1);
-
-  clause_string = "order";
-
-  clause_string = parent_node + "_" + clause_string + "_" +
-                  std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + " -- " + clause_string + "\n";
-  dot_file << current_line.c_str();
-  indent += "\t";
+                                    int index,
+                                    std::string_view parent_node) const {
+  const std::string indent(static_cast<std::size_t>(depth), '\t');
+  writeClauseNode(dot_file, indent, parent_node, "order", depth, index);
 };
 
 void OpenMPLastprivateClause::generateDOT(std::ostream &dot_file, int depth,
                                           int index,
-                                          std::string parent_node) const {
+                                          std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
-  std::string clause_kind =
-      "lastprivate_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  std::string clause_kind = writeClauseNode(
+      dot_file, indent, parent_node, "lastprivate", depth, index);
   indent += "\t";
   OpenMPLastprivateClauseModifier modifier = this->getModifier();
   std::string parameter_string;
@@ -1764,15 +1088,14 @@ void OpenMPLastprivateClause::generateDOT(std::ostream &dot_file, int depth,
 };
 
 void OpenMPLinearClause::generateDOT(std::ostream &dot_file, int depth,
-                                     int index, std::string parent_node) const {
+                                     int index,
+                                     std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "linear_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "linear", depth, index);
   indent += "\t";
   OpenMPLinearClauseModifier modifier = this->getModifier();
   std::string parameter_string;
@@ -1814,15 +1137,13 @@ void OpenMPLinearClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPAlignedClause::generateDOT(std::ostream &dot_file, int depth,
                                       int index,
-                                      std::string parent_node) const {
+                                      std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "aligned_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "aligned", depth, index);
   indent += "\t";
   std::string parameter_string;
 
@@ -1841,15 +1162,13 @@ void OpenMPAlignedClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPScheduleClause::generateDOT(std::ostream &dot_file, int depth,
                                        int index,
-                                       std::string parent_node) const {
+                                       std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "schedule_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "schedule", depth, index);
   indent += "\t";
   OpenMPScheduleClauseModifier modifier1 = this->getModifier1();
   OpenMPScheduleClauseModifier modifier2 = this->getModifier2();
@@ -1930,15 +1249,13 @@ void OpenMPScheduleClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPDistScheduleClause::generateDOT(std::ostream &dot_file, int depth,
                                            int index,
-                                           std::string parent_node) const {
+                                           std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
-  std::string clause_kind =
-      "dist_schedule_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  std::string clause_kind = writeClauseNode(
+      dot_file, indent, parent_node, "dist_schedule", depth, index);
   indent += "\t";
   OpenMPDistScheduleClauseKind kind = this->getKind();
   std::string parameter_string;
@@ -1970,15 +1287,13 @@ void OpenMPDistScheduleClause::generateDOT(std::ostream &dot_file, int depth,
 };
 
 void OpenMPIfClause::generateDOT(std::ostream &dot_file, int depth, int index,
-                                 std::string parent_node) const {
+                                 std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "if_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "if", depth, index);
   indent += "\t";
   OpenMPIfClauseModifier modifier = this->getModifier();
   std::string parameter_string;
@@ -2029,15 +1344,13 @@ void OpenMPIfClause::generateDOT(std::ostream &dot_file, int depth, int index,
 
 void OpenMPInitializerClause::generateDOT(std::ostream &dot_file, int depth,
                                           int index,
-                                          std::string parent_node) const {
+                                          std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
-  std::string clause_kind =
-      "initializer_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+  std::string clause_kind = writeClauseNode(
+      dot_file, indent, parent_node, "initializer", depth, index);
   indent += "\t";
   std::string priv = this->getUserDefinedPriv();
   std::string parameter_string;
@@ -2056,15 +1369,13 @@ void OpenMPInitializerClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPAllocateClause::generateDOT(std::ostream &dot_file, int depth,
                                        int index,
-                                       std::string parent_node) const {
+                                       std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "allocate_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "allocate", depth, index);
   indent += "\t";
   OpenMPAllocateClauseAllocator allocator = this->getAllocator();
   std::string parameter_string;
@@ -2109,15 +1420,13 @@ void OpenMPAllocateClause::generateDOT(std::ostream &dot_file, int depth,
 
 void OpenMPAllocatorClause::generateDOT(std::ostream &dot_file, int depth,
                                         int index,
-                                        std::string parent_node) const {
+                                        std::string_view parent_node) const {
 
   std::string current_line;
   std::string indent = std::string(depth, '\t');
 
   std::string clause_kind =
-      "allocator_" + std::to_string(depth) + "_" + std::to_string(index);
-  current_line = indent + parent_node + "-- " + clause_kind + "\n";
-  dot_file << current_line.c_str();
+      writeClauseNode(dot_file, indent, parent_node, "allocator", depth, index);
   indent += "\t";
   OpenMPAllocatorClauseAllocator allocator = this->getAllocator();
   std::string parameter_string;
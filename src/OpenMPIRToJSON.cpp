@@ -0,0 +1,760 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// JSON export of the OpenMP IR, written straight into a TextSink.
+//
+// A directive is an object
+//   {"directive": <kind>, "language": "c" | "cplusplus" | "fortran" |
+//    "unknown", "line": <int>, "column": <int>, <directive fields>,
+//    "clauses": [<clause>, ...]}
+// and a clause an object
+//   {"clause": <kind>, "line": <int>, "column": <int>, <clause fields>,
+//    "items": [<spelling>, ...]}
+// where kinds are the names in OpenMPKinds.def ("parallel_for", "map", ...).
+// The fields of each node class are written by its visit hook below, always
+// in that order and always present, except "directive_name_modifier" and
+// "implementation_defined", which only appear when set. Enumerations are
+// written as their OpenMPKinds.def names, "unspecified" and "unknown"
+// included; host fragments as their source spelling, "" when absent; nested
+// directives and clauses as objects, null when absent. docs/json-schema.md
+// lists the keys, types and enumeration vocabularies of every class.
+
+#include "OpenMPIR.h"
+#include "OpenMPIRVisitor.h"
+#include "OpenMPKindNames.h"
+#include "OpenMPParserInternal.h"
+#include "OpenMPSchema.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace {
+
+using ompparser::detail::kindName;
+
+// Writes JSON tokens into a sink through a fixed buffer, so a directive
+// reaches the sink in a few large appends and no document is built.
+class JsonOutput {
+public:
+  explicit JsonOutput(ompparser::TextSink &sink) : sink(sink) {}
+
+  void beginObject() { open('{'); }
+  void endObject() { close('}'); }
+  void beginArray() { open('['); }
+  void endArray() { close(']'); }
+
+  void key(std::string_view name) {
+    separate();
+    put('"');
+    raw(name);
+    raw("\":");
+    needs_comma = false;
+  }
+
+  void string(std::string_view text) {
+    separate();
+    put('"');
+    // Bytes that need no escape, including every byte of a multibyte UTF-8
+    // sequence, are copied in runs.
+    std::size_t run = 0;
+    for (std::size_t index = 0; index < text.size(); ++index) {
+      const auto byte = static_cast<unsigned char>(text[index]);
+      if (byte >= 0x20 && byte != '"' && byte != '\\') {
+        continue;
+      }
+      raw(text.substr(run, index - run));
+      escape(byte);
+      run = index + 1;
+    }
+    raw(text.substr(run));
+    put('"');
+    needs_comma = true;
+  }
+
+  void number(long long value) {
+    separate();
+    char digits[24];
+    char *end = digits + sizeof(digits);
+    char *begin = end;
+    unsigned long long magnitude =
+        value < 0 ? 0ULL - static_cast<unsigned long long>(value)
+                  : static_cast<unsigned long long>(value);
+    do {
+      *--begin = static_cast<char>('0' + magnitude % 10);
+      magnitude /= 10;
+    } while (magnitude != 0);
+    if (value < 0) {
+      *--begin = '-';
+    }
+    raw(std::string_view(begin, end - begin));
+    needs_comma = true;
+  }
+
+  void boolean(bool value) {
+    separate();
+    raw(value ? "true" : "false");
+    needs_comma = true;
+  }
+
+  void null() {
+    separate();
+    raw("null");
+    needs_comma = true;
+  }
+
+  // Text between values, such as the newline after an NDJSON record.
+  void raw(std::string_view text) {
+    if (text.empty()) {
+      return;
+    }
+    if (text.size() > sizeof(buffer) - used) {
+      flush();
+      if (text.size() > sizeof(buffer)) {
+        sink.append(text);
+        return;
+      }
+    }
+    std::memcpy(buffer + used, text.data(), text.size());
+    used += text.size();
+  }
+
+  void flush() {
+    if (used != 0) {
+      sink.append(std::string_view(buffer, used));
+      used = 0;
+    }
+  }
+
+private:
+  void put(char character) {
+    if (used == sizeof(buffer)) {
+      flush();
+    }
+    buffer[used++] = character;
+  }
+
+  void separate() {
+    if (needs_comma) {
+      put(',');
+    }
+  }
+
+  void open(char bracket) {
+    separate();
+    put(bracket);
+    needs_comma = false;
+  }
+
+  void close(char bracket) {
+    put(bracket);
+    needs_comma = true;
+  }
+
+  void escape(unsigned char byte) {
+    switch (byte) {
+    case '"':
+      raw("\\\"");
+      return;
+    case '\\':
+      raw("\\\\");
+      return;
+    case '\n':
+      raw("\\n");
+      return;
+    case '\r':
+      raw("\\r");
+      return;
+    case '\t':
+      raw("\\t");
+      return;
+    default:
+      break;
+    }
+    static const char hex[] = "0123456789abcdef";
+    const char sequence[] = {'\\', 'u', '0', '0', hex[byte >> 4],
+                             hex[byte & 0xF]};
+    raw(std::string_view(sequence, sizeof(sequence)));
+  }
+
+  ompparser::TextSink &sink;
+  char buffer[4096];
+  std::size_t used = 0;
+  bool needs_comma = false;
+};
+
+class JsonWriter : public ompparser::ConstOpenMPIRVisitor<JsonWriter> {
+public:
+  explicit JsonWriter(JsonOutput &out) : out(out) {}
+
+  void writeDirective(const OpenMPDirective &directive) {
+    out.beginObject();
+    field("directive", directive.getKind());
+    field("language", directive.getBaseLang());
+    location(directive);
+    dispatch(directive);
+    out.endObject();
+  }
+
+  void writeClause(const OpenMPClause &clause) {
+    out.beginObject();
+    field("clause", clause.OpenMPClause::getKind());
+    location(clause);
+    dispatch(clause);
+    out.endObject();
+  }
+
+  bool visitDirective(const OpenMPDirective &directive) {
+    const std::string &payload = directive.getImplementationDefinedPayload();
+    if (!payload.empty()) {
+      field("implementation_defined", payload);
+    }
+    out.key("clauses");
+    out.beginArray();
+    for (const OpenMPClause *clause : directive.getClausesInOriginalOrder()) {
+      optionalClause(clause);
+    }
+    out.endArray();
+    return true;
+  }
+
+  bool visitClause(const OpenMPClause &clause) {
+    if (clause.OpenMPClause::hasDirectiveNameModifier()) {
+      field("directive_name_modifier",
+            clause.OpenMPClause::getDirectiveNameModifier());
+    }
+    out.key("items");
+    out.beginArray();
+    for (const OpenMPExpressionItem &item : clause.getExpressionItems()) {
+      out.string(item.fragment.spelling);
+    }
+    out.endArray();
+    return true;
+  }
+
+  // Directives.
+  bool visitEndDirective(const OpenMPEndDirective &directive) {
+    field("paired_directive_role", directive.getPairedDirectiveRole());
+    field("paired_directive", directive.getPairedDirective());
+    field("end_argument", directive.getEndArgument());
+    return visitDirective(directive);
+  }
+  bool visitDeclareVariantDirective(
+      const OpenMPDeclareVariantDirective &directive) {
+    field("variant_function", directive.getVariantFuncFragment());
+    return visitDirective(directive);
+  }
+  bool visitAllocateDirective(const OpenMPAllocateDirective &directive) {
+    field("list", directive.getAllocateList());
+    return visitDirective(directive);
+  }
+  bool
+  visitThreadprivateDirective(const OpenMPThreadprivateDirective &directive) {
+    field("list", directive.getThreadprivateList());
+    return visitDirective(directive);
+  }
+  bool
+  visitGroupprivateDirective(const OpenMPGroupprivateDirective &directive) {
+    field("list", directive.getGroupprivateList());
+    return visitDirective(directive);
+  }
+  bool visitDeclareSimdDirective(const OpenMPDeclareSimdDirective &directive) {
+    field("proc_name", directive.getProcNameFragment());
+    return visitDirective(directive);
+  }
+  bool visitDeclareReductionDirective(
+      const OpenMPDeclareReductionDirective &directive) {
+    field("typenames", directive.getTypenameList());
+    field("identifier", directive.getIdentifier());
+    field("combiner", directive.getCombinerFragment());
+    return visitDirective(directive);
+  }
+  bool
+  visitDeclareMapperDirective(const OpenMPDeclareMapperDirective &directive) {
+    field("identifier", directive.getIdentifier());
+    field("user_defined_identifier",
+          directive.getUserDefinedIdentifierFragment());
+    field("type", directive.getDeclareMapperTypeFragment());
+    field("variable", directive.getDeclareMapperVarFragment());
+    return visitDirective(directive);
+  }
+  bool
+  visitDeclareTargetDirective(const OpenMPDeclareTargetDirective &directive) {
+    field("list", directive.getExtendedList());
+    return visitDirective(directive);
+  }
+  bool visitFlushDirective(const OpenMPFlushDirective &directive) {
+    field("list", directive.getFlushList());
+    return visitDirective(directive);
+  }
+  bool visitCriticalDirective(const OpenMPCriticalDirective &directive) {
+    field("name", directive.getCriticalNameFragment());
+    return visitDirective(directive);
+  }
+  bool visitDepobjDirective(const OpenMPDepobjDirective &directive) {
+    field("depobj", directive.getDepobjFragment());
+    return visitDirective(directive);
+  }
+
+  // Clauses.
+  bool visitIfClause(const OpenMPIfClause &clause) {
+    field("modifier", clause.getModifier());
+    field("user_defined_modifier", clause.getUserDefinedModifierFragment());
+    return visitClause(clause);
+  }
+  bool visitNumThreadsClause(const OpenMPNumThreadsClause &clause) {
+    field("strict", clause.isStrict());
+    return visitClause(clause);
+  }
+  bool visitDefaultClause(const OpenMPDefaultClause &clause) {
+    field("kind", clause.getDefaultClauseKind());
+    field("category", clause.getCategory());
+    field("variant_directive", clause.getVariantDirective());
+    return visitClause(clause);
+  }
+  bool visitFirstprivateClause(const OpenMPFirstprivateClause &clause) {
+    field("saved", clause.isSaved());
+    out.key("current_directive_name_modifier");
+    if (clause.hasDirectiveNameModifier()) {
+      out.string(kindName(clause.getDirectiveNameModifier()));
+    } else {
+      out.null();
+    }
+    return visitClause(clause);
+  }
+  bool visitReductionClause(const OpenMPReductionClause &clause) {
+    field("modifier", clause.getModifier());
+    field("identifier", clause.getIdentifier());
+    field("user_defined_identifier",
+          clause.getUserDefinedIdentifierFragment());
+    return visitClause(clause);
+  }
+  bool visitProcBindClause(const OpenMPProcBindClause &clause) {
+    field("kind", clause.getProcBindClauseKind());
+    return visitClause(clause);
+  }
+  bool visitAllocateClause(const OpenMPAllocateClause &clause) {
+    field("allocator", clause.getAllocator());
+    field("user_defined_allocator", clause.getUserDefinedAllocatorFragment());
+    field("alignment", clause.getAlignmentFragment());
+    return visitClause(clause);
+  }
+  bool visitLastprivateClause(const OpenMPLastprivateClause &clause) {
+    field("modifier", clause.getModifier());
+    return visitClause(clause);
+  }
+  bool visitOrderClause(const OpenMPOrderClause &clause) {
+    field("modifier", clause.getOrderClauseModifier());
+    field("kind", clause.getOrderClauseKind());
+    return visitClause(clause);
+  }
+  bool visitLinearClause(const OpenMPLinearClause &clause) {
+    field("modifier", clause.getModifier());
+    field("step", clause.getUserDefinedStepFragment());
+    return visitClause(clause);
+  }
+  bool visitScheduleClause(const OpenMPScheduleClause &clause) {
+    field("modifier1", clause.getModifier1());
+    field("modifier2", clause.getModifier2());
+    field("kind", clause.getKind());
+    field("user_defined_kind", clause.getUserDefinedKindFragment());
+    field("chunk_size", clause.getChunkSizeFragment());
+    return visitClause(clause);
+  }
+  bool visitAlignedClause(const OpenMPAlignedClause &clause) {
+    field("alignment", clause.getUserDefinedAlignmentFragment());
+    return visitClause(clause);
+  }
+  bool visitDistScheduleClause(const OpenMPDistScheduleClause &clause) {
+    field("kind", clause.getKind());
+    field("chunk_size", clause.getChunkSizeFragment());
+    return visitClause(clause);
+  }
+  bool visitBindClause(const OpenMPBindClause &clause) {
+    field("binding", clause.getBindClauseBinding());
+    return visitClause(clause);
+  }
+  bool visitAllocatorClause(const OpenMPAllocatorClause &clause) {
+    field("allocator", clause.getAllocator());
+    field("user_defined_allocator", clause.getUserDefinedAllocatorFragment());
+    return visitClause(clause);
+  }
+  bool visitInitializerClause(const OpenMPInitializerClause &clause) {
+    field("priv", clause.getPriv());
+    return visitClause(clause);
+  }
+  bool visitInReductionClause(const OpenMPInReductionClause &clause) {
+    field("identifier", clause.getIdentifier());
+    field("user_defined_identifier",
+          clause.getUserDefinedIdentifierFragment());
+    return visitClause(clause);
+  }
+  bool visitDependClause(const OpenMPDependClause &clause) {
+    field("modifier", clause.getModifier());
+    field("type", clause.getType());
+    field("dependence_vector", clause.getDependenceVectorFragment());
+    field("iterators", clause.getIterators());
+    return visitClause(clause);
+  }
+  bool visitAffinityClause(const OpenMPAffinityClause &clause) {
+    field("modifier", clause.getModifier());
+    field("iterators", clause.getIterators());
+    return visitClause(clause);
+  }
+  bool visitGrainsizeClause(const OpenMPGrainsizeClause &clause) {
+    field("modifier", clause.getModifier());
+    return visitClause(clause);
+  }
+  bool visitNumTasksClause(const OpenMPNumTasksClause &clause) {
+    field("modifier", clause.getModifier());
+    return visitClause(clause);
+  }
+  bool visitAtomicDefaultMemOrderClause(
+      const OpenMPAtomicDefaultMemOrderClause &clause) {
+    field("kind", clause.getKind());
+    return visitClause(clause);
+  }
+  bool visitExtImplementationDefinedRequirementClause(
+      const OpenMPExtImplementationDefinedRequirementClause &clause) {
+    field("requirement", clause.getImplementationDefinedRequirement());
+    return visitClause(clause);
+  }
+  bool visitDeviceClause(const OpenMPDeviceClause &clause) {
+    field("modifier", clause.getModifier());
+    return visitClause(clause);
+  }
+  bool visitMapClause(const OpenMPMapClause &clause) {
+    field("modifier1", clause.getModifier1());
+    field("modifier2", clause.getModifier2());
+    field("modifier3", clause.getModifier3());
+    field("type", clause.getType());
+    field("ref_modifier", clause.getRefModifier());
+    field("mapper", clause.getMapperIdentifierFragment());
+    field("iterators", clause.getIterators());
+    out.key("dist_data");
+    out.beginArray();
+    for (const auto &policies : clause.getDistDataPolicies()) {
+      out.beginArray();
+      for (const OpenMPMapClause::DistDataPolicy &policy : policies) {
+        out.beginObject();
+        field("kind", policy.kind);
+        field("argument", policy.argument);
+        out.endObject();
+      }
+      out.endArray();
+    }
+    out.endArray();
+    return visitClause(clause);
+  }
+  bool visitDefaultmapClause(const OpenMPDefaultmapClause &clause) {
+    field("behavior", clause.getBehavior());
+    field("category", clause.getCategory());
+    return visitClause(clause);
+  }
+  bool visitToClause(const OpenMPToClause &clause) {
+    field("kind", clause.getKind());
+    field("mapper", clause.getMapperIdentifierFragment());
+    field("iterators", clause.getIterators());
+    return visitClause(clause);
+  }
+  bool visitFromClause(const OpenMPFromClause &clause) {
+    field("kind", clause.getKind());
+    field("mapper", clause.getMapperIdentifierFragment());
+    field("iterators", clause.getIterators());
+    return visitClause(clause);
+  }
+  bool visitUsesAllocatorsClause(const OpenMPUsesAllocatorsClause &clause) {
+    out.key("allocators");
+    out.beginArray();
+    for (const usesAllocatorParameter *parameter :
+         clause.getUsesAllocatorsAllocatorSequence()) {
+      if (parameter == nullptr) {
+        out.null();
+        continue;
+      }
+      out.beginObject();
+      field("allocator", parameter->getUsesAllocatorsAllocator());
+      field("traits", parameter->getAllocatorTraitsArrayFragment());
+      field("user", parameter->getAllocatorUserFragment());
+      out.endObject();
+    }
+    out.endArray();
+    return visitClause(clause);
+  }
+  bool visitVariantClause(const OpenMPVariantClause &clause) {
+    out.key("trait_sets");
+    out.beginArray();
+    for (const OpenMPVariantClause::TraitSetSelector &set :
+         clause.getTraitSets()) {
+      out.beginObject();
+      field("set", set.kind);
+      out.key("selectors");
+      out.beginArray();
+      for (const OpenMPVariantClause::TraitSelector &selector : set.selectors) {
+        traitSelector(selector);
+      }
+      out.endArray();
+      out.endObject();
+    }
+    out.endArray();
+    return visitClause(clause);
+  }
+  bool visitWhenClause(const OpenMPWhenClause &clause) {
+    field("variant_directive", clause.getVariantDirective());
+    return visitVariantClause(clause);
+  }
+  bool visitOtherwiseClause(const OpenMPOtherwiseClause &clause) {
+    field("variant_directive", clause.getVariantDirective());
+    return visitVariantClause(clause);
+  }
+  bool visitDeviceTypeClause(const OpenMPDeviceTypeClause &clause) {
+    field("kind", clause.getDeviceTypeClauseKind());
+    return visitClause(clause);
+  }
+  bool visitTaskReductionClause(const OpenMPTaskReductionClause &clause) {
+    field("identifier", clause.getIdentifier());
+    field("user_defined_identifier",
+          clause.getUserDefinedIdentifierFragment());
+    return visitClause(clause);
+  }
+  bool visitDepobjUpdateClause(const OpenMPDepobjUpdateClause &clause) {
+    field("type", clause.getType());
+    return visitClause(clause);
+  }
+  bool visitFailClause(const OpenMPFailClause &clause) {
+    field("memory_order", clause.getMemoryOrder());
+    return visitClause(clause);
+  }
+  bool visitAtClause(const OpenMPAtClause &clause) {
+    field("kind", clause.getAtKind());
+    return visitClause(clause);
+  }
+  bool visitSeverityClause(const OpenMPSeverityClause &clause) {
+    field("kind", clause.getSeverityKind());
+    return visitClause(clause);
+  }
+  bool visitDoacrossClause(const OpenMPDoacrossClause &clause) {
+    field("type", clause.getType());
+    return visitClause(clause);
+  }
+  bool visitAbsentClause(const OpenMPAbsentClause &clause) {
+    field("directives", clause.getDirectives());
+    return visitClause(clause);
+  }
+  bool visitContainsClause(const OpenMPContainsClause &clause) {
+    field("directives", clause.getDirectives());
+    return visitClause(clause);
+  }
+  bool visitMemscopeClause(const OpenMPMemscopeClause &clause) {
+    field("scope", clause.getScope());
+    return visitClause(clause);
+  }
+  bool visitInitClause(const OpenMPInitClause &clause) {
+    field("modifiers", clause.getModifiers());
+    field("operand", clause.getOperandFragment());
+    return visitClause(clause);
+  }
+  bool visitInductionClause(const OpenMPInductionClause &clause) {
+    out.key("specification");
+    out.beginArray();
+    clause.visitSpecificationItems(
+        [this](OpenMPInductionClause::SpecificationItemKind kind,
+               const ompparser::HostFragment *label,
+               const ompparser::HostFragment &expression) {
+          out.beginObject();
+          field("kind", kind);
+          out.key("label");
+          if (label != nullptr) {
+            out.string(label->spelling);
+          } else {
+            out.null();
+          }
+          field("expression", expression);
+          out.endObject();
+        });
+    out.endArray();
+    return visitClause(clause);
+  }
+  bool visitAdjustArgsClause(const OpenMPAdjustArgsClause &clause) {
+    field("modifier", clause.getModifier());
+    field("arguments", clause.getArguments());
+    return visitClause(clause);
+  }
+  bool visitAppendArgsClause(const OpenMPAppendArgsClause &clause) {
+    out.key("operations");
+    out.beginArray();
+    for (const OpenMPAppendArgsClause::Operation &operation :
+         clause.getOperations()) {
+      out.beginObject();
+      field("kind", operation.kind);
+      field("modifiers", operation.modifiers);
+      out.endObject();
+    }
+    out.endArray();
+    return visitClause(clause);
+  }
+  bool visitApplyClause(const OpenMPApplyClause &clause) {
+    field("label", clause.getLabelFragment());
+    out.key("transformations");
+    out.beginArray();
+    for (const OpenMPApplyClause::ApplyTransform &transform :
+         clause.getTransformations()) {
+      out.beginObject();
+      field("kind", transform.kind);
+      field("argument", transform.argument);
+      out.key("nested_apply");
+      optionalClause(transform.nested_apply.get());
+      out.endObject();
+    }
+    out.endArray();
+    return visitClause(clause);
+  }
+
+private:
+  template <typename Enum,
+            typename = std::enable_if_t<std::is_enum_v<Enum>>>
+  void field(std::string_view name, Enum value) {
+    out.key(name);
+    out.string(kindName(value));
+  }
+  void field(std::string_view name, bool value) {
+    out.key(name);
+    out.boolean(value);
+  }
+  void field(std::string_view name, const std::string &text) {
+    out.key(name);
+    out.string(text);
+  }
+  void field(std::string_view name,
+             const ompparser::HostFragment &host_fragment) {
+    out.key(name);
+    out.string(host_fragment.spelling);
+  }
+  void field(std::string_view name,
+             const std::vector<ompparser::HostFragment> &host_fragments) {
+    out.key(name);
+    out.beginArray();
+    for (const ompparser::HostFragment &host_fragment : host_fragments) {
+      out.string(host_fragment.spelling);
+    }
+    out.endArray();
+  }
+  void field(std::string_view name, const std::vector<OpenMPIterator> &list) {
+    out.key(name);
+    out.beginArray();
+    for (const OpenMPIterator &iterator : list) {
+      out.beginObject();
+      field("qualifier", iterator.qualifier);
+      field("variable", iterator.variable);
+      field("begin", iterator.begin);
+      field("end", iterator.end);
+      field("step", iterator.step);
+      out.endObject();
+    }
+    out.endArray();
+  }
+  void field(std::string_view name, const OpenMPInitModifierList &list) {
+    out.key(name);
+    out.beginArray();
+    for (const OpenMPInitModifier &modifier : list.getModifiers()) {
+      out.beginObject();
+      field("category", modifier.category);
+      field("interop_type", modifier.interop_type);
+      field("directive_name", modifier.directive_name);
+      field("dependence_type", modifier.dependence_type);
+      field("argument", modifier.argument);
+      out.endObject();
+    }
+    out.endArray();
+  }
+  void field(std::string_view name,
+             const std::vector<OpenMPDirectiveKind> &kinds) {
+    out.key(name);
+    out.beginArray();
+    for (OpenMPDirectiveKind kind : kinds) {
+      out.string(kindName(kind));
+    }
+    out.endArray();
+  }
+  void field(std::string_view name, const OpenMPDirective *directive) {
+    out.key(name);
+    if (directive != nullptr) {
+      writeDirective(*directive);
+    } else {
+      out.null();
+    }
+  }
+  template <typename Enum>
+  void field(std::string_view name, const std::optional<Enum> &value) {
+    out.key(name);
+    if (value.has_value()) {
+      out.string(kindName(*value));
+    } else {
+      out.null();
+    }
+  }
+
+  void location(const SourceLocation &node) {
+    out.key("line");
+    out.number(node.getLine());
+    out.key("column");
+    out.number(node.getColumn());
+  }
+
+  void optionalClause(const OpenMPClause *clause) {
+    if (clause != nullptr) {
+      writeClause(*clause);
+    } else {
+      out.null();
+    }
+  }
+
+  void traitSelector(const OpenMPVariantClause::TraitSelector &selector) {
+    out.beginObject();
+    field("kind", selector.kind);
+    field("score", selector.score);
+    field("name", selector.implementation_defined_name);
+    out.key("properties");
+    out.beginArray();
+    for (const OpenMPVariantClause::TraitProperty &property :
+         selector.properties) {
+      out.beginObject();
+      field("value", property.fragment);
+      field("context_kind", property.context_kind);
+      field("context_vendor", property.context_vendor);
+      field("atomic_default_mem_order", property.atomic_default_mem_order);
+      out.key("requirement");
+      optionalClause(property.requirement.get());
+      out.endObject();
+    }
+    out.endArray();
+    field("construct", selector.construct_directive.get());
+    out.endObject();
+  }
+
+  JsonOutput &out;
+};
+
+} // namespace
+
+namespace ompparser::detail {
+
+void writeJson(const OpenMPDirective &directive, TextSink &sink,
+               std::string_view terminator) {
+  JsonOutput out(sink);
+  JsonWriter(out).writeDirective(directive);
+  out.raw(terminator);
+  out.flush();
+}
+
+} // namespace ompparser::detail
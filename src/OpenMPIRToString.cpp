@@ -7,8 +7,11 @@
  */
 
 #include "OpenMPIR.h"
+#include "OpenMPSchema.h"
 
+#include <array>
 #include <cctype>
+#include <string_view>
 
 namespace {
 std::string formatDirectiveName(const char *name) {
@@ -20,42 +23,87 @@ std::string formatDirectiveName(const char *name) {
   return result;
 }
 
-std::string getDirectiveSpelling(OpenMPDirectiveKind kind) {
-  switch (kind) {
-#define OPENMP_DIRECTIVE(Name)                                                 \
-  case OMPD_##Name:                                                            \
-    return formatDirectiveName(#Name);
-#define OPENMP_DIRECTIVE_EXT(Name, Str)                                        \
-  case OMPD_##Name:                                                            \
-    return std::string(Str);
+// Spellings are formatted once; emitters append views of them.
+std::string_view getDirectiveSpelling(OpenMPDirectiveKind kind) {
+  static const std::array<std::string, ompparser::DirectiveKindCount>
+      spellings = [] {
+        std::array<std::string, ompparser::DirectiveKindCount> table;
+#define OPENMP_DIRECTIVE(Name) table[OMPD_##Name] = formatDirectiveName(#Name);
+#define OPENMP_DIRECTIVE_EXT(Name, Str) table[OMPD_##Name] = Str;
 #include "OpenMPKinds.def"
 #undef OPENMP_DIRECTIVE
 #undef OPENMP_DIRECTIVE_EXT
-  }
-  return std::string();
+        return table;
+      }();
+  const auto index = static_cast<std::size_t>(kind);
+  return index < spellings.size() ? std::string_view(spellings[index])
+                                  : std::string_view();
 }
 
-std::string getDirectiveNameModifierSpelling(OpenMPDirectiveKind kind) {
-  std::string result = getDirectiveSpelling(kind);
+std::string_view getDirectiveNameModifierSpelling(OpenMPDirectiveKind kind) {
+  std::string_view result = getDirectiveSpelling(kind);
   while (!result.empty() && result.back() == ' ') {
-    result.pop_back();
+    result.remove_suffix(1);
   }
   return result;
 }
 
-std::string getClauseSpelling(OpenMPClauseKind kind) {
+constexpr std::string_view getClauseSpelling(OpenMPClauseKind kind) {
   switch (kind) {
 #define OPENMP_CLAUSE(Name, Class)                                             \
   case OMPC_##Name:                                                            \
-    return std::string(#Name " ");
+    return #Name " ";
 #define OPENMP_CLAUSE_EXT(Name, Class, Str)                                    \
   case OMPC_##Name:                                                            \
-    return std::string(Str);
+    return Str;
 #include "OpenMPKinds.def"
 #undef OPENMP_CLAUSE_EXT
 #undef OPENMP_CLAUSE
   }
-  return std::string();
+  return std::string_view();
+}
+
+// The directive name as OpenMPDirective::toString spells it, with its
+// trailing space.
+void appendDirectiveSpelling(const OpenMPDirective &directive,
+                             std::string &result) {
+  switch (directive.getKind()) {
+  case OMPD_ompx: {
+    const std::string &payload = directive.getImplementationDefinedPayload();
+    if (!payload.empty()) {
+      result += payload;
+      result += ' ';
+    }
+    return;
+  }
+  case OMPD_parallel_do:
+    if (directive.getCompactParallelDo()) {
+      result += "paralleldo ";
+      return;
+    }
+    break;
+  case OMPD_declare_target:
+    if (directive.getDeclareTargetUnderscore()) {
+      result += "declare_target ";
+      return;
+    }
+    break;
+  case OMPD_begin_declare_target:
+    if (directive.getDeclareTargetUnderscore()) {
+      result += "begin declare_target ";
+      return;
+    }
+    break;
+  case OMPD_end_declare_target:
+    if (directive.getDeclareTargetUnderscore()) {
+      result += "end declare_target ";
+      return;
+    }
+    break;
+  default:
+    break;
+  }
+  result += getDirectiveSpelling(directive.getKind());
 }
 
 std::string withoutTrailingWhitespace(std::string value) {
@@ -66,7 +114,7 @@ std::string withoutTrailingWhitespace(std::string value) {
   return value;
 }
 
-std::string logicalReductionSpelling(OpenMPBaseLang language,
+const char *logicalReductionSpelling(OpenMPBaseLang language,
                                      bool conjunction) {
   if (language == Lang_Fortran) {
     return conjunction ? ".and." : ".or.";
@@ -78,7 +126,7 @@ std::string logicalReductionSpelling(OpenMPBaseLang language,
       "logical reduction identifier has no exact base language");
 }
 
-std::string equivalenceReductionSpelling(OpenMPBaseLang language,
+const char *equivalenceReductionSpelling(OpenMPBaseLang language,
                                          bool equivalent) {
   if (language != Lang_Fortran) {
     throw std::logic_error("equivalence reduction identifier requires Fortran");
@@ -86,7 +134,7 @@ std::string equivalenceReductionSpelling(OpenMPBaseLang language,
   return equivalent ? ".eqv." : ".neqv.";
 }
 
-std::string
+std::string_view
 getVariableCategorySpelling(OpenMPDefaultmapClauseCategory category) {
   switch (category) {
   case OMPC_DEFAULTMAP_CATEGORY_scalar:
@@ -100,26 +148,37 @@ getVariableCategorySpelling(OpenMPDefaultmapClauseCategory category) {
   case OMPC_DEFAULTMAP_CATEGORY_allocatable:
     return "allocatable";
   default:
-    return std::string();
+    return std::string_view();
   }
 }
 } // namespace
 
 std::string OpenMPDirective::generatePragmaString(std::string prefix) const {
+  std::string result;
+  std::string clause_buffer;
+  writePragmaString(result, clause_buffer, prefix);
+  return result;
+}
+
+void OpenMPDirective::writePragmaString(std::string &result,
+                                        std::string &clause_buffer,
+                                        std::string_view prefix) const {
 
   if (this->getBaseLang() == Lang_Fortran && prefix == "#pragma omp ") {
     prefix = (this->getFortranSentinel() == OMPFS_ompx) ? "!$ompx " : "!$omp ";
   };
-  std::string result = prefix;
+  result.assign(prefix.data(), prefix.size());
 
-  result += this->toString();
+  appendDirectiveSpelling(*this, result);
 
   switch (this->getKind()) {
 
   case OMPD_declare_variant: {
     const auto *declare_variant =
         static_cast<const OpenMPDeclareVariantDirective *>(this);
-    result += "(" + declare_variant->getVariantFuncID() + ") ";
+    result += '(';
+    result += declare_variant->getVariantFuncID();
+    result += ") ";
     break;
   }
   case OMPD_allocate: {
@@ -271,7 +330,7 @@ std::string OpenMPDirective::generatePragmaString(std::string prefix) const {
     const OpenMPDirective *paired = end_directive->getPairedDirective();
     if (this->getBaseLang() == Lang_Fortran && paired != nullptr &&
         paired->getKind() == OMPD_do) {
-      result = prefix;
+      result.assign(prefix.data(), prefix.size());
       if (end_directive->getUseCompactEndDo()) {
         result += "enddo";
       } else {
@@ -284,10 +343,12 @@ std::string OpenMPDirective::generatePragmaString(std::string prefix) const {
       result += "metadirective ";
       goto default_case;
     } else if (paired != nullptr) {
-      result += paired->toString();
+      appendDirectiveSpelling(*paired, result);
       const std::string &argument = end_directive->getEndArgument().spelling;
       if (!argument.empty()) {
-        result += "(" + argument + ") ";
+        result += '(';
+        result += argument;
+        result += ") ";
       }
       goto default_case;
     }
@@ -355,7 +416,8 @@ std::string OpenMPDirective::generatePragmaString(std::string prefix) const {
           (*iter)->getKind() == OMPC_induction) {
         continue;
       }
-      std::string clause_str = (*iter)->toString();
+      (*iter)->writeString(clause_buffer);
+      const std::string &clause_str = clause_buffer;
       if (clause_str.empty()) {
         continue;
       }
@@ -384,11 +446,11 @@ std::string OpenMPDirective::generatePragmaString(std::string prefix) const {
       result.pop_back();
     }
   }
-  return result;
 };
 
 std::string OpenMPDirective::generateContextTraitString() const {
-  std::string result = toString();
+  std::string result;
+  appendDirectiveSpelling(*this, result);
   if (!result.empty() && result.back() == ' ') {
     result.pop_back();
   }
@@ -400,11 +462,12 @@ std::string OpenMPDirective::generateContextTraitString() const {
 
   result += "(";
   bool first = true;
+  std::string clause_text;
   for (OpenMPClause *clause : clauses) {
     if (clause == nullptr) {
       continue;
     }
-    std::string clause_text = clause->toString();
+    clause->writeString(clause_text);
     if (!clause_text.empty() && clause_text.back() == ' ') {
       clause_text.pop_back();
     }
@@ -423,44 +486,12 @@ std::string OpenMPDirective::generateContextTraitString() const {
 }
 
 std::string OpenMPDirective::toString() const {
-  switch (this->getKind()) {
-  case OMPD_ompx: {
-    const std::string &payload = this->getImplementationDefinedPayload();
-    if (payload.empty()) {
-      return std::string();
-    }
-    return payload + " ";
-  }
-  case OMPD_parallel_do:
-    if (this->getCompactParallelDo()) {
-      return "paralleldo ";
-    }
-    break;
-  case OMPD_declare_target:
-    if (this->getDeclareTargetUnderscore()) {
-      return "declare_target ";
-    }
-    break;
-  case OMPD_begin_declare_target:
-    if (this->getDeclareTargetUnderscore()) {
-      return "begin declare_target ";
-    }
-    break;
-  case OMPD_end_declare_target:
-    if (this->getDeclareTargetUnderscore()) {
-      return "end declare_target ";
-    }
-    break;
-  default:
-    break;
-  }
-
-  return getDirectiveSpelling(this->getKind());
-};
-
-std::string OpenMPClause::expressionToString() {
-
   std::string result;
+  appendDirectiveSpelling(*this, result);
+  return result;
+}
+
+void OpenMPClause::appendExpressions(std::string &result) const {
   for (size_t idx = 0; idx < expressions.size(); ++idx) {
     if (idx > 0) {
       result +=
@@ -468,44 +499,63 @@ std::string OpenMPClause::expressionToString() {
     }
     result += expressions[idx].fragment.spelling;
   }
+}
 
+std::string OpenMPClause::expressionToString() const {
+  std::string result;
+  appendExpressions(result);
   return result;
-};
+}
 
-std::string OpenMPClause::toString() {
+std::string OpenMPClause::toString() const {
+  std::string result;
+  writeString(result);
+  return result;
+}
 
-  std::string result = getClauseSpelling(this->getKind());
+void OpenMPClause::writeString(std::string &result) const {
+  result = getClauseSpelling(this->getKind());
 
-  std::string clause_string = "(";
+  const size_t open = result.size();
+  result += '(';
   if (this->hasDirectiveNameModifier()) {
-    std::string modifier =
+    std::string_view modifier =
         getDirectiveNameModifierSpelling(this->getDirectiveNameModifier());
     if (!modifier.empty()) {
-      clause_string += modifier;
-      clause_string += ": ";
+      result += modifier;
+      result += ": ";
     }
   }
-  clause_string += this->expressionToString();
-  clause_string += ")";
-  if (clause_string.size() > 2) {
-    // clang-format: space before ( only for 'if' clause
-    if (this->getKind() != OMPC_if && !result.empty() && result.back() == ' ') {
-      result.pop_back(); // Remove trailing space before (
-    }
-    result += clause_string;
-    result += " "; // Add space after )
+  appendExpressions(result);
+  if (result.size() == open + 1) {
+    result.resize(open);
+    return;
   }
-
-  return result;
-};
+  result += ") "; // Add space after )
+  // clang-format: space before ( only for 'if' clause
+  if (this->getKind() != OMPC_if && open > 0 && result[open - 1] == ' ') {
+    result.erase(open - 1, 1); // Remove trailing space before (
+  }
+}
 
 namespace {
-std::string iteratorToString(const std::string &qualifier,
-                             const std::string &var, const std::string &begin,
-                             const std::string &end, const std::string &step) {
-  std::string result;
+// Appends the clause expressions after one space, or nothing when they
+// spell nothing.
+void appendSpacedExpressions(const OpenMPClause &clause, std::string &result) {
+  const size_t separator = result.size();
+  result += ' ';
+  clause.appendExpressions(result);
+  if (result.size() == separator + 1) {
+    result.resize(separator);
+  }
+}
+
+void appendIterator(std::string &result, const std::string &qualifier,
+                    const std::string &var, const std::string &begin,
+                    const std::string &end, const std::string &step) {
   if (!qualifier.empty()) {
-    result += qualifier + " ";
+    result += qualifier;
+    result += ' ';
   }
   result += var;
   result += "=";
@@ -516,24 +566,19 @@ std::string iteratorToString(const std::string &qualifier,
     result += ":";
     result += step;
   }
-  return result;
 }
 } // namespace
 
-std::string OpenMPExtImplementationDefinedRequirementClause::toString() {
-  std::string result = "";
-  std::string parameter_string;
-
-  std::string ext_user_defined_implementation =
-      this->getImplementationDefinedRequirement();
-  result += "ext_" + ext_user_defined_implementation;
+void OpenMPExtImplementationDefinedRequirementClause::writeString(
+    std::string &result) const {
+  result = "ext_";
+  result += this->getImplementationDefinedRequirement();
   result += " ";
-  return result;
 };
 
-std::string OpenMPAtomicDefaultMemOrderClause::toString() {
-  std::string result = "atomic_default_mem_order(";
-  std::string parameter_string;
+void OpenMPAtomicDefaultMemOrderClause::writeString(std::string &result) const {
+  result = "atomic_default_mem_order(";
+  std::string_view parameter_string;
   OpenMPAtomicDefaultMemOrderClauseKind kind = this->getKind();
   switch (kind) {
   case OMPC_ATOMIC_DEFAULT_MEM_ORDER_seq_cst:
@@ -556,142 +601,140 @@ std::string OpenMPAtomicDefaultMemOrderClause::toString() {
   };
 
   if (parameter_string.size() > 0) {
-    result += parameter_string + ") ";
+    result += parameter_string;
+    result += ") ";
   } else {
-    return std::string();
+    result.clear();
+    return;
   }
-
-  return result;
 };
 
-std::string OpenMPInReductionClause::toString() {
-
-  std::string result = "in_reduction ";
-  std::string clause_string = "(";
+void OpenMPInReductionClause::writeString(std::string &result) const {
+  result = "in_reduction ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPInReductionClauseIdentifier identifier = this->getIdentifier();
   switch (identifier) {
   case OMPC_IN_REDUCTION_IDENTIFIER_plus:
-    clause_string += "+";
+    result += "+";
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_minus:
-    clause_string += "-";
+    result += "-";
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_mul:
-    clause_string += "*";
+    result += "*";
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_bitand:
-    clause_string += "&";
+    result += "&";
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_bitor:
-    clause_string += "|";
+    result += "|";
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_bitxor:
-    clause_string += "^";
+    result += "^";
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_logand:
-    clause_string += logicalReductionSpelling(getBaseLang(), true);
+    result += logicalReductionSpelling(getBaseLang(), true);
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_logor:
-    clause_string += logicalReductionSpelling(getBaseLang(), false);
+    result += logicalReductionSpelling(getBaseLang(), false);
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_eqv:
-    clause_string += equivalenceReductionSpelling(getBaseLang(), true);
+    result += equivalenceReductionSpelling(getBaseLang(), true);
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_neqv:
-    clause_string += equivalenceReductionSpelling(getBaseLang(), false);
+    result += equivalenceReductionSpelling(getBaseLang(), false);
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_min:
-    clause_string += "min";
+    result += "min";
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_max:
-    clause_string += "max";
+    result += "max";
     break;
   case OMPC_IN_REDUCTION_IDENTIFIER_user:
-    clause_string += this->getUserDefinedIdentifier();
+    result += this->getUserDefinedIdentifier();
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += " : ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += " : ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
+  }
 };
 
-std::string OpenMPDependClause::toString() {
+void OpenMPDependClause::writeString(std::string &result) const {
   OpenMPDependClauseModifier modifier = this->getModifier();
   const auto &iterator_defs = this->getIterators();
-  std::string result = "depend ";
-  std::string clause_string = "(";
+  result = "depend ";
+  const size_t open = result.size();
+  result += '(';
 
   OpenMPDependClauseType type = this->getType();
   if (modifier == OMPC_DEPEND_MODIFIER_iterator) {
-    clause_string += "iterator";
-    clause_string += " ( ";
+    result += "iterator";
+    result += " ( ";
     for (size_t i = 0; i < iterator_defs.size(); ++i) {
       if (i > 0) {
-        clause_string += ", ";
+        result += ", ";
       }
-      clause_string += iteratorToString(
-          iterator_defs[i].qualifier.spelling,
+      appendIterator(
+          result, iterator_defs[i].qualifier.spelling,
           iterator_defs[i].variable.spelling, iterator_defs[i].begin.spelling,
           iterator_defs[i].end.spelling, iterator_defs[i].step.spelling);
     }
-    clause_string += " )";
+    result += " )";
   }
 
-  if (clause_string.size() > 1) {
-    clause_string += ", ";
+  if (result.size() - open > 1) {
+    result += ", ";
   };
   switch (type) {
   case OMPC_DEPENDENCE_TYPE_in:
-    clause_string += "in";
+    result += "in";
     break;
   case OMPC_DEPENDENCE_TYPE_out:
-    clause_string += "out";
+    result += "out";
     break;
   case OMPC_DEPENDENCE_TYPE_inout:
-    clause_string += "inout";
+    result += "inout";
     break;
   case OMPC_DEPENDENCE_TYPE_inoutset:
-    clause_string += "inoutset";
+    result += "inoutset";
     break;
   case OMPC_DEPENDENCE_TYPE_mutexinoutset:
-    clause_string += "mutexinoutset";
+    result += "mutexinoutset";
     break;
   case OMPC_DEPENDENCE_TYPE_depobj:
-    clause_string += "depobj";
+    result += "depobj";
     break;
   case OMPC_DEPENDENCE_TYPE_source:
-    clause_string += "source";
+    result += "source";
     break;
   case OMPC_DEPENDENCE_TYPE_sink:
-    clause_string += "sink";
+    result += "sink";
     break;
   default:;
   }
 
-  if (clause_string.size() > 1 && type != OMPC_DEPENDENCE_TYPE_source) {
-    clause_string += " : ";
+  if (result.size() - open > 1 && type != OMPC_DEPENDENCE_TYPE_source) {
+    result += " : ";
   };
   if (type == OMPC_DEPENDENCE_TYPE_sink) {
-    clause_string += this->getDependenceVector();
+    result += this->getDependenceVector();
+  }
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
   }
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    result += clause_string;
-  };
-  return result;
 };
 
-std::string OpenMPDoacrossClause::toString() {
-  std::string result = "doacross (";
+void OpenMPDoacrossClause::writeString(std::string &result) const {
+  result = "doacross (";
 
   OpenMPDoacrossClauseType type = this->getType();
   switch (type) {
@@ -706,7 +749,8 @@ std::string OpenMPDoacrossClause::toString() {
   }
 
   if (type == OMPC_DOACROSS_TYPE_source && this->hasSourceExpression()) {
-    result += " " + this->getSourceExpression().fragment.spelling;
+    result += " ";
+    result += this->getSourceExpression().fragment.spelling;
   } else if (type == OMPC_DOACROSS_TYPE_sink) {
     const auto &args = this->getSinkArgs();
     for (size_t idx = 0; idx < args.size(); ++idx) {
@@ -717,276 +761,245 @@ std::string OpenMPDoacrossClause::toString() {
     }
   } else {
     // Fallback to legacy expression list if present
-    std::string expr_string = this->expressionToString();
-    if (!expr_string.empty()) {
-      result += " " + expr_string;
-    }
+    appendSpacedExpressions(*this, result);
   }
 
   result += ") ";
-  return result;
 };
 
-std::string OpenMPDepobjUpdateClause::toString() {
-
-  std::string result = "update ";
-  std::string clause_string = "(";
+void OpenMPDepobjUpdateClause::writeString(std::string &result) const {
+  result = "update ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPDepobjUpdateClauseDependeceType type = this->getType();
   switch (type) {
   case OMPC_DEPOBJ_UPDATE_DEPENDENCE_TYPE_source:
-    clause_string += "source";
+    result += "source";
     break;
   case OMPC_DEPOBJ_UPDATE_DEPENDENCE_TYPE_in:
-    clause_string += "in";
+    result += "in";
     break;
   case OMPC_DEPOBJ_UPDATE_DEPENDENCE_TYPE_out:
-    clause_string += "out";
+    result += "out";
     break;
   case OMPC_DEPOBJ_UPDATE_DEPENDENCE_TYPE_inout:
-    clause_string += "inout";
+    result += "inout";
     break;
   case OMPC_DEPOBJ_UPDATE_DEPENDENCE_TYPE_inoutset:
-    clause_string += "inoutset";
+    result += "inoutset";
     break;
   case OMPC_DEPOBJ_UPDATE_DEPENDENCE_TYPE_mutexinoutset:
-    clause_string += "mutexinoutset";
+    result += "mutexinoutset";
     break;
   case OMPC_DEPOBJ_UPDATE_DEPENDENCE_TYPE_depobj:
-    clause_string += "depobj";
+    result += "depobj";
     break;
   case OMPC_DEPOBJ_UPDATE_DEPENDENCE_TYPE_sink:
-    clause_string += "sink";
+    result += "sink";
     break;
   default:;
   }
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    result += clause_string;
-  };
-
-  return result;
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
+  }
 };
 
-std::string OpenMPAffinityClause::toString() {
+void OpenMPAffinityClause::writeString(std::string &result) const {
   const auto &iterators_definition_class = this->getIteratorsDefinitionClass();
-  std::string result = "affinity ";
-  std::string clause_string = "(";
+  result = "affinity ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPAffinityClauseModifier modifier = this->getModifier();
   switch (modifier) {
   case OMPC_AFFINITY_MODIFIER_iterator:
-    clause_string += "iterator";
-    clause_string += " ( ";
+    result += "iterator";
+    result += " ( ";
     for (size_t i = 0; i < iterators_definition_class.size(); i++) {
       if (i > 0) {
-        clause_string += ", ";
+        result += ", ";
       }
-      clause_string +=
-          iteratorToString(iterators_definition_class[i].qualifier.spelling,
-                           iterators_definition_class[i].variable.spelling,
-                           iterators_definition_class[i].begin.spelling,
-                           iterators_definition_class[i].end.spelling,
-                           iterators_definition_class[i].step.spelling);
+      appendIterator(result, iterators_definition_class[i].qualifier.spelling,
+                     iterators_definition_class[i].variable.spelling,
+                     iterators_definition_class[i].begin.spelling,
+                     iterators_definition_class[i].end.spelling,
+                     iterators_definition_class[i].step.spelling);
     };
-    clause_string += " )";
+    result += " )";
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += " : ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += " : ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
+  }
 };
 
-std::string OpenMPToClause::toString() {
-
-  std::string result = "to ";
-  std::string clause_string = "(";
+void OpenMPToClause::writeString(std::string &result) const {
+  result = "to ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPToClauseKind to_kind = this->getKind();
   const auto &iterator_defs = this->getIterators();
   switch (to_kind) {
   case OMPC_TO_mapper:
-    clause_string += "mapper";
-    clause_string += "(";
-    clause_string += this->getMapperIdentifier();
-    clause_string += ")";
+    result += "mapper";
+    result += "(";
+    result += this->getMapperIdentifier();
+    result += ")";
     break;
   case OMPC_TO_iterator:
-    clause_string += "iterator";
-    clause_string += "(";
+    result += "iterator";
+    result += "(";
     for (size_t i = 0; i < iterator_defs.size(); ++i) {
       if (i > 0) {
-        clause_string += ", ";
+        result += ", ";
       }
-      clause_string += iteratorToString(
-          iterator_defs[i].qualifier.spelling,
+      appendIterator(
+          result, iterator_defs[i].qualifier.spelling,
           iterator_defs[i].variable.spelling, iterator_defs[i].begin.spelling,
           iterator_defs[i].end.spelling, iterator_defs[i].step.spelling);
     }
-    clause_string += ")";
+    result += ")";
     break;
   case OMPC_TO_present:
-    clause_string += "present";
+    result += "present";
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += " : ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    if (to_kind == OMPC_TO_iterator) {
-      if (!result.empty() && result.back() == ' ') {
-        result.pop_back();
-      }
-    } else if (!result.empty() && result.back() != ' ') {
-      result += " ";
-    }
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += " : ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
+  } else if (to_kind == OMPC_TO_iterator) {
+    result.erase(open - 1, 1);
+  }
 };
 
-std::string OpenMPFromClause::toString() {
-
-  std::string result = "from ";
-  std::string clause_string = "(";
+void OpenMPFromClause::writeString(std::string &result) const {
+  result = "from ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPFromClauseKind from_kind = this->getKind();
   const auto &iterator_defs = this->getIterators();
   switch (from_kind) {
   case OMPC_FROM_mapper:
-    clause_string += "mapper";
-    clause_string += "(";
-    clause_string += this->getMapperIdentifier();
-    clause_string += ")";
+    result += "mapper";
+    result += "(";
+    result += this->getMapperIdentifier();
+    result += ")";
     break;
   case OMPC_FROM_iterator:
-    clause_string += "iterator";
-    clause_string += "(";
+    result += "iterator";
+    result += "(";
     for (size_t i = 0; i < iterator_defs.size(); ++i) {
       if (i > 0) {
-        clause_string += ", ";
+        result += ", ";
       }
-      clause_string += iteratorToString(
-          iterator_defs[i].qualifier.spelling,
+      appendIterator(
+          result, iterator_defs[i].qualifier.spelling,
           iterator_defs[i].variable.spelling, iterator_defs[i].begin.spelling,
           iterator_defs[i].end.spelling, iterator_defs[i].step.spelling);
     }
-    clause_string += ")";
+    result += ")";
     break;
   case OMPC_FROM_present:
-    clause_string += "present";
+    result += "present";
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += " : ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    if (from_kind == OMPC_FROM_iterator) {
-      if (!result.empty() && result.back() == ' ') {
-        result.pop_back();
-      }
-    } else if (!result.empty() && result.back() != ' ') {
-      result += " ";
-    }
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += " : ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
+  } else if (from_kind == OMPC_FROM_iterator) {
+    result.erase(open - 1, 1);
+  }
 };
 
-std::string OpenMPDefaultmapClause::toString() {
-
-  std::string result = "defaultmap ";
-  std::string clause_string = "(";
+void OpenMPDefaultmapClause::writeString(std::string &result) const {
+  result = "defaultmap ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPDefaultmapClauseBehavior behavior = this->getBehavior();
   OpenMPDefaultmapClauseCategory category = this->getCategory();
   switch (behavior) {
   case OMPC_DEFAULTMAP_BEHAVIOR_alloc:
-    clause_string += "alloc";
+    result += "alloc";
     break;
   case OMPC_DEFAULTMAP_BEHAVIOR_to:
-    clause_string += "to";
+    result += "to";
     break;
   case OMPC_DEFAULTMAP_BEHAVIOR_from:
-    clause_string += "from";
+    result += "from";
     break;
   case OMPC_DEFAULTMAP_BEHAVIOR_tofrom:
-    clause_string += "tofrom";
+    result += "tofrom";
     break;
   case OMPC_DEFAULTMAP_BEHAVIOR_firstprivate:
-    clause_string += "firstprivate";
+    result += "firstprivate";
     break;
   case OMPC_DEFAULTMAP_BEHAVIOR_none:
-    clause_string += "none";
+    result += "none";
     break;
   case OMPC_DEFAULTMAP_BEHAVIOR_default:
-    clause_string += "default";
+    result += "default";
     break;
   case OMPC_DEFAULTMAP_BEHAVIOR_present:
-    clause_string += "present";
+    result += "present";
     break;
   default:;
   }
-  const std::string category_spelling = getVariableCategorySpelling(category);
+  const std::string_view category_spelling =
+      getVariableCategorySpelling(category);
   if (!category_spelling.empty()) {
-    clause_string += ": " + category_spelling;
+    result += ": ";
+    result += category_spelling;
+  }
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
   }
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    if (!result.empty() && result.back() != ' ') {
-      result += " ";
-    }
-    result += clause_string;
-  };
-
-  return result;
 };
 
-std::string OpenMPDeviceClause::toString() {
-
-  std::string result = "device ";
-  std::string clause_string = "(";
+void OpenMPDeviceClause::writeString(std::string &result) const {
+  result = "device ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPDeviceClauseModifier modifier = this->getModifier();
   switch (modifier) {
   case OMPC_DEVICE_MODIFIER_ancestor:
-    clause_string += "ancestor";
+    result += "ancestor";
     break;
   case OMPC_DEVICE_MODIFIER_device_num:
-    clause_string += "device_num";
+    result += "device_num";
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += " : ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    if (!result.empty() && result.back() != ' ') {
-      result += " ";
-    }
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += " : ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
+  }
 };
 
-std::string OpenMPDeviceTypeClause::toString() {
-
-  std::string result = "device_type (";
-  std::string parameter_string;
+void OpenMPDeviceTypeClause::writeString(std::string &result) const {
+  result = "device_type (";
+  std::string_view parameter_string;
   OpenMPDeviceTypeClauseKind device_type_kind = this->getDeviceTypeClauseKind();
   switch (device_type_kind) {
   case OMPC_DEVICE_TYPE_host:
@@ -1003,77 +1016,75 @@ std::string OpenMPDeviceTypeClause::toString() {
   };
 
   if (parameter_string.size() > 0) {
-    result += parameter_string + ") ";
+    result += parameter_string;
+    result += ") ";
   } else {
-    return std::string();
+    result.clear();
+    return;
   }
-
-  return result;
 }
 
-std::string OpenMPTaskReductionClause::toString() {
-
-  std::string result = "task_reduction ";
-  std::string clause_string = "(";
+void OpenMPTaskReductionClause::writeString(std::string &result) const {
+  result = "task_reduction ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPTaskReductionClauseIdentifier identifier = this->getIdentifier();
   switch (identifier) {
   case OMPC_TASK_REDUCTION_IDENTIFIER_plus:
-    clause_string += "+";
+    result += "+";
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_minus:
-    clause_string += "-";
+    result += "-";
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_mul:
-    clause_string += "*";
+    result += "*";
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_bitand:
-    clause_string += "&";
+    result += "&";
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_bitor:
-    clause_string += "|";
+    result += "|";
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_bitxor:
-    clause_string += "^";
+    result += "^";
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_logand:
-    clause_string += logicalReductionSpelling(getBaseLang(), true);
+    result += logicalReductionSpelling(getBaseLang(), true);
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_logor:
-    clause_string += logicalReductionSpelling(getBaseLang(), false);
+    result += logicalReductionSpelling(getBaseLang(), false);
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_eqv:
-    clause_string += equivalenceReductionSpelling(getBaseLang(), true);
+    result += equivalenceReductionSpelling(getBaseLang(), true);
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_neqv:
-    clause_string += equivalenceReductionSpelling(getBaseLang(), false);
+    result += equivalenceReductionSpelling(getBaseLang(), false);
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_min:
-    clause_string += "min";
+    result += "min";
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_max:
-    clause_string += "max";
+    result += "max";
     break;
   case OMPC_TASK_REDUCTION_IDENTIFIER_user:
-    clause_string += this->getUserDefinedIdentifier();
+    result += this->getUserDefinedIdentifier();
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += " : ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 3) {
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += " : ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 3) {
+    result.resize(open);
+  }
 };
 
-std::string OpenMPMapClause::toString() {
-
-  std::string result = "map ";
-  std::string clause_string = "(";
+void OpenMPMapClause::writeString(std::string &result) const {
+  result = "map ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPMapClauseModifier modifier1 = this->getModifier1();
   OpenMPMapClauseModifier modifier2 = this->getModifier2();
   OpenMPMapClauseModifier modifier3 = this->getModifier3();
@@ -1085,26 +1096,26 @@ std::string OpenMPMapClause::toString() {
 
   switch (ref_modifier) {
   case OMPC_MAP_REF_MODIFIER_ref_ptee:
-    clause_string += "ref_ptee";
+    result += "ref_ptee";
     has_content = true;
     break;
   case OMPC_MAP_REF_MODIFIER_ref_ptr:
-    clause_string += "ref_ptr";
+    result += "ref_ptr";
     has_content = true;
     break;
   case OMPC_MAP_REF_MODIFIER_ref_ptr_ptee:
-    clause_string += "ref_ptr_ptee";
+    result += "ref_ptr_ptee";
     has_content = true;
     break;
   default:;
   }
 
   // Helper to append modifier text with separator
-  auto append_modifier = [&](const std::string &text) {
+  auto append_modifier = [&](const char *text) {
     if (has_content) {
-      clause_string += ", ";
+      result += ", ";
     }
-    clause_string += text;
+    result += text;
     has_content = true;
   };
 
@@ -1123,28 +1134,28 @@ std::string OpenMPMapClause::toString() {
     break;
   case OMPC_MAP_MODIFIER_mapper:
     if (has_content) {
-      clause_string += ", ";
+      result += ", ";
     }
-    clause_string += "mapper(";
-    clause_string += this->getMapperIdentifier();
-    clause_string += ")";
+    result += "mapper(";
+    result += this->getMapperIdentifier();
+    result += ")";
     has_content = true;
     break;
   case OMPC_MAP_MODIFIER_iterator: {
     if (has_content) {
-      clause_string += ", ";
+      result += ", ";
     }
-    clause_string += "iterator(";
+    result += "iterator(";
     for (size_t i = 0; i < iterator_defs.size(); ++i) {
       if (i > 0) {
-        clause_string += ", ";
+        result += ", ";
       }
-      clause_string += iteratorToString(
-          iterator_defs[i].qualifier.spelling,
+      appendIterator(
+          result, iterator_defs[i].qualifier.spelling,
           iterator_defs[i].variable.spelling, iterator_defs[i].begin.spelling,
           iterator_defs[i].end.spelling, iterator_defs[i].step.spelling);
     }
-    clause_string += ")";
+    result += ")";
     has_content = true;
     break;
   }
@@ -1165,11 +1176,11 @@ std::string OpenMPMapClause::toString() {
     break;
   case OMPC_MAP_MODIFIER_mapper:
     if (has_content) {
-      clause_string += ", ";
+      result += ", ";
     }
-    clause_string += "mapper(";
-    clause_string += this->getMapperIdentifier();
-    clause_string += ")";
+    result += "mapper(";
+    result += this->getMapperIdentifier();
+    result += ")";
     has_content = true;
     break;
   default:;
@@ -1189,11 +1200,11 @@ std::string OpenMPMapClause::toString() {
     break;
   case OMPC_MAP_MODIFIER_mapper:
     if (has_content) {
-      clause_string += ", ";
+      result += ", ";
     }
-    clause_string += "mapper(";
-    clause_string += this->getMapperIdentifier();
-    clause_string += ")";
+    result += "mapper(";
+    result += this->getMapperIdentifier();
+    result += ")";
     has_content = true;
     break;
   default:;
@@ -1229,180 +1240,172 @@ std::string OpenMPMapClause::toString() {
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += " : ";
+  if (result.size() - open > 1) {
+    result += " : ";
   };
   const auto &items = this->getItems();
   const auto &dist_data = this->getDistDataPolicies();
   if (!items.empty()) {
     for (size_t idx = 0; idx < items.size(); ++idx) {
       if (idx > 0) {
-        clause_string +=
+        result +=
             (items[idx].separator == OMPC_CLAUSE_SEP_comma) ? ", " : " ";
       }
-      clause_string += items[idx].fragment.spelling;
+      result += items[idx].fragment.spelling;
       if (idx < dist_data.size() && !dist_data[idx].empty()) {
-        clause_string += " dist_data(";
+        result += " dist_data(";
         for (size_t policy_index = 0; policy_index < dist_data[idx].size();
              ++policy_index) {
           if (policy_index > 0) {
-            clause_string += ", ";
+            result += ", ";
           }
           const OpenMPMapClause::DistDataPolicy &policy =
               dist_data[idx][policy_index];
           switch (policy.kind) {
           case OpenMPMapClause::DIST_DATA_duplicate:
-            clause_string += "duplicate";
+            result += "duplicate";
             break;
           case OpenMPMapClause::DIST_DATA_block:
-            clause_string += "block";
+            result += "block";
             break;
           case OpenMPMapClause::DIST_DATA_cyclic:
-            clause_string += "cyclic";
+            result += "cyclic";
             break;
           case OpenMPMapClause::DIST_DATA_unknown:
             break;
           }
           if (!policy.argument.spelling.empty()) {
-            clause_string += "(" + policy.argument.spelling + ")";
+            result += '(';
+            result += policy.argument.spelling;
+            result += ')';
           }
         }
-        clause_string += ")";
+        result += ")";
       }
     }
   } else {
-    clause_string += this->expressionToString();
+    appendExpressions(result);
   }
-  clause_string += ")";
-  if (clause_string.size() > 2) {
+  result += ")";
+  if (result.size() - open <= 2) {
+    result.resize(open);
+  } else {
     // clang-format: no space before ( for map clause
-    if (!result.empty() && result.back() == ' ') {
-      result.pop_back();
-    }
-    result += clause_string;
+    result.erase(open - 1, 1);
     result += " ";
-  };
-
-  return result;
+  }
 };
 
-std::string OpenMPReductionClause::toString() {
-
-  std::string result = "reduction ";
-  std::string clause_string = "(";
+void OpenMPReductionClause::writeString(std::string &result) const {
+  result = "reduction ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPReductionClauseModifier modifier = this->getModifier();
   OpenMPReductionClauseIdentifier identifier = this->getIdentifier();
   switch (modifier) {
   case OMPC_REDUCTION_MODIFIER_default:
-    clause_string += "default";
+    result += "default";
     break;
   case OMPC_REDUCTION_MODIFIER_inscan:
-    clause_string += "inscan";
+    result += "inscan";
     break;
   case OMPC_REDUCTION_MODIFIER_task:
-    clause_string += "task";
+    result += "task";
     break;
   case OMPC_REDUCTION_MODIFIER_original_private:
-    clause_string += "original(private)";
+    result += "original(private)";
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += ", ";
+  if (result.size() - open > 1) {
+    result += ", ";
   }
   switch (identifier) {
   case OMPC_REDUCTION_IDENTIFIER_plus:
-    clause_string += "+";
+    result += "+";
     break;
   case OMPC_REDUCTION_IDENTIFIER_minus:
-    clause_string += "-";
+    result += "-";
     break;
   case OMPC_REDUCTION_IDENTIFIER_mul:
-    clause_string += "*";
+    result += "*";
     break;
   case OMPC_REDUCTION_IDENTIFIER_bitand:
-    clause_string += "&";
+    result += "&";
     break;
   case OMPC_REDUCTION_IDENTIFIER_bitor:
-    clause_string += "|";
+    result += "|";
     break;
   case OMPC_REDUCTION_IDENTIFIER_bitxor:
-    clause_string += "^";
+    result += "^";
     break;
   case OMPC_REDUCTION_IDENTIFIER_logand:
-    clause_string += logicalReductionSpelling(getBaseLang(), true);
+    result += logicalReductionSpelling(getBaseLang(), true);
     break;
   case OMPC_REDUCTION_IDENTIFIER_logor:
-    clause_string += logicalReductionSpelling(getBaseLang(), false);
+    result += logicalReductionSpelling(getBaseLang(), false);
     break;
   case OMPC_REDUCTION_IDENTIFIER_eqv:
-    clause_string += equivalenceReductionSpelling(getBaseLang(), true);
+    result += equivalenceReductionSpelling(getBaseLang(), true);
     break;
   case OMPC_REDUCTION_IDENTIFIER_neqv:
-    clause_string += equivalenceReductionSpelling(getBaseLang(), false);
+    result += equivalenceReductionSpelling(getBaseLang(), false);
     break;
   case OMPC_REDUCTION_IDENTIFIER_min:
-    clause_string += "min";
+    result += "min";
     break;
   case OMPC_REDUCTION_IDENTIFIER_max:
-    clause_string += "max";
+    result += "max";
     break;
   case OMPC_REDUCTION_IDENTIFIER_user:
-    clause_string += this->getUserDefinedIdentifier();
+    result += this->getUserDefinedIdentifier();
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += " : ";
+  if (result.size() - open > 1) {
+    result += " : ";
   };
   const auto &operands = this->getOperands();
   for (size_t idx = 0; idx < operands.size(); ++idx) {
     if (idx > 0) {
-      clause_string +=
+      result +=
           (operands[idx].separator == OMPC_CLAUSE_SEP_comma) ? ", " : " ";
     }
-    clause_string += operands[idx].fragment.spelling;
+    result += operands[idx].fragment.spelling;
   }
-  clause_string += ")";
-  if (clause_string.size() > 2) {
+  result += ")";
+  if (result.size() - open <= 2) {
+    result.resize(open);
+  } else {
     // clang-format: no space before ( for reduction clause
-    if (!result.empty() && result.back() == ' ') {
-      result.pop_back();
-    }
-    result += clause_string;
+    result.erase(open - 1, 1);
     result += " ";
-  };
-
-  return result;
+  }
 };
 
-std::string OpenMPLastprivateClause::toString() {
-
-  std::string result = "lastprivate ";
-  std::string clause_string = "(";
+void OpenMPLastprivateClause::writeString(std::string &result) const {
+  result = "lastprivate ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPLastprivateClauseModifier modifier = this->getModifier();
   switch (modifier) {
   case OMPC_LASTPRIVATE_MODIFIER_conditional:
-    clause_string += "conditional";
+    result += "conditional";
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += ": ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 2) {
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += ": ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 2) {
+    result.resize(open);
+  }
 };
 
-std::string OpenMPLinearClause::toString() {
-
-  std::string result = "linear ";
-  std::string clause_string = "(";
+void OpenMPLinearClause::writeString(std::string &result) const {
+  result = "linear (";
   OpenMPLinearClauseModifier modifier = this->getModifier();
   bool has_modifier = (modifier != OMPC_LINEAR_MODIFIER_unspecified);
   bool modifier_first = this->isModifierFirstSyntax();
@@ -1414,228 +1417,213 @@ std::string OpenMPLinearClause::toString() {
     // Modifier-first syntax: linear(mod(vars))
     switch (modifier) {
     case OMPC_LINEAR_MODIFIER_val:
-      clause_string += "val";
+      result += "val";
       break;
     case OMPC_LINEAR_MODIFIER_ref:
-      clause_string += "ref";
+      result += "ref";
       break;
     case OMPC_LINEAR_MODIFIER_uval:
-      clause_string += "uval";
+      result += "uval";
       break;
     default:;
     }
-    clause_string += "( ";
-    clause_string += this->expressionToString();
-    clause_string += ") ";
+    result += "( ";
+    appendExpressions(result);
+    result += ") ";
     if (has_step) {
-      clause_string += ":";
+      result += ":";
     }
   } else {
     // Variable-first syntax: linear(vars) or linear(vars: mod) or linear(vars:
     // mod, step)
-    clause_string += this->expressionToString();
+    appendExpressions(result);
     if (has_modifier) {
-      clause_string += " : ";
+      result += " : ";
       switch (modifier) {
       case OMPC_LINEAR_MODIFIER_val:
-        clause_string += "val";
+        result += "val";
         break;
       case OMPC_LINEAR_MODIFIER_ref:
-        clause_string += "ref";
+        result += "ref";
         break;
       case OMPC_LINEAR_MODIFIER_uval:
-        clause_string += "uval";
+        result += "uval";
         break;
       default:;
       }
     }
     if (has_step) {
       if (has_modifier) {
-        clause_string += ", ";
+        result += ", ";
       } else {
-        clause_string += ":";
+        result += ":";
       }
     }
   }
   if (has_step) {
-    clause_string += user_defined_step;
+    result += user_defined_step;
   }
-  clause_string += ") ";
-  result += clause_string;
-  return result;
+  result += ") ";
 };
 
-std::string OpenMPAlignedClause::toString() {
-
-  std::string result = "aligned ";
-  std::string clause_string = "(";
-  clause_string += this->expressionToString();
+void OpenMPAlignedClause::writeString(std::string &result) const {
+  result = "aligned (";
+  appendExpressions(result);
   if (this->getUserDefinedAlignment() != "") {
-    clause_string += ":";
-    clause_string += this->getUserDefinedAlignment();
+    result += ":";
+    result += this->getUserDefinedAlignment();
   }
-  clause_string += ") ";
-  result += clause_string;
-  return result;
+  result += ") ";
 };
 
-std::string OpenMPDistScheduleClause::toString() {
-
-  std::string result = "dist_schedule ";
-  std::string clause_string = "(";
+void OpenMPDistScheduleClause::writeString(std::string &result) const {
+  result = "dist_schedule (";
   OpenMPDistScheduleClauseKind kind = this->getKind();
   switch (kind) {
   case OMPC_DIST_SCHEDULE_KIND_static:
-    clause_string += "static";
+    result += "static";
     break;
   default:;
   }
   if (this->getChunkSize() != "") {
-    clause_string += ", ";
-    clause_string += this->getChunkSize();
+    result += ", ";
+    result += this->getChunkSize();
   }
-  clause_string += ") ";
-  result += clause_string;
-  return result;
+  result += ") ";
 };
 
-std::string OpenMPScheduleClause::toString() {
-
-  std::string result = "schedule ";
-  std::string clause_string = "(";
+void OpenMPScheduleClause::writeString(std::string &result) const {
+  result = "schedule ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPScheduleClauseModifier modifier1 = this->getModifier1();
   OpenMPScheduleClauseModifier modifier2 = this->getModifier2();
   OpenMPScheduleClauseKind kind = this->getKind();
   switch (modifier1) {
   case OMPC_SCHEDULE_MODIFIER_monotonic:
-    clause_string += "monotonic";
+    result += "monotonic";
     break;
   case OMPC_SCHEDULE_MODIFIER_nonmonotonic:
-    clause_string += "nonmonotonic";
+    result += "nonmonotonic";
     break;
   case OMPC_SCHEDULE_MODIFIER_simd:
-    clause_string += "simd";
+    result += "simd";
     break;
   default:;
   }
   switch (modifier2) {
   case OMPC_SCHEDULE_MODIFIER_monotonic:
-    clause_string += ",monotonic";
+    result += ",monotonic";
     break;
   case OMPC_SCHEDULE_MODIFIER_nonmonotonic:
-    clause_string += ",nonmonotonic";
+    result += ",nonmonotonic";
     break;
   case OMPC_SCHEDULE_MODIFIER_simd:
-    clause_string += ",simd";
+    result += ",simd";
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += ":";
+  if (result.size() - open > 1) {
+    result += ":";
   }
   switch (kind) {
   case OMPC_SCHEDULE_KIND_static:
-    clause_string += "static";
+    result += "static";
     break;
   case OMPC_SCHEDULE_KIND_dynamic:
-    clause_string += "dynamic";
+    result += "dynamic";
     break;
   case OMPC_SCHEDULE_KIND_guided:
-    clause_string += "guided";
+    result += "guided";
     break;
   case OMPC_SCHEDULE_KIND_auto:
-    clause_string += "auto";
+    result += "auto";
     break;
   case OMPC_SCHEDULE_KIND_runtime:
-    clause_string += "runtime";
+    result += "runtime";
     break;
   default:;
   }
   if (this->getChunkSize() != "") {
-    clause_string += ", ";
-    clause_string += this->getChunkSize();
+    result += ", ";
+    result += this->getChunkSize();
   }
-  clause_string += ")";
-  if (clause_string.size() > 2) {
+  result += ")";
+  if (result.size() - open <= 2) {
+    result.resize(open);
+  } else {
     // clang-format: no space before ( for schedule clause
-    if (!result.empty() && result.back() == ' ') {
-      result.pop_back();
-    }
-    result += clause_string;
+    result.erase(open - 1, 1);
     result += " ";
-  };
-
-  return result;
+  }
 };
 
-std::string OpenMPIfClause::toString() {
-
-  std::string result = "if ";
-  std::string clause_string = "(";
+void OpenMPIfClause::writeString(std::string &result) const {
+  result = "if ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPIfClauseModifier modifier = this->getModifier();
   switch (modifier) {
   case OMPC_IF_MODIFIER_parallel:
-    clause_string += "parallel";
+    result += "parallel";
     break;
   case OMPC_IF_MODIFIER_simd:
-    clause_string += "simd";
+    result += "simd";
     break;
   case OMPC_IF_MODIFIER_task:
-    clause_string += "task";
+    result += "task";
     break;
   case OMPC_IF_MODIFIER_taskloop:
-    clause_string += "taskloop";
+    result += "taskloop";
     break;
   case OMPC_IF_MODIFIER_teams:
-    clause_string += "teams";
+    result += "teams";
     break;
   case OMPC_IF_MODIFIER_task_iteration:
-    clause_string += "task_iteration";
+    result += "task_iteration";
     break;
   case OMPC_IF_MODIFIER_taskgraph:
-    clause_string += "taskgraph";
+    result += "taskgraph";
     break;
   case OMPC_IF_MODIFIER_cancel:
-    clause_string += "cancel";
+    result += "cancel";
     break;
   case OMPC_IF_MODIFIER_target_data:
-    clause_string += "target data";
+    result += "target data";
     break;
   case OMPC_IF_MODIFIER_target_enter_data:
-    clause_string += "target enter data";
+    result += "target enter data";
     break;
   case OMPC_IF_MODIFIER_target_exit_data:
-    clause_string += "target exit data";
+    result += "target exit data";
     break;
   case OMPC_IF_MODIFIER_target:
-    clause_string += "target";
+    result += "target";
     break;
   case OMPC_IF_MODIFIER_target_update:
-    clause_string += "target update";
+    result += "target update";
     break;
   default:;
   }
-  if (clause_string.size() > 1) {
-    clause_string += ": ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 2) {
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += ": ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 2) {
+    result.resize(open);
+  }
 };
 
-std::string OpenMPFirstprivateClause::toString() {
-  std::string result;
+void OpenMPFirstprivateClause::writeString(std::string &result) const {
+  result.clear();
   if (expressions.empty()) {
-    return result;
+    return;
   }
   result = "firstprivate(";
   bool emitted_modifier = false;
   if (hasDirectiveNameModifier()) {
-    const std::string modifier =
+    const std::string_view modifier =
         getDirectiveNameModifierSpelling(getDirectiveNameModifier());
     if (!modifier.empty()) {
       result += modifier;
@@ -1652,28 +1640,25 @@ std::string OpenMPFirstprivateClause::toString() {
   if (emitted_modifier) {
     result += ": ";
   }
-  result += expressionToString();
+  appendExpressions(result);
   result += ") ";
-  return result;
 }
 
-std::string OpenMPInitializerClause::toString() {
-
-  std::string result = "initializer";
-  std::string clause_string = "(";
-  std::string priv = this->expressionToString();
-  clause_string += priv;
-  clause_string += ")";
-  if (clause_string.size() > 2) {
-    result += clause_string;
+void OpenMPInitializerClause::writeString(std::string &result) const {
+  result = "initializer";
+  const size_t open = result.size();
+  result += '(';
+  appendExpressions(result);
+  result += ")";
+  if (result.size() - open <= 2) {
+    result.resize(open);
+  } else {
     result += " ";
-  };
-
-  return result;
+  }
 };
 
-std::string OpenMPApplyClause::toString() {
-  std::string result = "apply(";
+void OpenMPApplyClause::writeString(std::string &result) const {
+  result = "apply(";
   bool need_colon = false;
   if (!label.spelling.empty()) {
     result += label.spelling;
@@ -1699,7 +1684,9 @@ std::string OpenMPApplyClause::toString() {
       case OMPC_APPLY_TRANSFORM_unroll_partial:
         result += "unroll partial";
         if (!t.argument.spelling.empty()) {
-          result += "(" + t.argument.spelling + ")";
+          result += '(';
+          result += t.argument.spelling;
+          result += ')';
         }
         break;
       case OMPC_APPLY_TRANSFORM_unroll_full:
@@ -1715,7 +1702,9 @@ std::string OpenMPApplyClause::toString() {
         result += "nothing";
         break;
       case OMPC_APPLY_TRANSFORM_tile_sizes:
-        result += "tile sizes(" + t.argument.spelling + ")";
+        result += "tile sizes(";
+        result += t.argument.spelling;
+        result += ')';
         break;
       case OMPC_APPLY_TRANSFORM_apply:
         if (t.nested_apply) {
@@ -1737,7 +1726,6 @@ std::string OpenMPApplyClause::toString() {
   }
   result += ")";
   result += " ";
-  return result;
 }
 
 std::string OpenMPInductionClause::specificationToString() const {
@@ -1750,13 +1738,17 @@ std::string OpenMPInductionClause::specificationToString() const {
     }
     switch (item.kind) {
     case ItemStep:
-      result += "step(" + step_expression.spelling + ")";
+      result += "step(";
+      result += step_expression.spelling;
+      result += ')';
       break;
     case ItemBinding:
       if (item.index < bindings.size()) {
         const auto &binding = bindings[item.index];
         if (!binding.label.spelling.empty()) {
-          result += binding.label.spelling + ": " + binding.expression.spelling;
+          result += binding.label.spelling;
+          result += ": ";
+          result += binding.expression.spelling;
         } else {
           result += binding.expression.spelling;
         }
@@ -1774,128 +1766,138 @@ std::string OpenMPInductionClause::specificationToString() const {
   return result;
 }
 
-std::string OpenMPInductionClause::toString() {
-  std::string result = "induction(";
+void OpenMPInductionClause::writeString(std::string &result) const {
+  result = "induction(";
   result += specificationToString();
   result += ") ";
-  return result;
 }
 
-std::string OpenMPAllocateClause::toString() {
-
-  std::string result = "allocate ";
-  std::string clause_string = "(";
+void OpenMPAllocateClause::writeString(std::string &result) const {
+  result = "allocate ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPAllocateClauseAllocator allocator = this->getAllocator();
-  std::vector<std::string> parameters;
+  const char *predefined_allocator = nullptr;
   switch (allocator) {
   case OMPC_ALLOCATE_ALLOCATOR_default:
-    parameters.emplace_back("omp_default_mem_alloc");
+    predefined_allocator = "omp_default_mem_alloc";
     break;
   case OMPC_ALLOCATE_ALLOCATOR_large_cap:
-    parameters.emplace_back("omp_large_cap_mem_alloc");
+    predefined_allocator = "omp_large_cap_mem_alloc";
     break;
   case OMPC_ALLOCATE_ALLOCATOR_cons_mem:
-    parameters.emplace_back("omp_const_mem_alloc");
+    predefined_allocator = "omp_const_mem_alloc";
     break;
   case OMPC_ALLOCATE_ALLOCATOR_high_bw:
-    parameters.emplace_back("omp_high_bw_mem_alloc");
+    predefined_allocator = "omp_high_bw_mem_alloc";
     break;
   case OMPC_ALLOCATE_ALLOCATOR_low_lat:
-    parameters.emplace_back("omp_low_lat_mem_alloc");
+    predefined_allocator = "omp_low_lat_mem_alloc";
     break;
   case OMPC_ALLOCATE_ALLOCATOR_cgroup:
-    parameters.emplace_back("omp_cgroup_mem_alloc");
+    predefined_allocator = "omp_cgroup_mem_alloc";
     break;
   case OMPC_ALLOCATE_ALLOCATOR_pteam:
-    parameters.emplace_back("omp_pteam_mem_alloc");
+    predefined_allocator = "omp_pteam_mem_alloc";
     break;
   case OMPC_ALLOCATE_ALLOCATOR_thread:
-    parameters.emplace_back("omp_thread_mem_alloc");
+    predefined_allocator = "omp_thread_mem_alloc";
     break;
   default:;
   }
   if (usesAllocatorModifierSyntax() || hasAlignModifier()) {
-    parameters.clear();
+    bool first = true;
     for (ModifierKind modifier : getModifierOrder()) {
+      if (!first) {
+        result += ", ";
+      }
+      first = false;
       if (modifier == ModifierKind::Allocator) {
-        parameters.push_back("allocator(" + getUserDefinedAllocator() + ")");
+        result += "allocator(";
+        result += getUserDefinedAllocator();
       } else {
-        parameters.push_back("align(" + getAlignment() + ")");
+        result += "align(";
+        result += getAlignment();
       }
+      result += ')';
     }
-  } else if (!getUserDefinedAllocator().empty()) {
-    parameters.push_back(getUserDefinedAllocator());
-  }
-  for (size_t i = 0; i < parameters.size(); ++i) {
-    if (i > 0) {
-      clause_string += ", ";
+  } else {
+    if (predefined_allocator != nullptr) {
+      result += predefined_allocator;
+    }
+    if (!getUserDefinedAllocator().empty()) {
+      if (predefined_allocator != nullptr) {
+        result += ", ";
+      }
+      result += getUserDefinedAllocator();
     }
-    clause_string += parameters[i];
   }
-  if (clause_string.size() > 1) {
-    clause_string += ": ";
-  };
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 2) {
-    result += clause_string;
+  if (result.size() - open > 1) {
+    result += ": ";
   };
-
-  return result;
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 2) {
+    result.resize(open);
+  }
 };
 
-std::string OpenMPAllocatorClause::toString() {
-
-  std::string result = "allocator ";
-  std::string clause_string = "(";
+void OpenMPAllocatorClause::writeString(std::string &result) const {
+  result = "allocator ";
+  const size_t open = result.size();
+  result += '(';
   OpenMPAllocatorClauseAllocator allocator = this->getAllocator();
   switch (allocator) {
   case OMPC_ALLOCATOR_ALLOCATOR_default:
-    clause_string += "omp_default_mem_alloc";
+    result += "omp_default_mem_alloc";
     break;
   case OMPC_ALLOCATOR_ALLOCATOR_large_cap:
-    clause_string += "omp_large_cap_mem_alloc";
+    result += "omp_large_cap_mem_alloc";
     break;
   case OMPC_ALLOCATOR_ALLOCATOR_cons_mem:
-    clause_string += "omp_const_mem_alloc";
+    result += "omp_const_mem_alloc";
     break;
   case OMPC_ALLOCATOR_ALLOCATOR_high_bw:
-    clause_string += "omp_high_bw_mem_alloc";
+    result += "omp_high_bw_mem_alloc";
     break;
   case OMPC_ALLOCATOR_ALLOCATOR_low_lat:
-    clause_string += "omp_low_lat_mem_alloc";
+    result += "omp_low_lat_mem_alloc";
     break;
   case OMPC_ALLOCATOR_ALLOCATOR_cgroup:
-    clause_string += "omp_cgroup_mem_alloc";
+    result += "omp_cgroup_mem_alloc";
     break;
   case OMPC_ALLOCATOR_ALLOCATOR_pteam:
-    clause_string += "omp_pteam_mem_alloc";
+    result += "omp_pteam_mem_alloc";
     break;
   case OMPC_ALLOCATOR_ALLOCATOR_thread:
-    clause_string += "omp_thread_mem_alloc";
+    result += "omp_thread_mem_alloc";
     break;
   default:;
   }
   if (this->getUserDefinedAllocator() != "") {
-    clause_string += this->getUserDefinedAllocator();
+    result += this->getUserDefinedAllocator();
+  }
+  appendExpressions(result);
+  result += ") ";
+  if (result.size() - open <= 2) {
+    result.resize(open);
   }
-  clause_string += this->expressionToString();
-  clause_string += ") ";
-  if (clause_string.size() > 2) {
-    result += clause_string;
-  };
-
-  return result;
 };
 
-std::string OpenMPVariantClause::toString() {
+void OpenMPVariantClause::writeString(std::string &result) const {
   const OpenMPClauseKind clause_kind = getKind();
   if (clause_kind == OMPC_otherwise) {
-    OpenMPDirective *directive =
-        static_cast<OpenMPOtherwiseClause *>(this)->getVariantDirective();
-    return directive == nullptr
-               ? "otherwise "
-               : "otherwise (" + directive->generatePragmaString("") + ") ";
+    const OpenMPDirective *directive =
+        static_cast<const OpenMPOtherwiseClause *>(this)
+            ->getVariantDirective();
+    if (directive == nullptr) {
+      result = "otherwise ";
+      return;
+    }
+    result = "otherwise (";
+    result += directive->generatePragmaString("");
+    result += ") ";
+    return;
   }
   if (clause_kind != OMPC_when && clause_kind != OMPC_match) {
     std::cerr << "OMPPARSER_INVARIANT[variant-clause]: invalid clause kind\n";
@@ -1907,16 +1909,6 @@ std::string OpenMPVariantClause::toString() {
     std::abort();
   }
 
-  auto join = [](const std::vector<std::string> &values) {
-    std::string result;
-    for (std::size_t index = 0; index < values.size(); ++index) {
-      if (index != 0) {
-        result += ", ";
-      }
-      result += values[index];
-    }
-    return result;
-  };
   auto contextKindName = [](OpenMPClauseContextKind kind) -> const char * {
     switch (kind) {
     case OMPC_CONTEXT_KIND_host:
@@ -1993,7 +1985,8 @@ std::string OpenMPVariantClause::toString() {
     std::abort();
   };
 
-  std::vector<std::string> set_strings;
+  result = clause_kind == OMPC_when ? "when (" : "match (";
+  bool first_set = true;
   for (const TraitSetSelector &set : trait_sets) {
     const char *set_name = nullptr;
     switch (set.kind) {
@@ -2017,9 +2010,19 @@ std::string OpenMPVariantClause::toString() {
       std::cerr << "OMPPARSER_INVARIANT[variant-set]: invalid selector set\n";
       std::abort();
     }
+    if (!first_set) {
+      result += ", ";
+    }
+    first_set = false;
+    result += set_name;
+    result += " = {";
 
-    std::vector<std::string> selector_strings;
+    bool first_selector = true;
     for (const TraitSelector &selector : set.selectors) {
+      if (!first_selector) {
+        result += ", ";
+      }
+      first_selector = false;
       if (selector.kind == OMPC_TRAIT_construct) {
         if (selector.construct_directive == nullptr ||
             !selector.score.spelling.empty() || !selector.properties.empty()) {
@@ -2027,78 +2030,47 @@ std::string OpenMPVariantClause::toString() {
               << "OMPPARSER_INVARIANT[variant-construct]: malformed selector\n";
           std::abort();
         }
-        selector_strings.push_back(
-            selector.construct_directive->generateContextTraitString());
+        result += selector.construct_directive->generateContextTraitString();
         continue;
       }
 
-      std::vector<std::string> property_strings;
-      for (const TraitProperty &property : selector.properties) {
-        const bool expression = !property.fragment.spelling.empty();
-        const bool context_kind = property.context_kind.has_value();
-        const bool context_vendor = property.context_vendor.has_value();
-        const bool atomic_order = property.atomic_default_mem_order.has_value();
-        const bool requirement = property.requirement != nullptr;
-        if (static_cast<int>(expression) + static_cast<int>(context_kind) +
-                static_cast<int>(context_vendor) +
-                static_cast<int>(atomic_order) +
-                static_cast<int>(requirement) !=
-            1) {
-          std::cerr << "OMPPARSER_INVARIANT[variant-property]: invalid typed "
-                       "payload\n";
-          std::abort();
-        }
-        if (expression) {
-          property_strings.push_back(property.fragment.spelling);
-        } else if (context_kind) {
-          property_strings.push_back(contextKindName(*property.context_kind));
-        } else if (context_vendor) {
-          property_strings.push_back(vendorName(*property.context_vendor));
-        } else if (atomic_order) {
-          property_strings.push_back(
-              atomicOrderName(*property.atomic_default_mem_order));
-        } else {
-          property_strings.push_back(
-              withoutTrailingWhitespace(property.requirement->toString()));
-        }
-      }
-      const std::string properties = join(property_strings);
-      const std::string scored_properties =
-          selector.score.spelling.empty()
-              ? properties
-              : "score(" + selector.score.spelling + "): " + properties;
-
+      const char *selector_name = nullptr;
+      bool scored = true;
       switch (selector.kind) {
       case OMPC_TRAIT_condition:
-        selector_strings.push_back("condition(" + scored_properties + ")");
+        selector_name = "condition";
         break;
       case OMPC_TRAIT_kind:
-        selector_strings.push_back("kind(" + properties + ")");
+        selector_name = "kind";
+        scored = false;
         break;
       case OMPC_TRAIT_arch:
-        selector_strings.push_back("arch(" + properties + ")");
+        selector_name = "arch";
+        scored = false;
         break;
       case OMPC_TRAIT_isa:
-        selector_strings.push_back("isa(" + properties + ")");
+        selector_name = "isa";
+        scored = false;
         break;
       case OMPC_TRAIT_device_num:
-        selector_strings.push_back("device_num(" + properties + ")");
+        selector_name = "device_num";
+        scored = false;
         break;
       case OMPC_TRAIT_uid:
-        selector_strings.push_back("uid(" + properties + ")");
+        selector_name = "uid";
+        scored = false;
         break;
       case OMPC_TRAIT_vendor:
-        selector_strings.push_back("vendor(" + scored_properties + ")");
+        selector_name = "vendor";
         break;
       case OMPC_TRAIT_extension:
-        selector_strings.push_back("extension(" + scored_properties + ")");
+        selector_name = "extension";
         break;
       case OMPC_TRAIT_requires:
-        selector_strings.push_back("requires(" + scored_properties + ")");
+        selector_name = "requires";
         break;
       case OMPC_TRAIT_atomic_default_mem_order:
-        selector_strings.push_back("atomic_default_mem_order(" +
-                                   scored_properties + ")");
+        selector_name = "atomic_default_mem_order";
         break;
       case OMPC_TRAIT_implementation_user:
         if (selector.implementation_defined_name.empty()) {
@@ -2106,35 +2078,81 @@ std::string OpenMPVariantClause::toString() {
                        "selector name\n";
           std::abort();
         }
-        selector_strings.push_back(properties.empty()
-                                       ? selector.implementation_defined_name
-                                       : selector.implementation_defined_name +
-                                             "(" + scored_properties + ")");
         break;
       case OMPC_TRAIT_construct:
         std::abort();
       }
+      if (selector_name != nullptr) {
+        result += selector_name;
+      } else {
+        result += selector.implementation_defined_name;
+      }
+      const size_t open = result.size();
+      result += '(';
+      if (scored && !selector.score.spelling.empty()) {
+        result += "score(";
+        result += selector.score.spelling;
+        result += "): ";
+      }
+      const size_t properties_begin = result.size();
+
+      bool first_property = true;
+      for (const TraitProperty &property : selector.properties) {
+        const bool expression = !property.fragment.spelling.empty();
+        const bool context_kind = property.context_kind.has_value();
+        const bool context_vendor = property.context_vendor.has_value();
+        const bool atomic_order = property.atomic_default_mem_order.has_value();
+        const bool requirement = property.requirement != nullptr;
+        if (static_cast<int>(expression) + static_cast<int>(context_kind) +
+                static_cast<int>(context_vendor) +
+                static_cast<int>(atomic_order) +
+                static_cast<int>(requirement) !=
+            1) {
+          std::cerr << "OMPPARSER_INVARIANT[variant-property]: invalid typed "
+                       "payload\n";
+          std::abort();
+        }
+        if (!first_property) {
+          result += ", ";
+        }
+        first_property = false;
+        if (expression) {
+          result += property.fragment.spelling;
+        } else if (context_kind) {
+          result += contextKindName(*property.context_kind);
+        } else if (context_vendor) {
+          result += vendorName(*property.context_vendor);
+        } else if (atomic_order) {
+          result += atomicOrderName(*property.atomic_default_mem_order);
+        } else {
+          result += withoutTrailingWhitespace(property.requirement->toString());
+        }
+      }
+      // An implementation-defined selector without properties is written
+      // as its bare name.
+      if (selector.kind == OMPC_TRAIT_implementation_user &&
+          result.size() == properties_begin) {
+        result.resize(open);
+        continue;
+      }
+      result += ')';
     }
-    set_strings.push_back(std::string(set_name) + " = {" +
-                          join(selector_strings) + "}");
+    result += '}';
   }
 
-  std::string result =
-      (clause_kind == OMPC_when ? "when (" : "match (") + join(set_strings);
   if (clause_kind == OMPC_when) {
-    result += " :";
-    OpenMPDirective *directive =
-        static_cast<OpenMPWhenClause *>(this)->getVariantDirective();
-    result +=
-        directive == nullptr ? " " : " " + directive->generatePragmaString("");
+    result += " : ";
+    const OpenMPDirective *directive =
+        static_cast<const OpenMPWhenClause *>(this)->getVariantDirective();
+    if (directive != nullptr) {
+      result += directive->generatePragmaString("");
+    }
   }
   result += ") ";
-  return result;
 };
 
-std::string OpenMPDefaultClause::toString() {
-
-  std::string result = "default (";
+void OpenMPDefaultClause::writeString(std::string &result) const {
+  result = "default (";
   std::string parameter_string;
   OpenMPDefaultClauseKind default_kind = this->getDefaultClauseKind();
   switch (default_kind) {
@@ -2159,22 +2177,21 @@ std::string OpenMPDefaultClause::toString() {
 
   if (parameter_string.size() > 0) {
     result += parameter_string;
-    const std::string category =
+    const std::string_view category =
         getVariableCategorySpelling(this->getCategory());
     if (!category.empty()) {
-      result += ": " + category;
+      result += ": ";
+      result += category;
     }
     result += ") ";
   } else {
-    return std::string();
+    result.clear();
+    return;
   }
-
-  return result;
 };
 
-std::string OpenMPScanClause::toString() {
-
-  std::string result;
+void OpenMPScanClause::writeString(std::string &result) const {
+  result.clear();
   switch (this->getKind()) {
   case OMPC_inclusive:
     result = "inclusive(";
@@ -2183,7 +2200,8 @@ std::string OpenMPScanClause::toString() {
     result = "exclusive(";
     break;
   default:
-    return std::string();
+    result.clear();
+    return;
   }
 
   const auto &ops = this->getOperands();
@@ -2195,14 +2213,12 @@ std::string OpenMPScanClause::toString() {
   }
 
   result += ") ";
-  return result;
 }
 
-std::string OpenMPOrderClause::toString() {
-
-  std::string result = "order (";
-  std::string modifier_string;
-  std::string parameter_string;
+void OpenMPOrderClause::writeString(std::string &result) const {
+  result = "order (";
+  std::string_view modifier_string;
+  std::string_view parameter_string;
 
   OpenMPOrderClauseModifier order_modifier = this->getOrderClauseModifier();
   switch (order_modifier) {
@@ -2227,9 +2243,11 @@ std::string OpenMPOrderClause::toString() {
   };
 
   if (parameter_string.size() > 0) {
-    result += modifier_string + parameter_string;
+    result += modifier_string;
+    result += parameter_string;
   } else {
-    return std::string();
+    result.clear();
+    return;
   }
 
   const auto &ops = this->getOperands();
@@ -2243,14 +2261,11 @@ std::string OpenMPOrderClause::toString() {
     }
   }
   result += ") ";
-
-  return result;
 };
 
-std::string OpenMPBindClause::toString() {
-
-  std::string result = "bind (";
-  std::string parameter_string;
+void OpenMPBindClause::writeString(std::string &result) const {
+  result = "bind (";
+  std::string_view parameter_string;
   OpenMPBindClauseBinding bind_binding = this->getBindClauseBinding();
   switch (bind_binding) {
   case OMPC_BIND_teams:
@@ -2267,18 +2282,17 @@ std::string OpenMPBindClause::toString() {
   };
 
   if (parameter_string.size() > 0) {
-    result += parameter_string + ") ";
+    result += parameter_string;
+    result += ") ";
   } else {
-    return std::string();
+    result.clear();
+    return;
   }
-
-  return result;
 };
 
-std::string OpenMPProcBindClause::toString() {
-
-  std::string result = "proc_bind (";
-  std::string parameter_string;
+void OpenMPProcBindClause::writeString(std::string &result) const {
+  result = "proc_bind (";
+  std::string_view parameter_string;
   OpenMPProcBindClauseKind proc_bind_kind = this->getProcBindClauseKind();
   switch (proc_bind_kind) {
   case OMPC_PROC_BIND_close:
@@ -2298,21 +2312,21 @@ std::string OpenMPProcBindClause::toString() {
   };
 
   if (parameter_string.size() > 0) {
-    result += parameter_string + ") ";
+    result += parameter_string;
+    result += ") ";
   } else {
-    return std::string();
+    result.clear();
+    return;
   }
-
-  return result;
 };
 
-std::string OpenMPUsesAllocatorsClause::toString() {
-  std::vector<usesAllocatorParameter *> *usesAllocatorsAllocatorSequence =
+void OpenMPUsesAllocatorsClause::writeString(std::string &result) const {
+  const std::vector<usesAllocatorParameter *> &usesAllocatorsAllocatorSequence =
       this->getUsesAllocatorsAllocatorSequence();
-  std::string result = "uses_allocators(";
+  result = "uses_allocators(";
   bool first = true;
-  for (unsigned int i = 0; i < usesAllocatorsAllocatorSequence->size(); i++) {
-    auto *entry = usesAllocatorsAllocatorSequence->at(i);
+  for (unsigned int i = 0; i < usesAllocatorsAllocatorSequence.size(); i++) {
+    auto *entry = usesAllocatorsAllocatorSequence.at(i);
     if (!first) {
       result += ", ";
     }
@@ -2347,9 +2361,12 @@ std::string OpenMPUsesAllocatorsClause::toString() {
       break;
     case OMPC_USESALLOCATORS_ALLOCATOR_unspecified: {
       if (!entry->getAllocatorTraitsArray().empty()) {
-        result += "traits(" + entry->getAllocatorTraitsArray() + ")";
+        result += "traits(";
+        result += entry->getAllocatorTraitsArray();
+        result += ')';
         if (!entry->getAllocatorUser().empty()) {
-          result += ":" + entry->getAllocatorUser();
+          result += ':';
+          result += entry->getAllocatorUser();
         }
       } else if (!entry->getAllocatorUser().empty()) {
         result += entry->getAllocatorUser();
@@ -2362,15 +2379,16 @@ std::string OpenMPUsesAllocatorsClause::toString() {
     if (entry->getUsesAllocatorsAllocator() !=
             OMPC_USESALLOCATORS_ALLOCATOR_unspecified &&
         !entry->getAllocatorTraitsArray().empty()) {
-      result += "(" + entry->getAllocatorTraitsArray() + ")";
+      result += '(';
+      result += entry->getAllocatorTraitsArray();
+      result += ')';
     }
   }
   result += ") ";
-  return result;
 };
 
-std::string OpenMPFailClause::toString() {
-  std::string result = "fail (";
+void OpenMPFailClause::writeString(std::string &result) const {
+  result = "fail (";
 
   OpenMPFailClauseMemoryOrder memory_order = this->getMemoryOrder();
   switch (memory_order) {
@@ -2388,11 +2406,10 @@ std::string OpenMPFailClause::toString() {
   }
 
   result += ") ";
-  return result;
 };
 
-std::string OpenMPSeverityClause::toString() {
-  std::string result = "severity (";
+void OpenMPSeverityClause::writeString(std::string &result) const {
+  result = "severity (";
 
   OpenMPSeverityClauseKind severity_kind = this->getSeverityKind();
   switch (severity_kind) {
@@ -2407,11 +2424,10 @@ std::string OpenMPSeverityClause::toString() {
   }
 
   result += ") ";
-  return result;
 };
 
-std::string OpenMPAtClause::toString() {
-  std::string result = "at (";
+void OpenMPAtClause::writeString(std::string &result) const {
+  result = "at (";
 
   OpenMPAtClauseKind at_kind = this->getAtKind();
   switch (at_kind) {
@@ -2426,60 +2442,73 @@ std::string OpenMPAtClause::toString() {
   }
 
   result += ") ";
-  return result;
 };
 
-std::string OpenMPGrainsizeClause::toString() {
-  std::string result = "grainsize (";
+void OpenMPGrainsizeClause::writeString(std::string &result) const {
+  result = "grainsize (";
 
   OpenMPGrainsizeClauseModifier modifier = this->getModifier();
   if (modifier == OMPC_GRAINSIZE_MODIFIER_strict) {
     result += "strict:";
   }
 
-  std::string expr_string = this->expressionToString();
-  if (expr_string.size() > 0) {
-    if (modifier == OMPC_GRAINSIZE_MODIFIER_strict) {
-      result += " " + expr_string;
-    } else {
-      result += expr_string;
-    }
+  if (modifier == OMPC_GRAINSIZE_MODIFIER_strict) {
+    appendSpacedExpressions(*this, result);
+  } else {
+    appendExpressions(result);
   }
 
   result += ") ";
-  return result;
 };
 
-std::string OpenMPNumTasksClause::toString() {
-  std::string result = "num_tasks (";
+void OpenMPNumTasksClause::writeString(std::string &result) const {
+  result = "num_tasks (";
 
   OpenMPNumTasksClauseModifier modifier = this->getModifier();
   if (modifier == OMPC_NUM_TASKS_MODIFIER_strict) {
     result += "strict:";
   }
 
-  std::string expr_string = this->expressionToString();
-  if (expr_string.size() > 0) {
-    if (modifier == OMPC_NUM_TASKS_MODIFIER_strict) {
-      result += " " + expr_string;
-    } else {
-      result += expr_string;
-    }
+  if (modifier == OMPC_NUM_TASKS_MODIFIER_strict) {
+    appendSpacedExpressions(*this, result);
+  } else {
+    appendExpressions(result);
   }
 
   result += ") ";
-  return result;
 };
 
-std::string OpenMPNumThreadsClause::toString() {
-  std::string result = "num_threads(";
+void OpenMPNumThreadsClause::writeString(std::string &result) const {
+  result = "num_threads(";
   if (this->isStrict()) {
     result += "strict:";
   }
-  std::string expr_string = this->expressionToString();
-  if (!expr_string.empty()) {
-    result += expr_string;
-  }
+  appendExpressions(result);
   result += ") ";
-  return result;
 };
+
+void OpenMPAbsentClause::writeString(std::string &result) const {
+  result = "absent(";
+  bool first = true;
+  for (auto kind : directive_list) {
+    if (!first) {
+      result += ", ";
+    }
+    result += getDirectiveNameModifierSpelling(kind);
+    first = false;
+  }
+  result += ") ";
+}
+
+void OpenMPContainsClause::writeString(std::string &result) const {
+  result = "contains(";
+  bool first = true;
+  for (auto kind : directive_list) {
+    if (!first) {
+      result += ", ";
+    }
+    result += getDirectiveNameModifierSpelling(kind);
+    first = false;
+  }
+  result += ") ";
+}
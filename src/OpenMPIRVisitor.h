@@ -0,0 +1,207 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPIRVISITOR_H
+#define OMPPARSER_OPENMPIRVISITOR_H
+
+#include "OpenMPIR.h"
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ompparser {
+
+// Concrete IR class used for each directive and clause kind. Kinds without a
+// dedicated subclass are represented by OpenMPDirective or OpenMPClause.
+template <OpenMPDirectiveKind Kind> struct OpenMPDirectiveNode {
+  using type = OpenMPDirective;
+};
+template <OpenMPClauseKind Kind> struct OpenMPClauseNode {
+  using type = OpenMPClause;
+};
+
+#define OPENMP_DIRECTIVE_NODE(Name, Class)                                     \
+  template <> struct OpenMPDirectiveNode<OMPD_##Name> {                        \
+    using type = OpenMP##Class;                                                \
+  };
+#define OPENMP_CLAUSE_NODE_KIND(Name, Class)                                   \
+  template <> struct OpenMPClauseNode<OMPC_##Name> {                           \
+    using type = OpenMP##Class;                                                \
+  };
+#include "OpenMPIRNodes.def"
+#undef OPENMP_CLAUSE_NODE_KIND
+#undef OPENMP_DIRECTIVE_NODE
+
+template <OpenMPDirectiveKind Kind>
+using OpenMPDirectiveNodeT = typename OpenMPDirectiveNode<Kind>::type;
+template <OpenMPClauseKind Kind>
+using OpenMPClauseNodeT = typename OpenMPClauseNode<Kind>::type;
+
+// Statically dispatched visitor over one IR node. Derived classes shadow the
+// typed visit hooks they care about; every hook returns false to stop a walk.
+// Unhandled hooks forward to the parent class hook, ending at visitDirective
+// and visitClause. Dispatch trusts the kind/class pairing listed in
+// OpenMPIRNodes.def, which the parser and addOpenMPClause always establish.
+template <typename Derived, bool IsConst> class OpenMPIRVisitorBase {
+public:
+  template <typename T> using Node = std::conditional_t<IsConst, const T, T>;
+
+  bool visitDirective(Node<OpenMPDirective> &) { return true; }
+  bool visitClause(Node<OpenMPClause> &) { return true; }
+
+#define OPENMP_DIRECTIVE_NODE(Name, Class)                                     \
+  bool visit##Class(Node<OpenMP##Class> &directive) {                          \
+    return derived().visitDirective(directive);                                \
+  }
+#define OPENMP_CLAUSE_NODE(Class, Parent)                                      \
+  bool visit##Class(Node<OpenMP##Class> &clause) {                             \
+    return derived().visit##Parent(clause);                                    \
+  }
+#include "OpenMPIRNodes.def"
+#undef OPENMP_CLAUSE_NODE
+#undef OPENMP_DIRECTIVE_NODE
+
+  bool dispatch(Node<OpenMPDirective> &directive) {
+    switch (directive.getKind()) {
+#define OPENMP_DIRECTIVE_NODE(Name, Class)                                     \
+  case OMPD_##Name:                                                            \
+    return derived().visit##Class(                                             \
+        static_cast<Node<OpenMP##Class> &>(directive));
+#include "OpenMPIRNodes.def"
+#undef OPENMP_DIRECTIVE_NODE
+    default:
+      return derived().visitDirective(directive);
+    }
+  }
+
+  bool dispatch(Node<OpenMPClause> &clause) {
+    // Some subclasses shadow getKind() with a clause-specific enumeration.
+    switch (clause.OpenMPClause::getKind()) {
+#define OPENMP_CLAUSE_NODE_KIND(Name, Class)                                   \
+  case OMPC_##Name:                                                            \
+    return derived().visit##Class(static_cast<Node<OpenMP##Class> &>(clause));
+#include "OpenMPIRNodes.def"
+#undef OPENMP_CLAUSE_NODE_KIND
+    default:
+      return derived().visitClause(clause);
+    }
+  }
+
+protected:
+  Derived &derived() { return *static_cast<Derived *>(this); }
+};
+
+template <typename Derived>
+using OpenMPIRVisitor = OpenMPIRVisitorBase<Derived, false>;
+template <typename Derived>
+using ConstOpenMPIRVisitor = OpenMPIRVisitorBase<Derived, true>;
+
+// Pre-order walk over a directive, its clauses in source order and every
+// directive nested in them: the complete begin directive of a paired end,
+// metadirective when/otherwise/default variants, construct selectors and
+// requires-selector clauses.
+template <typename Derived, bool IsConst>
+class RecursiveOpenMPIRVisitorBase
+    : public OpenMPIRVisitorBase<Derived, IsConst> {
+  using Base = OpenMPIRVisitorBase<Derived, IsConst>;
+
+public:
+  template <typename T> using Node = typename Base::template Node<T>;
+
+  bool traverseDirective(Node<OpenMPDirective> &directive) {
+    if (!this->derived().dispatch(directive)) {
+      return false;
+    }
+    if (directive.getKind() == OMPD_end) {
+      auto &end_directive = static_cast<Node<OpenMPEndDirective> &>(directive);
+      Node<OpenMPDirective> *paired = end_directive.getPairedDirective();
+      if (paired != nullptr && end_directive.getPairedDirectiveRole() ==
+                                   OpenMPPairedDirectiveRole::Complete) {
+        if (!this->derived().traverseDirective(*paired)) {
+          return false;
+        }
+      }
+    }
+    // Index the live sequence so hooks may append clauses while walking.
+    const std::vector<OpenMPClause *> &clauses =
+        std::as_const(directive).getClausesInOriginalOrder();
+    for (std::size_t index = 0; index < clauses.size(); ++index) {
+      if (clauses[index] != nullptr &&
+          !this->derived().traverseClause(*clauses[index])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool traverseClause(Node<OpenMPClause> &clause) {
+    if (!this->derived().dispatch(clause)) {
+      return false;
+    }
+    Node<OpenMPDirective> *variant_directive = nullptr;
+    switch (clause.OpenMPClause::getKind()) {
+    case OMPC_when: {
+      auto &when = static_cast<Node<OpenMPWhenClause> &>(clause);
+      if (!traverseSelectors(when)) {
+        return false;
+      }
+      variant_directive = when.getVariantDirective();
+      break;
+    }
+    case OMPC_otherwise: {
+      auto &otherwise = static_cast<Node<OpenMPOtherwiseClause> &>(clause);
+      if (!traverseSelectors(otherwise)) {
+        return false;
+      }
+      variant_directive = otherwise.getVariantDirective();
+      break;
+    }
+    case OMPC_match:
+      return traverseSelectors(static_cast<Node<OpenMPMatchClause> &>(clause));
+    case OMPC_default:
+      variant_directive = static_cast<Node<OpenMPDefaultClause> &>(clause)
+                              .getVariantDirective();
+      break;
+    default:
+      break;
+    }
+    return variant_directive == nullptr ||
+           this->derived().traverseDirective(*variant_directive);
+  }
+
+private:
+  bool traverseSelectors(Node<OpenMPVariantClause> &clause) {
+    for (const auto &set : clause.getTraitSets()) {
+      for (const auto &selector : set.selectors) {
+        if (selector.construct_directive != nullptr &&
+            !this->derived().traverseDirective(*selector.construct_directive)) {
+          return false;
+        }
+        for (const auto &property : selector.properties) {
+          if (property.requirement != nullptr &&
+              !this->derived().traverseClause(*property.requirement)) {
+            return false;
+          }
+        }
+      }
+    }
+    return true;
+  }
+};
+
+template <typename Derived>
+using RecursiveOpenMPIRVisitor = RecursiveOpenMPIRVisitorBase<Derived, false>;
+template <typename Derived>
+using ConstRecursiveOpenMPIRVisitor =
+    RecursiveOpenMPIRVisitorBase<Derived, true>;
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPIRVISITOR_H
@@ -0,0 +1,411 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// The name of every enumerator the IR stores, indexed by value, for the
+// exporters that write enumerations by name and for the readers that check a
+// stored value names an enumerator. kindName(value) gives the name, or
+// "unknown" past the table, and kindCount(value) the number of enumerators of
+// value's enumeration.
+
+#ifndef OMPPARSER_OPENMPKINDNAMES_H
+#define OMPPARSER_OPENMPKINDNAMES_H
+
+#include "OpenMPIR.h"
+#include "OpenMPSchema.h"
+
+#include <cstddef>
+#include <iterator>
+#include <string_view>
+
+namespace ompparser::detail {
+
+// Names of the enumerations OpenMPKinds.def lists, indexed by value.
+#define OMPPARSER_KIND_NAME(Name) #Name,
+
+#define OPENMP_IF_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *IfModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_IF_MODIFIER
+#define OPENMP_DEFAULT_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *DefaultKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DEFAULT_KIND
+#define OPENMP_ORDER_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *OrderModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_ORDER_MODIFIER
+#define OPENMP_ORDER_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *OrderKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_ORDER_KIND
+#define OPENMP_PROC_BIND_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *ProcBindKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_PROC_BIND_KIND
+#define OPENMP_ALLOCATE_ALLOCATOR_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *AllocateAllocatorNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_ALLOCATE_ALLOCATOR_KIND
+#define OPENMP_ALLOCATOR_ALLOCATOR_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *AllocatorAllocatorNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_ALLOCATOR_ALLOCATOR_KIND
+#define OPENMP_REDUCTION_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *ReductionModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_REDUCTION_MODIFIER
+#define OPENMP_REDUCTION_IDENTIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *ReductionIdentifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_REDUCTION_IDENTIFIER
+#define OPENMP_LASTPRIVATE_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *LastprivateModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_LASTPRIVATE_MODIFIER
+#define OPENMP_LINEAR_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *LinearModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_LINEAR_MODIFIER
+#define OPENMP_SCHEDULE_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *ScheduleModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_SCHEDULE_MODIFIER
+#define OPENMP_SCHEDULE_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *ScheduleKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_SCHEDULE_KIND
+#define OPENMP_DIST_SCHEDULE_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *DistScheduleKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DIST_SCHEDULE_KIND
+#define OPENMP_GRAINSIZE_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *GrainsizeModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_GRAINSIZE_MODIFIER
+#define OPENMP_NUM_TASKS_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *NumTasksModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_NUM_TASKS_MODIFIER
+#define OPENMP_BIND_BINDING OMPPARSER_KIND_NAME
+inline constexpr const char *BindBindingNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_BIND_BINDING
+#define OPENMP_INITIALIZER_PRIV OMPPARSER_KIND_NAME
+inline constexpr const char *InitializerPrivNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_INITIALIZER_PRIV
+#define OPENMP_ATOMIC_DEFAULT_MEM_ORDER_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *AtomicDefaultMemOrderNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_ATOMIC_DEFAULT_MEM_ORDER_KIND
+#define OPENMP_USESALLOCATORS_ALLOCATOR_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *UsesAllocatorsAllocatorNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_USESALLOCATORS_ALLOCATOR_KIND
+#define OPENMP_DEVICE_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *DeviceModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DEVICE_MODIFIER
+#define OPENMP_IN_REDUCTION_IDENTIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *InReductionIdentifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_IN_REDUCTION_IDENTIFIER
+#define OPENMP_DEPEND_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *DependModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DEPEND_MODIFIER
+#define OPENMP_DECLARE_MAPPER_IDENTIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *DeclareMapperIdentifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DECLARE_MAPPER_IDENTIFIER
+#define OPENMP_DEPENDENCE_TYPE OMPPARSER_KIND_NAME
+inline constexpr const char *DependenceTypeNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DEPENDENCE_TYPE
+#define OPENMP_AFFINITY_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *AffinityModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_AFFINITY_MODIFIER
+#define OPENMP_TO_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *ToKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_TO_KIND
+#define OPENMP_FROM_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *FromKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_FROM_KIND
+#define OPENMP_DEFAULTMAP_BEHAVIOR OMPPARSER_KIND_NAME
+inline constexpr const char *DefaultmapBehaviorNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DEFAULTMAP_BEHAVIOR
+#define OPENMP_DEFAULTMAP_CATEGORY OMPPARSER_KIND_NAME
+inline constexpr const char *DefaultmapCategoryNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DEFAULTMAP_CATEGORY
+#define OPENMP_DEVICE_TYPE_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *DeviceTypeKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DEVICE_TYPE_KIND
+#define OPENMP_MAP_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *MapModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_MAP_MODIFIER
+#define OPENMP_MAP_REF_MODIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *MapRefModifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_MAP_REF_MODIFIER
+#define OPENMP_MAP_TYPE OMPPARSER_KIND_NAME
+inline constexpr const char *MapTypeNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_MAP_TYPE
+#define OPENMP_TASK_REDUCTION_IDENTIFIER OMPPARSER_KIND_NAME
+inline constexpr const char *TaskReductionIdentifierNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_TASK_REDUCTION_IDENTIFIER
+#define OPENMP_DEPOBJ_UPDATE_DEPENDENCE_TYPE OMPPARSER_KIND_NAME
+inline constexpr const char *DepobjUpdateTypeNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DEPOBJ_UPDATE_DEPENDENCE_TYPE
+#define OPENMP_DOACROSS_TYPE OMPPARSER_KIND_NAME
+inline constexpr const char *DoacrossTypeNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_DOACROSS_TYPE
+#define OPENMP_AT_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *AtKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_AT_KIND
+#define OPENMP_SEVERITY_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *SeverityKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_SEVERITY_KIND
+#define OPENMP_FAIL_MEMORY_ORDER OMPPARSER_KIND_NAME
+inline constexpr const char *FailMemoryOrderNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_FAIL_MEMORY_ORDER
+#define OPENMP_MEMSCOPE_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *MemscopeKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_MEMSCOPE_KIND
+#define OPENMP_CONTEXT_KIND OMPPARSER_KIND_NAME
+inline constexpr const char *ContextKindNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_CONTEXT_KIND
+#define OPENMP_CONTEXT_VENDOR OMPPARSER_KIND_NAME
+inline constexpr const char *ContextVendorNames[] = {
+#include "OpenMPKinds.def"
+};
+#undef OPENMP_CONTEXT_VENDOR
+#undef OMPPARSER_KIND_NAME
+
+// Enumerations declared outside OpenMPKinds.def.
+inline constexpr const char *LanguageNames[] = {"c", "cplusplus", "fortran",
+                                                "unknown"};
+inline constexpr const char *SelectorSetNames[] = {
+    "user", "construct", "device", "target_device", "implementation"};
+inline constexpr const char *TraitSelectorNames[] = {"condition",
+                                                     "construct",
+                                                     "kind",
+                                                     "arch",
+                                                     "isa",
+                                                     "device_num",
+                                                     "uid",
+                                                     "vendor",
+                                                     "extension",
+                                                     "requires",
+                                                     "atomic_default_mem_order",
+                                                     "implementation_user"};
+inline constexpr const char *InitKindNames[] = {"target", "targetsync",
+                                                "unknown"};
+inline constexpr const char *InitModifierCategoryNames[] = {
+    "interop_type", "directive_name", "prefer_type", "depinfo"};
+inline constexpr const char *AdjustArgsModifierNames[] = {
+    "need_device_addr", "need_device_ptr", "nothing", "unknown"};
+inline constexpr const char *AppendArgsModifierNames[] = {"interop",
+                                                          "unknown"};
+inline constexpr const char *ApplyTransformNames[] = {
+    "unroll",      "unroll_partial", "unroll_full", "reverse",
+    "interchange", "nothing",        "tile_sizes",  "apply",
+    "unknown"};
+inline constexpr const char *DistDataPolicyNames[] = {"duplicate", "block",
+                                                      "cyclic", "unknown"};
+inline constexpr const char *InductionItemNames[] = {"step", "binding",
+                                                     "expression"};
+inline constexpr const char *PairedRoleNames[] = {"complete", "kind_only"};
+inline constexpr const char *FortranSentinelNames[] = {"omp", "ompx"};
+inline constexpr const char *ClauseSeparatorNames[] = {"space", "comma"};
+inline constexpr const char *ExprParseModeNames[] = {
+    "none",
+    "expression",
+    "constant_integer",
+    "variable_list",
+    "array_section",
+    "openmp_iterator_type",
+    "openmp_iterator_name",
+    "openmp_declare_mapper_identifier",
+    "openmp_declare_mapper_type",
+    "openmp_declare_mapper_variable",
+    "openmp_context_name",
+    "openmp_source",
+    "openmp_syntax",
+    "verbatim"};
+inline constexpr const char *AllocateModifierNames[] = {"allocator", "align"};
+inline constexpr const char *HostFragmentRoleNames[] = {
+    "expression", "condition",  "variable",    "locator",
+    "type",       "declarator", "initializer", "verbatim"};
+static_assert(std::size(LanguageNames) == Lang_unknown + 1 &&
+              std::size(SelectorSetNames) == OMPC_SELECTOR_implementation + 1 &&
+              std::size(TraitSelectorNames) ==
+                  OMPC_TRAIT_implementation_user + 1 &&
+              std::size(InitKindNames) == OMPC_INIT_KIND_unknown + 1 &&
+              std::size(AdjustArgsModifierNames) ==
+                  OMPC_ADJUST_ARGS_unknown + 1 &&
+              std::size(AppendArgsModifierNames) ==
+                  OMPC_APPEND_ARGS_unknown + 1 &&
+              std::size(ApplyTransformNames) ==
+                  OMPC_APPLY_TRANSFORM_unknown + 1 &&
+              std::size(DistDataPolicyNames) ==
+                  OpenMPMapClause::DIST_DATA_unknown + 1 &&
+              std::size(FortranSentinelNames) == OMPFS_ompx + 1 &&
+              std::size(ClauseSeparatorNames) == OMPC_CLAUSE_SEP_comma + 1 &&
+              std::size(ExprParseModeNames) == OMP_EXPR_PARSE_verbatim + 1 &&
+              std::size(AllocateModifierNames) ==
+                  static_cast<std::size_t>(
+                      OpenMPAllocateClause::ModifierKind::Align) +
+                      1 &&
+              std::size(HostFragmentRoleNames) ==
+                  static_cast<std::size_t>(HostFragmentRole::Verbatim) + 1,
+              "names must list every enumerator in declaration order");
+
+template <std::size_t N, typename Enum>
+inline std::string_view lookup(const char *const (&names)[N], Enum value) {
+  const auto index = static_cast<std::size_t>(value);
+  return index < N ? names[index] : "unknown";
+}
+
+#define OMPPARSER_KIND_NAMES(Enum, Table)                                      \
+  inline std::string_view kindName(Enum value) {                               \
+    return lookup(Table, value);                                               \
+  }                                                                            \
+  constexpr std::size_t kindCount(Enum) { return std::size(Table); }
+OMPPARSER_KIND_NAMES(OpenMPDirectiveKind, DirectiveNames)
+OMPPARSER_KIND_NAMES(OpenMPClauseKind, ClauseNames)
+OMPPARSER_KIND_NAMES(OpenMPBaseLang, LanguageNames)
+OMPPARSER_KIND_NAMES(OpenMPIfClauseModifier, IfModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPDefaultClauseKind, DefaultKindNames)
+OMPPARSER_KIND_NAMES(OpenMPOrderClauseModifier, OrderModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPOrderClauseKind, OrderKindNames)
+OMPPARSER_KIND_NAMES(OpenMPProcBindClauseKind, ProcBindKindNames)
+OMPPARSER_KIND_NAMES(OpenMPAllocateClauseAllocator, AllocateAllocatorNames)
+OMPPARSER_KIND_NAMES(OpenMPAllocatorClauseAllocator, AllocatorAllocatorNames)
+OMPPARSER_KIND_NAMES(OpenMPReductionClauseModifier, ReductionModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPReductionClauseIdentifier,
+                     ReductionIdentifierNames)
+OMPPARSER_KIND_NAMES(OpenMPLastprivateClauseModifier,
+                     LastprivateModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPLinearClauseModifier, LinearModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPScheduleClauseModifier, ScheduleModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPScheduleClauseKind, ScheduleKindNames)
+OMPPARSER_KIND_NAMES(OpenMPDistScheduleClauseKind, DistScheduleKindNames)
+OMPPARSER_KIND_NAMES(OpenMPGrainsizeClauseModifier, GrainsizeModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPNumTasksClauseModifier, NumTasksModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPBindClauseBinding, BindBindingNames)
+OMPPARSER_KIND_NAMES(OpenMPInitializerClausePriv, InitializerPrivNames)
+OMPPARSER_KIND_NAMES(OpenMPAtomicDefaultMemOrderClauseKind,
+                     AtomicDefaultMemOrderNames)
+OMPPARSER_KIND_NAMES(OpenMPUsesAllocatorsClauseAllocator,
+                     UsesAllocatorsAllocatorNames)
+OMPPARSER_KIND_NAMES(OpenMPDeviceClauseModifier, DeviceModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPInReductionClauseIdentifier,
+                     InReductionIdentifierNames)
+OMPPARSER_KIND_NAMES(OpenMPDependClauseModifier, DependModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPDeclareMapperDirectiveIdentifier,
+                     DeclareMapperIdentifierNames)
+OMPPARSER_KIND_NAMES(OpenMPDependClauseType, DependenceTypeNames)
+OMPPARSER_KIND_NAMES(OpenMPAffinityClauseModifier, AffinityModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPToClauseKind, ToKindNames)
+OMPPARSER_KIND_NAMES(OpenMPFromClauseKind, FromKindNames)
+OMPPARSER_KIND_NAMES(OpenMPDefaultmapClauseBehavior, DefaultmapBehaviorNames)
+OMPPARSER_KIND_NAMES(OpenMPDefaultmapClauseCategory, DefaultmapCategoryNames)
+OMPPARSER_KIND_NAMES(OpenMPDeviceTypeClauseKind, DeviceTypeKindNames)
+OMPPARSER_KIND_NAMES(OpenMPMapClauseModifier, MapModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPMapClauseRefModifier, MapRefModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPMapClauseType, MapTypeNames)
+OMPPARSER_KIND_NAMES(OpenMPTaskReductionClauseIdentifier,
+                     TaskReductionIdentifierNames)
+OMPPARSER_KIND_NAMES(OpenMPDepobjUpdateClauseDependeceType,
+                     DepobjUpdateTypeNames)
+OMPPARSER_KIND_NAMES(OpenMPDoacrossClauseType, DoacrossTypeNames)
+OMPPARSER_KIND_NAMES(OpenMPAtClauseKind, AtKindNames)
+OMPPARSER_KIND_NAMES(OpenMPSeverityClauseKind, SeverityKindNames)
+OMPPARSER_KIND_NAMES(OpenMPFailClauseMemoryOrder, FailMemoryOrderNames)
+OMPPARSER_KIND_NAMES(OpenMPMemscopeClauseKind, MemscopeKindNames)
+OMPPARSER_KIND_NAMES(OpenMPClauseContextKind, ContextKindNames)
+OMPPARSER_KIND_NAMES(OpenMPClauseContextVendor, ContextVendorNames)
+OMPPARSER_KIND_NAMES(OpenMPContextSelectorSequenceKind, SelectorSetNames)
+OMPPARSER_KIND_NAMES(OpenMPContextTraitSelectorKind, TraitSelectorNames)
+OMPPARSER_KIND_NAMES(OpenMPInitClauseKind, InitKindNames)
+OMPPARSER_KIND_NAMES(OpenMPInitModifierCategory, InitModifierCategoryNames)
+OMPPARSER_KIND_NAMES(OpenMPAdjustArgsModifier, AdjustArgsModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPAppendArgsModifier, AppendArgsModifierNames)
+OMPPARSER_KIND_NAMES(OpenMPApplyTransformKind, ApplyTransformNames)
+OMPPARSER_KIND_NAMES(OpenMPMapClause::DistDataPolicyKind, DistDataPolicyNames)
+OMPPARSER_KIND_NAMES(OpenMPInductionClause::SpecificationItemKind,
+                     InductionItemNames)
+OMPPARSER_KIND_NAMES(OpenMPPairedDirectiveRole, PairedRoleNames)
+OMPPARSER_KIND_NAMES(OpenMPFortranSentinelKind, FortranSentinelNames)
+OMPPARSER_KIND_NAMES(OpenMPClauseSeparator, ClauseSeparatorNames)
+OMPPARSER_KIND_NAMES(OpenMPExprParseMode, ExprParseModeNames)
+OMPPARSER_KIND_NAMES(OpenMPAllocateClause::ModifierKind, AllocateModifierNames)
+OMPPARSER_KIND_NAMES(HostFragmentRole, HostFragmentRoleNames)
+#undef OMPPARSER_KIND_NAMES
+
+} // namespace ompparser::detail
+
+#endif // OMPPARSER_OPENMPKINDNAMES_H
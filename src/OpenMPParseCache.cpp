@@ -0,0 +1,488 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "OpenMPParseCache.h"
+#include "OpenMPIR.h"
+#include "OpenMPParserInternal.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <system_error>
+#include <thread>
+
+#if !defined(__EMSCRIPTEN__) && (defined(__unix__) || defined(__APPLE__))
+#define OMPPARSER_HAS_SHARED_MEMORY 1
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ompparser {
+
+MemoryParseCache::MemoryParseCache(std::size_t capacity)
+    : capacity(capacity) {}
+
+bool MemoryParseCache::lookup(std::string_view key, std::string &bytes) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto found = index.find(key);
+  if (found == index.end()) {
+    ++misses;
+    return false;
+  }
+  ++hits;
+  entries.splice(entries.begin(), entries, found->second);
+  bytes = found->second->bytes;
+  return true;
+}
+
+void MemoryParseCache::store(std::string_view key, std::string_view bytes) {
+  const std::size_t entry_size = key.size() + bytes.size();
+  if (entry_size > capacity) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(mutex);
+  if (index.count(key) != 0) {
+    return;
+  }
+  while (size + entry_size > capacity) {
+    const Entry &oldest = entries.back();
+    size -= oldest.key.size() + oldest.bytes.size();
+    index.erase(oldest.key);
+    entries.pop_back();
+  }
+  entries.push_front(Entry{std::string(key), std::string(bytes)});
+  index.emplace(entries.front().key, entries.begin());
+  size += entry_size;
+}
+
+ParseCacheStats MemoryParseCache::stats() const {
+  std::lock_guard<std::mutex> lock(mutex);
+  ParseCacheStats result;
+  result.hits = hits;
+  result.misses = misses;
+  result.entries = entries.size();
+  result.bytes = size;
+  return result;
+}
+
+namespace {
+
+// Identifies the shared-memory layout; bumped when Header or Slot change.
+constexpr uint32_t SharedCacheMagic = 0x53504D4F; // "OMPS"
+constexpr uint32_t SharedCacheVersion = 2;
+// Slots a key may occupy, starting at its hash.
+constexpr uint64_t SharedCacheProbeLength = 8;
+// How long a slot may stay odd before a store checks whether its writer is
+// still running, in steady_clock ticks.
+constexpr uint64_t SharedCacheWriterTimeout =
+    std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::seconds(1))
+        .count();
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "the shared cache needs address-free atomics");
+
+uint64_t hashKey(std::string_view key) {
+  // FNV-1a, which every process computes alike.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const char c : key) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+uint64_t now() {
+  return static_cast<uint64_t>(
+      std::chrono::steady_clock::now().time_since_epoch().count());
+}
+
+// A claim on a slot: the writer's pid in the high half and a token unique
+// within its process in the low half, so no two claims are equal.
+uint64_t newOwner() {
+  static std::atomic<uint32_t> tokens{0};
+#ifdef OMPPARSER_HAS_SHARED_MEMORY
+  const uint64_t pid = static_cast<uint32_t>(getpid());
+#else
+  const uint64_t pid = 0;
+#endif
+  return pid << 32 | (tokens.fetch_add(1, std::memory_order_relaxed) + 1);
+}
+
+// False once the process that made the claim owner has exited. A process
+// that is only stopped or swapped out still owns its slot.
+bool ownerRunning(uint64_t owner) {
+#ifdef OMPPARSER_HAS_SHARED_MEMORY
+  const auto pid = static_cast<pid_t>(owner >> 32);
+  return owner == 0 || pid <= 0 || kill(pid, 0) == 0 || errno != ESRCH;
+#else
+  static_cast<void>(owner);
+  return true;
+#endif
+}
+
+} // namespace
+
+// The object starts with a Header, followed by slot_count slots of
+// slot_size bytes. A slot whose sequence is 0 has never been written.
+struct SharedMemoryParseCache::Header {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t slot_count;
+  uint64_t slot_size;
+  uint64_t serialization_version;
+  std::atomic<uint32_t> ready;
+  unsigned char padding[28];
+};
+
+struct SharedMemoryParseCache::Slot {
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> last_used;
+  // The claim of the store writing the slot, from before its sequence turns
+  // odd until after it turns even again, and 0 otherwise. A store takes it
+  // before the sequence, so only one store at a time can claim the slot.
+  std::atomic<uint64_t> owner;
+  // When owner claimed the slot.
+  std::atomic<uint64_t> claimed_at;
+  uint64_t hash;
+  uint32_t key_size;
+  uint32_t bytes_size;
+  // Followed by the key, then the image, in the rest of the slot.
+};
+
+#ifdef OMPPARSER_HAS_SHARED_MEMORY
+
+namespace {
+
+[[noreturn]] void throwSystemError(int error, const std::string &what) {
+  throw std::system_error(error, std::generic_category(), what);
+}
+
+// Waits for the creator of an object to size it and publish its header.
+bool waitFor(const std::function<bool()> &condition) {
+  for (int attempt = 0; attempt < 5000; ++attempt) {
+    if (condition()) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return false;
+}
+
+// Unlinks name if it still names the object open as fd, and not one that
+// another process has already created in its place.
+void unlinkAbandoned(const std::string &name, int fd) {
+  const int current = shm_open(name.c_str(), O_RDONLY, 0);
+  if (current < 0) {
+    return;
+  }
+  struct stat ours {};
+  struct stat named {};
+  const bool same = fstat(fd, &ours) == 0 && fstat(current, &named) == 0 &&
+                    ours.st_dev == named.st_dev && ours.st_ino == named.st_ino;
+  close(current);
+  if (same) {
+    shm_unlink(name.c_str());
+  }
+}
+
+} // namespace
+
+SharedMemoryParseCache::SharedMemoryParseCache(const std::string &name,
+                                               std::size_t capacity,
+                                               std::size_t slot_size) {
+  static_assert(sizeof(Header) == 64 && sizeof(Slot) == 48,
+                "slots start and stay 8-byte aligned");
+  const std::string context = "shared parse cache " + name;
+  slot_size = (std::max(slot_size, sizeof(Slot) + 64) + 63) & ~63ull;
+  // A creator that died before publishing the header leaves an object that
+  // never becomes ready; it is replaced once before giving up.
+  for (int attempt = 0; !attach(name, capacity, slot_size, context);
+       ++attempt) {
+    if (attempt == 1) {
+      throwSystemError(ETIMEDOUT, context);
+    }
+  }
+}
+
+bool SharedMemoryParseCache::attach(const std::string &name,
+                                    std::size_t capacity,
+                                    std::size_t slot_size,
+                                    const std::string &context) {
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+  const bool created = fd >= 0;
+  if (!created && errno == EEXIST) {
+    fd = shm_open(name.c_str(), O_RDWR, 0600);
+  }
+  if (fd < 0) {
+    throwSystemError(errno, context);
+  }
+
+  if (created) {
+    slot_count = std::max<uint64_t>(capacity / slot_size,
+                                    SharedCacheProbeLength);
+    this->slot_size = slot_size;
+    mapping_size = sizeof(Header) + slot_count * slot_size;
+    if (ftruncate(fd, static_cast<off_t>(mapping_size)) != 0) {
+      const int error = errno;
+      close(fd);
+      shm_unlink(name.c_str());
+      throwSystemError(error, context);
+    }
+  } else {
+    struct stat status {};
+    if (!waitFor([&] {
+          return fstat(fd, &status) == 0 &&
+                 static_cast<std::size_t>(status.st_size) >= sizeof(Header);
+        })) {
+      unlinkAbandoned(name, fd);
+      close(fd);
+      return false;
+    }
+    mapping_size = static_cast<std::size_t>(status.st_size);
+  }
+
+  void *address =
+      mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (address == MAP_FAILED) {
+    const int map_error = errno;
+    close(fd);
+    throwSystemError(map_error, context);
+  }
+  mapping = static_cast<unsigned char *>(address);
+  Header &header = *reinterpret_cast<Header *>(mapping);
+
+  if (created) {
+    close(fd);
+    header.magic = SharedCacheMagic;
+    header.version = SharedCacheVersion;
+    header.slot_count = slot_count;
+    header.slot_size = this->slot_size;
+    header.serialization_version = SerializationFormatVersion;
+    header.ready.store(1, std::memory_order_release);
+    return true;
+  }
+
+  if (!waitFor([&] {
+        return header.ready.load(std::memory_order_acquire) != 0;
+      })) {
+    munmap(mapping, mapping_size);
+    mapping = nullptr;
+    unlinkAbandoned(name, fd);
+    close(fd);
+    return false;
+  }
+  close(fd);
+  slot_count = header.slot_count;
+  this->slot_size = header.slot_size;
+  if (header.magic != SharedCacheMagic ||
+      header.version != SharedCacheVersion ||
+      header.serialization_version != SerializationFormatVersion ||
+      this->slot_size <= sizeof(Slot) || slot_count == 0 ||
+      mapping_size < sizeof(Header) + slot_count * this->slot_size) {
+    munmap(mapping, mapping_size);
+    throwSystemError(EPROTO, context + " has an incompatible layout");
+  }
+  return true;
+}
+
+SharedMemoryParseCache::~SharedMemoryParseCache() {
+  munmap(mapping, mapping_size);
+}
+
+bool SharedMemoryParseCache::remove(const std::string &name) {
+  return shm_unlink(name.c_str()) == 0;
+}
+
+#else
+
+SharedMemoryParseCache::SharedMemoryParseCache(const std::string &name,
+                                               std::size_t, std::size_t) {
+  throw std::system_error(ENOSYS, std::generic_category(),
+                          "shared parse cache " + name);
+}
+
+SharedMemoryParseCache::~SharedMemoryParseCache() = default;
+
+bool SharedMemoryParseCache::remove(const std::string &) { return false; }
+
+#endif
+
+SharedMemoryParseCache::Slot &
+SharedMemoryParseCache::slot(uint64_t index) const {
+  return *reinterpret_cast<Slot *>(mapping + sizeof(Header) +
+                                   (index % slot_count) * slot_size);
+}
+
+bool SharedMemoryParseCache::lookup(std::string_view key, std::string &bytes) {
+  const uint64_t hash = hashKey(key);
+  const std::size_t payload_size = slot_size - sizeof(Slot);
+  for (uint64_t probe = 0; probe < SharedCacheProbeLength; ++probe) {
+    Slot &entry = slot(hash + probe);
+    const uint64_t sequence = entry.sequence.load(std::memory_order_acquire);
+    if (sequence == 0 || (sequence & 1) != 0 || entry.hash != hash) {
+      continue;
+    }
+    // Everything read here may be torn by a concurrent store; it is used
+    // only if the sequence is unchanged afterwards.
+    const std::size_t key_size = entry.key_size;
+    const std::size_t bytes_size = entry.bytes_size;
+    if (key_size != key.size() || key_size + bytes_size > payload_size) {
+      continue;
+    }
+    const char *payload = reinterpret_cast<const char *>(&entry + 1);
+    const bool same_key = std::memcmp(payload, key.data(), key_size) == 0;
+    bytes.assign(payload + key_size, bytes_size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (!same_key ||
+        entry.sequence.load(std::memory_order_relaxed) != sequence) {
+      continue;
+    }
+    entry.last_used.store(now(), std::memory_order_relaxed);
+    ++hits;
+    return true;
+  }
+  ++misses;
+  return false;
+}
+
+void SharedMemoryParseCache::store(std::string_view key,
+                                   std::string_view bytes) {
+  if (key.size() + bytes.size() > slot_size - sizeof(Slot)) {
+    return;
+  }
+  const uint64_t hash = hashKey(key);
+  Slot *victim = nullptr;
+  uint64_t victim_sequence = 0;
+  uint64_t victim_used = UINT64_MAX;
+  uint64_t victim_owner = 0;
+  const uint64_t started = now();
+  for (uint64_t probe = 0; probe < SharedCacheProbeLength; ++probe) {
+    Slot &entry = slot(hash + probe);
+    const uint64_t sequence = entry.sequence.load(std::memory_order_acquire);
+    if ((sequence & 1) != 0) {
+      // Being written, and left to its writer unless that has exited
+      // without publishing it.
+      const uint64_t owner = entry.owner.load(std::memory_order_acquire);
+      const uint64_t claimed_at =
+          entry.claimed_at.load(std::memory_order_relaxed);
+      if (started - std::min(claimed_at, started) <=
+              SharedCacheWriterTimeout ||
+          ownerRunning(owner)) {
+        continue;
+      }
+      victim = &entry;
+      victim_sequence = sequence;
+      victim_owner = owner;
+      break;
+    }
+    if (sequence == 0) {
+      victim = &entry;
+      victim_sequence = 0;
+      victim_owner = 0;
+      break;
+    }
+    if (entry.hash == hash && entry.key_size == key.size()) {
+      const bool same_key =
+          std::memcmp(&entry + 1, key.data(), key.size()) == 0;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (same_key &&
+          entry.sequence.load(std::memory_order_relaxed) == sequence) {
+        return;
+      }
+    }
+    const uint64_t used = entry.last_used.load(std::memory_order_relaxed);
+    if (used < victim_used) {
+      victim = &entry;
+      victim_sequence = sequence;
+      victim_used = used;
+      victim_owner = 0;
+    }
+  }
+  if (victim == nullptr) {
+    return;
+  }
+  // The slot is claimed by replacing the owner it was chosen with, 0 or an
+  // exited writer, and then moving its sequence to the next odd value.
+  // Losing either race to another store only means this entry is not cached.
+  uint64_t expected_owner = victim_owner;
+  if (!victim->owner.compare_exchange_strong(expected_owner, newOwner(),
+                                             std::memory_order_acq_rel)) {
+    return;
+  }
+  victim->claimed_at.store(started, std::memory_order_relaxed);
+  const uint64_t claimed = victim_sequence + ((victim_sequence & 1) ? 2 : 1);
+  if (!victim->sequence.compare_exchange_strong(victim_sequence, claimed,
+                                                std::memory_order_acq_rel)) {
+    victim->owner.store(victim_owner, std::memory_order_release);
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+  victim->hash = hash;
+  victim->key_size = static_cast<uint32_t>(key.size());
+  victim->bytes_size = static_cast<uint32_t>(bytes.size());
+  char *payload = reinterpret_cast<char *>(victim + 1);
+  std::memcpy(payload, key.data(), key.size());
+  std::memcpy(payload + key.size(), bytes.data(), bytes.size());
+  victim->last_used.store(now(), std::memory_order_relaxed);
+  victim->sequence.store(claimed + 1, std::memory_order_release);
+  victim->owner.store(0, std::memory_order_release);
+}
+
+ParseCacheStats SharedMemoryParseCache::stats() const {
+  ParseCacheStats result;
+  result.hits = hits;
+  result.misses = misses;
+  for (uint64_t index = 0; index < slot_count; ++index) {
+    const Slot &entry = slot(index);
+    const uint64_t sequence = entry.sequence.load(std::memory_order_acquire);
+    if (sequence != 0 && (sequence & 1) == 0) {
+      ++result.entries;
+      result.bytes += entry.key_size + entry.bytes_size;
+    }
+  }
+  return result;
+}
+
+ParseResult parseDirective(std::string_view input, const ParseOptions &options,
+                           ParseCache &cache) {
+  if (options.host_hooks || input.data() == nullptr) {
+    return parseDirective(input, options);
+  }
+
+  std::string key;
+  key.reserve(input.size() + 2);
+  key.push_back(static_cast<char>(options.language));
+  key.push_back(static_cast<char>(options.extensions));
+  key.append(input);
+
+  std::string bytes;
+  if (cache.lookup(key, bytes)) {
+    ParseResult cached = deserialize(bytes);
+    if (cached.success()) {
+      // Images do not carry the retained text, so it is taken from input.
+      if (options.retain_source) {
+        detail::retainSourceText(input, *cached.directive);
+      }
+      return cached;
+    }
+  }
+
+  ParseResult result = parseDirective(input, options);
+  if (result.directive && result.diagnostics.empty()) {
+    cache.store(key, serialize(*result.directive));
+  }
+  return result;
+}
+
+} // namespace ompparser
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPPARSECACHE_H
+#define OMPPARSER_OPENMPPARSECACHE_H
+
+#include "OpenMPParser.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace ompparser {
+
+struct ParseCacheStats {
+  // Lookups through this object.
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  // What the cache holds, which a shared cache counts across processes.
+  uint64_t entries = 0;
+  // Bytes of keys and images held.
+  uint64_t bytes = 0;
+};
+
+// Storage for parse results, keyed by the input text and every option that
+// decides the result. Entries are serialize images, so a hit is rebuilt with
+// deserialize instead of being lexed, parsed and validated again. Backends
+// are called concurrently from every thread that parses through them.
+class ParseCache {
+public:
+  virtual ~ParseCache() = default;
+
+  // Copies the image stored for key into bytes; false when there is none.
+  virtual bool lookup(std::string_view key, std::string &bytes) = 0;
+  virtual void store(std::string_view key, std::string_view bytes) = 0;
+
+  virtual ParseCacheStats stats() const = 0;
+};
+
+// Cache within one process. Once its keys and images exceed capacity bytes,
+// the least recently used entries are dropped.
+class MemoryParseCache final : public ParseCache {
+public:
+  explicit MemoryParseCache(std::size_t capacity);
+
+  bool lookup(std::string_view key, std::string &bytes) override;
+  void store(std::string_view key, std::string_view bytes) override;
+
+  ParseCacheStats stats() const override;
+
+private:
+  struct Entry {
+    std::string key;
+    std::string bytes;
+  };
+
+  mutable std::mutex mutex;
+  // Most recently used first.
+  std::list<Entry> entries;
+  std::unordered_map<std::string_view, std::list<Entry>::iterator> index;
+  std::size_t capacity;
+  std::size_t size = 0;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+};
+
+// Cache shared by every process that opens the same name, in a POSIX
+// shared-memory object, so that the compiler processes of a parallel build
+// reuse each other's parses without a daemon. Entries live in fixed-size
+// slots of an open-addressing table and are read and written without locks:
+// each slot carries a sequence number that is odd while it is written, and a
+// reader that sees it change discards what it copied. An entry larger than a
+// slot is not stored, and a store whose probe window is full replaces the
+// least recently used entry in it, passing over slots being written unless
+// the process writing one has exited without publishing it. The object
+// persists after the processes exit, until remove() unlinks it.
+class SharedMemoryParseCache final : public ParseCache {
+public:
+  // Opens the shared-memory object name, such as "/ompparser-build", or
+  // creates it with capacity bytes of slot_size-byte slots. An object that
+  // exists keeps the layout it was created with. Throws std::system_error
+  // when the object cannot be opened or mapped, or was written by another
+  // version of this layout.
+  SharedMemoryParseCache(const std::string &name, std::size_t capacity,
+                         std::size_t slot_size = 1024);
+  ~SharedMemoryParseCache() override;
+  SharedMemoryParseCache(const SharedMemoryParseCache &) = delete;
+  SharedMemoryParseCache &operator=(const SharedMemoryParseCache &) = delete;
+
+  bool lookup(std::string_view key, std::string &bytes) override;
+  void store(std::string_view key, std::string_view bytes) override;
+
+  ParseCacheStats stats() const override;
+
+  // Unlinks name; processes that have it open keep their mapping.
+  static bool remove(const std::string &name);
+
+private:
+  struct Header;
+  struct Slot;
+
+  // Maps name, creating it if it does not exist. Returns false, having
+  // unlinked it, if it exists but its header is never published.
+  bool attach(const std::string &name, std::size_t capacity,
+              std::size_t slot_size, const std::string &context);
+  Slot &slot(uint64_t index) const;
+
+  unsigned char *mapping = nullptr;
+  std::size_t mapping_size = 0;
+  uint64_t slot_count = 0;
+  std::size_t slot_size = 0;
+  std::atomic<uint64_t> hits{0};
+  std::atomic<uint64_t> misses{0};
+};
+
+// parseDirective, answered from cache when it holds the same input under
+// the same options. Input parsed with host hooks bypasses the cache, since
+// semantic nodes are not serialized, and only results without diagnostics
+// are stored. With retain_source, a directive answered from cache retains
+// input as a fresh parse would.
+ParseResult parseDirective(std::string_view input, const ParseOptions &options,
+                           ParseCache &cache);
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPPARSECACHE_H
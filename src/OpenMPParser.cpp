@@ -7,16 +7,28 @@
  */
 
 #include "OpenMPParser.h"
+#include "OpenMPClauseCache.h"
 
 #include "OpenMPIR.h"
+#include "OpenMPIRVisitor.h"
+#include "OpenMPKindNames.h"
 #include "OpenMPParserInternal.h"
 #include "OpenMPSchema.h"
 
 #include <algorithm>
+#include <cassert>
 #include <cctype>
+#include <exception>
 #include <initializer_list>
 #include <iterator>
 #include <numeric>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
 
 namespace {
 
@@ -383,17 +395,788 @@ bool hasEmptyApplyTree(const OpenMPApplyClause &apply) {
                      });
 }
 
-void validateOpenMPStructure(const OpenMPDirective &directive,
-                             std::vector<ompparser::Diagnostic> &diagnostics) {
-  for (const auto &entry : directive.getAllClauses()) {
-    if (ompparser::getClauseCardinality(entry.first) ==
-            ompparser::ClauseCardinality::Unique &&
-        entry.second.size() > 1) {
+using Diagnostics = std::vector<ompparser::Diagnostic>;
+
+std::size_t clauseCount(const OpenMPDirective &directive,
+                        OpenMPClauseKind kind) {
+  const auto *clauses = directive.findClauses(kind);
+  return clauses == nullptr ? std::size_t{0} : clauses->size();
+}
+
+std::size_t clauseCount(const OpenMPDirective &directive,
+                        std::initializer_list<OpenMPClauseKind> kinds) {
+  return std::accumulate(kinds.begin(), kinds.end(), std::size_t{0},
+                         [&directive](std::size_t sum, OpenMPClauseKind kind) {
+                           return sum + clauseCount(directive, kind);
+                         });
+}
+
+std::size_t requireAnyClause(const OpenMPDirective &directive,
+                             std::initializer_list<OpenMPClauseKind> kinds,
+                             const char *message, Diagnostics &diagnostics) {
+  const std::size_t count = clauseCount(directive, kinds);
+  if (count == 0) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidDirective, message);
+  }
+  return count;
+}
+
+// Clause-set rules run for every member kind present; only the first one
+// present reports, so each violated set yields a single diagnostic.
+void rejectExclusiveClauses(const OpenMPDirective &directive,
+                            OpenMPClauseKind kind,
+                            std::initializer_list<OpenMPClauseKind> kinds,
+                            const char *message, Diagnostics &diagnostics) {
+  const auto first_present =
+      std::find_if(kinds.begin(), kinds.end(), [&](OpenMPClauseKind member) {
+        return clauseCount(directive, member) != 0;
+      });
+  if (first_present != kinds.end() && *first_present == kind &&
+      clauseCount(directive, kinds) > 1) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause, message);
+  }
+}
+
+bool hasEmptyExpression(const OpenMPClause &clause) {
+  const auto &expressions = clause.getExpressionItems();
+  return expressions.empty() ||
+         std::any_of(expressions.begin(), expressions.end(),
+                     [](const OpenMPExpressionItem &expression) {
+                       return expression.fragment.spelling.empty();
+                     });
+}
+
+bool isMalformedMapperIdentifier(const ompparser::HostFragment &mapper) {
+  return !mapper.spelling.empty() &&
+         (mapper.role != ompparser::HostFragmentRole::Declarator ||
+          mapper.parse_mode != OMP_EXPR_PARSE_verbatim ||
+          !isOpenMPIdentifier(mapper.spelling));
+}
+
+void reportEmptyDirectiveList(const OpenMPClause &clause,
+                              Diagnostics &diagnostics) {
+  addStructureDiagnostic(diagnostics, ompparser::DiagnosticCode::InvalidClause,
+                         std::string("clause '") +
+                             ompparser::getClauseName(clause.getKind()) +
+                             "' requires a non-empty directive-name list");
+}
+
+// Clause rules; see OpenMPValidation.def.
+
+void validateAbsentClause(const OpenMPAbsentClause &clause,
+                          const OpenMPDirective &, Diagnostics &diagnostics) {
+  if (clause.getDirectives().empty()) {
+    reportEmptyDirectiveList(clause, diagnostics);
+  }
+}
+
+void validateContainsClause(const OpenMPContainsClause &clause,
+                            const OpenMPDirective &, Diagnostics &diagnostics) {
+  if (clause.getDirectives().empty()) {
+    reportEmptyDirectiveList(clause, diagnostics);
+  }
+}
+
+void validateAdjustArgsClause(const OpenMPAdjustArgsClause &clause,
+                              const OpenMPDirective &,
+                              Diagnostics &diagnostics) {
+  if (clause.getModifier() == OMPC_ADJUST_ARGS_unknown ||
+      clause.getArguments().empty()) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "adjust_args requires a typed adjust-op and a "
+                           "non-empty parameter list");
+  }
+}
+
+void validateAllocateClause(const OpenMPAllocateClause &clause,
+                            const OpenMPDirective &, Diagnostics &diagnostics) {
+  const bool has_user_allocator = !clause.getUserDefinedAllocator().empty();
+  const bool typed_user_allocator =
+      clause.getAllocator() == OMPC_ALLOCATE_ALLOCATOR_user;
+  if (has_user_allocator != typed_user_allocator ||
+      (clause.usesAllocatorModifierSyntax() && !typed_user_allocator)) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "allocate allocator kind, modifier syntax, and "
+                           "typed payload must agree");
+  }
+}
+
+void validateInitClause(const OpenMPInitClause &clause,
+                        const OpenMPDirective &directive,
+                        Diagnostics &diagnostics) {
+  if (clause.getOperand().empty()) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "init requires an init-var argument");
+  }
+  const bool on_interop = directive.getKind() == OMPD_interop;
+  const bool on_depobj = directive.getKind() == OMPD_depobj;
+  if (!on_interop && !on_depobj) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "init is only valid on interop and depobj directives");
+  } else {
+    validateInitModifiers(clause.getModifiers(), on_interop, on_depobj,
+                          diagnostics);
+  }
+}
+
+void validateDestroyClause(const OpenMPClause &clause,
+                           const OpenMPDirective &directive,
+                           Diagnostics &diagnostics) {
+  if (directive.getKind() == OMPD_interop && hasEmptyExpression(clause)) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "destroy on interop requires a destroy-var argument");
+  }
+}
+
+void validateAppendArgsClause(const OpenMPAppendArgsClause &clause,
+                              const OpenMPDirective &,
+                              Diagnostics &diagnostics) {
+  if (clause.getOperations().empty()) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "append_args requires a non-empty operation list");
+  }
+  for (const OpenMPAppendArgsClause::Operation &operation :
+       clause.getOperations()) {
+    if (operation.kind != OMPC_APPEND_ARGS_interop) {
+      addStructureDiagnostic(diagnostics,
+                             ompparser::DiagnosticCode::InvalidClause,
+                             "append_args contains an unknown operation");
+      continue;
+    }
+    validateInitModifiers(operation.modifiers, true, false, diagnostics);
+  }
+}
+
+void validateApplyClause(const OpenMPApplyClause &clause,
+                         const OpenMPDirective &, Diagnostics &diagnostics) {
+  if (hasEmptyApplyTree(clause)) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "apply and nested apply clauses require non-empty "
+                           "applied-directives lists");
+  }
+}
+
+void validateVariantClause(const OpenMPVariantClause &clause,
+                           const OpenMPDirective &, Diagnostics &diagnostics) {
+  std::vector<std::string> selector_errors;
+  clause.validateSelectorInvariants(selector_errors);
+  for (const std::string &message : selector_errors) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause, message);
+  }
+}
+
+void validateDefaultClause(const OpenMPDefaultClause &clause,
+                           const OpenMPDirective &, Diagnostics &diagnostics) {
+  if (clause.getDefaultClauseKind() == OMPC_DEFAULT_variant &&
+      clause.getVariantDirective() == nullptr) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidAst,
+        "default variant clause requires a variant directive");
+  }
+}
+
+void validateUsesAllocatorsClause(const OpenMPUsesAllocatorsClause &clause,
+                                  const OpenMPDirective &,
+                                  Diagnostics &diagnostics) {
+  if (clause.getUsesAllocatorsAllocatorSequence().empty()) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "uses_allocators requires a non-empty allocator list");
+  }
+}
+
+void validateMapClause(const OpenMPMapClause &clause, const OpenMPDirective &,
+                       Diagnostics &diagnostics) {
+  const ompparser::HostFragment &mapper = clause.getMapperIdentifierFragment();
+  if (isMalformedMapperIdentifier(mapper)) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "map mapper identifier '" + mapper.spelling +
+                               "' is not a typed OpenMP name (mode " +
+                               std::to_string(mapper.parse_mode) + ")");
+  }
+  const auto &all_policies = clause.getDistDataPolicies();
+  const bool has_invalid_policy = std::any_of(
+      all_policies.begin(), all_policies.end(), [](const auto &policies) {
+        return std::any_of(
+            policies.begin(), policies.end(),
+            [](const OpenMPMapClause::DistDataPolicy &policy) {
+              return policy.kind == OpenMPMapClause::DIST_DATA_unknown;
+            });
+      });
+  if (has_invalid_policy) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "dist_data contains an unrecognized or malformed policy");
+  }
+}
+
+void validateToClause(const OpenMPToClause &clause, const OpenMPDirective &,
+                      Diagnostics &diagnostics) {
+  if (isMalformedMapperIdentifier(clause.getMapperIdentifierFragment())) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "to mapper identifier is not a typed OpenMP name");
+  }
+}
+
+void validateFromClause(const OpenMPFromClause &clause, const OpenMPDirective &,
+                        Diagnostics &diagnostics) {
+  if (isMalformedMapperIdentifier(clause.getMapperIdentifierFragment())) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "from mapper identifier is not a typed OpenMP name");
+  }
+}
+
+void validateDependClause(const OpenMPDependClause &clause,
+                          const OpenMPDirective &, Diagnostics &diagnostics) {
+  if (clause.getType() == OMPC_DEPENDENCE_TYPE_sink) {
+    if (clause.getDependenceVector().empty() &&
+        clause.getExpressionItems().empty()) {
       addStructureDiagnostic(diagnostics,
-                             ompparser::DiagnosticCode::DuplicateClause,
-                             std::string("duplicate unique clause '") +
-                                 ompparser::getClauseName(entry.first) + "'");
+                             ompparser::DiagnosticCode::InvalidClause,
+                             "depend(sink) requires a dependence vector");
     }
+  } else if (clause.getType() != OMPC_DEPENDENCE_TYPE_source &&
+             clause.getExpressionItems().empty()) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "depend requires a non-empty locator list");
+  }
+}
+
+void validateReductionClause(const OpenMPReductionClause &clause,
+                             const OpenMPDirective &directive,
+                             Diagnostics &diagnostics) {
+  switch (clause.getModifier()) {
+  case OMPC_REDUCTION_MODIFIER_unspecified:
+  case OMPC_REDUCTION_MODIFIER_default:
+  case OMPC_REDUCTION_MODIFIER_inscan:
+  case OMPC_REDUCTION_MODIFIER_task:
+  case OMPC_REDUCTION_MODIFIER_original_private:
+    break;
+  default:
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "reduction has an unknown modifier");
+    break;
+  }
+  const OpenMPReductionClauseIdentifier identifier = clause.getIdentifier();
+  const bool c_only = identifier == OMPC_REDUCTION_IDENTIFIER_bitand ||
+                      identifier == OMPC_REDUCTION_IDENTIFIER_bitor ||
+                      identifier == OMPC_REDUCTION_IDENTIFIER_bitxor;
+  const bool fortran_only = identifier == OMPC_REDUCTION_IDENTIFIER_eqv ||
+                            identifier == OMPC_REDUCTION_IDENTIFIER_neqv;
+  if (identifier == OMPC_REDUCTION_IDENTIFIER_unknown) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "reduction has an unknown identifier");
+  }
+  validateReductionIdentifier(directive.getBaseLang(), c_only, fortran_only,
+                              identifier == OMPC_REDUCTION_IDENTIFIER_user,
+                              clause.getUserDefinedIdentifierFragment(),
+                              diagnostics);
+}
+
+void validateInReductionClause(const OpenMPInReductionClause &clause,
+                               const OpenMPDirective &directive,
+                               Diagnostics &diagnostics) {
+  const OpenMPInReductionClauseIdentifier identifier = clause.getIdentifier();
+  const bool c_only = identifier == OMPC_IN_REDUCTION_IDENTIFIER_bitand ||
+                      identifier == OMPC_IN_REDUCTION_IDENTIFIER_bitor ||
+                      identifier == OMPC_IN_REDUCTION_IDENTIFIER_bitxor;
+  const bool fortran_only = identifier == OMPC_IN_REDUCTION_IDENTIFIER_eqv ||
+                            identifier == OMPC_IN_REDUCTION_IDENTIFIER_neqv;
+  if (identifier == OMPC_IN_REDUCTION_IDENTIFIER_unknown) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "in_reduction has an unknown identifier");
+  }
+  validateReductionIdentifier(directive.getBaseLang(), c_only, fortran_only,
+                              identifier == OMPC_IN_REDUCTION_IDENTIFIER_user,
+                              clause.getUserDefinedIdentifierFragment(),
+                              diagnostics);
+}
+
+void validateTaskReductionClause(const OpenMPTaskReductionClause &clause,
+                                 const OpenMPDirective &directive,
+                                 Diagnostics &diagnostics) {
+  const OpenMPTaskReductionClauseIdentifier identifier =
+      clause.getIdentifier();
+  const bool c_only = identifier == OMPC_TASK_REDUCTION_IDENTIFIER_bitand ||
+                      identifier == OMPC_TASK_REDUCTION_IDENTIFIER_bitor ||
+                      identifier == OMPC_TASK_REDUCTION_IDENTIFIER_bitxor;
+  const bool fortran_only =
+      identifier == OMPC_TASK_REDUCTION_IDENTIFIER_eqv ||
+      identifier == OMPC_TASK_REDUCTION_IDENTIFIER_neqv;
+  if (identifier == OMPC_TASK_REDUCTION_IDENTIFIER_unknown) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "task_reduction has an unknown identifier");
+  }
+  validateReductionIdentifier(
+      directive.getBaseLang(), c_only, fortran_only,
+      identifier == OMPC_TASK_REDUCTION_IDENTIFIER_user,
+      clause.getUserDefinedIdentifierFragment(), diagnostics);
+}
+
+// Clause-set rules; see OpenMPValidation.def.
+
+void validateIfClauses(const OpenMPDirective &, OpenMPClauseKind,
+                       const std::vector<OpenMPClause *> &clauses,
+                       Diagnostics &diagnostics) {
+  std::vector<std::pair<OpenMPIfClauseModifier, std::string>> seen;
+  for (const OpenMPClause *clause : clauses) {
+    const auto *if_clause = dynamic_cast<const OpenMPIfClause *>(clause);
+    if (if_clause == nullptr) {
+      continue;
+    }
+    const auto key =
+        std::make_pair(if_clause->getModifier(),
+                       if_clause->getModifier() == OMPC_IF_MODIFIER_user
+                           ? if_clause->getUserDefinedModifier()
+                           : std::string());
+    if (std::find(seen.begin(), seen.end(), key) != seen.end()) {
+      addStructureDiagnostic(
+          diagnostics, ompparser::DiagnosticCode::DuplicateClause,
+          "at most one if clause may apply to each constituent directive");
+    } else {
+      seen.push_back(key);
+    }
+  }
+}
+
+template <typename CategoryClause>
+void validateCategories(OpenMPClauseKind clause_kind,
+                        const std::vector<OpenMPClause *> &clauses,
+                        Diagnostics &diagnostics) {
+  std::vector<OpenMPDefaultmapClauseCategory> seen;
+  for (const OpenMPClause *clause : clauses) {
+    const auto *category_clause = dynamic_cast<const CategoryClause *>(clause);
+    OpenMPDefaultmapClauseCategory category =
+        category_clause != nullptr ? category_clause->getCategory()
+                                   : OMPC_DEFAULTMAP_CATEGORY_unknown;
+    if (category == OMPC_DEFAULTMAP_CATEGORY_unspecified) {
+      category = OMPC_DEFAULTMAP_CATEGORY_all;
+    }
+    if (category == OMPC_DEFAULTMAP_CATEGORY_unknown) {
+      continue;
+    }
+    if (std::find(seen.begin(), seen.end(), category) != seen.end()) {
+      addStructureDiagnostic(
+          diagnostics, ompparser::DiagnosticCode::DuplicateClause,
+          std::string("duplicate variable-category on '") +
+              ompparser::getClauseName(clause_kind) + "' clause");
+    }
+    seen.push_back(category);
+  }
+  if (std::find(seen.begin(), seen.end(), OMPC_DEFAULTMAP_CATEGORY_all) !=
+          seen.end() &&
+      seen.size() > 1) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           std::string("the all variable-category on '") +
+                               ompparser::getClauseName(clause_kind) +
+                               "' excludes all other occurrences");
+  }
+}
+
+void validateDefaultCategories(const OpenMPDirective &, OpenMPClauseKind kind,
+                               const std::vector<OpenMPClause *> &clauses,
+                               Diagnostics &diagnostics) {
+  validateCategories<OpenMPDefaultClause>(kind, clauses, diagnostics);
+}
+
+void validateDefaultmapCategories(const OpenMPDirective &,
+                                  OpenMPClauseKind kind,
+                                  const std::vector<OpenMPClause *> &clauses,
+                                  Diagnostics &diagnostics) {
+  validateCategories<OpenMPDefaultmapClause>(kind, clauses, diagnostics);
+}
+
+void validateBranchClauses(const OpenMPDirective &directive,
+                           OpenMPClauseKind kind,
+                           const std::vector<OpenMPClause *> &,
+                           Diagnostics &diagnostics) {
+  rejectExclusiveClauses(
+      directive, kind, {OMPC_inbranch, OMPC_notinbranch},
+      "inbranch and notinbranch clauses are mutually exclusive", diagnostics);
+}
+
+void validateTaskCountClauses(const OpenMPDirective &directive,
+                              OpenMPClauseKind kind,
+                              const std::vector<OpenMPClause *> &,
+                              Diagnostics &diagnostics) {
+  rejectExclusiveClauses(
+      directive, kind, {OMPC_grainsize, OMPC_num_tasks},
+      "grainsize and num_tasks clauses are mutually exclusive", diagnostics);
+}
+
+void validateUnrollClauses(const OpenMPDirective &directive,
+                           OpenMPClauseKind kind,
+                           const std::vector<OpenMPClause *> &,
+                           Diagnostics &diagnostics) {
+  rejectExclusiveClauses(directive, kind, {OMPC_full, OMPC_partial},
+                         "full and partial clauses are mutually exclusive",
+                         diagnostics);
+}
+
+void validateCopyprivateClauses(const OpenMPDirective &directive,
+                                OpenMPClauseKind,
+                                const std::vector<OpenMPClause *> &,
+                                Diagnostics &diagnostics) {
+  if (clauseCount(directive, OMPC_nowait) != 0) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "copyprivate and nowait clauses are mutually exclusive");
+  }
+}
+
+void validateNogroupClauses(const OpenMPDirective &directive,
+                            OpenMPClauseKind,
+                            const std::vector<OpenMPClause *> &,
+                            Diagnostics &diagnostics) {
+  if (clauseCount(directive, OMPC_reduction) != 0) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "nogroup and reduction clauses are mutually exclusive");
+  }
+}
+
+void validateMemoryOrderClauses(const OpenMPDirective &directive,
+                                OpenMPClauseKind kind,
+                                const std::vector<OpenMPClause *> &,
+                                Diagnostics &diagnostics) {
+  rejectExclusiveClauses(
+      directive, kind,
+      {OMPC_seq_cst, OMPC_acq_rel, OMPC_release, OMPC_acquire, OMPC_relaxed},
+      "mutually exclusive memory-order clauses cannot be combined",
+      diagnostics);
+}
+
+// Directive rules; see OpenMPValidation.def.
+
+void validateCancellationDirective(const OpenMPDirective &directive,
+                                   Diagnostics &diagnostics) {
+  if (requireAnyClause(
+          directive,
+          {OMPC_parallel, OMPC_sections, OMPC_for, OMPC_do, OMPC_taskgroup},
+          "cancellation directive requires a construct type",
+          diagnostics) > 1) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "cancellation directive permits exactly one construct type");
+  }
+}
+
+void validateDeclareMapperDirective(
+    const OpenMPDeclareMapperDirective &directive, Diagnostics &diagnostics) {
+  requireAnyClause(directive, {OMPC_map},
+                   "declare mapper requires at least one map clause",
+                   diagnostics);
+  if (directive.getDeclareMapperType().empty() ||
+      directive.getDeclareMapperVar().empty()) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidDirective,
+        "declare mapper requires a mapped type and variable");
+  }
+}
+
+void validateTargetDataDirective(const OpenMPDirective &directive,
+                                 Diagnostics &diagnostics) {
+  requireAnyClause(directive,
+                   {OMPC_map, OMPC_use_device_addr, OMPC_use_device_ptr},
+                   "target_data requires a data-environment clause",
+                   diagnostics);
+}
+
+void validateTargetDataMotionDirective(const OpenMPDirective &directive,
+                                       Diagnostics &diagnostics) {
+  requireAnyClause(directive, {OMPC_map},
+                   "target data-motion construct requires a map clause",
+                   diagnostics);
+}
+
+void validateTargetUpdateDirective(const OpenMPDirective &directive,
+                                   Diagnostics &diagnostics) {
+  requireAnyClause(directive, {OMPC_to, OMPC_from},
+                   "target_update requires a to or from clause", diagnostics);
+}
+
+void validateDepobjDirective(const OpenMPDepobjDirective &directive,
+                             Diagnostics &diagnostics) {
+  if (requireAnyClause(
+          directive, {OMPC_depend, OMPC_destroy, OMPC_depobj_update, OMPC_init},
+          "depobj requires an action clause", diagnostics) > 1) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "depobj permits exactly one depend, destroy, update, or init "
+        "clause");
+  }
+  if (directive.getDepobj().empty()) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidDirective,
+                           "depobj requires a depobj argument");
+  }
+}
+
+void validateInteropDirective(const OpenMPDirective &directive,
+                              Diagnostics &diagnostics) {
+  requireAnyClause(directive, {OMPC_destroy, OMPC_init, OMPC_use},
+                   "interop requires an action clause", diagnostics);
+  if (clauseCount(directive, OMPC_depend) == 0) {
+    return;
+  }
+
+  const auto *init_clauses = directive.findClauses(OMPC_init);
+  const bool has_targetsync_init =
+      init_clauses != nullptr &&
+      std::any_of(
+          init_clauses->begin(), init_clauses->end(),
+          [](const OpenMPClause *clause) {
+            const auto *init = dynamic_cast<const OpenMPInitClause *>(clause);
+            return init != nullptr &&
+                   initIncludesInteropType(*init, OMPC_INIT_KIND_targetsync);
+          });
+  // A use or destroy clause inherits its interop type from the object's
+  // prior initialization, which requires host-language contextual checks.
+  const bool has_inferred_type_action =
+      clauseCount(directive, OMPC_use) != 0 ||
+      clauseCount(directive, OMPC_destroy) != 0;
+  if (!has_targetsync_init && !has_inferred_type_action) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidClause,
+        "depend on interop requires a targetsync interop type");
+  }
+}
+
+void validateTileDirective(const OpenMPDirective &directive,
+                           Diagnostics &diagnostics) {
+  requireAnyClause(directive, {OMPC_sizes},
+                   "tile and stripe require a sizes clause", diagnostics);
+}
+
+void validateSplitDirective(const OpenMPDirective &directive,
+                            Diagnostics &diagnostics) {
+  requireAnyClause(directive, {OMPC_counts}, "split requires a counts clause",
+                   diagnostics);
+}
+
+void validateDeclareInductionDirective(const OpenMPDirective &directive,
+                                       Diagnostics &diagnostics) {
+  requireAnyClause(directive, {OMPC_inductor},
+                   "declare_induction requires an inductor clause",
+                   diagnostics);
+  requireAnyClause(directive, {OMPC_collector},
+                   "declare_induction requires a collector clause",
+                   diagnostics);
+}
+
+void validateUnrollDirective(const OpenMPDirective &directive,
+                             Diagnostics &diagnostics) {
+  if (clauseCount(directive, OMPC_apply) != 0 &&
+      clauseCount(directive, OMPC_partial) == 0) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidClause,
+                           "unroll apply clauses require a partial clause");
+  }
+}
+
+void validateEndDirective(const OpenMPEndDirective &directive,
+                          Diagnostics &diagnostics) {
+  const OpenMPDirective *paired = directive.getPairedDirective();
+  const OpenMPDirectiveKind paired_kind =
+      paired != nullptr ? paired->getKind() : OMPD_unknown;
+  if (paired == nullptr) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidDirective,
+        "end directive requires an owned paired-directive payload");
+  }
+  for (const OpenMPClause *clause : directive.getClausesInOriginalOrder()) {
+    if (clause == nullptr) {
+      continue;
+    }
+    bool allowed = false;
+    if (clause->getKind() == OMPC_copyprivate) {
+      allowed = paired_kind == OMPD_single;
+    } else if (clause->getKind() == OMPC_nowait) {
+      allowed = ompparser::isClauseAllowedOnDirective(paired_kind, OMPC_nowait);
+    }
+    if (!allowed) {
+      addStructureDiagnostic(
+          diagnostics, ompparser::DiagnosticCode::InvalidClause,
+          std::string("clause '") +
+              ompparser::getClauseName(clause->getKind()) +
+              "' does not have the end-clause property for this directive");
+    }
+  }
+}
+
+void validateScanDirective(const OpenMPDirective &directive,
+                           Diagnostics &diagnostics) {
+  if (clauseCount(directive,
+                  {OMPC_inclusive, OMPC_exclusive, OMPC_init_complete}) != 1) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidDirective,
+        "scan requires exactly one inclusive, exclusive, or init_complete "
+        "clause");
+  }
+}
+
+void validateDeclareReductionDirective(
+    const OpenMPDeclareReductionDirective &directive,
+    Diagnostics &diagnostics) {
+  const bool has_combiner_clause = clauseCount(directive, OMPC_combiner) != 0;
+  if (directive.getIdentifier().empty() ||
+      directive.getTypenameList().empty() ||
+      (directive.getCombiner().empty() && !has_combiner_clause)) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidDirective,
+        "declare reduction requires an identifier, type list, and combiner");
+  }
+}
+
+void validateThreadprivateDirective(
+    const OpenMPThreadprivateDirective &directive, Diagnostics &diagnostics) {
+  if (directive.getThreadprivateList().empty()) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidDirective,
+        "threadprivate requires a non-empty variable list");
+  }
+}
+
+void validateGroupprivateDirective(
+    const OpenMPGroupprivateDirective &directive, Diagnostics &diagnostics) {
+  if (directive.getGroupprivateList().empty()) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidDirective,
+                           "groupprivate requires a non-empty variable list");
+  }
+}
+
+void validateAllocateDirective(const OpenMPAllocateDirective &directive,
+                               Diagnostics &diagnostics) {
+  if (directive.getAllocateList().empty()) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidDirective,
+                           "allocate requires a non-empty variable list");
+  }
+}
+
+void validateDeclareVariantDirective(
+    const OpenMPDeclareVariantDirective &directive, Diagnostics &diagnostics) {
+  if (directive.getVariantFuncID().empty()) {
+    addStructureDiagnostic(
+        diagnostics, ompparser::DiagnosticCode::InvalidDirective,
+        "declare variant requires a variant function identifier");
+  }
+}
+
+void validateCriticalDirective(const OpenMPCriticalDirective &directive,
+                               Diagnostics &diagnostics) {
+  const ompparser::HostFragment &name = directive.getCriticalNameFragment();
+  if (!name.spelling.empty() &&
+      (!isOpenMPIdentifier(name.spelling) ||
+       name.role != ompparser::HostFragmentRole::Declarator ||
+       name.parse_mode != OMP_EXPR_PARSE_openmp_syntax)) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::InvalidDirective,
+                           "critical name is not a typed OpenMP name");
+  }
+}
+
+// Rule dispatch generated from OpenMPValidation.def. Like OpenMPIRVisitor.h,
+// it trusts the kind-to-class pairing in OpenMPIRNodes.def: every producer
+// builds a rule kind as its dedicated class, and a node that breaks the
+// pairing is a bug, not input to skip.
+
+// Rules run on this thread, for detail::validationRuleRuns.
+thread_local uint64_t rule_runs = 0;
+
+void runClauseRule(const OpenMPClause &clause, const OpenMPDirective &directive,
+                   Diagnostics &diagnostics) {
+  switch (clause.OpenMPClause::getKind()) {
+#define OPENMP_CLAUSE_RULE(Name, Rule)                                         \
+  case OMPC_##Name: {                                                          \
+    using Typed = ompparser::OpenMPClauseNodeT<OMPC_##Name>;                   \
+    assert(dynamic_cast<const Typed *>(&clause) != nullptr);                   \
+    ++rule_runs;                                                               \
+    Rule(static_cast<const Typed &>(clause), directive, diagnostics);          \
+    break;                                                                     \
+  }
+#include "OpenMPValidation.def"
+#undef OPENMP_CLAUSE_RULE
+  default:
+    break;
+  }
+}
+
+void runClauseSetRule(const OpenMPDirective &directive, OpenMPClauseKind kind,
+                      const std::vector<OpenMPClause *> &clauses,
+                      Diagnostics &diagnostics) {
+  switch (kind) {
+#define OPENMP_CLAUSE_SET_RULE(Name, Rule)                                     \
+  case OMPC_##Name:                                                            \
+    ++rule_runs;                                                               \
+    Rule(directive, kind, clauses, diagnostics);                               \
+    break;
+#include "OpenMPValidation.def"
+#undef OPENMP_CLAUSE_SET_RULE
+  default:
+    break;
+  }
+}
+
+void runDirectiveRule(const OpenMPDirective &directive,
+                      Diagnostics &diagnostics) {
+  switch (directive.getKind()) {
+#define OPENMP_DIRECTIVE_RULE(Name, Rule)                                      \
+  case OMPD_##Name: {                                                          \
+    using Typed = ompparser::OpenMPDirectiveNodeT<OMPD_##Name>;                \
+    assert(dynamic_cast<const Typed *>(&directive) != nullptr);                \
+    ++rule_runs;                                                               \
+    Rule(static_cast<const Typed &>(directive), diagnostics);                  \
+    break;                                                                     \
+  }
+#include "OpenMPValidation.def"
+#undef OPENMP_DIRECTIVE_RULE
+  default:
+    break;
+  }
+}
+
+void validateClauseSet(const OpenMPDirective &directive, OpenMPClauseKind kind,
+                       const std::vector<OpenMPClause *> &clauses,
+                       Diagnostics &diagnostics) {
+  if (clauses.empty()) {
+    return;
+  }
+  if (ompparser::getClauseCardinality(kind) ==
+          ompparser::ClauseCardinality::Unique &&
+      clauses.size() > 1) {
+    addStructureDiagnostic(diagnostics,
+                           ompparser::DiagnosticCode::DuplicateClause,
+                           std::string("duplicate unique clause '") +
+                               ompparser::getClauseName(kind) + "'");
+  }
+  runClauseSetRule(directive, kind, clauses, diagnostics);
+}
+
+void validateOpenMPStructure(const OpenMPDirective &directive,
+                             Diagnostics &diagnostics) {
+  for (const auto &entry : directive.getAllClauses()) {
+    validateClauseSet(directive, entry.first, entry.second, diagnostics);
   }
 
   for (const OpenMPClause *clause : directive.getClausesInOriginalOrder()) {
@@ -415,678 +1198,957 @@ void validateOpenMPStructure(const OpenMPDirective &directive,
               "' is not allowed on directive '" +
               ompparser::getDirectiveName(directive.getKind()) + "'");
     }
-    if (ompparser::clauseRequiresExpressionList(clause->getKind())) {
-      const auto &expressions = clause->getExpressionItems();
-      if (expressions.empty() ||
-          std::any_of(expressions.begin(), expressions.end(),
-                      [](const OpenMPExpressionItem &expression) {
-                        return expression.fragment.spelling.empty();
-                      })) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            std::string("clause '") +
-                ompparser::getClauseName(clause->getKind()) +
-                "' requires a non-empty expression or locator list");
-      }
+    if (ompparser::clauseRequiresExpressionList(clause->getKind()) &&
+        hasEmptyExpression(*clause)) {
+      addStructureDiagnostic(
+          diagnostics, ompparser::DiagnosticCode::InvalidClause,
+          std::string("clause '") +
+              ompparser::getClauseName(clause->getKind()) +
+              "' requires a non-empty expression or locator list");
     }
-    const auto *absent = dynamic_cast<const OpenMPAbsentClause *>(clause);
-    const auto *contains = dynamic_cast<const OpenMPContainsClause *>(clause);
-    if ((absent != nullptr && absent->getDirectives().empty()) ||
-        (contains != nullptr && contains->getDirectives().empty())) {
-      addStructureDiagnostic(diagnostics,
-                             ompparser::DiagnosticCode::InvalidClause,
-                             std::string("clause '") +
-                                 ompparser::getClauseName(clause->getKind()) +
-                                 "' requires a non-empty directive-name list");
-    }
-    if (const auto *adjust_args =
-            dynamic_cast<const OpenMPAdjustArgsClause *>(clause)) {
-      if (adjust_args->getModifier() == OMPC_ADJUST_ARGS_unknown ||
-          adjust_args->getArguments().empty()) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "adjust_args requires a typed adjust-op and a non-empty "
-            "parameter list");
-      }
+    runClauseRule(*clause, directive, diagnostics);
+  }
+
+  runDirectiveRule(directive, diagnostics);
+}
+
+// Validates a directive reparse assembled after an edit changed its clauses
+// of the kinds in changed. The clauses the edit touched were validated on the
+// partial directive that parsed them and the others on the previous one, which
+// had the same kind and language, the only parts of the directive a clause
+// rule reads. That leaves the clause sets of the changed kinds, the clause-set
+// rules that read them, and the directive rule.
+void validateEditedStructure(const OpenMPDirective &directive,
+                             std::vector<OpenMPClauseKind> changed,
+                             Diagnostics &diagnostics) {
+  const std::size_t edited = changed.size();
+  for (std::size_t index = 0; index < edited; ++index) {
+#define OPENMP_CLAUSE_SET_RULE_READS(Name, Read)                               \
+  if (changed[index] == OMPC_##Read) {                                         \
+    changed.push_back(OMPC_##Name);                                            \
+  }
+#include "OpenMPValidation.def"
+#undef OPENMP_CLAUSE_SET_RULE_READS
+  }
+  std::sort(changed.begin(), changed.end());
+  changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+  for (OpenMPClauseKind kind : changed) {
+    const auto entry = directive.getAllClauses().find(kind);
+    if (entry != directive.getAllClauses().end()) {
+      validateClauseSet(directive, kind, entry->second, diagnostics);
     }
-    if (const auto *allocate =
-            dynamic_cast<const OpenMPAllocateClause *>(clause)) {
-      const bool has_user_allocator =
-          !allocate->getUserDefinedAllocator().empty();
-      const bool typed_user_allocator =
-          allocate->getAllocator() == OMPC_ALLOCATE_ALLOCATOR_user;
-      if (has_user_allocator != typed_user_allocator ||
-          (allocate->usesAllocatorModifierSyntax() && !typed_user_allocator)) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "allocate allocator kind, modifier syntax, and typed payload "
-            "must agree");
-      }
+  }
+  runDirectiveRule(directive, diagnostics);
+}
+
+// A trusted tree comes straight from the grammar, so only the construction
+// errors recorded while building it can be reported by validateInvariants.
+using DirectiveSet = std::unordered_set<const OpenMPDirective *>;
+
+void validateDirectiveTree(const OpenMPDirective &directive,
+                           std::vector<ompparser::Diagnostic> &diagnostics,
+                           DirectiveSet &active, DirectiveSet &validated,
+                           bool trusted) {
+  if (active.count(&directive) != 0) {
+    addStructureDiagnostic(diagnostics, ompparser::DiagnosticCode::InvalidAst,
+                           "directive tree contains a cycle");
+    return;
+  }
+  if (validated.count(&directive) != 0) {
+    return;
+  }
+
+  active.insert(&directive);
+  std::vector<std::string> errors;
+  if (trusted) {
+    directive.collectConstructionErrors(errors);
+  } else {
+    directive.validateInvariants(errors);
+  }
+  for (std::string &message : errors) {
+    addStructureDiagnostic(diagnostics, ompparser::DiagnosticCode::InvalidAst,
+                           message);
+  }
+  validateOpenMPStructure(directive, diagnostics);
+  visitImmediateNestedDirectives(directive, [&](const OpenMPDirective &nested) {
+    validateDirectiveTree(nested, diagnostics, active, validated, trusted);
+  });
+  active.erase(&directive);
+  validated.insert(&directive);
+}
+
+ompparser::ValidationResult validateTree(const OpenMPDirective &directive,
+                                         bool trusted) {
+  ompparser::ValidationResult result;
+  DirectiveSet active;
+  DirectiveSet validated;
+  validateDirectiveTree(directive, result.diagnostics, active, validated,
+                        trusted);
+  if (result.success()) {
+    for (const OpenMPDirective *accepted : validated) {
+      accepted->markValidated();
     }
-    if (const auto *init = dynamic_cast<const OpenMPInitClause *>(clause)) {
-      if (init->getOperand().empty()) {
-        addStructureDiagnostic(diagnostics,
-                               ompparser::DiagnosticCode::InvalidClause,
-                               "init requires an init-var argument");
-      }
-      const bool on_interop = directive.getKind() == OMPD_interop;
-      const bool on_depobj = directive.getKind() == OMPD_depobj;
-      if (!on_interop && !on_depobj) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "init is only valid on interop and depobj directives");
-      } else {
-        validateInitModifiers(init->getModifiers(), on_interop, on_depobj,
-                              diagnostics);
-      }
+  }
+  return result;
+}
+
+// True when every directive in the tree is unchanged since validation last
+// accepted it. A cycle is never cached, so validation gets to report it.
+bool isValidatedTree(const OpenMPDirective &directive,
+                     std::vector<const OpenMPDirective *> &path) {
+  if (!directive.isValidated() ||
+      std::find(path.begin(), path.end(), &directive) != path.end()) {
+    return false;
+  }
+  path.push_back(&directive);
+  bool validated = true;
+  visitImmediateNestedDirectives(directive, [&](const OpenMPDirective &nested) {
+    validated = validated && isValidatedTree(nested, path);
+  });
+  path.pop_back();
+  return validated;
+}
+
+ompparser::ValidationResult
+validateUnlessUnchanged(const OpenMPDirective &directive) {
+  std::vector<const OpenMPDirective *> path;
+  if (isValidatedTree(directive, path)) {
+    return {};
+  }
+  return validateTree(directive, false);
+}
+
+// Writes the input directive retains, regenerating the clauses modified
+// since it was retained; false when there is no input or the header or
+// clause list has changed.
+bool writeVerbatim(const OpenMPDirective &directive, std::string &text,
+                   std::string &clause_buffer) {
+  const OpenMPRetainedSource *source = directive.getRetainedSource();
+  if (source == nullptr ||
+      source->header_generation != directive.getHeaderGeneration()) {
+    return false;
+  }
+  if (source->generation == directive.getModificationGeneration()) {
+    text.assign(source->text, 0, source->end);
+    return true;
+  }
+  const std::vector<OpenMPClause *> &clauses =
+      directive.getClausesInOriginalOrder();
+  if (clauses.size() != source->clauses.size()) {
+    return false;
+  }
+  text.assign(source->text, 0, source->header_end);
+  std::size_t previous_end = source->header_end;
+  for (std::size_t index = 0; index < clauses.size(); ++index) {
+    const OpenMPRetainedSource::Clause &span = source->clauses[index];
+    if (clauses[index] != span.clause) {
+      return false;
     }
-    if (clause->getKind() == OMPC_destroy &&
-        directive.getKind() == OMPD_interop) {
-      const auto &expressions = clause->getExpressionItems();
-      if (expressions.empty() ||
-          std::any_of(expressions.begin(), expressions.end(),
-                      [](const OpenMPExpressionItem &expression) {
-                        return expression.fragment.spelling.empty();
-                      })) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "destroy on interop requires a destroy-var argument");
-      }
+    text.append(source->text, previous_end, span.begin - previous_end);
+    if (clauses[index]->getModificationGeneration() == span.generation) {
+      text.append(source->text, span.begin, span.end - span.begin);
+    } else {
+      // The separators around the clause are the input's.
+      clauses[index]->writeString(clause_buffer);
+      text.append(clause_buffer, 0, clause_buffer.find_last_not_of(' ') + 1);
     }
-    if (const auto *append_args =
-            dynamic_cast<const OpenMPAppendArgsClause *>(clause)) {
-      if (append_args->getOperations().empty()) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "append_args requires a non-empty operation list");
-      }
-      for (const OpenMPAppendArgsClause::Operation &operation :
-           append_args->getOperations()) {
-        if (operation.kind != OMPC_APPEND_ARGS_interop) {
-          addStructureDiagnostic(diagnostics,
-                                 ompparser::DiagnosticCode::InvalidClause,
-                                 "append_args contains an unknown operation");
-          continue;
-        }
-        validateInitModifiers(operation.modifiers, true, false, diagnostics);
-      }
+    previous_end = span.end;
+  }
+  return true;
+}
+
+// Renders a directive unparse accepts into text; text is left empty when
+// there are diagnostics.
+ompparser::ValidationResult renderDirective(
+    const OpenMPDirective &directive, std::string &text,
+    std::string &clause_buffer,
+    ompparser::UnparseFormat format = ompparser::UnparseFormat::Normalized) {
+  text.clear();
+  ompparser::ValidationResult result = validateUnlessUnchanged(directive);
+  if (!result.success()) {
+    return result;
+  }
+  if (format != ompparser::UnparseFormat::Verbatim ||
+      !writeVerbatim(directive, text, clause_buffer)) {
+    directive.writePragmaString(text, clause_buffer);
+  }
+  if (text.empty()) {
+    ompparser::Diagnostic diagnostic;
+    diagnostic.code = ompparser::DiagnosticCode::InvalidAst;
+    diagnostic.severity = ompparser::DiagnosticSeverity::Error;
+    diagnostic.message = "cannot unparse an invalid OpenMP AST";
+    result.diagnostics.push_back(std::move(diagnostic));
+  }
+  return result;
+}
+
+// Output of one contiguous slice of an unparseAll batch; ends[i] is where
+// the slice's i-th directive stops in text.
+struct UnparseChunk {
+  std::string text;
+  std::vector<std::size_t> ends;
+  std::vector<ompparser::BatchDiagnostic> diagnostics;
+  // What a worker thread threw, rethrown once every worker has joined.
+  std::exception_ptr error;
+};
+
+void unparseChunk(const OpenMPDirective *const *directives, std::size_t begin,
+                  std::size_t end, std::string_view terminator,
+                  UnparseChunk &chunk) {
+  std::string text;
+  std::string clause_buffer;
+  chunk.ends.reserve(end - begin);
+  for (std::size_t index = begin; index < end; ++index) {
+    ompparser::ValidationResult result;
+    if (directives[index] == nullptr) {
+      ompparser::Diagnostic diagnostic;
+      diagnostic.code = ompparser::DiagnosticCode::NullInput;
+      diagnostic.severity = ompparser::DiagnosticSeverity::Error;
+      diagnostic.message = "cannot unparse a null directive";
+      result.diagnostics.push_back(std::move(diagnostic));
+    } else {
+      result = renderDirective(*directives[index], text, clause_buffer);
     }
-    if (const auto *apply = dynamic_cast<const OpenMPApplyClause *>(clause)) {
-      if (hasEmptyApplyTree(*apply)) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "apply and nested apply clauses require non-empty "
-            "applied-directives lists");
+    if (result.diagnostics.empty()) {
+      chunk.text += text;
+      chunk.text += terminator;
+    } else {
+      for (ompparser::Diagnostic &diagnostic : result.diagnostics) {
+        chunk.diagnostics.push_back({index, std::move(diagnostic)});
       }
     }
-    if (const auto *variant =
-            dynamic_cast<const OpenMPVariantClause *>(clause)) {
-      std::vector<std::string> selector_errors;
-      variant->validateSelectorInvariants(selector_errors);
-      for (const std::string &message : selector_errors) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause, message);
-      }
+    chunk.ends.push_back(chunk.text.size());
+  }
+}
+
+bool isIdentifierCharacter(char character) {
+  return std::isalnum(static_cast<unsigned char>(character)) ||
+         character == '_';
+}
+
+// Start of the last whole-word, case-insensitive occurrence of keyword that
+// begins in [lower, upper], or npos. Grammar actions that build a clause
+// after its opening parenthesis record a position past the keyword.
+std::size_t findKeywordBackward(std::string_view source,
+                                std::string_view keyword, std::size_t lower,
+                                std::size_t upper) {
+  if (keyword.empty() || source.size() < keyword.size()) {
+    return std::string_view::npos;
+  }
+  for (std::size_t start = std::min(upper, source.size() - keyword.size()) + 1;
+       start-- > lower;) {
+    if ((start > 0 && isIdentifierCharacter(source[start - 1])) ||
+        (start + keyword.size() < source.size() &&
+         isIdentifierCharacter(source[start + keyword.size()]))) {
+      continue;
     }
-    if (const auto *default_clause =
-            dynamic_cast<const OpenMPDefaultClause *>(clause)) {
-      if (default_clause->getDefaultClauseKind() == OMPC_DEFAULT_variant &&
-          default_clause->getVariantDirective() == nullptr) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidAst,
-            "default variant clause requires a variant directive");
-      }
+    if (std::equal(keyword.begin(), keyword.end(), source.begin() + start,
+                   [](char lhs, char rhs) {
+                     return std::tolower(static_cast<unsigned char>(lhs)) ==
+                            std::tolower(static_cast<unsigned char>(rhs));
+                   })) {
+      return start;
     }
-    if (const auto *uses_allocators =
-            dynamic_cast<const OpenMPUsesAllocatorsClause *>(clause)) {
-      if (uses_allocators->getUsesAllocatorsAllocatorSequence().empty()) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "uses_allocators requires a non-empty allocator list");
-      }
+  }
+  return std::string_view::npos;
+}
+
+
+// Moves the keyword position of clause and the ranges of the fragments it
+// owns from the text from describes to the text to describes. Returns false
+// when a position does not lie in from, as when the lexer could not record a
+// fragment's range; such a clause cannot be moved.
+template <typename OffsetMap>
+bool moveClausePositions(OpenMPClause &clause,
+                         const ompparser::detail::SourceLineTable &from,
+                         const ompparser::detail::SourceLineTable &to,
+                         OffsetMap map_offset) {
+  const std::size_t keyword =
+      from.offsetOf(clause.getLine(), clause.getColumn());
+  if (keyword == std::string_view::npos) {
+    return false;
+  }
+  const ompparser::SourcePosition position =
+      to.positionOf(map_offset(keyword));
+  clause.setLine(static_cast<int>(position.line));
+  clause.setColumn(static_cast<int>(position.column));
+
+  auto recorded = [&](const ompparser::SourcePosition &point) {
+    return from.offsetOf(static_cast<int>(point.line),
+                         static_cast<int>(point.column)) == point.offset;
+  };
+  bool moved = true;
+  clause.visitHostFragments([&](ompparser::HostFragment &fragment) {
+    if (fragment.range.begin.line == 0) {
+      return;
     }
-    if (const auto *map_clause =
-            dynamic_cast<const OpenMPMapClause *>(clause)) {
-      const ompparser::HostFragment &mapper =
-          map_clause->getMapperIdentifierFragment();
-      if (!mapper.spelling.empty() &&
-          (mapper.role != ompparser::HostFragmentRole::Declarator ||
-           mapper.parse_mode != OMP_EXPR_PARSE_verbatim ||
-           !isOpenMPIdentifier(mapper.spelling))) {
-        addStructureDiagnostic(diagnostics,
-                               ompparser::DiagnosticCode::InvalidClause,
-                               "map mapper identifier '" + mapper.spelling +
-                                   "' is not a typed OpenMP name (mode " +
-                                   std::to_string(mapper.parse_mode) + ")");
-      }
-      const auto &all_policies = map_clause->getDistDataPolicies();
-      const bool has_invalid_policy = std::any_of(
-          all_policies.begin(), all_policies.end(), [](const auto &policies) {
-            return std::any_of(
-                policies.begin(), policies.end(),
-                [](const OpenMPMapClause::DistDataPolicy &policy) {
-                  return policy.kind == OpenMPMapClause::DIST_DATA_unknown;
-                });
-          });
-      if (has_invalid_policy) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "dist_data contains an unrecognized or malformed policy");
-      }
+    if (!recorded(fragment.range.begin) || !recorded(fragment.range.end)) {
+      moved = false;
+      return;
     }
-    if (const auto *to_clause = dynamic_cast<const OpenMPToClause *>(clause)) {
-      const ompparser::HostFragment &mapper =
-          to_clause->getMapperIdentifierFragment();
-      if (!mapper.spelling.empty() &&
-          (mapper.role != ompparser::HostFragmentRole::Declarator ||
-           mapper.parse_mode != OMP_EXPR_PARSE_verbatim ||
-           !isOpenMPIdentifier(mapper.spelling))) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "to mapper identifier is not a typed OpenMP name");
-      }
+    fragment.range.begin =
+        to.positionOf(map_offset(fragment.range.begin.offset));
+    fragment.range.end = to.positionOf(map_offset(fragment.range.end.offset));
+  });
+  return moved;
+}
+
+constexpr std::string_view ClauseSeparators = " \t\r\n\\,";
+
+std::string_view trimClauseSeparators(std::string_view text) {
+  return text.substr(0, text.find_last_not_of(ClauseSeparators) + 1);
+}
+
+// Keeps text on directive for UnparseFormat::Verbatim, given the offset of
+// each clause keyword in it.
+void retainSourceSpans(std::string_view text, OpenMPDirective &directive,
+                       const std::vector<std::size_t> &starts) {
+  const std::vector<OpenMPClause *> &clauses =
+      std::as_const(directive).getClausesInOriginalOrder();
+  auto source = std::make_unique<OpenMPRetainedSource>();
+  source->text.assign(text.data(), text.size());
+  source->header_end =
+      trimClauseSeparators(
+          text.substr(0, clauses.empty() ? text.size() : starts.front()))
+          .size();
+  source->end = source->header_end;
+  source->clauses.reserve(clauses.size());
+  for (std::size_t index = 0; index < clauses.size(); ++index) {
+    const std::size_t begin = starts[index];
+    const std::size_t limit =
+        index + 1 < starts.size() ? starts[index + 1] : text.size();
+    source->end =
+        begin + trimClauseSeparators(text.substr(begin, limit - begin)).size();
+    source->clauses.push_back({clauses[index], begin, source->end,
+                               clauses[index]->getModificationGeneration()});
+  }
+  source->generation = directive.getModificationGeneration();
+  source->header_generation = directive.getHeaderGeneration();
+  directive.retainSource(std::move(source));
+}
+
+// Keeps text on directive for UnparseFormat::Verbatim, with the span of each
+// clause, unless a clause keyword cannot be located or the directive's text
+// depends on a directive nested in it.
+void retainSourceText(std::string_view text, OpenMPDirective &directive) {
+  const OpenMPDirectiveKind kind = directive.getKind();
+  if (kind == OMPD_atomic || kind == OMPD_end ||
+      kind == OMPD_declare_induction) {
+    return;
+  }
+  const std::vector<OpenMPClause *> &clauses =
+      std::as_const(directive).getClausesInOriginalOrder();
+  for (const OpenMPClause *clause : clauses) {
+    if (clause == nullptr || clause->rendersNestedDirective()) {
+      return;
     }
-    if (const auto *from_clause =
-            dynamic_cast<const OpenMPFromClause *>(clause)) {
-      const ompparser::HostFragment &mapper =
-          from_clause->getMapperIdentifierFragment();
-      if (!mapper.spelling.empty() &&
-          (mapper.role != ompparser::HostFragmentRole::Declarator ||
-           mapper.parse_mode != OMP_EXPR_PARSE_verbatim ||
-           !isOpenMPIdentifier(mapper.spelling))) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            "from mapper identifier is not a typed OpenMP name");
-      }
+  }
+  std::vector<std::size_t> starts;
+  if (!clauses.empty()) {
+    starts = ompparser::detail::locateClauseKeywords(clauses, text,
+                                                     text.size());
+    if (starts.empty()) {
+      return;
     }
-    if (const auto *depend = dynamic_cast<const OpenMPDependClause *>(clause)) {
-      if (depend->getType() == OMPC_DEPENDENCE_TYPE_sink) {
-        if (depend->getDependenceVector().empty() &&
-            depend->getExpressionItems().empty()) {
-          addStructureDiagnostic(diagnostics,
-                                 ompparser::DiagnosticCode::InvalidClause,
-                                 "depend(sink) requires a dependence vector");
-        }
-      } else if (depend->getType() != OMPC_DEPENDENCE_TYPE_source &&
-                 depend->getExpressionItems().empty()) {
-        addStructureDiagnostic(diagnostics,
-                               ompparser::DiagnosticCode::InvalidClause,
-                               "depend requires a non-empty locator list");
-      }
+  }
+  retainSourceSpans(text, directive, starts);
+}
+
+// The position just past text when text starts at position.
+ompparser::SourcePosition advancePosition(ompparser::SourcePosition position,
+                                          std::string_view text) {
+  const std::size_t newline = text.rfind('\n');
+  if (newline == std::string_view::npos) {
+    position.column += static_cast<uint32_t>(text.size());
+  } else {
+    position.line += static_cast<uint32_t>(
+        std::count(text.begin(), text.begin() + newline + 1, '\n'));
+    position.column = static_cast<uint32_t>(text.size() - newline);
+  }
+  position.offset += static_cast<uint32_t>(text.size());
+  return position;
+}
+
+// Moves positions at or after from, whose text is unchanged up to the next
+// edit, to the same place relative to to: a position on the line of from
+// keeps its distance from it, and one on a later line keeps its column.
+struct PositionShift {
+  ompparser::SourcePosition from;
+  ompparser::SourcePosition to;
+
+  // False when line and column lie before from.
+  bool move(uint32_t &line, uint32_t &column) const {
+    if (line < from.line || (line == from.line && column < from.column)) {
+      return false;
     }
-    if (const auto *reduction =
-            dynamic_cast<const OpenMPReductionClause *>(clause)) {
-      switch (reduction->getModifier()) {
-      case OMPC_REDUCTION_MODIFIER_unspecified:
-      case OMPC_REDUCTION_MODIFIER_default:
-      case OMPC_REDUCTION_MODIFIER_inscan:
-      case OMPC_REDUCTION_MODIFIER_task:
-      case OMPC_REDUCTION_MODIFIER_original_private:
-        break;
-      default:
-        addStructureDiagnostic(diagnostics,
-                               ompparser::DiagnosticCode::InvalidClause,
-                               "reduction has an unknown modifier");
-        break;
-      }
-      const OpenMPReductionClauseIdentifier identifier =
-          reduction->getIdentifier();
-      const bool c_only = identifier == OMPC_REDUCTION_IDENTIFIER_bitand ||
-                          identifier == OMPC_REDUCTION_IDENTIFIER_bitor ||
-                          identifier == OMPC_REDUCTION_IDENTIFIER_bitxor;
-      const bool fortran_only = identifier == OMPC_REDUCTION_IDENTIFIER_eqv ||
-                                identifier == OMPC_REDUCTION_IDENTIFIER_neqv;
-      if (identifier == OMPC_REDUCTION_IDENTIFIER_unknown) {
-        addStructureDiagnostic(diagnostics,
-                               ompparser::DiagnosticCode::InvalidClause,
-                               "reduction has an unknown identifier");
-      }
-      validateReductionIdentifier(directive.getBaseLang(), c_only, fortran_only,
-                                  identifier == OMPC_REDUCTION_IDENTIFIER_user,
-                                  reduction->getUserDefinedIdentifierFragment(),
-                                  diagnostics);
-    }
-    if (const auto *reduction =
-            dynamic_cast<const OpenMPInReductionClause *>(clause)) {
-      const OpenMPInReductionClauseIdentifier identifier =
-          reduction->getIdentifier();
-      const bool c_only = identifier == OMPC_IN_REDUCTION_IDENTIFIER_bitand ||
-                          identifier == OMPC_IN_REDUCTION_IDENTIFIER_bitor ||
-                          identifier == OMPC_IN_REDUCTION_IDENTIFIER_bitxor;
-      const bool fortran_only =
-          identifier == OMPC_IN_REDUCTION_IDENTIFIER_eqv ||
-          identifier == OMPC_IN_REDUCTION_IDENTIFIER_neqv;
-      if (identifier == OMPC_IN_REDUCTION_IDENTIFIER_unknown) {
-        addStructureDiagnostic(diagnostics,
-                               ompparser::DiagnosticCode::InvalidClause,
-                               "in_reduction has an unknown identifier");
-      }
-      validateReductionIdentifier(
-          directive.getBaseLang(), c_only, fortran_only,
-          identifier == OMPC_IN_REDUCTION_IDENTIFIER_user,
-          reduction->getUserDefinedIdentifierFragment(), diagnostics);
-    }
-    if (const auto *reduction =
-            dynamic_cast<const OpenMPTaskReductionClause *>(clause)) {
-      const OpenMPTaskReductionClauseIdentifier identifier =
-          reduction->getIdentifier();
-      const bool c_only = identifier == OMPC_TASK_REDUCTION_IDENTIFIER_bitand ||
-                          identifier == OMPC_TASK_REDUCTION_IDENTIFIER_bitor ||
-                          identifier == OMPC_TASK_REDUCTION_IDENTIFIER_bitxor;
-      const bool fortran_only =
-          identifier == OMPC_TASK_REDUCTION_IDENTIFIER_eqv ||
-          identifier == OMPC_TASK_REDUCTION_IDENTIFIER_neqv;
-      if (identifier == OMPC_TASK_REDUCTION_IDENTIFIER_unknown) {
-        addStructureDiagnostic(diagnostics,
-                               ompparser::DiagnosticCode::InvalidClause,
-                               "task_reduction has an unknown identifier");
-      }
-      validateReductionIdentifier(
-          directive.getBaseLang(), c_only, fortran_only,
-          identifier == OMPC_TASK_REDUCTION_IDENTIFIER_user,
-          reduction->getUserDefinedIdentifierFragment(), diagnostics);
+    if (line == from.line) {
+      column = column - from.column + to.column;
     }
+    line = line - from.line + to.line;
+    return true;
   }
 
-  auto clause_count = [&directive](OpenMPClauseKind kind) {
-    const auto *clauses = directive.findClauses(kind);
-    return clauses == nullptr ? std::size_t{0} : clauses->size();
-  };
-  auto require_any_clause = [&diagnostics, &clause_count](
-                                std::initializer_list<OpenMPClauseKind> kinds,
-                                const char *message) {
-    const std::size_t count = std::accumulate(
-        kinds.begin(), kinds.end(), std::size_t{0},
-        [&clause_count](std::size_t sum, OpenMPClauseKind kind) {
-          return sum + clause_count(kind);
-        });
-    if (count == 0) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidDirective, message);
+  bool move(ompparser::SourcePosition &position) const {
+    if (position.offset < from.offset ||
+        !move(position.line, position.column)) {
+      return false;
     }
-    return count;
-  };
-  auto reject_exclusive_clauses =
-      [&diagnostics, &clause_count](
-          std::initializer_list<OpenMPClauseKind> kinds, const char *message) {
-        const std::size_t count = std::accumulate(
-            kinds.begin(), kinds.end(), std::size_t{0},
-            [&clause_count](std::size_t sum, OpenMPClauseKind kind) {
-              return sum + clause_count(kind);
-            });
-        if (count > 1) {
-          addStructureDiagnostic(
-              diagnostics, ompparser::DiagnosticCode::InvalidClause, message);
-        }
-      };
+    position.offset = position.offset - from.offset + to.offset;
+    return true;
+  }
+};
+
+// Applies shift to the keyword position of clause and the ranges of the
+// fragments it owns. Returns false when a position lies before the shift.
+bool shiftClausePositions(OpenMPClause &clause, const PositionShift &shift) {
+  uint32_t line = static_cast<uint32_t>(clause.getLine());
+  uint32_t column = static_cast<uint32_t>(clause.getColumn());
+  if (clause.getLine() <= 0 || !shift.move(line, column)) {
+    return false;
+  }
+  clause.setLine(static_cast<int>(line));
+  clause.setColumn(static_cast<int>(column));
+
+  bool moved = true;
+  clause.visitHostFragments([&](ompparser::HostFragment &fragment) {
+    if (fragment.range.begin.line != 0) {
+      moved = moved && shift.move(fragment.range.begin) &&
+              shift.move(fragment.range.end);
+    }
+  });
+  return moved;
+}
+
+// Reparses that took the fast path on this thread, for detail::fastReparses.
+thread_local uint64_t fast_reparses = 0;
+
+// The fast path of reparse: parses the header of previous_text followed by
+// the clauses the edit touches, then splices copies of the other clauses
+// around them. The copies keep their positions, or shift them by the change
+// in length the edit makes, and validation only reruns the rules of the
+// clause kinds the edit changed. Returns a null directive whenever a full
+// parse is needed.
+ompparser::ParseResult
+reparseEditedClauses(const ompparser::ParseResult &previous,
+                     std::string_view previous_text,
+                     const ompparser::SourceEdit &edit, std::string_view text,
+                     const ompparser::ParseOptions &options) {
+  ompparser::ParseResult result;
+  const OpenMPDirective *directive = previous.directive.get();
+  if (!previous.success() || options.host_hooks ||
+      directive->getKind() == OMPD_atomic ||
+      directive->getKind() == OMPD_end ||
+      directive->getBaseLang() !=
+          ompparser::detail::convertLanguage(options.language) ||
+      (options.language == ompparser::BaseLanguage::Fortran &&
+       text.find('&') != std::string_view::npos)) {
+    return result;
+  }
+  const std::vector<OpenMPClause *> &clauses =
+      directive->getClausesInOriginalOrder();
+  for (const OpenMPClause *clause : clauses) {
+    if (clause == nullptr || clause->rendersNestedDirective()) {
+      return result;
+    }
+  }
+  // The spans retained with the previous text, while it is unchanged, save
+  // locating every clause keyword again.
+  std::vector<std::size_t> starts;
+  const OpenMPRetainedSource *retained = directive->getRetainedSource();
+  if (retained != nullptr &&
+      retained->generation == directive->getModificationGeneration() &&
+      retained->clauses.size() == clauses.size() &&
+      retained->text == previous_text) {
+    starts.reserve(clauses.size());
+    for (const OpenMPRetainedSource::Clause &span : retained->clauses) {
+      starts.push_back(span.begin);
+    }
+  } else {
+    starts = ompparser::detail::locateClauseKeywords(clauses, previous_text,
+                                                     previous_text.size());
+  }
+  if (starts.empty() || edit.offset <= starts.front()) {
+    return result;
+  }
+
+  // Clause i spans [starts[i], starts[i + 1]], the last one the rest of the
+  // text; the edit touches every clause whose span it meets, and the clause
+  // after it when it only changes the separator before that clause.
+  const std::size_t edit_end = edit.offset + edit.length;
+  const std::size_t next_token =
+      previous_text.find_first_not_of(ClauseSeparators, edit_end);
+  std::size_t first = 0;
+  while (first + 1 < starts.size() && starts[first + 1] < edit.offset) {
+    ++first;
+  }
+  std::size_t last = first;
+  while (last + 1 < starts.size() && starts[last + 1] <= next_token) {
+    ++last;
+  }
+  const std::size_t region_begin = starts[first];
+  const bool at_end = last + 1 == starts.size();
+  const std::size_t region_end =
+      (at_end ? previous_text.size() : starts[last + 1]) - edit.length +
+      edit.text.size();
+  std::string_view region =
+      text.substr(region_begin, region_end - region_begin);
+  if (!at_end) {
+    region = trimClauseSeparators(region);
+  }
+
+  const std::size_t header_size = starts.front();
+  std::string synthetic(previous_text.substr(0, header_size));
+  synthetic += region;
+  ompparser::ParseResult partial =
+      ompparser::parseDirective(synthetic, options);
+  if (!partial.success() ||
+      partial.directive->getKind() != directive->getKind()) {
+    return result;
+  }
 
-  switch (directive.getKind()) {
-  case OMPD_cancel:
-  case OMPD_cancellation_point:
-    if (require_any_clause(
-            {OMPC_parallel, OMPC_sections, OMPC_for, OMPC_do, OMPC_taskgroup},
-            "cancellation directive requires a construct "
-            "type") > 1) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidClause,
-          "cancellation directive permits exactly one construct type");
-    }
-    break;
-  case OMPD_declare_mapper:
-    require_any_clause({OMPC_map},
-                       "declare mapper requires at least one map clause");
-    break;
-  case OMPD_target_data:
-  case OMPD_target_data_composite:
-    require_any_clause({OMPC_map, OMPC_use_device_addr, OMPC_use_device_ptr},
-                       "target_data requires a data-environment clause");
-    break;
-  case OMPD_target_enter_data:
-  case OMPD_target_exit_data:
-    require_any_clause({OMPC_map},
-                       "target data-motion construct requires a map clause");
-    break;
-  case OMPD_target_update:
-    require_any_clause({OMPC_to, OMPC_from},
-                       "target_update requires a to or from clause");
-    break;
-  case OMPD_depobj:
-    if (require_any_clause(
-            {OMPC_depend, OMPC_destroy, OMPC_depobj_update, OMPC_init},
-            "depobj requires an action clause") > 1) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidClause,
-          "depobj permits exactly one depend, destroy, update, or init "
-          "clause");
+  // The text before the edit is the same in all three texts, so positions
+  // follow from the newlines up to the end of the edit.
+  ompparser::SourcePosition origin;
+  origin.line = 1;
+  origin.column = 1;
+  const ompparser::SourcePosition header =
+      advancePosition(origin, previous_text.substr(0, header_size));
+  const ompparser::SourcePosition region_start = advancePosition(
+      header,
+      previous_text.substr(header_size, region_begin - header_size));
+  const ompparser::SourcePosition edit_start = advancePosition(
+      region_start,
+      previous_text.substr(region_begin, edit.offset - region_begin));
+  const PositionShift edited_shift{header, region_start};
+  const PositionShift following_shift{
+      advancePosition(edit_start,
+                      previous_text.substr(edit.offset, edit.length)),
+      advancePosition(edit_start, edit.text)};
+
+  std::unique_ptr<OpenMPDirective> merged = std::move(partial.directive);
+  std::vector<std::size_t> merged_starts;
+  const OpenMPRetainedSource *partial_source = merged->getRetainedSource();
+  if (options.retain_source) {
+    if (partial_source == nullptr) {
+      return result;
     }
-    break;
-  case OMPD_interop: {
-    require_any_clause({OMPC_destroy, OMPC_init, OMPC_use},
-                       "interop requires an action clause");
-    if (clause_count(OMPC_depend) == 0) {
-      break;
+    merged_starts.assign(starts.begin(), starts.begin() + first);
+    for (const OpenMPRetainedSource::Clause &span : partial_source->clauses) {
+      merged_starts.push_back(span.begin - header_size + region_begin);
     }
-
-    const auto *init_clauses = directive.findClauses(OMPC_init);
-    const bool has_targetsync_init =
-        init_clauses != nullptr &&
-        std::any_of(
-            init_clauses->begin(), init_clauses->end(),
-            [](const OpenMPClause *clause) {
-              const auto *init = dynamic_cast<const OpenMPInitClause *>(clause);
-              return init != nullptr &&
-                     initIncludesInteropType(*init, OMPC_INIT_KIND_targetsync);
-            });
-    // A use or destroy clause inherits its interop type from the object's
-    // prior initialization, which requires host-language contextual checks.
-    const bool has_inferred_type_action =
-        clause_count(OMPC_use) != 0 || clause_count(OMPC_destroy) != 0;
-    if (!has_targetsync_init && !has_inferred_type_action) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidClause,
-          "depend on interop requires a targetsync interop type");
+  }
+  std::vector<OpenMPClauseKind> changed;
+  OpenMPDirective edited(merged->getKind(), merged->getBaseLang());
+  edited.adoptClausesFrom(*merged);
+  for (OpenMPClause *clause : *edited.getClausesInOriginalOrder()) {
+    if (!shiftClausePositions(*clause, edited_shift)) {
+      return result;
     }
-    break;
+    changed.push_back(clause->getKind());
   }
-  case OMPD_tile:
-  case OMPD_stripe:
-    require_any_clause({OMPC_sizes}, "tile and stripe require a sizes clause");
-    break;
-  case OMPD_split:
-    require_any_clause({OMPC_counts}, "split requires a counts clause");
-    break;
-  case OMPD_declare_induction:
-    require_any_clause({OMPC_inductor},
-                       "declare_induction requires an inductor clause");
-    require_any_clause({OMPC_collector},
-                       "declare_induction requires a collector clause");
-    break;
-  default:
-    break;
+  const std::size_t preceding =
+      text.substr(0, region_begin).find_last_not_of(" \t\r\n\\");
+  if (first > 0 && !edited.getClausesInOriginalOrder()->empty() &&
+      preceding != std::string_view::npos && text[preceding] == ',') {
+    edited.getClausesInOriginalOrder()->front()->setPrecedingSeparator(
+        OMPC_CLAUSE_SEP_comma);
   }
 
-  reject_exclusive_clauses(
-      {OMPC_inbranch, OMPC_notinbranch},
-      "inbranch and notinbranch clauses are mutually exclusive");
-  reject_exclusive_clauses(
-      {OMPC_grainsize, OMPC_num_tasks},
-      "grainsize and num_tasks clauses are mutually exclusive");
-  reject_exclusive_clauses({OMPC_full, OMPC_partial},
-                           "full and partial clauses are mutually exclusive");
-  if (clause_count(OMPC_copyprivate) != 0 && clause_count(OMPC_nowait) != 0) {
-    addStructureDiagnostic(
-        diagnostics, ompparser::DiagnosticCode::InvalidClause,
-        "copyprivate and nowait clauses are mutually exclusive");
+  auto copyClause = [&](const OpenMPClause &clause) {
+    OpenMPClause *copy = merged->registerClause(clause.clone());
+    copy->setClausePosition(
+        static_cast<int>(merged->getClausesInOriginalOrder()->size()));
+    merged->getClausesInOriginalOrder()->push_back(copy);
+    merged->getClauses(copy->getKind())->push_back(copy);
+    return copy;
+  };
+  for (std::size_t index = 0; index < first; ++index) {
+    copyClause(*clauses[index]);
   }
-  if (clause_count(OMPC_nogroup) != 0 && clause_count(OMPC_reduction) != 0) {
-    addStructureDiagnostic(
-        diagnostics, ompparser::DiagnosticCode::InvalidClause,
-        "nogroup and reduction clauses are mutually exclusive");
+  merged->adoptClausesFrom(edited);
+  for (std::size_t index = first; index <= last; ++index) {
+    changed.push_back(clauses[index]->getKind());
   }
-  if (directive.getKind() == OMPD_unroll && clause_count(OMPC_apply) != 0 &&
-      clause_count(OMPC_partial) == 0) {
-    addStructureDiagnostic(diagnostics,
-                           ompparser::DiagnosticCode::InvalidClause,
-                           "unroll apply clauses require a partial clause");
+  for (std::size_t index = last + 1; index < clauses.size(); ++index) {
+    if (!shiftClausePositions(*copyClause(*clauses[index]), following_shift)) {
+      return result;
+    }
+    if (options.retain_source) {
+      merged_starts.push_back(starts[index] - edit.length + edit.text.size());
+    }
   }
 
-  const auto *if_clauses = directive.findClauses(OMPC_if);
-  if (if_clauses != nullptr) {
-    std::vector<std::pair<OpenMPIfClauseModifier, std::string>> seen;
-    for (const OpenMPClause *clause : *if_clauses) {
-      const auto *if_clause = dynamic_cast<const OpenMPIfClause *>(clause);
-      if (if_clause == nullptr) {
-        continue;
-      }
-      const auto key =
-          std::make_pair(if_clause->getModifier(),
-                         if_clause->getModifier() == OMPC_IF_MODIFIER_user
-                             ? if_clause->getUserDefinedModifier()
-                             : std::string());
-      if (std::find(seen.begin(), seen.end(), key) != seen.end()) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::DuplicateClause,
-            "at most one if clause may apply to each constituent directive");
-      } else {
-        seen.push_back(key);
-      }
+  ompparser::ValidationResult validation;
+  validateEditedStructure(*merged, std::move(changed), validation.diagnostics);
+  validateExtensionPolicy(*merged, options.extensions, validation.diagnostics);
+  if (validation.success()) {
+    merged->markValidated();
+    if (options.retain_source) {
+      retainSourceSpans(text, *merged, merged_starts);
     }
+    ++fast_reparses;
+    result.directive = std::move(merged);
+    result.diagnostics = std::move(validation.diagnostics);
   }
+  return result;
+}
 
-  auto validate_categories =
-      [&diagnostics](const std::vector<OpenMPClause *> *clauses,
-                     OpenMPClauseKind clause_kind) {
-        if (clauses == nullptr) {
-          return;
-        }
-        std::vector<OpenMPDefaultmapClauseCategory> seen;
-        for (const OpenMPClause *clause : *clauses) {
-          OpenMPDefaultmapClauseCategory category =
-              OMPC_DEFAULTMAP_CATEGORY_unknown;
-          if (clause_kind == OMPC_default) {
-            const auto *default_clause =
-                dynamic_cast<const OpenMPDefaultClause *>(clause);
-            if (default_clause != nullptr) {
-              category = default_clause->getCategory();
-            }
-          } else {
-            const auto *defaultmap_clause =
-                dynamic_cast<const OpenMPDefaultmapClause *>(clause);
-            if (defaultmap_clause != nullptr) {
-              category = defaultmap_clause->getCategory();
-            }
-          }
-          if (category == OMPC_DEFAULTMAP_CATEGORY_unspecified) {
-            category = OMPC_DEFAULTMAP_CATEGORY_all;
-          }
-          if (category == OMPC_DEFAULTMAP_CATEGORY_unknown) {
-            continue;
-          }
-          if (std::find(seen.begin(), seen.end(), category) != seen.end()) {
-            addStructureDiagnostic(
-                diagnostics, ompparser::DiagnosticCode::DuplicateClause,
-                std::string("duplicate variable-category on '") +
-                    ompparser::getClauseName(clause_kind) + "' clause");
-          }
-          seen.push_back(category);
-        }
-        if (std::find(seen.begin(), seen.end(), OMPC_DEFAULTMAP_CATEGORY_all) !=
-                seen.end() &&
-            seen.size() > 1) {
-          addStructureDiagnostic(diagnostics,
-                                 ompparser::DiagnosticCode::InvalidClause,
-                                 std::string("the all variable-category on '") +
-                                     ompparser::getClauseName(clause_kind) +
-                                     "' excludes all other occurrences");
-        }
-      };
-  validate_categories(directive.findClauses(OMPC_default), OMPC_default);
-  validate_categories(directive.findClauses(OMPC_defaultmap), OMPC_defaultmap);
-
-  if (directive.getKind() == OMPD_end) {
-    const auto &end_directive =
-        static_cast<const OpenMPEndDirective &>(directive);
-    const OpenMPDirective *paired = end_directive.getPairedDirective();
-    const OpenMPDirectiveKind paired_kind =
-        paired != nullptr ? paired->getKind() : OMPD_unknown;
-    if (paired == nullptr) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidDirective,
-          "end directive requires an owned paired-directive payload");
+// A run of text up to a separator or parenthesis, with the balanced
+// parenthesized group that follows it: a word of the directive name, or a
+// whole clause such as "map(tofrom: a[0:n])".
+struct TextUnit {
+  std::size_t begin = 0;
+  std::size_t end = 0;
+};
+
+// False when a parenthesis does not follow a word or does not balance.
+bool splitTextUnits(std::string_view text, std::vector<TextUnit> &units) {
+  units.clear();
+  std::size_t position = text.find_first_not_of(ClauseSeparators);
+  while (position != std::string_view::npos) {
+    const std::size_t begin = position;
+    while (position < text.size() &&
+           ClauseSeparators.find(text[position]) == std::string_view::npos &&
+           text[position] != '(' && text[position] != ')') {
+      ++position;
     }
-    for (const OpenMPClause *clause : directive.getClausesInOriginalOrder()) {
-      if (clause == nullptr) {
-        continue;
-      }
-      bool allowed = false;
-      if (clause->getKind() == OMPC_copyprivate) {
-        allowed = paired_kind == OMPD_single;
-      } else if (clause->getKind() == OMPC_nowait) {
-        allowed =
-            ompparser::isClauseAllowedOnDirective(paired_kind, OMPC_nowait);
-      }
-      if (!allowed) {
-        addStructureDiagnostic(
-            diagnostics, ompparser::DiagnosticCode::InvalidClause,
-            std::string("clause '") +
-                ompparser::getClauseName(clause->getKind()) +
-                "' does not have the end-clause property for this directive");
+    if (position == begin) {
+      return false;
+    }
+    const std::size_t group = text.find_first_not_of(" \t", position);
+    if (group != std::string_view::npos && text[group] == '(') {
+      int depth = 0;
+      position = group;
+      do {
+        depth += text[position] == '(' ? 1 : text[position] == ')' ? -1 : 0;
+        ++position;
+      } while (depth > 0 && position < text.size());
+      if (depth != 0) {
+        return false;
       }
     }
+    units.push_back({begin, position});
+    position = text.find_first_not_of(ClauseSeparators, position);
   }
+  return true;
+}
+
+void startCacheKey(std::string &key, const ompparser::ParseOptions &options) {
+  key.assign(1, static_cast<char>(options.language));
+  key.push_back(static_cast<char>(options.extensions));
+}
+
+void appendClauseKey(std::string &key, OpenMPDirectiveKind kind, bool comma,
+                     std::string_view clause) {
+  key.push_back(static_cast<char>(kind & 0xFF));
+  key.push_back(static_cast<char>(kind >> 8));
+  key.push_back(comma ? ',' : ' ');
+  key += clause;
+}
 
-  const OpenMPClauseKind memory_orders[] = {
-      OMPC_seq_cst, OMPC_acq_rel, OMPC_release, OMPC_acquire, OMPC_relaxed};
-  std::size_t memory_order_count = 0;
-  for (OpenMPClauseKind kind : memory_orders) {
-    const auto *clauses = directive.findClauses(kind);
-    memory_order_count += clauses ? clauses->size() : 0;
+// Adds the header of directive, parsed from text, and every clause of it
+// the cache does not hold yet. A clause is stored with its positions moved
+// to its own text, and left out when they do not lie in it.
+void rememberClauses(std::string_view text,
+                     const ompparser::ParseOptions &options,
+                     const OpenMPDirective &directive,
+                     ompparser::detail::ClauseCacheState &state) {
+  using ompparser::detail::SourceLineTable;
+  if (directive.getKind() == OMPD_atomic || directive.getKind() == OMPD_end) {
+    return;
   }
-  if (memory_order_count > 1) {
-    addStructureDiagnostic(
-        diagnostics, ompparser::DiagnosticCode::InvalidClause,
-        "mutually exclusive memory-order clauses cannot be combined");
-  }
-
-  if (directive.getKind() == OMPD_scan) {
-    const auto *inclusive = directive.findClauses(OMPC_inclusive);
-    const auto *exclusive = directive.findClauses(OMPC_exclusive);
-    const auto *init_complete = directive.findClauses(OMPC_init_complete);
-    const std::size_t scan_kind_count =
-        (inclusive ? inclusive->size() : 0) +
-        (exclusive ? exclusive->size() : 0) +
-        (init_complete ? init_complete->size() : 0);
-    if (scan_kind_count != 1) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidDirective,
-          "scan requires exactly one inclusive, exclusive, or init_complete "
-          "clause");
+  const std::vector<OpenMPClause *> &clauses =
+      directive.getClausesInOriginalOrder();
+  for (const OpenMPClause *clause : clauses) {
+    if (clause == nullptr || clause->rendersNestedDirective()) {
+      return;
     }
   }
-
-  if (const auto *declaration =
-          dynamic_cast<const OpenMPDeclareReductionDirective *>(&directive)) {
-    const auto *combiner_clauses = directive.findClauses(OMPC_combiner);
-    const bool has_combiner_clause =
-        combiner_clauses && !combiner_clauses->empty();
-    if (declaration->getIdentifier().empty() ||
-        declaration->getTypenameList().empty() ||
-        (declaration->getCombiner().empty() && !has_combiner_clause)) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidDirective,
-          "declare reduction requires an identifier, type list, and combiner");
+  std::vector<std::size_t> starts;
+  if (!clauses.empty()) {
+    starts = ompparser::detail::locateClauseKeywords(clauses, text,
+                                                     text.size());
+    if (starts.empty()) {
+      return;
     }
   }
 
-  if (const auto *threadprivate =
-          dynamic_cast<const OpenMPThreadprivateDirective *>(&directive)) {
-    if (threadprivate->getThreadprivateList().empty()) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidDirective,
-          "threadprivate requires a non-empty variable list");
-    }
+  std::string key;
+  startCacheKey(key, options);
+  const std::string_view header = trimClauseSeparators(
+      text.substr(0, clauses.empty() ? text.size() : starts.front()));
+  key += header;
+  if (state.headers.find(key) == state.headers.end()) {
+    std::unique_ptr<OpenMPDirective> copy = directive.clone();
+    OpenMPDirective stripped(copy->getKind(), copy->getBaseLang());
+    stripped.adoptClausesFrom(*copy);
+    state.headers.emplace(key, std::move(copy));
   }
 
-  if (const auto *groupprivate =
-          dynamic_cast<const OpenMPGroupprivateDirective *>(&directive)) {
-    if (groupprivate->getGroupprivateList().empty()) {
-      addStructureDiagnostic(diagnostics,
-                             ompparser::DiagnosticCode::InvalidDirective,
-                             "groupprivate requires a non-empty variable list");
+  const SourceLineTable lines(text);
+  std::size_t previous_end = header.size();
+  for (std::size_t index = 0; index < clauses.size(); ++index) {
+    const std::size_t begin = starts[index];
+    const std::size_t limit =
+        index + 1 < starts.size() ? starts[index + 1] : text.size();
+    const std::string_view span =
+        trimClauseSeparators(text.substr(begin, limit - begin));
+    const bool comma =
+        text.substr(previous_end, begin - previous_end).find(',') !=
+        std::string_view::npos;
+    previous_end = begin + span.size();
+    startCacheKey(key, options);
+    appendClauseKey(key, directive.getKind(), comma, span);
+    if (state.clauses.find(key) != state.clauses.end()) {
+      continue;
+    }
+    std::unique_ptr<OpenMPClause> copy = clauses[index]->clone();
+    const SourceLineTable span_lines(span);
+    bool inside = true;
+    if (moveClausePositions(*copy, lines, span_lines,
+                            [&](std::size_t offset) {
+                              if (offset < begin ||
+                                  offset - begin > span.size()) {
+                                inside = false;
+                                return std::size_t(0);
+                              }
+                              return offset - begin;
+                            }) &&
+        inside) {
+      state.clauses.emplace(
+          key, ompparser::detail::ClauseCacheState::Clause{std::move(copy),
+                                                           span_lines});
     }
   }
+}
 
-  if (const auto *allocate =
-          dynamic_cast<const OpenMPAllocateDirective *>(&directive)) {
-    if (allocate->getAllocateList().empty()) {
-      addStructureDiagnostic(diagnostics,
-                             ompparser::DiagnosticCode::InvalidDirective,
-                             "allocate requires a non-empty variable list");
+// Every directive name and each run of its leading words, such as "target",
+// "target_teams" and "target_teams_loop", mapped to whether it is a whole
+// name.
+const std::unordered_map<std::string, bool> &directiveNamePrefixes() {
+  static const std::unordered_map<std::string, bool> prefixes = [] {
+    std::unordered_map<std::string, bool> result;
+    for (std::size_t kind = 0;
+         kind < ompparser::detail::kindCount(OpenMPDirectiveKind()); ++kind) {
+      const std::string name(ompparser::detail::kindName(
+          static_cast<OpenMPDirectiveKind>(kind)));
+      for (std::size_t end = name.find('_'); end != std::string::npos;
+           end = name.find('_', end + 1)) {
+        result.emplace(name.substr(0, end), false);
+      }
+      result[name] = true;
     }
-  }
+    return result;
+  }();
+  return prefixes;
+}
 
-  if (const auto *mapper =
-          dynamic_cast<const OpenMPDeclareMapperDirective *>(&directive)) {
-    if (mapper->getDeclareMapperType().empty() ||
-        mapper->getDeclareMapperVar().empty()) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidDirective,
-          "declare mapper requires a mapped type and variable");
+// The number of units of text in its header: those up to the end of the
+// longest directive name spelled by consecutive words, starting at the first
+// word that can begin one, so that "#pragma omp" is passed over. A word with
+// a parenthesized group, as in critical(name), ends the name. 0 when no
+// directive is named.
+std::size_t countHeaderUnits(std::string_view text,
+                             const std::vector<TextUnit> &units) {
+  const std::unordered_map<std::string, bool> &prefixes =
+      directiveNamePrefixes();
+  std::string name;
+  std::size_t count = 0;
+  for (std::size_t index = 0; index < units.size(); ++index) {
+    std::string candidate = name.empty() ? std::string() : name + '_';
+    std::size_t position = units[index].begin;
+    while (position < units[index].end && text[position] != '(' &&
+           ClauseSeparators.find(text[position]) == std::string_view::npos) {
+      candidate.push_back(static_cast<char>(
+          std::tolower(static_cast<unsigned char>(text[position++]))));
+    }
+    const auto found = prefixes.find(candidate);
+    if (found == prefixes.end()) {
+      if (name.empty()) {
+        continue;
+      }
+      break;
+    }
+    name = std::move(candidate);
+    if (found->second) {
+      count = index + 1;
+    }
+    if (position != units[index].end) {
+      break;
     }
   }
+  return count;
+}
 
-  if (const auto *depobj =
-          dynamic_cast<const OpenMPDepobjDirective *>(&directive)) {
-    if (depobj->getDepobj().empty()) {
-      addStructureDiagnostic(diagnostics,
-                             ompparser::DiagnosticCode::InvalidDirective,
-                             "depobj requires a depobj argument");
+// The fast path of parseDirective with a ClauseCache: finds the header of
+// text by its directive name, parses it with the clauses the cache misses,
+// and places copies of the cached ones around them. Returns a null
+// directive whenever a full parse is needed.
+ompparser::ParseResult
+assembleCachedClauses(std::string_view text,
+                      const ompparser::ParseOptions &options,
+                      ompparser::detail::ClauseCacheState &state) {
+  using ompparser::detail::ClauseCacheState;
+  using ompparser::detail::SourceLineTable;
+  ompparser::ParseResult result;
+  std::vector<TextUnit> units;
+  if (!splitTextUnits(text, units)) {
+    return result;
+  }
+  // One lookup, of the text up to the first unit after the directive name.
+  const std::size_t first = countHeaderUnits(text, units);
+  if (first == 0) {
+    return result;
+  }
+  const std::string_view header_text = trimClauseSeparators(text.substr(
+      0, first == units.size() ? text.size() : units[first].begin));
+  const std::size_t header_size = header_text.size();
+  std::string key;
+  startCacheKey(key, options);
+  key += header_text;
+  const auto found_header = state.headers.find(key);
+  if (found_header == state.headers.end()) {
+    return result;
+  }
+  const OpenMPDirective *header = found_header->second.get();
+
+  // The missed clauses are parsed behind the header with the separators
+  // that precede them in text; segments maps each back to text.
+  std::vector<const ClauseCacheState::Clause *> cached;
+  std::string synthetic(text.substr(0, header_size));
+  std::vector<std::pair<std::size_t, std::size_t>> segments;
+  std::size_t previous_end = header_size;
+  for (std::size_t index = first; index < units.size(); ++index) {
+    const TextUnit &unit = units[index];
+    const bool comma =
+        text.substr(previous_end, unit.begin - previous_end).find(',') !=
+        std::string_view::npos;
+    startCacheKey(key, options);
+    appendClauseKey(key, header->getKind(), comma,
+                    text.substr(unit.begin, unit.end - unit.begin));
+    const auto found = state.clauses.find(key);
+    cached.push_back(found != state.clauses.end() ? &found->second : nullptr);
+    if (!cached.back()) {
+      // The grammar does not take a comma straight after the header.
+      if (segments.empty() && comma) {
+        return result;
+      }
+      segments.emplace_back(synthetic.size(), previous_end);
+      synthetic += text.substr(previous_end, unit.end - previous_end);
     }
+    previous_end = unit.end;
   }
 
-  if (const auto *declare_variant =
-          dynamic_cast<const OpenMPDeclareVariantDirective *>(&directive)) {
-    if (declare_variant->getVariantFuncID().empty()) {
-      addStructureDiagnostic(
-          diagnostics, ompparser::DiagnosticCode::InvalidDirective,
-          "declare variant requires a variant function identifier");
+  std::unique_ptr<OpenMPDirective> merged;
+  OpenMPDirective parsed(header->getKind(), header->getBaseLang());
+  if (segments.empty()) {
+    merged = header->clone();
+  } else {
+    ompparser::ParseResult partial =
+        ompparser::parseDirective(synthetic, options);
+    if (!partial.success() || !partial.diagnostics.empty() ||
+        partial.directive->getKind() != header->getKind() ||
+        partial.directive->getClausesInOriginalOrder()->size() !=
+            segments.size()) {
+      return result;
     }
+    merged = std::move(partial.directive);
+    parsed.adoptClausesFrom(*merged);
   }
 
-  if (const auto *critical =
-          dynamic_cast<const OpenMPCriticalDirective *>(&directive)) {
-    const ompparser::HostFragment &name = critical->getCriticalNameFragment();
-    if (!name.spelling.empty() &&
-        (!isOpenMPIdentifier(name.spelling) ||
-         name.role != ompparser::HostFragmentRole::Declarator ||
-         name.parse_mode != OMP_EXPR_PARSE_openmp_syntax)) {
-      addStructureDiagnostic(diagnostics,
-                             ompparser::DiagnosticCode::InvalidDirective,
-                             "critical name is not a typed OpenMP name");
+  const SourceLineTable lines(text);
+  const SourceLineTable synthetic_lines(synthetic);
+  auto from_synthetic = [&](std::size_t offset) {
+    auto segment = std::upper_bound(
+        segments.begin(), segments.end(), offset,
+        [](std::size_t value,
+           const std::pair<std::size_t, std::size_t> &entry) {
+          return value < entry.first;
+        });
+    if (segment == segments.begin()) {
+      return offset;
+    }
+    --segment;
+    return segment->second + (offset - segment->first);
+  };
+  const std::vector<OpenMPClause *> &parsed_clauses =
+      *parsed.getClausesInOriginalOrder();
+  std::size_t next_parsed = 0;
+  for (std::size_t index = 0; index < cached.size(); ++index) {
+    const OpenMPClause &source = cached[index]
+                                     ? *cached[index]->clause
+                                     : *parsed_clauses[next_parsed++];
+    OpenMPClause *copy = merged->registerClause(source.clone());
+    copy->setClausePosition(
+        static_cast<int>(merged->getClausesInOriginalOrder()->size()));
+    merged->getClausesInOriginalOrder()->push_back(copy);
+    merged->getClauses(copy->getKind())->push_back(copy);
+    const std::size_t unit_begin = units[first + index].begin;
+    const bool moved =
+        cached[index]
+            ? moveClausePositions(
+                  *copy, cached[index]->lines, lines,
+                  [&](std::size_t offset) { return offset + unit_begin; })
+            : moveClausePositions(*copy, synthetic_lines, lines,
+                                  from_synthetic);
+    if (!moved) {
+      return result;
     }
   }
-}
 
-void validateDirectiveTree(const OpenMPDirective &directive,
-                           std::vector<ompparser::Diagnostic> &diagnostics,
-                           std::vector<const OpenMPDirective *> &active,
-                           std::vector<const OpenMPDirective *> &validated) {
-  if (std::find(active.begin(), active.end(), &directive) != active.end()) {
-    addStructureDiagnostic(diagnostics, ompparser::DiagnosticCode::InvalidAst,
-                           "directive tree contains a cycle");
-    return;
+  ompparser::ValidationResult validation = validateTree(*merged, false);
+  validateExtensionPolicy(*merged, options.extensions, validation.diagnostics);
+  if (!validation.success()) {
+    return result;
   }
-  if (std::find(validated.begin(), validated.end(), &directive) !=
-      validated.end()) {
-    return;
+  state.hits += cached.size() - segments.size();
+  state.misses += segments.size();
+  if (!segments.empty()) {
+    rememberClauses(text, options, *merged, state);
   }
+  result.directive = std::move(merged);
+  result.diagnostics = std::move(validation.diagnostics);
+  return result;
+}
 
-  active.push_back(&directive);
-  std::vector<std::string> errors;
-  directive.validateInvariants(errors);
-  for (std::string &message : errors) {
-    addStructureDiagnostic(diagnostics, ompparser::DiagnosticCode::InvalidAst,
-                           message);
+// Below this many directives per thread, starting a thread costs more than
+// the unparsing it takes over.
+constexpr std::size_t MinDirectivesPerThread = 256;
+
+// Hands what a std::ostream writes to a TextSink in pieces of at most its
+// buffer's size, so the ostream-based DOT renderers can stream into a sink.
+// The owner flushes the stream when done.
+class SinkStreamBuffer final : public std::streambuf {
+public:
+  explicit SinkStreamBuffer(ompparser::TextSink &sink) : sink(sink) {
+    setp(buffer, buffer + sizeof(buffer));
   }
-  validateOpenMPStructure(directive, diagnostics);
-  visitImmediateNestedDirectives(directive, [&](const OpenMPDirective &nested) {
-    validateDirectiveTree(nested, diagnostics, active, validated);
-  });
-  active.pop_back();
-  validated.push_back(&directive);
-}
 
-OpenMPBaseLang convertLanguage(ompparser::BaseLanguage language) {
-  switch (language) {
-  case ompparser::BaseLanguage::C:
-    return Lang_C;
-  case ompparser::BaseLanguage::CXX:
-    return Lang_Cplusplus;
-  case ompparser::BaseLanguage::Fortran:
-    return Lang_Fortran;
+protected:
+  int_type overflow(int_type character) override {
+    forward();
+    if (!traits_type::eq_int_type(character, traits_type::eof())) {
+      *pptr() = traits_type::to_char_type(character);
+      pbump(1);
+    }
+    return traits_type::not_eof(character);
+  }
+  int sync() override {
+    forward();
+    return 0;
+  }
+
+private:
+  void forward() {
+    if (pptr() != pbase()) {
+      sink.append(std::string_view(pbase(), pptr() - pbase()));
+      setp(buffer, buffer + sizeof(buffer));
+    }
   }
-  return Lang_unknown;
-}
+
+  ompparser::TextSink &sink;
+  char buffer[4096];
+};
 
 } // namespace
 
@@ -1120,6 +2182,89 @@ std::vector<Diagnostic> takeDiagnostics() {
   return diagnostics;
 }
 
+void retainSourceText(std::string_view text, OpenMPDirective &directive) {
+  ::retainSourceText(text, directive);
+}
+
+uint64_t validationRuleRuns() { return rule_runs; }
+
+uint64_t fastReparses() { return fast_reparses; }
+
+OpenMPBaseLang convertLanguage(BaseLanguage language) {
+  switch (language) {
+  case BaseLanguage::C:
+    return Lang_C;
+  case BaseLanguage::CXX:
+    return Lang_Cplusplus;
+  case BaseLanguage::Fortran:
+    return Lang_Fortran;
+  }
+  return Lang_unknown;
+}
+
+
+SourceLineTable::SourceLineTable(std::string_view text) : size(text.size()) {
+  line_starts.push_back(0);
+  for (std::size_t offset = 0; offset < text.size(); ++offset) {
+    if (text[offset] == '\n') {
+      line_starts.push_back(offset + 1);
+    }
+  }
+}
+
+std::size_t SourceLineTable::offsetOf(int line, int column) const {
+  if (line < 1 || column < 1 ||
+      static_cast<std::size_t>(line) > line_starts.size()) {
+    return std::string_view::npos;
+  }
+  const std::size_t offset =
+      line_starts[line - 1] + static_cast<std::size_t>(column) - 1;
+  return offset <= size ? offset : std::string_view::npos;
+}
+
+SourcePosition SourceLineTable::positionOf(std::size_t offset) const {
+  const std::size_t line = static_cast<std::size_t>(
+      std::upper_bound(line_starts.begin(), line_starts.end(), offset) -
+      line_starts.begin());
+  SourcePosition position;
+  position.offset = static_cast<uint32_t>(offset);
+  position.line = static_cast<uint32_t>(line);
+  position.column = static_cast<uint32_t>(offset - line_starts[line - 1] + 1);
+  return position;
+}
+
+std::vector<std::size_t>
+locateClauseKeywords(const std::vector<OpenMPClause *> &clauses,
+                     std::string_view source, std::size_t limit) {
+  const SourceLineTable lines(source);
+  std::vector<std::size_t> starts;
+  starts.reserve(clauses.size());
+  for (const OpenMPClause *clause : clauses) {
+    if (clause == nullptr) {
+      return {};
+    }
+    const std::size_t recorded =
+        lines.offsetOf(clause->getLine(), clause->getColumn());
+    if (recorded == std::string_view::npos) {
+      return {};
+    }
+    const std::size_t lower = starts.empty() ? 0 : starts.back() + 1;
+    const std::size_t start =
+        findKeywordBackward(source, getClauseName(clause->getKind()), lower,
+                            std::min(recorded, limit));
+    if (start == std::string_view::npos) {
+      return {};
+    }
+    starts.push_back(start);
+  }
+  return starts;
+}
+
+bool isValidatedTree(const OpenMPDirective &directive) {
+  std::vector<const OpenMPDirective *> path;
+  return ::isValidatedTree(directive, path);
+}
+
 } // namespace ompparser::detail
 
 namespace ompparser {
@@ -1161,11 +2306,7 @@ bool ValidationResult::success() const {
 }
 
 ValidationResult validate(const OpenMPDirective &directive) {
-  ValidationResult result;
-  std::vector<const OpenMPDirective *> active;
-  std::vector<const OpenMPDirective *> validated;
-  validateDirectiveTree(directive, result.diagnostics, active, validated);
-  return result;
+  return validateTree(directive, false);
 }
 
 ParseResult parseDirective(std::string_view input,
@@ -1181,7 +2322,7 @@ ParseResult parseDirective(std::string_view input,
 
   std::string owned_input(input);
   detail::beginDiagnostics();
-  setLang(convertLanguage(options.language));
+  setLang(detail::convertLanguage(options.language));
   result.directive.reset(parseOpenMP(owned_input.c_str()));
   result.diagnostics = detail::takeDiagnostics();
   if (result.directive && options.host_hooks) {
@@ -1192,7 +2333,11 @@ ParseResult parseDirective(std::string_view input,
   }
 
   if (result.directive) {
-    ValidationResult validation = validate(*result.directive);
+    // Host hooks receive the directive mutably, so their output is checked
+    // in full.
+    const bool trusted =
+        !options.host_hooks && result.directive->isParserConstructed();
+    ValidationResult validation = validateTree(*result.directive, trusted);
     result.diagnostics.insert(
         result.diagnostics.end(),
         std::make_move_iterator(validation.diagnostics.begin()),
@@ -1207,30 +2352,267 @@ ParseResult parseDirective(std::string_view input,
                   })) {
     result.directive.reset();
   }
+  if (result.directive && options.retain_source) {
+    retainSourceText(input, *result.directive);
+  }
   return result;
 }
 
-UnparseResult unparse(const OpenMPDirective &directive) {
-  UnparseResult result;
-  ValidationResult validation = validate(directive);
-  if (!validation.success()) {
-    result.diagnostics = std::move(validation.diagnostics);
+ParseResult parseDirective(std::string_view input, const ParseOptions &options,
+                           ClauseCache &clauses) {
+  detail::ClauseCacheState &state = *clauses.state;
+  if (input.data() == nullptr || options.host_hooks ||
+      (options.language == BaseLanguage::Fortran &&
+       input.find('&') != std::string_view::npos)) {
+    return parseDirective(input, options);
+  }
+  ParseResult result = assembleCachedClauses(input, options, state);
+  if (result.directive) {
+    if (options.retain_source) {
+      retainSourceText(input, *result.directive);
+    }
     return result;
   }
-  result.text = directive.generatePragmaString();
-  if (result.text.empty()) {
-    Diagnostic diagnostic;
-    diagnostic.code = DiagnosticCode::InvalidAst;
-    diagnostic.severity = DiagnosticSeverity::Error;
-    diagnostic.message = "cannot unparse an invalid OpenMP AST";
-    result.diagnostics.push_back(std::move(diagnostic));
+  result = parseDirective(input, options);
+  if (result.success() && result.diagnostics.empty()) {
+    state.misses += result.directive->getClausesInOriginalOrder()->size();
+    rememberClauses(input, options, *result.directive, state);
+  }
+  return result;
+}
+
+ParseResult reparse(const ParseResult &previous, std::string_view previous_text,
+                    const SourceEdit &edit, const ParseOptions &options) {
+  if (edit.offset > previous_text.size() ||
+      edit.length > previous_text.size() - edit.offset) {
+    throw std::invalid_argument("source edit lies outside the previous text");
+  }
+  std::string text(previous_text.substr(0, edit.offset));
+  text += edit.text;
+  text += previous_text.substr(edit.offset + edit.length);
+  ParseResult result =
+      reparseEditedClauses(previous, previous_text, edit, text, options);
+  if (result.directive) {
+    return result;
+  }
+  return parseDirective(text, options);
+}
+
+void StringSink::append(std::string_view text) { target.append(text); }
+
+void BufferSink::append(std::string_view text) {
+  const std::size_t stored = std::min(text.size(), capacity - used);
+  std::copy_n(text.data(), stored, data + used);
+  used += stored;
+  overflow = overflow || stored < text.size();
+}
+
+void StreamSink::append(std::string_view text) {
+  stream.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+ValidationResult unparseTo(const OpenMPDirective &directive, TextSink &sink,
+                           UnparseFormat format) {
+  thread_local std::string text;
+  thread_local std::string clause_buffer;
+  ValidationResult result =
+      renderDirective(directive, text, clause_buffer, format);
+  if (result.diagnostics.empty()) {
+    sink.append(text);
+  }
+  return result;
+}
+
+UnparseResult unparse(const OpenMPDirective &directive, UnparseFormat format) {
+  UnparseResult result;
+  StringSink sink(result.text);
+  result.diagnostics = unparseTo(directive, sink, format).diagnostics;
+  return result;
+}
+
+bool UnparseAllResult::success() const {
+  return std::none_of(diagnostics.begin(), diagnostics.end(),
+                      [](const BatchDiagnostic &entry) {
+                        return entry.diagnostic.severity ==
+                               DiagnosticSeverity::Error;
+                      });
+}
+
+std::string_view UnparseAllResult::directiveText(std::size_t index) const {
+  if (index + 1 >= offsets.size()) {
+    throw std::out_of_range("unparseAll result has no directive at index");
+  }
+  return std::string_view(text).substr(offsets[index],
+                                       offsets[index + 1] - offsets[index]);
+}
+
+UnparseAllResult unparseAll(const OpenMPDirective *const *directives,
+                            std::size_t count,
+                            const UnparseAllOptions &options) {
+  if (directives == nullptr && count != 0) {
+    throw std::invalid_argument("unparseAll requires a directive array");
+  }
+  std::size_t threads = options.threads != 0
+                            ? options.threads
+                            : std::max(1u, std::thread::hardware_concurrency());
+  threads = std::max<std::size_t>(
+      1, std::min(threads, count / MinDirectivesPerThread));
+
+  std::vector<UnparseChunk> chunks(threads);
+  const std::size_t chunk_size = (count + threads - 1) / threads;
+  {
+    detail::ThreadGroup workers;
+    workers.reserve(threads - 1);
+    for (std::size_t chunk = 1; chunk < threads; ++chunk) {
+      const std::size_t begin = std::min(count, chunk * chunk_size);
+      const std::size_t end = std::min(count, begin + chunk_size);
+      UnparseChunk &output = chunks[chunk];
+      try {
+        workers.start([directives, begin, end, &options, &output] {
+          try {
+            unparseChunk(directives, begin, end, options.terminator, output);
+          } catch (...) {
+            output.error = std::current_exception();
+          }
+        });
+      } catch (const std::system_error &) {
+        // Without thread support the chunk is unparsed on this thread.
+        unparseChunk(directives, begin, end, options.terminator, output);
+      }
+    }
+    unparseChunk(directives, 0, std::min(count, chunk_size),
+                 options.terminator, chunks[0]);
+  }
+  for (const UnparseChunk &chunk : chunks) {
+    if (chunk.error) {
+      std::rethrow_exception(chunk.error);
+    }
+  }
+
+  std::size_t total = 0;
+  for (const UnparseChunk &chunk : chunks) {
+    total += chunk.text.size();
+  }
+  UnparseAllResult result;
+  result.text = std::move(chunks[0].text);
+  result.text.reserve(total);
+  result.offsets.reserve(count + 1);
+  result.offsets.push_back(0);
+  for (UnparseChunk &chunk : chunks) {
+    std::size_t base = 0;
+    if (&chunk != &chunks[0]) {
+      base = result.text.size();
+      result.text += chunk.text;
+    }
+    for (std::size_t end : chunk.ends) {
+      result.offsets.push_back(base + end);
+    }
+    std::move(chunk.diagnostics.begin(), chunk.diagnostics.end(),
+              std::back_inserter(result.diagnostics));
+  }
+  return result;
+}
+
+UnparseAllResult
+unparseAll(const std::vector<const OpenMPDirective *> &directives,
+           const UnparseAllOptions &options) {
+  return unparseAll(directives.data(), directives.size(), options);
+}
+
+bool DotGraphResult::success() const {
+  return std::none_of(diagnostics.begin(), diagnostics.end(),
+                      [](const BatchDiagnostic &entry) {
+                        return entry.diagnostic.severity ==
+                               DiagnosticSeverity::Error;
+                      });
+}
+
+DotGraphResult toDotGraph(const OpenMPDirective *const *directives,
+                          std::size_t count, TextSink &sink) {
+  DotGraphResult result;
+  SinkStreamBuffer buffer(sink);
+  std::ostream output(&buffer);
+  // A sink that throws should fail the call, not leave the stream bad.
+  output.exceptions(std::ios::badbit);
+  output << "graph OpenMPIR {\n";
+  for (std::size_t index = 0; index < count; ++index) {
+    if (directives[index] == nullptr) {
+      Diagnostic diagnostic;
+      diagnostic.code = DiagnosticCode::NullInput;
+      diagnostic.severity = DiagnosticSeverity::Error;
+      diagnostic.message = "cannot render a null directive as DOT";
+      result.diagnostics.push_back({index, std::move(diagnostic)});
+      continue;
+    }
+    ValidationResult validation = validateUnlessUnchanged(*directives[index]);
+    if (!validation.success()) {
+      for (Diagnostic &diagnostic : validation.diagnostics) {
+        result.diagnostics.push_back({index, std::move(diagnostic)});
+      }
+      continue;
+    }
+    directives[index]->generateDOTCluster(output, index);
+  }
+  output << "}\n";
+  output.flush();
+  return result;
+}
+
+DotGraphResult
+toDotGraph(const std::vector<const OpenMPDirective *> &directives,
+           TextSink &sink) {
+  return toDotGraph(directives.data(), directives.size(), sink);
+}
+
+ValidationResult toJson(const OpenMPDirective &directive, TextSink &sink) {
+  ValidationResult result = validateUnlessUnchanged(directive);
+  if (result.success()) {
+    detail::writeJson(directive, sink, std::string_view());
+  }
+  return result;
+}
+
+bool JsonLinesResult::success() const {
+  return std::none_of(diagnostics.begin(), diagnostics.end(),
+                      [](const BatchDiagnostic &entry) {
+                        return entry.diagnostic.severity ==
+                               DiagnosticSeverity::Error;
+                      });
+}
+
+JsonLinesResult toJsonLines(const OpenMPDirective *const *directives,
+                            std::size_t count, TextSink &sink) {
+  JsonLinesResult result;
+  for (std::size_t index = 0; index < count; ++index) {
+    if (directives[index] == nullptr) {
+      Diagnostic diagnostic;
+      diagnostic.code = DiagnosticCode::NullInput;
+      diagnostic.severity = DiagnosticSeverity::Error;
+      diagnostic.message = "cannot render a null directive as JSON";
+      result.diagnostics.push_back({index, std::move(diagnostic)});
+      continue;
+    }
+    ValidationResult validation = validateUnlessUnchanged(*directives[index]);
+    if (!validation.success()) {
+      for (Diagnostic &diagnostic : validation.diagnostics) {
+        result.diagnostics.push_back({index, std::move(diagnostic)});
+      }
+      continue;
+    }
+    detail::writeJson(*directives[index], sink, "\n");
   }
   return result;
 }
 
+JsonLinesResult
+toJsonLines(const std::vector<const OpenMPDirective *> &directives,
+            TextSink &sink) {
+  return toJsonLines(directives.data(), directives.size(), sink);
+}
+
 DotResult toDot(const OpenMPDirective &directive) {
   DotResult result;
-  ValidationResult validation = validate(directive);
+  ValidationResult validation = validateUnlessUnchanged(directive);
   if (!validation.success()) {
     result.diagnostics = std::move(validation.diagnostics);
     return result;
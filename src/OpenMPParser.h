@@ -11,13 +11,17 @@
 
 #include "OpenMPKinds.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <functional>
+#include <iosfwd>
 #include <memory>
 #include <string>
 #include <string_view>
+#include <type_traits>
 #include <vector>
 
+class OpenMPClause;
 class OpenMPDirective;
 
 enum OpenMPExprParseMode {
@@ -81,6 +85,43 @@ struct HostFragment {
 
 using HostFragmentVisitor = std::function<void(HostFragment &)>;
 
+// Non-owning reference to a fragment callback. Traversals take it by value so
+// visiting never copies or allocates the caller's callable, which must outlive
+// the call. `Fragment` is `const HostFragment` for read-only traversals.
+template <typename Fragment> class BasicHostFragmentVisitorRef;
+
+template <typename T> struct IsHostFragmentVisitorRef : std::false_type {};
+template <typename Fragment>
+struct IsHostFragmentVisitorRef<BasicHostFragmentVisitorRef<Fragment>>
+    : std::true_type {};
+
+template <typename Fragment> class BasicHostFragmentVisitorRef {
+public:
+  // Another reference is never wrapped, so a read-only visitor cannot bind to
+  // a mutable traversal.
+  template <typename Callable,
+            typename = std::enable_if_t<
+                !IsHostFragmentVisitorRef<std::decay_t<Callable>>::value &&
+                std::is_invocable_v<Callable &, Fragment &>>>
+  BasicHostFragmentVisitorRef(Callable &&callable) noexcept
+      : callable(const_cast<void *>(
+            static_cast<const void *>(std::addressof(callable)))),
+        invoke([](void *target, Fragment &fragment) {
+          (*static_cast<std::remove_reference_t<Callable> *>(target))(
+              fragment);
+        }) {}
+
+  void operator()(Fragment &fragment) const { invoke(callable, fragment); }
+
+private:
+  void *callable;
+  void (*invoke)(void *, Fragment &);
+};
+
+using HostFragmentVisitorRef = BasicHostFragmentVisitorRef<HostFragment>;
+using ConstHostFragmentVisitorRef =
+    BasicHostFragmentVisitorRef<const HostFragment>;
+
 enum class DiagnosticSeverity { Note, Warning, Error };
 
 enum class DiagnosticCode {
@@ -93,7 +134,9 @@ enum class DiagnosticCode {
   InvalidClause,
   InvalidAst,
   UnsupportedExtension,
-  HostLanguageError
+  HostLanguageError,
+  InvalidEdit,
+  MalformedSerialization
 };
 
 struct Diagnostic {
@@ -119,6 +162,9 @@ struct ParseOptions {
   BaseLanguage language = BaseLanguage::C;
   ExtensionPolicy extensions = ExtensionPolicy::RejectUnknown;
   const HostLanguageHooks *host_hooks = nullptr;
+  // Keeps a copy of the input on the directive, so that unparse with
+  // UnparseFormat::Verbatim can copy the parts that are never modified.
+  bool retain_source = false;
 };
 
 struct ParseResult {
@@ -156,11 +202,232 @@ struct ValidationResult {
   bool success() const;
 };
 
+// Destination for unparseTo.
+class TextSink {
+public:
+  virtual ~TextSink() = default;
+  virtual void append(std::string_view text) = 0;
+};
+
+// Appends to a caller-owned string. Clearing the string between directives
+// keeps its capacity, so steady-state unparsing does not allocate.
+class StringSink final : public TextSink {
+public:
+  explicit StringSink(std::string &target) : target(target) {}
+  void append(std::string_view text) override;
+
+private:
+  std::string &target;
+};
+
+// Writes into a caller-owned fixed buffer and never allocates. Text past the
+// capacity is dropped and reported by overflowed().
+class BufferSink final : public TextSink {
+public:
+  BufferSink(char *data, std::size_t capacity)
+      : data(data), capacity(capacity) {}
+  void append(std::string_view text) override;
+  std::string_view text() const { return std::string_view(data, used); }
+  bool overflowed() const { return overflow; }
+  void clear() {
+    used = 0;
+    overflow = false;
+  }
+
+private:
+  char *data;
+  std::size_t capacity;
+  std::size_t used = 0;
+  bool overflow = false;
+};
+
+class StreamSink final : public TextSink {
+public:
+  explicit StreamSink(std::ostream &stream) : stream(stream) {}
+  void append(std::string_view text) override;
+
+private:
+  std::ostream &stream;
+};
+
+enum class UnparseFormat {
+  // Regenerated from the IR, with normalized spacing and list separators.
+  Normalized,
+  // The input retained by ParseOptions::retain_source, with only the clauses
+  // modified since parsing regenerated; the header, the other clauses and
+  // every separator and line continuation between them are copied. Falls
+  // back to Normalized for a directive without retained input and for one
+  // whose header or clause list has changed. A directive with a nested
+  // directive (metadirective variants, an end directive), atomic and
+  // declare induction directives, and directives restored by deserialize or
+  // copied by clone keep no input.
+  Verbatim
+};
+
 ParseResult parseDirective(std::string_view input,
                            const ParseOptions &options = {});
 ValidationResult validate(const OpenMPDirective &directive);
-UnparseResult unparse(const OpenMPDirective &directive);
+// Both validate first, unless no directive in the tree has been modified
+// since validation last accepted it.
+UnparseResult unparse(const OpenMPDirective &directive,
+                      UnparseFormat format = UnparseFormat::Normalized);
 DotResult toDot(const OpenMPDirective &directive);
+// Writes the text unparse returns into sink, in one append, and returns the
+// diagnostics unparse reports; the sink receives nothing when there are any.
+// The text is rendered in per-thread buffers that keep their capacity, so
+// only the sink decides whether unparsing allocates. A sink must not call
+// unparseTo from append.
+ValidationResult unparseTo(const OpenMPDirective &directive, TextSink &sink,
+                           UnparseFormat format = UnparseFormat::Normalized);
+
+struct UnparseAllOptions {
+  // Appended after the text of every directive that unparses.
+  std::string_view terminator = "\n";
+  // Contiguous chunks of the batch are unparsed on up to this many threads
+  // and joined in input order; 0 uses std::thread::hardware_concurrency().
+  unsigned threads = 1;
+};
+
+struct BatchDiagnostic {
+  std::size_t index = 0;
+  Diagnostic diagnostic;
+};
+
+struct UnparseAllResult {
+  // Every directive's text and terminator, in input order, ready to be
+  // written with one call.
+  std::string text;
+  // Directive i occupies [offsets[i], offsets[i + 1]) of text, terminator
+  // included; the range is empty for a directive that did not unparse.
+  std::vector<std::size_t> offsets;
+  // Only directives that failed have entries, tagged with their input index.
+  std::vector<BatchDiagnostic> diagnostics;
+
+  bool success() const;
+  std::string_view directiveText(std::size_t index) const;
+};
+
+// Unparses a batch into one buffer instead of one UnparseResult each. A failed
+// or null directive leaves an empty range and does not stop the batch.
+UnparseAllResult unparseAll(const OpenMPDirective *const *directives,
+                            std::size_t count,
+                            const UnparseAllOptions &options = {});
+UnparseAllResult
+unparseAll(const std::vector<const OpenMPDirective *> &directives,
+           const UnparseAllOptions &options = {});
+
+struct DotGraphResult {
+  // Only directives that failed have entries, tagged with their input index;
+  // they are left out of the graph.
+  std::vector<BatchDiagnostic> diagnostics;
+
+  bool success() const;
+};
+
+// Writes a batch, such as every directive of a translation unit, into sink as
+// one DOT graph with a "subgraph cluster_<i>" per directive. The graph is
+// written while the batch is walked, through a small fixed buffer, so it is
+// never held in memory whole and no file is created.
+DotGraphResult toDotGraph(const OpenMPDirective *const *directives,
+                          std::size_t count, TextSink &sink);
+DotGraphResult
+toDotGraph(const std::vector<const OpenMPDirective *> &directives,
+           TextSink &sink);
+
+// Writes directive into sink as one JSON object: kinds, modifiers and other
+// enumerations by their OpenMPKinds.def names, host fragments by spelling,
+// and the typed fields of every directive and clause class, as listed in
+// OpenMPIRToJSON.cpp. The object is written while the tree is walked,
+// through a small fixed buffer, without building a document. Validates like
+// unparse; the sink receives nothing when there are diagnostics.
+ValidationResult toJson(const OpenMPDirective &directive, TextSink &sink);
+
+struct JsonLinesResult {
+  // Only directives that failed have entries, tagged with their input index;
+  // they are left out of the output.
+  std::vector<BatchDiagnostic> diagnostics;
+
+  bool success() const;
+};
+
+// Writes a batch, such as every directive of a scanned file, into sink as
+// newline-delimited JSON: one toJson object per line, in input order.
+JsonLinesResult toJsonLines(const OpenMPDirective *const *directives,
+                            std::size_t count, TextSink &sink);
+JsonLinesResult
+toJsonLines(const std::vector<const OpenMPDirective *> &directives,
+            TextSink &sink);
+
+// Replaces length bytes at offset of the text a directive was parsed from.
+struct SourceEdit {
+  std::size_t offset = 0;
+  std::size_t length = 0;
+  std::string text;
+};
+
+// Parses previous_text with edit applied. Only the clauses whose text the
+// edit touches are parsed again, and validation reruns only the rules of the
+// clause kinds the edit changed. The other clauses are copied from previous
+// with their positions shifted by the edit; copying them, the extension
+// policy check and finding their keywords in previous_text, which
+// retain_source on previous saves, remain per clause. The result matches
+// parseDirective on the edited text. It falls back to a full parse when
+// previous did not succeed, when the edit reaches the directive name or its
+// arguments, when host hooks are set or the language differs, and for atomic,
+// end, variant-bearing and continued Fortran directives.
+// previous must be the parse of previous_text with the same options; an edit
+// outside previous_text throws std::invalid_argument.
+ParseResult reparse(const ParseResult &previous, std::string_view previous_text,
+                    const SourceEdit &edit, const ParseOptions &options = {});
+
+struct StructuralOptions {
+  // Skip host fragment ranges and clause/directive line and column numbers.
+  bool ignore_source_ranges = false;
+};
+
+// Stable 128-bit structural digest; `low` alone is a 64-bit hash.
+struct StructuralHash {
+  uint64_t low = 0;
+  uint64_t high = 0;
+
+  bool operator==(const StructuralHash &other) const {
+    return low == other.low && high == other.high;
+  }
+  bool operator!=(const StructuralHash &other) const {
+    return !(*this == other);
+  }
+};
+
+// Compare and hash kinds, modifiers, host fragment spellings and nested
+// directives in one linear walk, without unparsing. Attached semantic nodes
+// and derived clause bookkeeping do not take part.
+bool structurallyEqual(const OpenMPDirective &lhs, const OpenMPDirective &rhs,
+                       const StructuralOptions &options = {});
+bool structurallyEqual(const OpenMPClause &lhs, const OpenMPClause &rhs,
+                       const StructuralOptions &options = {});
+StructuralHash hash(const OpenMPDirective &directive,
+                    const StructuralOptions &options = {});
+StructuralHash hash(const OpenMPClause &clause,
+                    const StructuralOptions &options = {});
+
+// Version of the serialize format. Images of another version, or written
+// against a different set of directive and clause kinds, are rejected.
+inline constexpr uint32_t SerializationFormatVersion = 1;
+
+// Writes a directive, its clauses, host fragments with their source ranges
+// and every nested directive as a self-contained binary image without
+// pointers, so it can be cached in a file and read from a mapping of it.
+// Attached semantic nodes are not written. A directive with construction
+// errors throws std::invalid_argument.
+std::string serialize(const OpenMPDirective &directive);
+// Rebuilds a directive from serialize output without lexing, parsing or
+// validating it; bytes need to outlive only the call. A directive validation
+// had accepted when it was written is returned already validated, so
+// unparse and toDot do not validate it again, once its IR invariants have
+// been checked. Truncated, mismatched or otherwise malformed bytes, including
+// a kind or other enumeration value outside its OpenMPKinds.def list, yield
+// no directive and a MalformedSerialization diagnostic.
+ParseResult deserialize(std::string_view bytes);
 
 } // namespace ompparser
 
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "OpenMPParserC.h"
+#include "OpenMPDirectiveStore.h"
+#include "OpenMPIR.h"
+#include "OpenMPParser.h"
+#include "OpenMPParserInternal.h"
+#include "OpenMPSchema.h"
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+static_assert(ompparser::ClauseModifierSlots ==
+                  std::size(ompparser_clause_record{}.modifiers),
+              "C clause records must hold every DirectiveStore slot");
+static_assert(ompparser::NoClauseModifier == OMPPARSER_NO_MODIFIER);
+
+struct ompparser_view {
+  // The input, then every spelling and message that is not a slice of it.
+  std::string text;
+  bool succeeded = false;
+  bool has_directive = false;
+  ompparser_directive_record directive{};
+  std::vector<ompparser_clause_record> clauses;
+  std::vector<ompparser_fragment_record> fragments;
+  std::vector<ompparser_diagnostic_record> diagnostics;
+};
+
+namespace {
+
+uint32_t unsignedPosition(int value) {
+  return static_cast<uint32_t>(std::max(value, 0));
+}
+
+// Flattens a parse result into a view whose text already holds the input.
+class ViewBuilder {
+public:
+  ViewBuilder(ompparser_view &view, std::size_t input_length)
+      : view(view), input_length(input_length) {}
+
+  void addDirective(const OpenMPDirective &directive) {
+    // Clause fragments are gathered first, so that the directive's own are
+    // the ones no clause reaches.
+    const std::vector<OpenMPClause *> &clauses =
+        directive.getClausesInOriginalOrder();
+    std::vector<std::vector<const ompparser::HostFragment *>> clause_fragments;
+    std::unordered_set<const ompparser::HostFragment *> owned_by_clauses;
+    for (const OpenMPClause *clause : clauses) {
+      std::vector<const ompparser::HostFragment *> &list =
+          clause_fragments.emplace_back();
+      for (const OpenMPExpressionItem &item : clause->getExpressionItems()) {
+        list.push_back(&item.fragment);
+      }
+      const std::size_t item_count = list.size();
+      clause->visitHostFragments(
+          [&list, item_count](const ompparser::HostFragment &fragment) {
+            const auto items_end = list.begin() + item_count;
+            if (std::find(list.begin(), items_end, &fragment) == items_end) {
+              list.push_back(&fragment);
+            }
+          });
+      owned_by_clauses.insert(list.begin(), list.end());
+    }
+
+    ompparser_directive_record &record = view.directive;
+    record.kind = directive.getKind();
+    record.language = directive.getBaseLang();
+    record.line = unsignedPosition(directive.getLine());
+    record.column = unsignedPosition(directive.getColumn());
+    record.first_fragment = fragmentIndex();
+    directive.visitHostFragments(
+        [this, &owned_by_clauses](const ompparser::HostFragment &fragment) {
+          if (owned_by_clauses.count(&fragment) == 0) {
+            addFragment(fragment, OMPPARSER_NO_INDEX);
+          }
+        });
+    record.fragment_count = fragmentIndex() - record.first_fragment;
+    view.has_directive = true;
+
+    view.clauses.reserve(clauses.size());
+    for (std::size_t index = 0; index < clauses.size(); ++index) {
+      const OpenMPClause &clause = *clauses[index];
+      ompparser_clause_record clause_record{};
+      clause_record.kind = clause.OpenMPClause::getKind();
+      clause_record.line = unsignedPosition(clause.getLine());
+      clause_record.column = unsignedPosition(clause.getColumn());
+      ompparser::detail::collectClauseModifiers(clause,
+                                                clause_record.modifiers);
+      clause_record.first_fragment = fragmentIndex();
+      clause_record.item_count =
+          static_cast<uint32_t>(clause.getExpressionItems().size());
+      for (const ompparser::HostFragment *fragment : clause_fragments[index]) {
+        addFragment(*fragment, static_cast<uint32_t>(index));
+      }
+      clause_record.fragment_count =
+          fragmentIndex() - clause_record.first_fragment;
+      view.clauses.push_back(clause_record);
+    }
+  }
+
+  void addDiagnostic(const ompparser::Diagnostic &diagnostic) {
+    ompparser_diagnostic_record record{};
+    record.code = static_cast<int32_t>(diagnostic.code);
+    record.severity = static_cast<int32_t>(diagnostic.severity);
+    record.line = diagnostic.range.begin.line;
+    record.column = diagnostic.range.begin.column;
+    record.message = append(diagnostic.message);
+    view.diagnostics.push_back(record);
+  }
+
+private:
+  uint32_t fragmentIndex() const {
+    return static_cast<uint32_t>(view.fragments.size());
+  }
+
+  ompparser_text append(std::string_view text) {
+    if (view.text.size() + text.size() >
+        std::numeric_limits<uint32_t>::max()) {
+      throw std::bad_alloc();
+    }
+    ompparser_text result{static_cast<uint32_t>(view.text.size()),
+                          static_cast<uint32_t>(text.size())};
+    view.text.append(text);
+    return result;
+  }
+
+  void addFragment(const ompparser::HostFragment &fragment, uint32_t clause) {
+    ompparser_fragment_record record{};
+    const ompparser::SourceRange &range = fragment.range;
+    if (range.begin.offset < range.end.offset &&
+        range.end.offset <= input_length) {
+      record.source = {range.begin.offset,
+                       range.end.offset - range.begin.offset};
+    }
+    // A spelling that reads as it does in the input is not copied.
+    if (std::string_view(view.text).substr(record.source.offset,
+                                           record.source.length) ==
+        fragment.spelling) {
+      record.spelling = record.source;
+    } else {
+      record.spelling = append(fragment.spelling);
+    }
+    record.role = static_cast<int32_t>(fragment.role);
+    record.clause = clause;
+    view.fragments.push_back(record);
+  }
+
+  ompparser_view &view;
+  std::size_t input_length;
+};
+
+template <typename Record>
+const Record *records(const std::vector<Record> &list, size_t *count) {
+  if (count != nullptr) {
+    *count = list.size();
+  }
+  return list.data();
+}
+
+} // namespace
+
+extern "C" {
+
+ompparser_view *ompparser_parse(const char *input, size_t length,
+                                int32_t language) {
+  if (length > std::numeric_limits<uint32_t>::max()) {
+    return nullptr;
+  }
+  try {
+    auto view = std::make_unique<ompparser_view>();
+    const std::string_view source =
+        input != nullptr ? std::string_view(input, length) : std::string_view();
+    view->text.assign(source);
+    ViewBuilder builder(*view, source.size());
+
+    ompparser::ParseOptions options;
+    switch (language) {
+    case OMPPARSER_LANGUAGE_C:
+      options.language = ompparser::BaseLanguage::C;
+      break;
+    case OMPPARSER_LANGUAGE_CXX:
+      options.language = ompparser::BaseLanguage::CXX;
+      break;
+    case OMPPARSER_LANGUAGE_FORTRAN:
+      options.language = ompparser::BaseLanguage::Fortran;
+      break;
+    default: {
+      ompparser::Diagnostic diagnostic;
+      diagnostic.code = ompparser::DiagnosticCode::LanguageMismatch;
+      diagnostic.message =
+          "unknown base language " + std::to_string(language);
+      builder.addDiagnostic(diagnostic);
+      return view.release();
+    }
+    }
+
+    ompparser::ParseResult result = ompparser::parseDirective(source, options);
+    for (const ompparser::Diagnostic &diagnostic : result.diagnostics) {
+      builder.addDiagnostic(diagnostic);
+    }
+    view->succeeded = result.success();
+    if (view->succeeded) {
+      builder.addDirective(*result.directive);
+    }
+    return view.release();
+  } catch (...) {
+    // Nothing may unwind into C; a view that cannot be completed is dropped.
+    return nullptr;
+  }
+}
+
+void ompparser_view_free(ompparser_view *view) { delete view; }
+
+int ompparser_view_succeeded(const ompparser_view *view) {
+  return view != nullptr && view->succeeded;
+}
+
+const ompparser_directive_record *
+ompparser_view_directive(const ompparser_view *view) {
+  return view != nullptr && view->has_directive ? &view->directive : nullptr;
+}
+
+const ompparser_clause_record *
+ompparser_view_clauses(const ompparser_view *view, size_t *count) {
+  return records(view->clauses, count);
+}
+
+const ompparser_fragment_record *
+ompparser_view_fragments(const ompparser_view *view, size_t *count) {
+  return records(view->fragments, count);
+}
+
+const ompparser_diagnostic_record *
+ompparser_view_diagnostics(const ompparser_view *view, size_t *count) {
+  return records(view->diagnostics, count);
+}
+
+const char *ompparser_view_text(const ompparser_view *view, size_t *length) {
+  if (length != nullptr) {
+    *length = view->text.size();
+  }
+  return view->text.data();
+}
+
+const char *ompparser_directive_kind_name(int32_t kind) {
+  return kind < 0 ? "unknown"
+                  : ompparser::getDirectiveName(
+                        static_cast<OpenMPDirectiveKind>(kind));
+}
+
+const char *ompparser_clause_kind_name(int32_t kind) {
+  return kind < 0
+             ? "unknown"
+             : ompparser::getClauseName(static_cast<OpenMPClauseKind>(kind));
+}
+
+} // extern "C"
@@ -0,0 +1,123 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// C interface for bindings. A parse yields a view: flat, read-only arrays of
+// fixed-layout records over one retained text buffer, which a binding can
+// read in place without calling back per field. Records are only appended to
+// in later versions of OMPPARSER_C_API_VERSION; kind values are those of
+// OpenMPKinds.h and may be renumbered between releases, so bindings that
+// persist them should store ompparser_*_kind_name instead.
+
+#ifndef OMPPARSER_OPENMPPARSERC_H
+#define OMPPARSER_OPENMPPARSERC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define OMPPARSER_C_API_VERSION 1
+
+// Owner index of a record that belongs to the directive itself.
+#define OMPPARSER_NO_INDEX UINT32_MAX
+// Modifier slot value of a clause that has no value in that slot.
+#define OMPPARSER_NO_MODIFIER UINT16_MAX
+
+enum {
+  OMPPARSER_LANGUAGE_C = 0,
+  OMPPARSER_LANGUAGE_CXX = 1,
+  OMPPARSER_LANGUAGE_FORTRAN = 2
+};
+
+// Bytes [offset, offset + length) of ompparser_view_text; not terminated.
+typedef struct ompparser_text {
+  uint32_t offset;
+  uint32_t length;
+} ompparser_text;
+
+typedef struct ompparser_directive_record {
+  int32_t kind;
+  int32_t language;
+  uint32_t line;
+  uint32_t column;
+  // The directive's own fragments, such as a flush list, are
+  // [first_fragment, first_fragment + fragment_count) of the fragment array.
+  uint32_t first_fragment;
+  uint32_t fragment_count;
+} ompparser_directive_record;
+
+typedef struct ompparser_clause_record {
+  int32_t kind;
+  uint32_t line;
+  uint32_t column;
+  // Slot 0 holds the clause's main value (map type, schedule kind, reduction
+  // identifier, ...) and slots 1 to 3 its modifiers, as in DirectiveStore.
+  uint16_t modifiers[4];
+  // The clause's fragments, its list items first, including those of any
+  // directive nested in it.
+  uint32_t first_fragment;
+  uint32_t fragment_count;
+  uint32_t item_count;
+} ompparser_clause_record;
+
+typedef struct ompparser_fragment_record {
+  // Host-language spelling.
+  ompparser_text spelling;
+  // Where the fragment was parsed from; the input is retained at offset 0 of
+  // the text, so this indexes the same buffer. Empty when unknown.
+  ompparser_text source;
+  // ompparser::HostFragmentRole.
+  int32_t role;
+  // Owning clause index, or OMPPARSER_NO_INDEX.
+  uint32_t clause;
+} ompparser_fragment_record;
+
+typedef struct ompparser_diagnostic_record {
+  // ompparser::DiagnosticCode and ompparser::DiagnosticSeverity.
+  int32_t code;
+  int32_t severity;
+  uint32_t line;
+  uint32_t column;
+  ompparser_text message;
+} ompparser_diagnostic_record;
+
+typedef struct ompparser_view ompparser_view;
+
+// Parses length bytes of input as one directive in language. Returns NULL
+// only when memory runs out or the input exceeds 4 GiB; a failed parse yields
+// a view with diagnostics and no directive. Free it with ompparser_view_free.
+ompparser_view *ompparser_parse(const char *input, size_t length,
+                                int32_t language);
+void ompparser_view_free(ompparser_view *view);
+
+// Nonzero when the input parsed without errors.
+int ompparser_view_succeeded(const ompparser_view *view);
+// NULL when the parse failed.
+const ompparser_directive_record *
+ompparser_view_directive(const ompparser_view *view);
+// The arrays live as long as the view; count receives their length.
+const ompparser_clause_record *
+ompparser_view_clauses(const ompparser_view *view, size_t *count);
+const ompparser_fragment_record *
+ompparser_view_fragments(const ompparser_view *view, size_t *count);
+const ompparser_diagnostic_record *
+ompparser_view_diagnostics(const ompparser_view *view, size_t *count);
+const char *ompparser_view_text(const ompparser_view *view, size_t *length);
+
+// OpenMPKinds.def names, such as "parallel_for" or "map"; "unknown" for a
+// value out of range.
+const char *ompparser_directive_kind_name(int32_t kind);
+const char *ompparser_clause_kind_name(int32_t kind);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OMPPARSER_OPENMPPARSERC_H
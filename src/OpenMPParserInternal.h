@@ -12,6 +12,16 @@
 #include "OpenMPIR.h"
 #include "OpenMPParser.h"
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
 OpenMPDirective *parseOpenMP(const char *input);
 void setLang(OpenMPBaseLang language);
 
@@ -22,6 +32,99 @@ void reportDiagnostic(DiagnosticCode code, const std::string &message,
                       int line = 0, int column = 0);
 bool hasErrorDiagnostics();
 std::vector<Diagnostic> takeDiagnostics();
+OpenMPBaseLang convertLanguage(BaseLanguage language);
+
+// Converts between offsets into a text and the 1-based line and column the
+// lexer records.
+class SourceLineTable {
+public:
+  explicit SourceLineTable(std::string_view text);
+  // npos when the position lies outside the text.
+  std::size_t offsetOf(int line, int column) const;
+  SourcePosition positionOf(std::size_t offset) const;
+
+private:
+  std::vector<std::size_t> line_starts;
+  std::size_t size;
+};
+
+// Threads joined when the group goes out of scope, so that an exception
+// thrown on the starting thread while they run unwinds instead of reaching
+// std::terminate through a joinable std::thread.
+class ThreadGroup {
+public:
+  ThreadGroup() = default;
+  ThreadGroup(const ThreadGroup &) = delete;
+  ThreadGroup &operator=(const ThreadGroup &) = delete;
+  ~ThreadGroup() { join(); }
+
+  // Throws std::system_error when the thread cannot be started.
+  template <typename Function> void start(Function &&function) {
+    threads.emplace_back(std::forward<Function>(function));
+  }
+  void reserve(std::size_t count) { threads.reserve(count); }
+  void join() {
+    for (std::thread &thread : threads) {
+      if (thread.joinable()) {
+        thread.join();
+      }
+    }
+    threads.clear();
+  }
+
+private:
+  std::vector<std::thread> threads;
+};
+
+// What a ClauseCache holds. Keys start with the language and extension
+// policy; a clause key then has the directive kind and whether a comma
+// precedes the clause, which the grammar records on it.
+struct ClauseCacheState {
+  struct Clause {
+    // Positions are relative to the clause's text, which lines describes.
+    std::unique_ptr<OpenMPClause> clause;
+    SourceLineTable lines;
+  };
+
+  // Parsed headers, without clauses.
+  std::unordered_map<std::string, std::unique_ptr<OpenMPDirective>> headers;
+  std::unordered_map<std::string, Clause> clauses;
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+};
+
+// Offset of each clause keyword in source, in clause order, or an empty
+// vector when one cannot be found before limit. Grammar actions record the
+// keyword position or one shortly past it, so the keyword is searched for
+// backwards from the recorded position.
+std::vector<std::size_t>
+locateClauseKeywords(const std::vector<OpenMPClause *> &clauses,
+                     std::string_view source, std::size_t limit);
+
+// Keeps text, which directive was parsed from, on it for
+// UnparseFormat::Verbatim, as ParseOptions::retain_source does.
+void retainSourceText(std::string_view text, OpenMPDirective &directive);
+
+// Rules from OpenMPValidation.def run on this thread so far. Benchmarks read
+// it to check that validation runs only the rules that apply.
+uint64_t validationRuleRuns();
+
+// Calls to reparse on this thread so far that spliced the previous clauses
+// around the edited ones instead of parsing the whole text again.
+uint64_t fastReparses();
+
+// True when validation accepted the directive and every directive nested in
+// it and none has changed since.
+bool isValidatedTree(const OpenMPDirective &directive);
+
+// Fills slots[0, ClauseModifierSlots) with the clause's modifier values in
+// the DirectiveStore layout.
+void collectClauseModifiers(const OpenMPClause &clause, uint16_t *slots);
+
+// Writes directive, which validation accepted, and then terminator into sink
+// in the toJson layout.
+void writeJson(const OpenMPDirective &directive, TextSink &sink,
+               std::string_view terminator);
 
 } // namespace ompparser::detail
 
@@ -0,0 +1,328 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "OpenMPPipeline.h"
+#include "OpenMPIR.h"
+#include "OpenMPParserInternal.h"
+#include "OpenMPPragmaScanner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <thread>
+#include <utility>
+
+namespace ompparser {
+
+namespace {
+
+// Waits for another stage: spins through a few yields, then sleeps, so an
+// idle stage does not hold a core while one before it reads a large file.
+class Backoff {
+public:
+  void pause() {
+    if (rounds < 64) {
+      ++rounds;
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+
+private:
+  unsigned rounds = 0;
+};
+
+// Bounded multi-producer, multi-consumer queue of directive numbers. Each
+// cell carries a sequence number that tells producers and consumers whose
+// turn it is, so neither takes a lock (D. Vyukov's bounded queue).
+class SequenceQueue {
+public:
+  explicit SequenceQueue(std::size_t capacity) {
+    std::size_t size = 2;
+    while (size < capacity) {
+      size *= 2;
+    }
+    cells = std::make_unique<Cell[]>(size);
+    mask = size - 1;
+    for (std::size_t i = 0; i < size; ++i) {
+      cells[i].turn.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  bool tryPush(uint64_t value) {
+    std::size_t position = tail.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell &cell = cells[position & mask];
+      const std::size_t turn = cell.turn.load(std::memory_order_acquire);
+      if (turn == position) {
+        if (tail.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed)) {
+          cell.value = value;
+          cell.turn.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (turn < position) {
+        return false;
+      } else {
+        position = tail.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  bool tryPop(uint64_t &value) {
+    std::size_t position = head.load(std::memory_order_relaxed);
+    for (;;) {
+      Cell &cell = cells[position & mask];
+      const std::size_t turn = cell.turn.load(std::memory_order_acquire);
+      if (turn == position + 1) {
+        if (head.compare_exchange_weak(position, position + 1,
+                                       std::memory_order_relaxed)) {
+          value = cell.value;
+          cell.turn.store(position + mask + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (turn < position + 1) {
+        return false;
+      } else {
+        position = head.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  void push(uint64_t value) {
+    Backoff backoff;
+    while (!tryPush(value)) {
+      backoff.pause();
+    }
+  }
+
+  // False once stopped is set and the queue is empty.
+  bool pop(uint64_t &value, const std::atomic<bool> &stopped) {
+    Backoff backoff;
+    while (!tryPop(value)) {
+      if (stopped.load(std::memory_order_acquire)) {
+        return tryPop(value);
+      }
+      backoff.pause();
+    }
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<std::size_t> turn{0};
+    uint64_t value = 0;
+  };
+
+  std::unique_ptr<Cell[]> cells;
+  std::size_t mask = 0;
+  alignas(64) std::atomic<std::size_t> tail{0};
+  alignas(64) std::atomic<std::size_t> head{0};
+};
+
+// A directive on its way through the stages. Directive n uses slot
+// n % in_flight, which the reader fills only after the writer has written
+// directive n - in_flight, so each slot has one owner at a time and the
+// strings keep their capacity from one directive to the next.
+struct Slot {
+  std::size_t file = 0;
+  ScannedPragma pragma;
+  ParseOptions options;
+  ParseResult result;
+  bool parsed = false;
+  ValidationResult emitted;
+  std::string text;
+  // Thrown while parsing or emitting; the writer rethrows it in order.
+  std::exception_ptr error;
+  std::atomic<bool> ready{false};
+};
+
+bool readFile(const std::string &path, std::string &content) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>(file),
+                 std::istreambuf_iterator<char>());
+  return !file.bad();
+}
+
+unsigned threadCount(unsigned requested) {
+  return requested != 0 ? requested
+                        : std::max(1u, std::thread::hardware_concurrency());
+}
+
+} // namespace
+
+bool PipelineResult::success() const {
+  return failed == 0 && unreadable.empty();
+}
+
+PipelineResult runPipeline(const std::vector<std::string> &paths,
+                           TextSink &sink, const PipelineOptions &options) {
+  const std::size_t in_flight = std::max<std::size_t>(1, options.in_flight);
+  std::unique_ptr<Slot[]> slots = std::make_unique<Slot[]>(in_flight);
+  SequenceQueue parse_queue(in_flight);
+  SequenceQueue emit_queue(in_flight);
+  std::atomic<bool> reading_done{false};
+  std::atomic<bool> parsing_done{false};
+  std::atomic<bool> stopping{false};
+  std::atomic<uint64_t> written{0};
+  std::atomic<uint64_t> total{UINT64_MAX};
+  std::exception_ptr reader_error;
+
+  PipelineResult result;
+  result.files = paths.size();
+
+  // Every stage started is joined before this returns or throws. When the
+  // writer throws, or a stage cannot be started, the stages are told to stop
+  // first, so that none waits for a directive that will not come.
+  const auto stop = [&] {
+    stopping.store(true, std::memory_order_release);
+    reading_done.store(true, std::memory_order_release);
+    parsing_done.store(true, std::memory_order_release);
+  };
+  const unsigned parse_threads = threadCount(options.parse_threads);
+  const unsigned emit_threads = threadCount(options.emit_threads);
+  std::atomic<unsigned> parsers_running{parse_threads};
+  detail::ThreadGroup stages;
+  try {
+    stages.reserve(1 + parse_threads + emit_threads);
+    stages.start([&] {
+      uint64_t next = 0;
+      try {
+        std::string content;
+        for (std::size_t file = 0; file < paths.size(); ++file) {
+          if (!readFile(paths[file], content)) {
+            result.unreadable.push_back(paths[file]);
+            continue;
+          }
+          ParseOptions file_options = options.parse;
+          file_options.language =
+              languageForPath(paths[file]).value_or(options.parse.language);
+          for (ScannedPragma &pragma :
+               scanPragmas(content, file_options.language)) {
+            Backoff backoff;
+            while (next - written.load(std::memory_order_acquire) >=
+                   in_flight) {
+              if (stopping.load(std::memory_order_acquire)) {
+                return;
+              }
+              backoff.pause();
+            }
+            Slot &slot = slots[next % in_flight];
+            slot.file = file;
+            slot.pragma = std::move(pragma);
+            slot.options = file_options;
+            parse_queue.push(next++);
+          }
+        }
+      } catch (...) {
+        // The directives before the failure are still written.
+        reader_error = std::current_exception();
+      }
+      total.store(next, std::memory_order_release);
+      reading_done.store(true, std::memory_order_release);
+    });
+
+    for (unsigned i = 0; i < parse_threads; ++i) {
+      stages.start([&] {
+        uint64_t number;
+        while (parse_queue.pop(number, reading_done)) {
+          Slot &slot = slots[number % in_flight];
+          try {
+            slot.result = parseDirective(slot.pragma.text, slot.options);
+            slot.parsed = slot.result.success();
+          } catch (...) {
+            slot.parsed = false;
+            slot.error = std::current_exception();
+          }
+          emit_queue.push(number);
+        }
+        if (--parsers_running == 0) {
+          parsing_done.store(true, std::memory_order_release);
+        }
+      });
+    }
+
+    for (unsigned i = 0; i < emit_threads; ++i) {
+      stages.start([&] {
+        uint64_t number;
+        while (emit_queue.pop(number, parsing_done)) {
+          Slot &slot = slots[number % in_flight];
+          if (slot.parsed) {
+            try {
+              StringSink text(slot.text);
+              slot.emitted = options.output == PipelineOutput::Json
+                                 ? toJson(*slot.result.directive, text)
+                                 : unparseTo(*slot.result.directive, text);
+              if (slot.emitted.success()) {
+                slot.text.push_back('\n');
+              }
+            } catch (...) {
+              slot.error = std::current_exception();
+            }
+          }
+          slot.ready.store(true, std::memory_order_release);
+        }
+      });
+    }
+
+    // The writer takes directives in order, whichever worker finished them.
+    for (uint64_t number = 0;; ++number) {
+      Slot &slot = slots[number % in_flight];
+      Backoff idle;
+      while (!slot.ready.load(std::memory_order_acquire)) {
+        if (number >= total.load(std::memory_order_acquire)) {
+          break;
+        }
+        idle.pause();
+      }
+      if (!slot.ready.load(std::memory_order_acquire)) {
+        break;
+      }
+      if (slot.error) {
+        std::rethrow_exception(slot.error);
+      }
+      ++result.directives;
+      if (!slot.parsed || !slot.emitted.success()) {
+        ++result.failed;
+      } else {
+        sink.append(slot.text);
+      }
+      for (std::vector<Diagnostic> *diagnostics :
+           {&slot.result.diagnostics, &slot.emitted.diagnostics}) {
+        for (Diagnostic &diagnostic : *diagnostics) {
+          result.diagnostics.push_back(PipelineDiagnostic{
+              paths[slot.file], slot.pragma.begin, std::move(diagnostic)});
+        }
+      }
+      slot.result = ParseResult();
+      slot.emitted.diagnostics.clear();
+      slot.text.clear();
+      slot.ready.store(false, std::memory_order_relaxed);
+      written.store(number + 1, std::memory_order_release);
+    }
+  } catch (...) {
+    stop();
+    throw;
+  }
+
+  stages.join();
+  if (reader_error) {
+    std::rethrow_exception(reader_error);
+  }
+  return result;
+}
+
+} // namespace ompparser
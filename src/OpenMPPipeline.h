@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPPIPELINE_H
+#define OMPPARSER_OPENMPPIPELINE_H
+
+#include "OpenMPParser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace ompparser {
+
+enum class PipelineOutput {
+  // The unparse text of each directive.
+  Unparse,
+  // The toJson object of each directive.
+  Json
+};
+
+struct PipelineOptions {
+  // Used for every file, except that a file's language is the one
+  // languageForPath gives it, when there is one.
+  ParseOptions parse;
+  PipelineOutput output = PipelineOutput::Unparse;
+  // Threads of the parse stage, which also validates and runs the host
+  // hooks, and of the emit stage; 0 uses std::thread::hardware_concurrency().
+  unsigned parse_threads = 0;
+  unsigned emit_threads = 1;
+  // Directives that may be between the reader and the sink at once. The
+  // reader waits while that many are, so a slow stage holds back the ones
+  // before it instead of letting memory grow.
+  std::size_t in_flight = 1024;
+};
+
+struct PipelineDiagnostic {
+  std::string path;
+  // Start of the directive in the file; the diagnostic's range is relative
+  // to the directive's scanned text.
+  SourcePosition begin;
+  Diagnostic diagnostic;
+};
+
+struct PipelineResult {
+  std::size_t files = 0;
+  std::size_t directives = 0;
+  // Directives that did not parse or did not emit.
+  std::size_t failed = 0;
+  // In the order their directives were written.
+  std::vector<PipelineDiagnostic> diagnostics;
+  std::vector<std::string> unreadable;
+
+  bool success() const;
+};
+
+// Scans, parses and emits every directive of paths as a pipeline of stages
+// on their own threads: one reader reads and scans the files, parse workers
+// parse them, emit workers render them, and the calling thread writes each
+// directive's text and a newline into sink in file order. The stages hand
+// directives to each other through lock-free bounded queues, so reading the
+// next file, parsing and emitting overlap. The output is what a serial loop
+// over the same files writes. Directives that fail are left out of it and
+// reported with their position. An exception thrown by a stage or by sink is
+// rethrown once every stage has stopped, after the directives before it.
+PipelineResult runPipeline(const std::vector<std::string> &paths,
+                           TextSink &sink,
+                           const PipelineOptions &options = {});
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPPIPELINE_H
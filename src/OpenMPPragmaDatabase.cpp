@@ -0,0 +1,441 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "OpenMPPragmaDatabase.h"
+#include "OpenMPIR.h"
+#include "OpenMPPragmaScanner.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <system_error>
+#include <unordered_map>
+#include <utility>
+
+namespace ompparser {
+
+namespace {
+
+namespace fs = std::filesystem;
+
+constexpr std::string_view DatabaseMagic = "OMPI";
+// Largest table diffPragmas fills to match the directives between a file's
+// unchanged head and tail; past it they are paired in order.
+constexpr std::size_t MaxDiffCells = std::size_t(1) << 22;
+
+uint64_t hashContent(std::string_view content) {
+  // FNV-1a.
+  uint64_t hash = 0xcbf29ce484222325ull;
+  for (const char c : content) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+  }
+  return hash;
+}
+
+// Two records are the same directive when they parse alike, or, when
+// neither parses, are spelled alike.
+bool sameDirective(const PragmaRecord &lhs, const PragmaRecord &rhs) {
+  if (lhs.parsed() != rhs.parsed()) {
+    return false;
+  }
+  return lhs.parsed() ? lhs.ast == rhs.ast : lhs.text == rhs.text;
+}
+
+void addChange(std::vector<PragmaChange> &changes, PragmaChangeKind kind,
+               const std::string &path, const PragmaRecord *before,
+               const PragmaRecord *after) {
+  PragmaChange change;
+  change.kind = kind;
+  change.path = path;
+  if (before) {
+    change.before = *before;
+  }
+  if (after) {
+    change.after = *after;
+  }
+  changes.push_back(std::move(change));
+}
+
+// Reports how after differs from before: directives are matched by the
+// longest common subsequence of sameDirective, and between two matches the
+// unmatched ones are paired in order as changed, the rest being removed or
+// added.
+void diffPragmas(const std::string &path,
+                 const std::vector<PragmaRecord> &before,
+                 const std::vector<PragmaRecord> &after,
+                 std::vector<PragmaChange> &changes) {
+  std::size_t head = 0;
+  while (head < before.size() && head < after.size() &&
+         sameDirective(before[head], after[head])) {
+    ++head;
+  }
+  std::size_t tail = 0;
+  while (tail < before.size() - head && tail < after.size() - head &&
+         sameDirective(before[before.size() - 1 - tail],
+                       after[after.size() - 1 - tail])) {
+    ++tail;
+  }
+  const std::size_t rows = before.size() - head - tail;
+  const std::size_t columns = after.size() - head - tail;
+
+  // matches[k] pairs before[head + first] with after[head + second].
+  std::vector<std::pair<std::size_t, std::size_t>> matches;
+  if (rows != 0 && columns != 0 &&
+      (rows + 1) * (columns + 1) <= MaxDiffCells) {
+    const std::size_t width = columns + 1;
+    std::vector<uint32_t> common((rows + 1) * width, 0);
+    for (std::size_t i = rows; i-- > 0;) {
+      for (std::size_t j = columns; j-- > 0;) {
+        common[i * width + j] =
+            sameDirective(before[head + i], after[head + j])
+                ? common[(i + 1) * width + j + 1] + 1
+                : std::max(common[(i + 1) * width + j],
+                           common[i * width + j + 1]);
+      }
+    }
+    for (std::size_t i = 0, j = 0; i < rows && j < columns;) {
+      if (sameDirective(before[head + i], after[head + j])) {
+        matches.emplace_back(i++, j++);
+      } else if (common[(i + 1) * width + j] >= common[i * width + j + 1]) {
+        ++i;
+      } else {
+        ++j;
+      }
+    }
+  }
+  matches.emplace_back(rows, columns);
+
+  std::size_t i = 0;
+  std::size_t j = 0;
+  for (const auto &[next_i, next_j] : matches) {
+    for (; i < next_i && j < next_j; ++i, ++j) {
+      addChange(changes, PragmaChangeKind::Changed, path, &before[head + i],
+                &after[head + j]);
+    }
+    for (; i < next_i; ++i) {
+      addChange(changes, PragmaChangeKind::Removed, path, &before[head + i],
+                nullptr);
+    }
+    for (; j < next_j; ++j) {
+      addChange(changes, PragmaChangeKind::Added, path, nullptr,
+                &after[head + j]);
+    }
+    ++i;
+    ++j;
+  }
+}
+
+void removeAll(const PragmaFile &file, std::vector<PragmaChange> &changes) {
+  for (const PragmaRecord &record : file.pragmas) {
+    addChange(changes, PragmaChangeKind::Removed, file.path, &record, nullptr);
+  }
+}
+
+bool readFile(const std::string &path, std::string &content) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>(file),
+                 std::istreambuf_iterator<char>());
+  return !file.bad();
+}
+
+// Scans content and parses each directive, copying the parse of a directive
+// whose text previous already held.
+std::vector<PragmaRecord> indexPragmas(std::string_view content,
+                                       const ParseOptions &options,
+                                       const PragmaFile *previous,
+                                       std::size_t &parsed) {
+  std::unordered_map<std::string_view, const PragmaRecord *> known;
+  if (previous) {
+    for (const PragmaRecord &record : previous->pragmas) {
+      known.emplace(record.text, &record);
+    }
+  }
+  StructuralOptions structural;
+  structural.ignore_source_ranges = true;
+
+  std::vector<PragmaRecord> records;
+  for (ScannedPragma &pragma : scanPragmas(content, options.language)) {
+    PragmaRecord record;
+    record.begin = pragma.begin;
+    const auto found = known.find(pragma.text);
+    if (found != known.end()) {
+      record.image = found->second->image;
+      record.ast = found->second->ast;
+    } else {
+      ++parsed;
+      const ParseResult result = parseDirective(pragma.text, options);
+      if (result.success()) {
+        try {
+          record.image = serialize(*result.directive);
+          record.ast = hash(*result.directive, structural);
+        } catch (const std::invalid_argument &) {
+          record.image.clear();
+        }
+      }
+    }
+    record.text = std::move(pragma.text);
+    records.push_back(std::move(record));
+  }
+  return records;
+}
+
+// Integers as little-endian base-128 groups and strings as a length and
+// their bytes, as serialize writes them.
+class DatabaseWriter {
+public:
+  explicit DatabaseWriter(std::string &bytes) : bytes(bytes) {}
+
+  void integer(uint64_t number) {
+    while (number >= 0x80) {
+      bytes.push_back(static_cast<char>((number & 0x7F) | 0x80));
+      number >>= 7;
+    }
+    bytes.push_back(static_cast<char>(number));
+  }
+  void text(std::string_view characters) {
+    integer(characters.size());
+    bytes.append(characters);
+  }
+
+private:
+  std::string &bytes;
+};
+
+class MalformedDatabase : public std::runtime_error {
+public:
+  using std::runtime_error::runtime_error;
+};
+
+class DatabaseReader {
+public:
+  explicit DatabaseReader(std::string_view bytes) : bytes(bytes) {}
+
+  uint64_t integer() {
+    uint64_t number = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      if (position == bytes.size()) {
+        throw MalformedDatabase("pragma database is truncated");
+      }
+      const auto byte = static_cast<unsigned char>(bytes[position++]);
+      number |= static_cast<uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return number;
+      }
+    }
+    throw MalformedDatabase("pragma database integer is too long");
+  }
+  uint64_t integer(uint64_t limit) {
+    const uint64_t number = integer();
+    if (number > limit) {
+      throw MalformedDatabase("pragma database field is out of range");
+    }
+    return number;
+  }
+  std::string text() {
+    const uint64_t size = integer();
+    if (size > remaining()) {
+      throw MalformedDatabase("pragma database is truncated");
+    }
+    std::string characters(bytes.substr(position, size));
+    position += size;
+    return characters;
+  }
+  std::size_t remaining() const { return bytes.size() - position; }
+
+private:
+  std::string_view bytes;
+  std::size_t position = 0;
+};
+
+} // namespace
+
+PragmaUpdateReport
+PragmaDatabase::update(const std::vector<std::string> &paths) {
+  std::vector<std::string> wanted = paths;
+  std::sort(wanted.begin(), wanted.end());
+  wanted.erase(std::unique(wanted.begin(), wanted.end()), wanted.end());
+
+  PragmaUpdateReport report;
+  std::vector<PragmaFile> previous = std::move(indexed);
+  indexed.clear();
+  auto old_file = previous.begin();
+  for (const std::string &path : wanted) {
+    for (; old_file != previous.end() && old_file->path < path; ++old_file) {
+      removeAll(*old_file, report.changes);
+    }
+    PragmaFile *old = old_file != previous.end() && old_file->path == path
+                          ? &*old_file++
+                          : nullptr;
+    ++report.files_checked;
+
+    std::error_code error;
+    const uint64_t size = fs::file_size(path, error);
+    const fs::file_time_type time =
+        error ? fs::file_time_type() : fs::last_write_time(path, error);
+    const int64_t modified = time.time_since_epoch().count();
+    if (!error && old && old->modified == modified && old->size == size) {
+      indexed.push_back(std::move(*old));
+      continue;
+    }
+    std::string content;
+    if (error || !readFile(path, content)) {
+      report.unreadable.push_back(path);
+      if (old) {
+        removeAll(*old, report.changes);
+      }
+      continue;
+    }
+
+    ++report.files_read;
+    const uint64_t content_hash = hashContent(content);
+    if (old && old->size == content.size() &&
+        old->content_hash == content_hash) {
+      old->modified = modified;
+      indexed.push_back(std::move(*old));
+      continue;
+    }
+
+    ++report.files_scanned;
+    PragmaFile file;
+    file.path = path;
+    file.language = languageForPath(path).value_or(BaseLanguage::C);
+    file.modified = modified;
+    file.size = content.size();
+    file.content_hash = content_hash;
+    ParseOptions options;
+    options.language = file.language;
+    options.extensions = extension_policy;
+    file.pragmas =
+        indexPragmas(content, options, old, report.directives_parsed);
+    diffPragmas(path, old ? old->pragmas : std::vector<PragmaRecord>(),
+                file.pragmas, report.changes);
+    indexed.push_back(std::move(file));
+  }
+  for (; old_file != previous.end(); ++old_file) {
+    removeAll(*old_file, report.changes);
+  }
+  return report;
+}
+
+const PragmaFile *PragmaDatabase::find(std::string_view path) const {
+  const auto found = std::lower_bound(
+      indexed.begin(), indexed.end(), path,
+      [](const PragmaFile &file, std::string_view key) {
+        return file.path < key;
+      });
+  return found != indexed.end() && found->path == path ? &*found : nullptr;
+}
+
+void PragmaDatabase::save(TextSink &sink) const {
+  std::string bytes(DatabaseMagic);
+  DatabaseWriter writer(bytes);
+  writer.integer(PragmaDatabaseVersion);
+  writer.integer(SerializationFormatVersion);
+  writer.integer(static_cast<uint64_t>(extension_policy));
+  writer.integer(indexed.size());
+  for (const PragmaFile &file : indexed) {
+    writer.text(file.path);
+    writer.integer(static_cast<uint64_t>(file.language));
+    writer.integer(static_cast<uint64_t>(file.modified));
+    writer.integer(file.size);
+    writer.integer(file.content_hash);
+    writer.integer(file.pragmas.size());
+    for (const PragmaRecord &record : file.pragmas) {
+      writer.text(record.text);
+      writer.integer(record.begin.offset);
+      writer.integer(record.begin.line);
+      writer.integer(record.begin.column);
+      writer.text(record.image);
+      writer.integer(record.ast.low);
+      writer.integer(record.ast.high);
+    }
+  }
+  sink.append(bytes);
+}
+
+bool PragmaDatabaseResult::success() const {
+  return std::none_of(diagnostics.begin(), diagnostics.end(),
+                      [](const Diagnostic &diagnostic) {
+                        return diagnostic.severity == DiagnosticSeverity::Error;
+                      });
+}
+
+PragmaDatabaseResult openPragmaDatabase(std::string_view bytes) {
+  PragmaDatabaseResult result;
+  auto reject = [&result](const std::string &message) {
+    Diagnostic diagnostic;
+    diagnostic.code = DiagnosticCode::MalformedSerialization;
+    diagnostic.severity = DiagnosticSeverity::Error;
+    diagnostic.message = message;
+    result.database = PragmaDatabase();
+    result.diagnostics.push_back(std::move(diagnostic));
+    return std::move(result);
+  };
+  if (bytes.substr(0, DatabaseMagic.size()) != DatabaseMagic) {
+    return reject("input is not an OpenMP pragma database");
+  }
+  DatabaseReader reader(bytes.substr(DatabaseMagic.size()));
+  try {
+    const uint64_t version = reader.integer();
+    if (version != PragmaDatabaseVersion) {
+      return reject("pragma database has version " + std::to_string(version) +
+                    ", expected " + std::to_string(PragmaDatabaseVersion));
+    }
+    if (reader.integer() != SerializationFormatVersion) {
+      return reject("pragma database holds directives of another serialize "
+                    "format");
+    }
+    PragmaDatabase &database = result.database;
+    database.extension_policy = static_cast<ExtensionPolicy>(reader.integer(
+        static_cast<uint64_t>(ExtensionPolicy::AllowRegistered)));
+    // Every file takes at least six bytes and every directive seven, which
+    // bounds the counts before anything is reserved for them.
+    const uint64_t file_count = reader.integer(reader.remaining() / 6);
+    database.indexed.reserve(file_count);
+    for (uint64_t f = 0; f < file_count; ++f) {
+      PragmaFile file;
+      file.path = reader.text();
+      if (!database.indexed.empty() &&
+          database.indexed.back().path >= file.path) {
+        return reject("pragma database files are not in path order");
+      }
+      file.language = static_cast<BaseLanguage>(
+          reader.integer(static_cast<uint64_t>(BaseLanguage::Fortran)));
+      file.modified = static_cast<int64_t>(reader.integer());
+      file.size = reader.integer();
+      file.content_hash = reader.integer();
+      const uint64_t pragma_count = reader.integer(reader.remaining() / 7);
+      file.pragmas.reserve(pragma_count);
+      for (uint64_t p = 0; p < pragma_count; ++p) {
+        PragmaRecord record;
+        record.text = reader.text();
+        record.begin.offset = static_cast<uint32_t>(reader.integer(UINT32_MAX));
+        record.begin.line = static_cast<uint32_t>(reader.integer(UINT32_MAX));
+        record.begin.column = static_cast<uint32_t>(reader.integer(UINT32_MAX));
+        record.image = reader.text();
+        record.ast.low = reader.integer();
+        record.ast.high = reader.integer();
+        file.pragmas.push_back(std::move(record));
+      }
+      database.indexed.push_back(std::move(file));
+    }
+    if (reader.remaining() != 0) {
+      return reject("pragma database is followed by trailing bytes");
+    }
+  } catch (const MalformedDatabase &error) {
+    return reject(error.what());
+  }
+  return result;
+}
+
+} // namespace ompparser
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPPRAGMADATABASE_H
+#define OMPPARSER_OPENMPPRAGMADATABASE_H
+
+#include "OpenMPParser.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ompparser {
+
+// Version of the pragma database layout; databases of another version, or
+// holding images of another serialize format, are rejected by
+// openPragmaDatabase.
+inline constexpr uint32_t PragmaDatabaseVersion = 1;
+
+// A directive of an indexed file.
+struct PragmaRecord {
+  // Scanned text, as scanPragmas returns it.
+  std::string text;
+  // Start of the directive in the file.
+  SourcePosition begin;
+  // serialize image of its parse, which deserialize rebuilds without
+  // parsing, and the hash of that parse with source ranges ignored. Both are
+  // empty when the directive did not parse.
+  std::string image;
+  StructuralHash ast;
+
+  bool parsed() const { return !image.empty(); }
+};
+
+struct PragmaFile {
+  std::string path;
+  BaseLanguage language = BaseLanguage::C;
+  // Last write time, in ticks of std::filesystem::file_time_type, and size
+  // when the file was read, and a 64-bit hash of its content.
+  int64_t modified = 0;
+  uint64_t size = 0;
+  uint64_t content_hash = 0;
+  // In file order.
+  std::vector<PragmaRecord> pragmas;
+};
+
+enum class PragmaChangeKind { Added, Removed, Changed };
+
+struct PragmaChange {
+  PragmaChangeKind kind = PragmaChangeKind::Added;
+  std::string path;
+  // The directive as it was, for Removed and Changed, and as it is, for
+  // Added and Changed.
+  PragmaRecord before;
+  PragmaRecord after;
+};
+
+struct PragmaUpdateReport {
+  // Grouped by file in path order, and in file order within a file.
+  std::vector<PragmaChange> changes;
+  // Files given, read because their time or size changed, and scanned
+  // because their content changed.
+  std::size_t files_checked = 0;
+  std::size_t files_read = 0;
+  std::size_t files_scanned = 0;
+  // Directives parsed; a scanned directive whose text the file already held
+  // reuses that parse.
+  std::size_t directives_parsed = 0;
+  // Files given that could not be read; their directives are removed.
+  std::vector<std::string> unreadable;
+};
+
+struct PragmaDatabaseResult;
+
+// An index of every directive in a project that is brought up to date
+// incrementally. update() looks at each file's time and size first, and
+// reads and hashes only the files where those differ; only files whose
+// content changed are scanned again, and of their directives only those
+// with new text are parsed. Changes are reported per directive: directives
+// are matched in file order by their parse, so moving a directive to
+// another line, or respelling it to the same parse, is not a change. A file
+// rewritten at the same size within one tick of its file system's clock is
+// not noticed until it changes again.
+class PragmaDatabase {
+public:
+  explicit PragmaDatabase(
+      ExtensionPolicy extensions = ExtensionPolicy::RejectUnknown)
+      : extension_policy(extensions) {}
+
+  // Brings the database up to date with paths, the project's source files:
+  // files it indexed that are not among them are dropped. Each file is
+  // parsed as the language languageForPath gives it, or as C.
+  PragmaUpdateReport update(const std::vector<std::string> &paths);
+
+  // Indexed files in path order.
+  const std::vector<PragmaFile> &files() const { return indexed; }
+  // nullptr when path is not indexed.
+  const PragmaFile *find(std::string_view path) const;
+  ExtensionPolicy extensions() const { return extension_policy; }
+
+  // Writes the database for openPragmaDatabase to read back.
+  void save(TextSink &sink) const;
+
+private:
+  friend PragmaDatabaseResult openPragmaDatabase(std::string_view bytes);
+
+  ExtensionPolicy extension_policy;
+  std::vector<PragmaFile> indexed;
+};
+
+struct PragmaDatabaseResult {
+  PragmaDatabase database;
+  std::vector<Diagnostic> diagnostics;
+
+  bool success() const;
+};
+
+// Reads a database save() wrote. A database that is truncated, or of
+// another version, yields an empty database, which the next update rebuilds
+// from scratch, and a MalformedSerialization diagnostic.
+PragmaDatabaseResult openPragmaDatabase(std::string_view bytes);
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPPRAGMADATABASE_H
@@ -0,0 +1,339 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "OpenMPPragmaScanner.h"
+
+#include <cctype>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace ompparser {
+
+namespace {
+
+bool isBlank(char c) { return c == ' ' || c == '\t'; }
+
+std::size_t skipBlanks(std::string_view text, std::size_t pos) {
+  while (pos < text.size() && isBlank(text[pos])) {
+    ++pos;
+  }
+  return pos;
+}
+
+bool equalsIgnoringCase(std::string_view text, std::string_view word) {
+  if (text.size() != word.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    if (std::tolower(static_cast<unsigned char>(text[i])) != word[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+struct Line {
+  std::string_view text;
+  uint32_t offset = 0;
+  uint32_t number = 0;
+};
+
+// Splits source into lines without their terminators; a trailing '\r' is
+// dropped as well.
+class LineReader {
+public:
+  explicit LineReader(std::string_view source) : source(source) {}
+
+  bool next(Line &line) {
+    if (pos >= source.size()) {
+      return false;
+    }
+    std::size_t end = source.find('\n', pos);
+    if (end == std::string_view::npos) {
+      end = source.size();
+    }
+    line.text = source.substr(pos, end - pos);
+    if (!line.text.empty() && line.text.back() == '\r') {
+      line.text.remove_suffix(1);
+    }
+    line.offset = static_cast<uint32_t>(pos);
+    line.number = ++number;
+    pos = end + 1;
+    return true;
+  }
+
+  // Position to return to when a line read ahead is not a continuation.
+  std::pair<std::size_t, uint32_t> mark() const { return {pos, number}; }
+  void reset(std::pair<std::size_t, uint32_t> marked) {
+    pos = marked.first;
+    number = marked.second;
+  }
+
+private:
+  std::string_view source;
+  std::size_t pos = 0;
+  uint32_t number = 0;
+};
+
+// Removes /* */ comments, carrying one left open into the next line. A
+// comment between two tokens leaves one space.
+std::string stripBlockComments(std::string_view line, bool &in_block_comment,
+                               bool &pending_space) {
+  std::string result;
+  std::size_t pos = 0;
+  while (pos < line.size()) {
+    if (in_block_comment) {
+      const std::size_t end = line.find("*/", pos);
+      if (end == std::string_view::npos) {
+        return result;
+      }
+      in_block_comment = false;
+      pos = end + 2;
+      if (pending_space && pos < line.size() &&
+          !std::isspace(static_cast<unsigned char>(line[pos]))) {
+        result.push_back(' ');
+      }
+      pending_space = false;
+      continue;
+    }
+    const std::size_t start = line.find("/*", pos);
+    if (start == std::string_view::npos) {
+      result.append(line.substr(pos));
+      break;
+    }
+    result.append(line.substr(pos, start - pos));
+    pending_space = !result.empty() &&
+                    !std::isspace(static_cast<unsigned char>(result.back()));
+    in_block_comment = true;
+    pos = start + 2;
+  }
+  return result;
+}
+
+void stripLineComment(std::string &line) {
+  const std::size_t start = line.find("//");
+  if (start != std::string::npos) {
+    line.erase(start);
+  }
+}
+
+// `#pragma omp` followed by a blank, each part possibly preceded by blanks.
+bool isCPragma(std::string_view line) {
+  std::size_t pos = skipBlanks(line, 0);
+  if (pos == line.size() || line[pos] != '#') {
+    return false;
+  }
+  pos = skipBlanks(line, pos + 1);
+  if (line.substr(pos, 6) != "pragma") {
+    return false;
+  }
+  std::size_t next = skipBlanks(line, pos + 6);
+  if (next == pos + 6 || line.substr(next, 3) != "omp") {
+    return false;
+  }
+  return next + 3 < line.size() && isBlank(line[next + 3]);
+}
+
+// Drops trailing backslashes and the blanks after them; true if there were
+// any.
+bool stripBackslashContinuation(std::string &line) {
+  std::size_t end = line.find_last_not_of(" \t");
+  if (end == std::string::npos || line[end] != '\\') {
+    return false;
+  }
+  while (end > 0 && line[end - 1] == '\\') {
+    --end;
+  }
+  line.erase(end);
+  return true;
+}
+
+struct FortranSentinel {
+  // [begin, body) is the sentinel and the blanks after it.
+  std::size_t begin = 0;
+  std::size_t body = 0;
+};
+
+// `!$omp`, `c$omp` or `*$omp` in any case, optionally followed by `x` and a
+// continuation `&`.
+bool matchFortranSentinel(std::string_view line, FortranSentinel &match) {
+  std::size_t pos = skipBlanks(line, 0);
+  if (pos == line.size()) {
+    return false;
+  }
+  const char lead = line[pos];
+  if (lead != '!' && lead != 'c' && lead != 'C' && lead != '*') {
+    return false;
+  }
+  if (!equalsIgnoringCase(line.substr(pos + 1, 4), "$omp")) {
+    return false;
+  }
+  match.begin = pos;
+  pos += 5;
+  if (pos < line.size() && (line[pos] == 'x' || line[pos] == 'X')) {
+    ++pos;
+  }
+  if (pos < line.size() && line[pos] == '&') {
+    ++pos;
+  }
+  match.body = skipBlanks(line, pos);
+  return true;
+}
+
+// Cuts a `!` comment that is outside a quoted string.
+std::string_view stripFortranInlineComment(std::string_view text) {
+  bool in_single_quote = false;
+  bool in_double_quote = false;
+  for (std::size_t i = 0; i < text.size(); ++i) {
+    const char current = text[i];
+    if (current == '\'' && !in_double_quote) {
+      if (in_single_quote && i + 1 < text.size() && text[i + 1] == '\'') {
+        ++i;
+      } else {
+        in_single_quote = !in_single_quote;
+      }
+    } else if (current == '"' && !in_single_quote) {
+      if (in_double_quote && i + 1 < text.size() && text[i + 1] == '"') {
+        ++i;
+      } else {
+        in_double_quote = !in_double_quote;
+      }
+    } else if (current == '!' && !in_single_quote && !in_double_quote) {
+      return text.substr(0, i);
+    }
+  }
+  return text;
+}
+
+// Drops a trailing `&` and the blanks around it; true if there was one.
+bool stripAmpersandContinuation(std::string &text) {
+  std::size_t end = text.find_last_not_of(" \t");
+  if (end == std::string::npos) {
+    text.clear();
+    return false;
+  }
+  if (text[end] != '&') {
+    return false;
+  }
+  text.erase(end);
+  end = text.find_last_not_of(" \t");
+  text.erase(end == std::string::npos ? 0 : end + 1);
+  return true;
+}
+
+SourcePosition lineStart(const Line &line) {
+  const std::size_t column = skipBlanks(line.text, 0);
+  return {static_cast<uint32_t>(line.offset + column), line.number,
+          static_cast<uint32_t>(column + 1)};
+}
+
+void scanC(std::string_view source, std::vector<ScannedPragma> &pragmas) {
+  LineReader reader(source);
+  Line line;
+  bool in_block_comment = false;
+  bool pending_space = false;
+  while (reader.next(line)) {
+    // Most lines can neither be a directive nor open a comment.
+    if (!in_block_comment &&
+        line.text.find_first_of("#/") == std::string_view::npos) {
+      continue;
+    }
+    std::string stripped =
+        stripBlockComments(line.text, in_block_comment, pending_space);
+    if (!isCPragma(stripped)) {
+      continue;
+    }
+    ScannedPragma &pragma = pragmas.emplace_back();
+    pragma.begin = lineStart(line);
+    stripLineComment(stripped);
+    while (stripBackslashContinuation(stripped)) {
+      pragma.text += stripped;
+      if (!reader.next(line)) {
+        stripped.clear();
+        break;
+      }
+      stripped = stripBlockComments(line.text, in_block_comment, pending_space);
+      stripLineComment(stripped);
+    }
+    pragma.text += stripped;
+    pragma.text.erase(0, skipBlanks(pragma.text, 0));
+  }
+}
+
+void scanFortran(std::string_view source,
+                 std::vector<ScannedPragma> &pragmas) {
+  LineReader reader(source);
+  Line line;
+  FortranSentinel match;
+  while (reader.next(line)) {
+    if (!matchFortranSentinel(line.text, match)) {
+      continue;
+    }
+    ScannedPragma &pragma = pragmas.emplace_back();
+    pragma.begin = lineStart(line);
+    std::string body(stripFortranInlineComment(line.text.substr(match.body)));
+    bool continued = stripAmpersandContinuation(body);
+    while (continued) {
+      const auto marked = reader.mark();
+      Line next;
+      if (!reader.next(next)) {
+        break;
+      }
+      FortranSentinel next_match;
+      if (!matchFortranSentinel(next.text, next_match)) {
+        reader.reset(marked);
+        break;
+      }
+      body += ' ';
+      body += stripFortranInlineComment(next.text.substr(next_match.body));
+      continued = stripAmpersandContinuation(body);
+    }
+    pragma.text = line.text.substr(match.begin, match.body - match.begin);
+    pragma.text += body;
+  }
+}
+
+} // namespace
+
+std::vector<ScannedPragma> scanPragmas(std::string_view source,
+                                       BaseLanguage language) {
+  std::vector<ScannedPragma> pragmas;
+  if (language == BaseLanguage::Fortran) {
+    scanFortran(source, pragmas);
+  } else {
+    scanC(source, pragmas);
+  }
+  return pragmas;
+}
+
+std::optional<BaseLanguage> languageForPath(std::string_view path) {
+  const std::size_t slash = path.find_last_of('/');
+  const std::size_t dot = path.find_last_of('.');
+  if (dot == std::string_view::npos ||
+      (slash != std::string_view::npos && dot < slash)) {
+    return std::nullopt;
+  }
+  const std::string_view extension = path.substr(dot + 1);
+  for (std::string_view fortran : {"f", "f90", "f95", "f03", "f08"}) {
+    if (equalsIgnoringCase(extension, fortran)) {
+      return BaseLanguage::Fortran;
+    }
+  }
+  if (extension == "c" || extension == "h") {
+    return BaseLanguage::C;
+  }
+  for (std::string_view cxx : {"cc", "cpp", "cxx", "hh", "hpp", "hxx"}) {
+    if (extension == cxx) {
+      return BaseLanguage::CXX;
+    }
+  }
+  return std::nullopt;
+}
+
+} // namespace ompparser
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#ifndef OMPPARSER_OPENMPPRAGMASCANNER_H
+#define OMPPARSER_OPENMPPRAGMASCANNER_H
+
+#include "OpenMPParser.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ompparser {
+
+// A directive found in a source file, joined across its continuation lines
+// with comments removed, ready for parseDirective.
+struct ScannedPragma {
+  std::string text;
+  // Start of the directive's first line, after leading blanks.
+  SourcePosition begin;
+};
+
+// Finds the `#pragma omp` lines of C and C++ source, or the `!$omp`, `c$omp`
+// and `*$omp` sentinel lines of Fortran source, in order. Backslash and `&`
+// continuations are joined, and block, `//` and trailing `!` comments are
+// dropped. The wasm module scans its input with this.
+std::vector<ScannedPragma> scanPragmas(std::string_view source,
+                                       BaseLanguage language);
+
+// Base language of a source file by its extension: .f, .f90, .f95, .f03 and
+// .f08 in either case are Fortran, .c and .h are C, and .cc, .cpp, .cxx,
+// .hh, .hpp and .hxx are C++. Other files have none.
+std::optional<BaseLanguage> languageForPath(std::string_view path);
+
+} // namespace ompparser
+
+#endif // OMPPARSER_OPENMPPRAGMASCANNER_H
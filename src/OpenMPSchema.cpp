@@ -8,9 +8,7 @@
 
 #include "OpenMPSchema.h"
 
-#include <algorithm>
 #include <cstdint>
-#include <iterator>
 
 namespace {
 
@@ -24,54 +22,63 @@ constexpr bool isStrictlyIncreasing(const uint32_t (&values)[Size]) {
   return true;
 }
 
-} // namespace
+constexpr uint32_t ClauseCount = ompparser::ClauseKindCount;
+constexpr std::size_t WordBits = 64;
+constexpr std::size_t RowWords = (ClauseCount + WordBits - 1) / WordBits;
 
-namespace ompparser {
+constexpr uint32_t AllowedDirectiveClauses[] = {
+#define OPENMP_ALLOWED_CLAUSE(Directive, Clause)                               \
+  static_cast<uint32_t>(OMPD_##Directive) * ClauseCount +                      \
+      static_cast<uint32_t>(OMPC_##Clause),
+#include "OpenMPApplicability.def"
+#undef OPENMP_ALLOWED_CLAUSE
+};
+static_assert(isStrictlyIncreasing(AllowedDirectiveClauses),
+              "OpenMPApplicability.def must follow enum order and contain "
+              "no duplicate entries");
 
-const char *getClauseName(OpenMPClauseKind kind) {
-  switch (kind) {
-#define OPENMP_CLAUSE(Name, Class)                                             \
-  case OMPC_##Name:                                                            \
-    return #Name;
-#define OPENMP_CLAUSE_EXT(Name, Class, Spelling) OPENMP_CLAUSE(Name, Class)
-#include "OpenMPKinds.def"
-#undef OPENMP_CLAUSE_EXT
-#undef OPENMP_CLAUSE
-  }
-  return "unknown";
-}
+// Dense directive x clause matrix, one row of RowWords words per directive.
+struct ApplicabilityMatrix {
+  uint64_t rows[ompparser::DirectiveKindCount][RowWords] = {};
+};
 
-const char *getDirectiveName(OpenMPDirectiveKind kind) {
-  switch (kind) {
-#define OPENMP_DIRECTIVE(Name)                                                 \
-  case OMPD_##Name:                                                            \
-    return #Name;
-#define OPENMP_DIRECTIVE_EXT(Name, Spelling) OPENMP_DIRECTIVE(Name)
-#include "OpenMPKinds.def"
-#undef OPENMP_DIRECTIVE_EXT
-#undef OPENMP_DIRECTIVE
+constexpr ApplicabilityMatrix buildApplicabilityMatrix() {
+  ApplicabilityMatrix matrix;
+  for (uint32_t key : AllowedDirectiveClauses) {
+    const uint32_t clause = key % ClauseCount;
+    const uint64_t bit = uint64_t{1} << (clause % WordBits);
+    matrix.rows[key / ClauseCount][clause / WordBits] |= bit;
   }
-  return "unknown";
+  return matrix;
 }
 
+constexpr ApplicabilityMatrix Applicability = buildApplicabilityMatrix();
+
+} // namespace
+
+namespace ompparser {
+
 bool isClauseAllowedOnDirective(OpenMPDirectiveKind directive,
                                 OpenMPClauseKind clause) {
-  constexpr uint32_t ClauseCount = static_cast<uint32_t>(OMPC_unknown) + 1;
-  static constexpr uint32_t AllowedDirectiveClauses[] = {
-#define OPENMP_ALLOWED_CLAUSE(Directive, Clause)                               \
-  static_cast<uint32_t>(OMPD_##Directive) * ClauseCount +                      \
-      static_cast<uint32_t>(OMPC_##Clause),
-#include "OpenMPApplicability.def"
-#undef OPENMP_ALLOWED_CLAUSE
-  };
-  static_assert(isStrictlyIncreasing(AllowedDirectiveClauses),
-                "OpenMPApplicability.def must follow enum order and contain "
-                "no duplicate entries");
-
-  const uint32_t key = static_cast<uint32_t>(directive) * ClauseCount +
-                       static_cast<uint32_t>(clause);
-  return std::binary_search(std::begin(AllowedDirectiveClauses),
-                            std::end(AllowedDirectiveClauses), key);
+  const auto row = static_cast<std::size_t>(directive);
+  const auto column = static_cast<std::size_t>(clause);
+  if (row >= DirectiveKindCount || column >= ClauseKindCount) {
+    return false;
+  }
+  return (Applicability.rows[row][column / WordBits] >> (column % WordBits)) &
+         1;
+}
+
+ClauseSet allowedClauses(OpenMPDirectiveKind directive) {
+  ClauseSet allowed;
+  const auto row = static_cast<std::size_t>(directive);
+  if (row >= DirectiveKindCount) {
+    return allowed;
+  }
+  for (std::size_t word = 0; word < RowWords; ++word) {
+    allowed |= ClauseSet(Applicability.rows[row][word]) << (word * WordBits);
+  }
+  return allowed;
 }
 
 ClauseCardinality getClauseCardinality(OpenMPClauseKind kind) {
@@ -11,16 +11,62 @@
 
 #include "OpenMPKinds.h"
 
+#include <bitset>
+#include <cstddef>
+#include <iterator>
+
 namespace ompparser {
 
+namespace detail {
+
+// Spellings indexed by kind, in OpenMPKinds.def order.
+inline constexpr const char *ClauseNames[] = {
+#define OPENMP_CLAUSE(Name, Class) #Name,
+#define OPENMP_CLAUSE_EXT(Name, Class, Spelling) OPENMP_CLAUSE(Name, Class)
+#include "OpenMPKinds.def"
+#undef OPENMP_CLAUSE_EXT
+#undef OPENMP_CLAUSE
+};
+
+inline constexpr const char *DirectiveNames[] = {
+#define OPENMP_DIRECTIVE(Name) #Name,
+#define OPENMP_DIRECTIVE_EXT(Name, Spelling) OPENMP_DIRECTIVE(Name)
+#include "OpenMPKinds.def"
+#undef OPENMP_DIRECTIVE_EXT
+#undef OPENMP_DIRECTIVE
+};
+
+} // namespace detail
+
+// Number of kinds, including the trailing unknown kind.
+inline constexpr std::size_t ClauseKindCount = std::size(detail::ClauseNames);
+inline constexpr std::size_t DirectiveKindCount =
+    std::size(detail::DirectiveNames);
+
+// One bit per clause kind, indexed by OpenMPClauseKind.
+using ClauseSet = std::bitset<ClauseKindCount>;
+
 enum class ClauseCardinality { Repeatable, Unique };
 
-const char *getClauseName(OpenMPClauseKind kind);
-const char *getDirectiveName(OpenMPDirectiveKind kind);
+constexpr const char *getClauseName(OpenMPClauseKind kind) {
+  return static_cast<std::size_t>(kind) < ClauseKindCount
+             ? detail::ClauseNames[kind]
+             : "unknown";
+}
+
+constexpr const char *getDirectiveName(OpenMPDirectiveKind kind) {
+  return static_cast<std::size_t>(kind) < DirectiveKindCount
+             ? detail::DirectiveNames[kind]
+             : "unknown";
+}
+
 ClauseCardinality getClauseCardinality(OpenMPClauseKind kind);
 bool clauseRequiresExpressionList(OpenMPClauseKind kind);
 bool isClauseAllowedOnDirective(OpenMPDirectiveKind directive,
                                 OpenMPClauseKind clause);
+// Every clause kind allowed on the directive, as one row of the
+// applicability matrix.
+ClauseSet allowedClauses(OpenMPDirectiveKind directive);
 
 } // namespace ompparser
 
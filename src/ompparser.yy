@@ -7129,6 +7129,7 @@ OpenMPDirective* parseOpenMP(const char* _input) {
 
     current_directive->setBaseLang(base_lang);
     OpenMPDirective *result = releaseDirectiveOwnership(current_directive);
+    result->markParserConstructed();
     current_directive = nullptr;
     current_clause = nullptr;
     current_parent_directive = nullptr;
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// Walks the host fragments of every directive in a pragma corpus and reports
+// the traversal cost. Fails when a walk allocates.
+
+#include <OpenMPIR.h>
+#include <OpenMPParser.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <regex>
+#include <string>
+#include <vector>
+
+extern std::unique_ptr<std::vector<std::string>>
+preProcessCManaged(std::ifstream &);
+
+namespace {
+
+std::size_t allocation_count = 0;
+
+void *countedAllocation(std::size_t size) {
+  ++allocation_count;
+  if (void *memory = std::malloc(size == 0 ? 1 : size)) {
+    return memory;
+  }
+  throw std::bad_alloc();
+}
+
+void countedRelease(void *memory) noexcept { std::free(memory); }
+
+ompparser::BaseLanguage languageForPath(const std::filesystem::path &path) {
+  const std::string extension = path.extension().string();
+  if (extension == ".cpp" || extension == ".cc" || extension == ".cxx") {
+    return ompparser::BaseLanguage::CXX;
+  }
+  if (extension == ".c") {
+    return ompparser::BaseLanguage::C;
+  }
+  return ompparser::BaseLanguage::Fortran;
+}
+
+bool isCorpusFile(const std::filesystem::path &path) {
+  static const char *const extensions[] = {".c",   ".cpp", ".cc",  ".cxx",
+                                           ".f",   ".f90", ".f95", ".F",
+                                           ".F90"};
+  const std::string extension = path.extension().string();
+  return std::find_if(std::begin(extensions), std::end(extensions),
+                      [&](const char *candidate) {
+                        return extension == candidate;
+                      }) != std::end(extensions);
+}
+
+} // namespace
+
+// Every unaligned allocation form is replaced, and every deallocation form
+// with it, so that each new is paired with a delete that uses free.
+void *operator new(std::size_t size) { return countedAllocation(size); }
+void *operator new[](std::size_t size) { return countedAllocation(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return countedAllocation(size);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept {
+  try {
+    return countedAllocation(size);
+  } catch (const std::bad_alloc &) {
+    return nullptr;
+  }
+}
+
+void operator delete(void *memory) noexcept { countedRelease(memory); }
+void operator delete[](void *memory) noexcept { countedRelease(memory); }
+void operator delete(void *memory, std::size_t) noexcept {
+  countedRelease(memory);
+}
+void operator delete[](void *memory, std::size_t) noexcept {
+  countedRelease(memory);
+}
+void operator delete(void *memory, const std::nothrow_t &) noexcept {
+  countedRelease(memory);
+}
+void operator delete[](void *memory, const std::nothrow_t &) noexcept {
+  countedRelease(memory);
+}
+
+int main(int argc, const char *argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: bench_host_fragments <corpus-dir> [iterations]\n";
+    return 2;
+  }
+  const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 100;
+
+  std::vector<std::filesystem::path> files;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(argv[1])) {
+    if (entry.is_regular_file() && isCorpusFile(entry.path())) {
+      files.push_back(entry.path());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  std::regex fortran_regex("^[[:blank:]]*[!cC\\*]\\$ompx?",
+                           std::regex_constants::icase);
+  std::vector<std::unique_ptr<OpenMPDirective>> directives;
+  for (const std::filesystem::path &file : files) {
+    std::ifstream input(file);
+    std::unique_ptr<std::vector<std::string>> pragmas =
+        preProcessCManaged(input);
+    for (const std::string &pragma : *pragmas) {
+      ompparser::ParseOptions options;
+      options.language = std::regex_search(pragma, fortran_regex)
+                             ? ompparser::BaseLanguage::Fortran
+                             : languageForPath(file);
+      ompparser::ParseResult parsed =
+          ompparser::parseDirective(pragma, options);
+      if (parsed.success()) {
+        directives.push_back(std::move(parsed.directive));
+      }
+    }
+  }
+
+  std::size_t fragments = 0;
+  std::size_t spelling_bytes = 0;
+  auto count = [&](ompparser::HostFragment &fragment) {
+    ++fragments;
+    spelling_bytes += fragment.spelling.size();
+  };
+
+  const std::size_t allocations_before = allocation_count;
+  const auto start = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    for (const std::unique_ptr<OpenMPDirective> &directive : directives) {
+      directive->visitHostFragments(count);
+    }
+  }
+  const auto stop = std::chrono::steady_clock::now();
+  const std::size_t walk_allocations = allocation_count - allocations_before;
+
+  const double elapsed_ns =
+      std::chrono::duration<double, std::nano>(stop - start).count();
+  std::cout << "files: " << files.size() << "\n"
+            << "directives: " << directives.size() << "\n"
+            << "iterations: " << iterations << "\n"
+            << "fragments visited: " << fragments << "\n"
+            << "spelling bytes: " << spelling_bytes << "\n"
+            << "elapsed ms: " << elapsed_ns / 1e6 << "\n"
+            << "ns per directive walk: "
+            << (directives.empty()
+                    ? 0.0
+                    : elapsed_ns / (static_cast<double>(directives.size()) *
+                                    iterations))
+            << "\n"
+            << "walk allocations: " << walk_allocations << "\n";
+  return walk_allocations == 0 ? 0 : 1;
+}
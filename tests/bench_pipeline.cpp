@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// Reads, scans, parses and unparses every directive of a corpus, once with
+// the serial loop omp_roundtrip runs, one directive after another, and once
+// through runPipeline, and reports the throughput of each. Fails when the
+// two write different text.
+
+#include <OpenMPIR.h>
+#include <OpenMPParser.h>
+#include <OpenMPPipeline.h>
+#include <OpenMPPragmaScanner.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+// What omp_roundtrip does for each file, over the whole corpus.
+std::size_t runSerial(const std::vector<std::string> &files,
+                      std::string &output) {
+  std::size_t directives = 0;
+  for (const std::string &path : files) {
+    std::ifstream file(path, std::ios::binary);
+    const std::string content((std::istreambuf_iterator<char>(file)),
+                              std::istreambuf_iterator<char>());
+    ompparser::ParseOptions options;
+    options.language =
+        ompparser::languageForPath(path).value_or(ompparser::BaseLanguage::C);
+    for (const ompparser::ScannedPragma &pragma :
+         ompparser::scanPragmas(content, options.language)) {
+      ++directives;
+      ompparser::ParseResult result =
+          ompparser::parseDirective(pragma.text, options);
+      if (!result.success()) {
+        continue;
+      }
+      ompparser::StringSink sink(output);
+      if (ompparser::unparseTo(*result.directive, sink).success()) {
+        output.push_back('\n');
+      }
+    }
+  }
+  return directives;
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  if (argc < 2) {
+    std::cerr << "usage: bench_pipeline CORPUS_DIR [ITERATIONS] "
+                 "[PARSE_THREADS]\n";
+    return 2;
+  }
+  const int iterations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+  ompparser::PipelineOptions options;
+  options.parse_threads =
+      argc > 3 ? static_cast<unsigned>(std::max(1, std::atoi(argv[3]))) : 0;
+
+  std::vector<std::string> files;
+  for (const auto &entry :
+       std::filesystem::recursive_directory_iterator(argv[1])) {
+    if (entry.is_regular_file() &&
+        ompparser::languageForPath(entry.path().string()).has_value()) {
+      files.push_back(entry.path().string());
+    }
+  }
+  std::sort(files.begin(), files.end());
+
+  std::string serial_output;
+  std::size_t directives = 0;
+  const auto serial_start = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    serial_output.clear();
+    directives = runSerial(files, serial_output);
+  }
+  const auto serial_stop = std::chrono::steady_clock::now();
+
+  std::string pipeline_output;
+  ompparser::PipelineResult pipeline;
+  const auto pipeline_start = std::chrono::steady_clock::now();
+  for (int iteration = 0; iteration < iterations; ++iteration) {
+    pipeline_output.clear();
+    ompparser::StringSink sink(pipeline_output);
+    pipeline = ompparser::runPipeline(files, sink, options);
+  }
+  const auto pipeline_stop = std::chrono::steady_clock::now();
+
+  const double serial_seconds =
+      std::chrono::duration<double>(serial_stop - serial_start).count();
+  const double pipeline_seconds =
+      std::chrono::duration<double>(pipeline_stop - pipeline_start).count();
+  const double total = static_cast<double>(directives) * iterations;
+  std::cout << "files: " << files.size() << "\n"
+            << "directives: " << directives << "\n"
+            << "iterations: " << iterations << "\n"
+            << "serial directives per second: " << total / serial_seconds
+            << "\n"
+            << "pipeline directives per second: " << total / pipeline_seconds
+            << "\n"
+            << "speedup: " << serial_seconds / pipeline_seconds << "\n";
+
+  if (pipeline.directives != directives ||
+      pipeline_output != serial_output) {
+    std::cerr << "pipeline output differs from the serial loop\n";
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// Validates parallel directives of the same length in which 0, a quarter,
+// half and all of the clauses have a rule in OpenMPValidation.def, and reports
+// the time per directive against the number of rules. Fails when a directive
+// that should be valid is not, or when validation runs any rule but the one
+// of each reduction clause.
+
+#include <OpenMPDirectiveBuilder.h>
+#include <OpenMPIR.h>
+#include <OpenMPParser.h>
+#include <OpenMPParserInternal.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int kClauseCount = 256;
+
+std::vector<std::string> variableList(int clause) {
+  return {"a" + std::to_string(clause), "b" + std::to_string(clause)};
+}
+
+// parallel has no directive rule, private no rule beyond the schema checks,
+// and reduction a clause rule; neither has a clause-set rule.
+ompparser::ParseResult buildParallel(int ruled) {
+  ompparser::DirectiveBuilder builder(OMPD_parallel);
+  for (int clause = 0; clause < kClauseCount; ++clause) {
+    if (clause < ruled) {
+      builder.reduction(OMPC_REDUCTION_IDENTIFIER_plus, variableList(clause));
+    } else {
+      builder.variables(OMPC_private, variableList(clause));
+    }
+  }
+  return builder.build();
+}
+
+} // namespace
+
+int main(int argc, const char *argv[]) {
+  const int iterations = argc > 1 ? std::max(1, std::atoi(argv[1])) : 1000;
+
+  int failures = 0;
+  std::cout << "clauses per directive: " << kClauseCount << "\n"
+            << "iterations: " << iterations << "\n";
+  for (const int ruled :
+       {0, kClauseCount / 4, kClauseCount / 2, kClauseCount}) {
+    const ompparser::ParseResult built = buildParallel(ruled);
+    if (!built.success() ||
+        built.directive->getClausesInOriginalOrder()->size() !=
+            static_cast<std::size_t>(kClauseCount)) {
+      std::cerr << ruled << " rules: directive failed to build\n";
+      ++failures;
+      continue;
+    }
+    std::size_t diagnostics = 0;
+    const uint64_t runs_before = ompparser::detail::validationRuleRuns();
+    const auto start = std::chrono::steady_clock::now();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+      diagnostics += ompparser::validate(*built.directive).diagnostics.size();
+    }
+    const auto stop = std::chrono::steady_clock::now();
+    const uint64_t runs = ompparser::detail::validationRuleRuns() - runs_before;
+    if (diagnostics != 0) {
+      std::cerr << ruled << " rules: validation reported " << diagnostics
+                << " diagnostics\n";
+      ++failures;
+    }
+    if (runs != static_cast<uint64_t>(ruled) * iterations) {
+      std::cerr << ruled << " rules: validation ran " << runs / iterations
+                << " rules per directive\n";
+      ++failures;
+    }
+
+    const double elapsed_ns =
+        std::chrono::duration<double, std::nano>(stop - start).count();
+    std::cout << "rules " << ruled
+              << ": ns per directive: " << elapsed_ns / iterations << "\n";
+  }
+  return failures == 0 ? 0 : 1;
+}
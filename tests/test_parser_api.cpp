@@ -6,20 +6,50 @@
  * SPDX-License-Identifier: (BSD-3-Clause)
  */
 
+#include <OpenMPClauseCache.h>
+#include <OpenMPDirectiveBuilder.h>
+#include <OpenMPDirectiveEditor.h>
+#include <OpenMPDirectiveStore.h>
 #include <OpenMPIR.h>
+#include <OpenMPIRVisitor.h>
+#include <OpenMPParseCache.h>
 #include <OpenMPParser.h>
-
+#include <OpenMPParserC.h>
+#include <OpenMPParserInternal.h>
+#include <OpenMPPipeline.h>
+#include <OpenMPPragmaDatabase.h>
+#include <OpenMPPragmaScanner.h>
+#include <OpenMPSchema.h>
+
+#include <algorithm>
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <memory>
+#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <thread>
 #include <utility>
 #include <vector>
 
+#if !defined(__EMSCRIPTEN__) && (defined(__unix__) || defined(__APPLE__))
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 namespace {
 
+static_assert(ompparser::getClauseName(OMPC_private)[0] == 'p' &&
+                  ompparser::getDirectiveName(OMPD_parallel)[0] == 'p',
+              "kind names must be available at compile time");
+
 class TestSemanticNode final : public ompparser::HostSemanticNode {};
 
 class RecordingHooks final : public ompparser::HostLanguageHooks {
@@ -65,6 +95,43 @@ public:
   }
 };
 
+class NodeCountingVisitor final
+    : public ompparser::ConstRecursiveOpenMPIRVisitor<NodeCountingVisitor> {
+public:
+  std::vector<OpenMPDirectiveKind> directives;
+  int map_clauses = 0;
+  int variant_clauses = 0;
+  int other_clauses = 0;
+
+  bool visitDirective(const OpenMPDirective &directive) {
+    directives.push_back(directive.getKind());
+    return true;
+  }
+  bool visitMapClause(const OpenMPMapClause &) {
+    ++map_clauses;
+    return true;
+  }
+  bool visitVariantClause(const OpenMPVariantClause &) {
+    ++variant_clauses;
+    return true;
+  }
+  bool visitClause(const OpenMPClause &) {
+    ++other_clauses;
+    return true;
+  }
+};
+
+class StoppingVisitor final
+    : public ompparser::RecursiveOpenMPIRVisitor<StoppingVisitor> {
+public:
+  int visited_clauses = 0;
+
+  bool visitClause(OpenMPClause &) {
+    ++visited_clauses;
+    return false;
+  }
+};
+
 struct ExpectedHostFragment {
   const char *spelling;
   OpenMPClauseKind clause_kind;
@@ -1594,6 +1661,1036 @@ int main() {
     ok = false;
   }
 
+  OpenMPDirective many_clause_ast(OMPD_target, Lang_C);
+  for (int index = 0; index < 4096; ++index) {
+    OpenMPClause *clause = many_clause_ast.addOpenMPClause(
+        OMPC_depend, OMPC_DEPEND_MODIFIER_unspecified, OMPC_DEPENDENCE_TYPE_in);
+    clause->addLangExpr(("a" + std::to_string(index)).c_str());
+  }
+  std::vector<std::string> many_clause_errors;
+  const bool many_clauses_valid =
+      many_clause_ast.validateInvariants(many_clause_errors);
+  std::vector<OpenMPClause *> &many_clause_order =
+      *many_clause_ast.getClausesInOriginalOrder();
+  many_clause_order.push_back(many_clause_order.front());
+  std::vector<std::string> duplicated_order_errors;
+  if (!many_clauses_valid || !many_clause_errors.empty() ||
+      many_clause_ast.validateInvariants(duplicated_order_errors) ||
+      std::find(duplicated_order_errors.begin(), duplicated_order_errors.end(),
+                "source-order sequence contains a duplicate pointer") ==
+          duplicated_order_errors.end()) {
+    std::cerr << "invariant check missed a duplicated source-order clause\n";
+    ok = false;
+  }
+
+  ompparser::ParseResult trusted_parse =
+      ompparser::parseDirective("#pragma omp parallel private(a) shared(b)");
+  if (!trusted_parse.success() ||
+      !trusted_parse.directive->isParserConstructed()) {
+    std::cerr << "parsed directive was not marked parser-constructed\n";
+    ok = false;
+  } else {
+    trusted_parse.directive->getClausesInOriginalOrder()->clear();
+    if (trusted_parse.directive->isParserConstructed() ||
+        ompparser::validate(*trusted_parse.directive).success()) {
+      std::cerr << "mutable clause access kept the parser-constructed mark\n";
+      ok = false;
+    }
+  }
+
+  ompparser::ParseResult memoized_parse =
+      ompparser::parseDirective("#pragma omp parallel private(a) shared(b)");
+  if (!memoized_parse.success() || !memoized_parse.directive->isValidated()) {
+    std::cerr << "parsed directive did not record its validation\n";
+    ok = false;
+  } else {
+    OpenMPDirective &memoized = *memoized_parse.directive;
+    const uint64_t generation = memoized.getModificationGeneration();
+    if (!ompparser::unparse(memoized).success() ||
+        !ompparser::toDot(memoized).success() ||
+        memoized.getModificationGeneration() != generation) {
+      std::cerr << "unparse or toDot changed an unmodified directive\n";
+      ok = false;
+    }
+    const OpenMPDirective &const_memoized = memoized;
+    OpenMPClause *private_clause =
+        const_memoized.findClauses(OMPC_private)->front();
+    private_clause->getExpressionItems().clear();
+    if (memoized.isValidated() ||
+        memoized.getModificationGeneration() == generation ||
+        ompparser::unparse(memoized).success()) {
+      std::cerr << "clause mutation did not invalidate cached validation\n";
+      ok = false;
+    }
+  }
+
+  const std::string edited_input =
+      "#pragma omp for private(i) schedule(static)";
+  ompparser::ParseResult edited_parse = ompparser::parseDirective(edited_input);
+  if (!edited_parse.success()) {
+    std::cerr << "edited directive did not parse\n";
+    ok = false;
+  } else {
+    const OpenMPDirective &edited = *edited_parse.directive;
+    const OpenMPClause *private_clause =
+        edited.findClauses(OMPC_private)->front();
+    const OpenMPClause *schedule_clause =
+        edited.findClauses(OMPC_schedule)->front();
+    ompparser::SourceEditResult patch =
+        ompparser::DirectiveEditor(edited, edited_input)
+            .replaceFragment(private_clause->getExpressionItems()
+                                 .front()
+                                 .fragment,
+                             "j")
+            .removeClause(*schedule_clause)
+            .addClause("nowait")
+            .finish();
+    if (!patch.success() || patch.edits.size() != 3 ||
+        patch.edits[0].offset != 24 || patch.edits[0].length != 1 ||
+        patch.edits[1].offset != 26 || patch.edits[1].length != 17 ||
+        patch.edits[2].offset != 43 || patch.edits[2].text != " nowait" ||
+        patch.text != "#pragma omp for private(j) nowait" ||
+        ompparser::applySourceEdits(edited_input, patch.edits) != patch.text ||
+        patch.directive->findClauses(OMPC_nowait) == nullptr) {
+      std::cerr << "directive edits did not produce minimal replacements\n";
+      ok = false;
+    }
+
+    ompparser::SourceEditResult conflicting =
+        ompparser::DirectiveEditor(edited, edited_input)
+            .replaceClause(*schedule_clause, "schedule(dynamic)")
+            .removeClause(*schedule_clause)
+            .finish();
+    if (conflicting.success() || conflicting.edits.size() != 1 ||
+        !hasDiagnostic(conflicting, ompparser::DiagnosticCode::InvalidEdit)) {
+      std::cerr << "overlapping directive edits were not reported\n";
+      ok = false;
+    }
+
+    OpenMPDirective foreign_ast(OMPD_for);
+    OpenMPClause *foreign_clause = foreign_ast.addOpenMPClause(OMPC_nowait);
+    bool foreign_clause_threw = false;
+    try {
+      ompparser::DirectiveEditor(edited, edited_input)
+          .removeClause(*foreign_clause);
+    } catch (const std::invalid_argument &) {
+      foreign_clause_threw = true;
+    }
+    if (!foreign_clause_threw) {
+      std::cerr << "editing a foreign clause did not fail immediately\n";
+      ok = false;
+    }
+  }
+
+  ompparser::ParseOptions verbatim_options;
+  verbatim_options.retain_source = true;
+  const std::string verbatim_input =
+      "#pragma omp parallel  private(a),\tshared(b) \\\n  firstprivate(e)";
+  ompparser::ParseResult rendered_parse =
+      ompparser::parseDirective(verbatim_input, verbatim_options);
+  if (!rendered_parse.success()) {
+    std::cerr << "verbatim directive did not parse\n";
+    ok = false;
+  } else {
+    OpenMPDirective &rendered = *rendered_parse.directive;
+    const OpenMPDirective &const_rendered = rendered;
+    auto verbatim = [](const OpenMPDirective &directive) {
+      return ompparser::unparse(directive, ompparser::UnparseFormat::Verbatim)
+          .text;
+    };
+    const std::string copied = verbatim(rendered);
+    const std::string normalized = ompparser::unparse(rendered).text;
+    const_rendered.findClauses(OMPC_private)
+        ->front()
+        ->addLangExpr("c", OMPC_CLAUSE_SEP_comma, 0, 0,
+                      OMP_EXPR_PARSE_variable_list);
+    const std::string extended = verbatim(rendered);
+    const_rendered.findClauses(OMPC_shared)
+        ->front()
+        ->visitHostFragments([](ompparser::HostFragment &fragment) {
+          fragment.spelling = "d";
+        });
+    const std::string renamed = verbatim(rendered);
+    // Fragments visited through the directive may include its header's.
+    rendered.visitHostFragments([](ompparser::HostFragment &) {});
+    const std::string revisited = verbatim(rendered);
+    const std::unique_ptr<OpenMPDirective> copy = rendered.clone();
+    if (copied != verbatim_input ||
+        normalized !=
+            ompparser::unparse(*ompparser::parseDirective(verbatim_input)
+                                    .directive)
+                .text ||
+        extended != "#pragma omp parallel  private(a, c),\tshared(b) \\\n"
+                    "  firstprivate(e)" ||
+        renamed != "#pragma omp parallel  private(a, c),\tshared(d) \\\n"
+                   "  firstprivate(e)" ||
+        revisited != ompparser::unparse(rendered).text ||
+        verbatim(*copy) != ompparser::unparse(*copy).text) {
+      std::cerr << "verbatim unparse did not follow the modifications\n";
+      ok = false;
+    }
+  }
+
+  ompparser::ParseResult sink_parse =
+      ompparser::parseDirective("#pragma omp parallel private(a) shared(b)");
+  if (!sink_parse.success()) {
+    std::cerr << "sink directive did not parse\n";
+    ok = false;
+  } else {
+    const std::string expected = ompparser::unparse(*sink_parse.directive).text;
+    std::string appended = "prefix ";
+    ompparser::StringSink string_sink(appended);
+    char wide[128];
+    ompparser::BufferSink wide_sink(wide, sizeof(wide));
+    char narrow[8];
+    ompparser::BufferSink narrow_sink(narrow, sizeof(narrow));
+    std::ostringstream stream;
+    ompparser::StreamSink stream_sink(stream);
+    if (!ompparser::unparseTo(*sink_parse.directive, string_sink).success() ||
+        !ompparser::unparseTo(*sink_parse.directive, wide_sink).success() ||
+        !ompparser::unparseTo(*sink_parse.directive, narrow_sink).success() ||
+        !ompparser::unparseTo(*sink_parse.directive, stream_sink).success() ||
+        appended != "prefix " + expected || wide_sink.text() != expected ||
+        wide_sink.overflowed() || !narrow_sink.overflowed() ||
+        narrow_sink.text() != expected.substr(0, sizeof(narrow)) ||
+        stream.str() != expected) {
+      std::cerr << "unparseTo sinks disagree with unparse\n";
+      ok = false;
+    }
+  }
+
+  OpenMPDirective invalid_sink_ast(OMPD_parallel);
+  invalid_sink_ast.addOpenMPClause(OMPC_private);
+  std::string invalid_sink_text;
+  ompparser::StringSink invalid_sink(invalid_sink_text);
+  ompparser::ValidationResult invalid_sink_result =
+      ompparser::unparseTo(invalid_sink_ast, invalid_sink);
+  if (invalid_sink_result.success() || !invalid_sink_text.empty()) {
+    std::cerr << "unparseTo wrote an invalid directive\n";
+    ok = false;
+  }
+
+  {
+    std::vector<ompparser::ParseResult> batch_parses;
+    batch_parses.push_back(
+        ompparser::parseDirective("#pragma omp parallel private(a)"));
+    batch_parses.push_back(
+        ompparser::parseDirective("#pragma omp for collapse(2) nowait"));
+    OpenMPDirective invalid_batch_ast(OMPD_parallel);
+    invalid_batch_ast.addOpenMPClause(OMPC_private);
+    std::vector<const OpenMPDirective *> batch;
+    std::string expected_batch;
+    for (std::size_t index = 0; index < 1200; ++index) {
+      if (index == 7) {
+        batch.push_back(nullptr);
+      } else if (index == 900) {
+        batch.push_back(&invalid_batch_ast);
+      } else {
+        const ompparser::ParseResult &parse = batch_parses[index % 2];
+        batch.push_back(parse.directive.get());
+        expected_batch += ompparser::unparse(*parse.directive).text + ";\n";
+      }
+    }
+    ompparser::UnparseAllOptions batch_options;
+    batch_options.terminator = ";\n";
+    batch_options.threads = 3;
+    ompparser::UnparseAllResult serial_batch = ompparser::unparseAll(
+        batch, ompparser::UnparseAllOptions{batch_options.terminator, 1});
+    ompparser::UnparseAllResult parallel_batch =
+        ompparser::unparseAll(batch, batch_options);
+    for (const ompparser::UnparseAllResult *batch_result :
+         {&serial_batch, &parallel_batch}) {
+      if (batch_result->success() || batch_result->text != expected_batch ||
+          batch_result->offsets.size() != batch.size() + 1 ||
+          !batch_result->directiveText(7).empty() ||
+          !batch_result->directiveText(900).empty() ||
+          batch_result->directiveText(901) !=
+              ompparser::unparse(*batch_parses[1].directive).text + ";\n" ||
+          batch_result->diagnostics.size() < 2 ||
+          batch_result->diagnostics.front().index != 7 ||
+          batch_result->diagnostics.back().index != 900) {
+        std::cerr << "unparseAll disagrees with per-directive unparse\n";
+        ok = false;
+      }
+    }
+    if (!ompparser::unparseAll(nullptr, 0).success()) {
+      std::cerr << "empty unparseAll batch failed\n";
+      ok = false;
+    }
+  }
+
+  ompparser::ParseResult graph_first =
+      ompparser::parseDirective("#pragma omp parallel private(a)");
+  ompparser::ParseResult graph_second =
+      ompparser::parseDirective("#pragma omp parallel private(b) nowait");
+  if (!graph_first.success() || !graph_second.success()) {
+    std::cerr << "DOT graph directives did not parse\n";
+    ok = false;
+  } else {
+    std::string graph;
+    ompparser::StringSink graph_sink(graph);
+    ompparser::DotGraphResult graph_result = ompparser::toDotGraph(
+        {graph_first.directive.get(), nullptr, graph_second.directive.get()},
+        graph_sink);
+    if (graph_result.success() || graph_result.diagnostics.size() != 1 ||
+        graph_result.diagnostics.front().index != 1 ||
+        graph.rfind("graph OpenMPIR {\n", 0) != 0 ||
+        graph.find("subgraph cluster_0 {") == std::string::npos ||
+        graph.find("subgraph cluster_1 {") != std::string::npos ||
+        graph.find("subgraph cluster_2 {") == std::string::npos ||
+        graph.find("d0 -- d0_private_2_0\n") == std::string::npos ||
+        graph.find("d2 -- d2_private_2_0\n") == std::string::npos ||
+        graph.find("d2 -- d2_nowait_2_1\n") == std::string::npos ||
+        graph.compare(graph.size() - 2, 2, "}\n") != 0) {
+      std::cerr << "toDotGraph did not write one cluster per directive\n";
+      ok = false;
+    }
+  }
+
+  ompparser::ParseResult json_source = ompparser::parseDirective(
+      "#pragma omp target map(always, tofrom: a, b) nowait");
+  ompparser::ParseResult json_escaped =
+      ompparser::DirectiveBuilder(OMPD_task)
+          .expression(OMPC_final, "s == \"\\\t\"")
+          .build();
+  if (!json_source.success() || !json_escaped.success()) {
+    std::cerr << "JSON export directives did not build\n";
+    ok = false;
+  } else {
+    std::string json;
+    ompparser::StringSink json_sink(json);
+    if (!ompparser::toJson(*json_source.directive, json_sink).success() ||
+        json.rfind("{\"directive\":\"target\",\"language\":\"c\",", 0) != 0 ||
+        json.find("{\"clause\":\"map\",") == std::string::npos ||
+        json.find("\"modifier1\":\"always\",") == std::string::npos ||
+        json.find("\"type\":\"tofrom\",") == std::string::npos ||
+        json.find("\"items\":[\"a\",\"b\"]}") == std::string::npos ||
+        json.find("{\"clause\":\"nowait\",") == std::string::npos ||
+        json.back() != '}') {
+      std::cerr << "toJson did not write the directive's typed fields\n";
+      ok = false;
+    }
+
+    std::string lines;
+    ompparser::StringSink lines_sink(lines);
+    ompparser::JsonLinesResult lines_result = ompparser::toJsonLines(
+        {json_source.directive.get(), nullptr, json_escaped.directive.get()},
+        lines_sink);
+    if (lines_result.success() || lines_result.diagnostics.size() != 1 ||
+        lines_result.diagnostics.front().index != 1 ||
+        lines.compare(0, json.size() + 1, json + "\n") != 0 ||
+        lines.find("\"items\":[\"s == \\\"\\\\\\t\\\"\"]") ==
+            std::string::npos ||
+        std::count(lines.begin(), lines.end(), '\n') != 2) {
+      std::cerr << "toJsonLines did not write one escaped line per directive\n";
+      ok = false;
+    }
+  }
+
+  const std::string c_view_input =
+      "#pragma omp target map(tofrom: a, b) nowait";
+  ompparser_view *c_view = ompparser_parse(
+      c_view_input.data(), c_view_input.size(), OMPPARSER_LANGUAGE_C);
+  if (c_view == nullptr || !ompparser_view_succeeded(c_view)) {
+    std::cerr << "C view did not parse\n";
+    ok = false;
+  } else {
+    size_t c_text_length = 0;
+    const char *c_text = ompparser_view_text(c_view, &c_text_length);
+    auto c_slice = [c_text](ompparser_text text) {
+      return std::string(c_text + text.offset, text.length);
+    };
+    size_t c_clause_count = 0;
+    const ompparser_clause_record *c_clauses =
+        ompparser_view_clauses(c_view, &c_clause_count);
+    size_t c_fragment_count = 0;
+    const ompparser_fragment_record *c_fragments =
+        ompparser_view_fragments(c_view, &c_fragment_count);
+    const ompparser_directive_record *c_directive =
+        ompparser_view_directive(c_view);
+    if (c_directive == nullptr ||
+        std::strcmp(ompparser_directive_kind_name(c_directive->kind),
+                    "target") != 0 ||
+        c_directive->fragment_count != 0 ||
+        c_text_length < c_view_input.size() ||
+        c_view_input.compare(0, c_view_input.size(), c_text,
+                             c_view_input.size()) != 0 ||
+        c_clause_count != 2 ||
+        std::strcmp(ompparser_clause_kind_name(c_clauses[0].kind), "map") !=
+            0 ||
+        c_clauses[0].modifiers[0] != OMPC_MAP_TYPE_tofrom ||
+        c_clauses[1].modifiers[0] != OMPPARSER_NO_MODIFIER ||
+        c_clauses[0].item_count != 2 || c_clauses[0].fragment_count < 2 ||
+        c_fragment_count < c_clauses[0].first_fragment + 2 ||
+        c_fragments[c_clauses[0].first_fragment].clause != 0 ||
+        c_slice(c_fragments[c_clauses[0].first_fragment].spelling) != "a" ||
+        c_slice(c_fragments[c_clauses[0].first_fragment + 1].spelling) !=
+            "b" ||
+        c_slice(c_fragments[c_clauses[0].first_fragment + 1].source) != "b" ||
+        c_clauses[1].item_count != 0) {
+      std::cerr << "C view did not flatten the directive\n";
+      ok = false;
+    }
+  }
+  ompparser_view_free(c_view);
+
+  ompparser_view *c_failed = ompparser_parse("#pragma omp", 11, 7);
+  size_t c_diagnostic_count = 0;
+  if (c_failed == nullptr || ompparser_view_succeeded(c_failed) ||
+      ompparser_view_directive(c_failed) != nullptr ||
+      ompparser_view_diagnostics(c_failed, &c_diagnostic_count) == nullptr ||
+      c_diagnostic_count != 1) {
+    std::cerr << "C view of an unknown language did not report it\n";
+    ok = false;
+  }
+  ompparser_view_free(c_failed);
+
+  const std::vector<ompparser::ScannedPragma> c_pragmas =
+      ompparser::scanPragmas("int x; /* #pragma omp barrier\n"
+                             "*/\n"
+                             "  #pragma omp parallel \\\n"
+                             "      private(x) // trailing\n"
+                             "#pragma once\n"
+                             "#  pragma  omp barrier\r\n",
+                             ompparser::BaseLanguage::C);
+  const std::vector<ompparser::ScannedPragma> fortran_pragmas =
+      ompparser::scanPragmas("x = 1\n"
+                             "!$OMP parallel do &\n"
+                             "!$omp& private(i) ! trailing\n"
+                             "c$omp barrier\n",
+                             ompparser::BaseLanguage::Fortran);
+  if (c_pragmas.size() != 2 ||
+      c_pragmas[0].text != "#pragma omp parallel       private(x) " ||
+      c_pragmas[0].begin.line != 3 || c_pragmas[0].begin.column != 3 ||
+      c_pragmas[0].begin.offset != 35 ||
+      c_pragmas[1].text != "#  pragma  omp barrier" ||
+      c_pragmas[1].begin.line != 6 || fortran_pragmas.size() != 2 ||
+      fortran_pragmas[0].text != "!$OMP parallel do private(i) " ||
+      fortran_pragmas[0].begin.line != 2 ||
+      fortran_pragmas[1].text != "c$omp barrier" ||
+      fortran_pragmas[1].begin.line != 4 ||
+      ompparser::languageForPath("src/a.F90") !=
+          ompparser::BaseLanguage::Fortran ||
+      ompparser::languageForPath("a.hpp") != ompparser::BaseLanguage::CXX ||
+      ompparser::languageForPath("a.c") != ompparser::BaseLanguage::C ||
+      ompparser::languageForPath("dir.f/readme").has_value()) {
+    std::cerr << "scanPragmas did not find the source's directives\n";
+    ok = false;
+  }
+
+  {
+    ompparser::MemoryParseCache cache(1 << 20);
+    const std::string cached_input = "#pragma omp parallel private(a, b)";
+    ompparser::ParseResult first_parse =
+        ompparser::parseDirective(cached_input, {}, cache);
+    ompparser::ParseResult cached_parse =
+        ompparser::parseDirective(cached_input, {}, cache);
+    ompparser::ParseOptions cxx_options;
+    cxx_options.language = ompparser::BaseLanguage::CXX;
+    ompparser::ParseResult other_language =
+        ompparser::parseDirective(cached_input, cxx_options, cache);
+    ompparser::ParseResult failed_parse =
+        ompparser::parseDirective("#pragma omp parallel (", {}, cache);
+    const ompparser::ParseCacheStats cache_stats = cache.stats();
+    if (!first_parse.success() || !cached_parse.success() ||
+        !ompparser::structurallyEqual(*first_parse.directive,
+                                      *cached_parse.directive) ||
+        ompparser::unparse(*cached_parse.directive).text !=
+            ompparser::unparse(*first_parse.directive).text ||
+        !other_language.success() || failed_parse.success() ||
+        failed_parse.diagnostics.empty() || cache_stats.hits != 1 ||
+        cache_stats.misses != 3 || cache_stats.entries != 2) {
+      std::cerr << "parse cache did not answer a repeated parse\n";
+      ok = false;
+    }
+
+    // A hit keeps the source text as a fresh parse does.
+    ompparser::MemoryParseCache retaining_cache(1 << 20);
+    ompparser::ParseOptions retain_options;
+    retain_options.retain_source = true;
+    const std::string spaced_input = "#pragma omp parallel  private( a,b )";
+    ompparser::ParseResult retained_miss = ompparser::parseDirective(
+        spaced_input, retain_options, retaining_cache);
+    ompparser::ParseResult retained_hit = ompparser::parseDirective(
+        spaced_input, retain_options, retaining_cache);
+    if (!retained_miss.success() || !retained_hit.success() ||
+        retaining_cache.stats().hits != 1 ||
+        ompparser::unparse(*retained_hit.directive,
+                           ompparser::UnparseFormat::Verbatim)
+                .text !=
+            ompparser::unparse(*retained_miss.directive,
+                               ompparser::UnparseFormat::Verbatim)
+                .text) {
+      std::cerr << "parse cache dropped the retained source text\n";
+      ok = false;
+    }
+
+    ompparser::MemoryParseCache small_cache(64);
+    small_cache.store("first", std::string(40, 'a'));
+    small_cache.store("second", std::string(20, 'b'));
+    std::string cached_bytes;
+    if (small_cache.lookup("first", cached_bytes) ||
+        !small_cache.lookup("second", cached_bytes) ||
+        cached_bytes != std::string(20, 'b') ||
+        small_cache.stats().bytes != 26) {
+      std::cerr << "parse cache did not evict beyond its capacity\n";
+      ok = false;
+    }
+  }
+
+#if !defined(__EMSCRIPTEN__) && (defined(__unix__) || defined(__APPLE__))
+  {
+    const std::string shared_name =
+        "/ompparser-test-" + std::to_string(getpid());
+    const std::vector<std::string> shared_inputs = {
+        "#pragma omp declare target",
+        "#pragma omp declare simd uniform(a) linear(i:1)",
+        "#pragma omp parallel for private(i) schedule(static, 4)",
+        "#pragma omp task final(n < 8) depend(in: x)",
+        "#pragma omp target teams distribute map(to: a[0:n])",
+        "#pragma omp barrier"};
+    std::vector<std::string> shared_expected;
+    for (const std::string &input : shared_inputs) {
+      ompparser::ParseResult result = ompparser::parseDirective(input);
+      shared_expected.push_back(
+          result.success() ? ompparser::unparse(*result.directive).text : "");
+    }
+
+    // Every child opens the cache by name and parses the inputs in its own
+    // order, so creation, stores and lookups race across processes.
+    std::vector<pid_t> children;
+    for (int child = 0; child < 16; ++child) {
+      const pid_t pid = fork();
+      if (pid == 0) {
+        int status = 0;
+        try {
+          ompparser::SharedMemoryParseCache cache(shared_name, 1 << 20);
+          for (int round = 0; round < 20; ++round) {
+            for (std::size_t i = 0; i < shared_inputs.size(); ++i) {
+              const std::size_t index = (i + child) % shared_inputs.size();
+              ompparser::ParseResult result = ompparser::parseDirective(
+                  shared_inputs[index], {}, cache);
+              if (!result.success() ||
+                  ompparser::unparse(*result.directive).text !=
+                      shared_expected[index]) {
+                status = 1;
+              }
+            }
+          }
+          if (cache.stats().hits == 0) {
+            status = 1;
+          }
+        } catch (const std::exception &) {
+          status = 1;
+        }
+        _exit(status);
+      }
+      if (pid > 0) {
+        children.push_back(pid);
+      }
+    }
+    bool children_ok = children.size() == 16;
+    for (pid_t pid : children) {
+      int status = 0;
+      children_ok = waitpid(pid, &status, 0) == pid && WIFEXITED(status) &&
+                    WEXITSTATUS(status) == 0 && children_ok;
+    }
+    try {
+      ompparser::SharedMemoryParseCache cache(shared_name, 1 << 20);
+      if (!children_ok || cache.stats().entries != shared_inputs.size()) {
+        std::cerr << "shared parse cache failed across processes\n";
+        ok = false;
+      }
+    } catch (const std::exception &error) {
+      std::cerr << "shared parse cache did not open: " << error.what() << "\n";
+      ok = false;
+    }
+    ompparser::SharedMemoryParseCache::remove(shared_name);
+
+    // Eight slots: the table stays bounded and keeps the newest entry, and
+    // an entry larger than a slot is not stored.
+    const std::string small_name = shared_name + "-small";
+    try {
+      ompparser::SharedMemoryParseCache cache(small_name, 8 * 1024, 1024);
+      for (int i = 0; i < 40; ++i) {
+        cache.store("key" + std::to_string(i), std::string(100, 'x'));
+      }
+      cache.store("large", std::string(2048, 'y'));
+      std::string bytes;
+      if (cache.stats().entries > 8 || !cache.lookup("key39", bytes) ||
+          bytes != std::string(100, 'x') || cache.lookup("large", bytes)) {
+        std::cerr << "shared parse cache did not stay within its capacity\n";
+        ok = false;
+      }
+    } catch (const std::exception &error) {
+      std::cerr << "shared parse cache did not open: " << error.what() << "\n";
+      ok = false;
+    }
+    ompparser::SharedMemoryParseCache::remove(small_name);
+
+    // Every slot of an eight-slot table left odd, as by writers that died or
+    // stopped: a store passes over them while their claim is recent or its
+    // process is running, and takes one over once it is stale and its
+    // process has exited. Each slot starts with its sequence, last_used,
+    // owner (pid and token) and claim time, after the 64-byte header.
+    const std::string odd_name = shared_name + "-odd";
+    try {
+      ompparser::SharedMemoryParseCache cache(odd_name, 8 * 1024, 1024);
+      const int fd = shm_open(odd_name.c_str(), O_RDWR, 0600);
+      void *address = fd < 0 ? MAP_FAILED
+                             : mmap(nullptr, 64 + 8 * 1024,
+                                    PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (fd >= 0) {
+        close(fd);
+      }
+      if (address == MAP_FAILED) {
+        throw std::runtime_error("cannot map the shared parse cache");
+      }
+      const pid_t exited = fork();
+      if (exited == 0) {
+        _exit(0);
+      }
+      waitpid(exited, nullptr, 0);
+      auto *table = static_cast<unsigned char *>(address) + 64;
+      const auto words = [&](int slot) {
+        return reinterpret_cast<std::atomic<uint64_t> *>(table + slot * 1024);
+      };
+      const auto leaveOdd = [&](pid_t pid, uint64_t claimed_at) {
+        for (int i = 0; i < 8; ++i) {
+          words(i)[0].store(1);
+          words(i)[2].store(static_cast<uint64_t>(pid) << 32 | 1);
+          words(i)[3].store(claimed_at);
+        }
+      };
+      std::string bytes;
+      leaveOdd(getpid(), 0);
+      cache.store("key", "bytes");
+      bool skipped = !cache.lookup("key", bytes) && words(0)[3].load() == 0;
+      const auto recent = static_cast<uint64_t>(
+          std::chrono::steady_clock::now().time_since_epoch().count());
+      leaveOdd(exited, recent);
+      cache.store("key", "bytes");
+      skipped = skipped && !cache.lookup("key", bytes);
+      leaveOdd(exited, 0);
+      cache.store("key", "bytes");
+      if (!skipped || !cache.lookup("key", bytes) || bytes != "bytes") {
+        std::cerr << "shared parse cache did not reclaim abandoned slots\n";
+        ok = false;
+      }
+      munmap(address, 64 + 8 * 1024);
+    } catch (const std::exception &error) {
+      std::cerr << "shared parse cache did not open: " << error.what() << "\n";
+      ok = false;
+    }
+    ompparser::SharedMemoryParseCache::remove(odd_name);
+
+    // An object whose creator died after sizing it but before publishing
+    // its header is replaced rather than waited on forever.
+    const std::string abandoned_name = shared_name + "-abandoned";
+    const int abandoned =
+        shm_open(abandoned_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (abandoned >= 0) {
+      if (ftruncate(abandoned, 64 + 8 * 1024) != 0) {
+        std::cerr << "cannot size the abandoned shared parse cache\n";
+        ok = false;
+      }
+      close(abandoned);
+    }
+    try {
+      ompparser::SharedMemoryParseCache cache(abandoned_name, 8 * 1024, 1024);
+      std::string bytes;
+      cache.store("key", "bytes");
+      if (!cache.lookup("key", bytes) || bytes != "bytes") {
+        std::cerr << "shared parse cache did not replace an abandoned "
+                     "object\n";
+        ok = false;
+      }
+    } catch (const std::exception &error) {
+      std::cerr << "shared parse cache did not open: " << error.what() << "\n";
+      ok = false;
+    }
+    ompparser::SharedMemoryParseCache::remove(abandoned_name);
+  }
+#endif
+
+  {
+    namespace fs = std::filesystem;
+    const fs::path project =
+        fs::temp_directory_path() /
+        ("ompparser-database-test-" +
+         std::to_string(
+             std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(project);
+    const std::string c_file = (project / "a.c").string();
+    const std::string fortran_file = (project / "b.f90").string();
+    auto write_file = [](const std::string &path, const std::string &text) {
+      std::ofstream(path, std::ios::binary | std::ios::trunc) << text;
+    };
+    write_file(c_file, "#pragma omp parallel private(a)\nint x;\n"
+                       "#pragma omp task final(n < 8)\n");
+    write_file(fortran_file, "!$omp parallel do private(i)\n");
+
+    ompparser::PragmaDatabase database;
+    const ompparser::PragmaUpdateReport built =
+        database.update({fortran_file, c_file});
+    const ompparser::PragmaUpdateReport unchanged =
+        database.update({c_file, fortran_file});
+
+    // The edit moves the parallel directive down a line, changes the task
+    // and adds a taskwait; touching the Fortran file does not change it.
+    write_file(c_file, "// header\n#pragma omp parallel private(a)\n"
+                       "int x;\n#pragma omp task final(n < 4)\n"
+                       "#pragma omp taskwait\n");
+    fs::last_write_time(fortran_file, fs::last_write_time(fortran_file) +
+                                          std::chrono::hours(1));
+    const ompparser::PragmaUpdateReport edited =
+        database.update({c_file, fortran_file});
+    if (built.changes.size() != 3 || built.files_scanned != 2 ||
+        built.directives_parsed != 3 || !unchanged.changes.empty() ||
+        unchanged.files_read != 0 || edited.files_read != 2 ||
+        edited.files_scanned != 1 || edited.directives_parsed != 2 ||
+        edited.changes.size() != 2 ||
+        edited.changes[0].kind != ompparser::PragmaChangeKind::Changed ||
+        edited.changes[0].before.text.find("n < 8") == std::string::npos ||
+        edited.changes[0].after.begin.line != 4 ||
+        edited.changes[1].kind != ompparser::PragmaChangeKind::Added ||
+        edited.changes[1].after.text != "#pragma omp taskwait") {
+      std::cerr << "pragma database did not track the project's changes\n";
+      ok = false;
+    }
+
+    std::string saved;
+    ompparser::StringSink saved_sink(saved);
+    database.save(saved_sink);
+    ompparser::PragmaDatabaseResult reopened =
+        ompparser::openPragmaDatabase(saved);
+    const ompparser::PragmaFile *indexed =
+        reopened.success() ? reopened.database.find(c_file) : nullptr;
+    bool reopened_ok = indexed && indexed->pragmas.size() == 3 &&
+                       reopened.database.files().size() == 2;
+    if (reopened_ok) {
+      ompparser::ParseResult rebuilt =
+          ompparser::deserialize(indexed->pragmas[1].image);
+      ompparser::ParseResult reparsed =
+          ompparser::parseDirective("#pragma omp task final(n < 4)");
+      ompparser::StructuralOptions ignore_ranges;
+      ignore_ranges.ignore_source_ranges = true;
+      reopened_ok = rebuilt.success() && reparsed.success() &&
+                    ompparser::structurallyEqual(
+                        *rebuilt.directive, *reparsed.directive, ignore_ranges);
+    }
+    const ompparser::PragmaUpdateReport dropped =
+        reopened.database.update({c_file, (project / "c.c").string()});
+    if (!reopened_ok || dropped.changes.size() != 1 ||
+        dropped.changes[0].kind != ompparser::PragmaChangeKind::Removed ||
+        dropped.changes[0].path != fortran_file || dropped.files_read != 0 ||
+        dropped.unreadable.size() != 1 ||
+        ompparser::openPragmaDatabase("OMPI\x01").success() ||
+        ompparser::openPragmaDatabase(saved.substr(0, saved.size() - 1))
+            .success()) {
+      std::cerr << "pragma database did not reopen\n";
+      ok = false;
+    }
+    fs::remove_all(project);
+  }
+
+  {
+    namespace fs = std::filesystem;
+    const fs::path project =
+        fs::temp_directory_path() /
+        ("ompparser-pipeline-test-" +
+         std::to_string(
+             std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(project);
+    const std::vector<std::string> pipeline_files = {
+        (project / "a.c").string(), (project / "missing.c").string(),
+        (project / "b.f90").string()};
+    std::ofstream(pipeline_files[0])
+        << "#pragma omp parallel private(a)\n#pragma omp task final(n)\n"
+           "#pragma omp parallel (\n#pragma omp barrier\n";
+    std::ofstream(pipeline_files[2]) << "!$omp parallel do private(i)\n";
+
+    auto unparsed_line = [](const char *input,
+                            const ompparser::ParseOptions &options) {
+      ompparser::ParseResult result =
+          ompparser::parseDirective(input, options);
+      return result.success()
+                 ? ompparser::unparse(*result.directive).text + "\n"
+                 : std::string();
+    };
+    ompparser::ParseOptions fortran_options;
+    fortran_options.language = ompparser::BaseLanguage::Fortran;
+    const std::string serial_text =
+        unparsed_line("#pragma omp parallel private(a)", {}) +
+        unparsed_line("#pragma omp task final(n)", {}) +
+        unparsed_line("#pragma omp barrier", {}) +
+        unparsed_line("!$omp parallel do private(i)", fortran_options);
+
+    // Two directives in flight keep every stage waiting on the next.
+    ompparser::PipelineOptions pipeline_options;
+    pipeline_options.parse_threads = 3;
+    pipeline_options.emit_threads = 2;
+    pipeline_options.in_flight = 2;
+    std::string pipeline_text;
+    ompparser::StringSink pipeline_sink(pipeline_text);
+    const ompparser::PipelineResult pipelined = ompparser::runPipeline(
+        pipeline_files, pipeline_sink, pipeline_options);
+    if (pipeline_text != serial_text || pipelined.files != 3 ||
+        pipelined.directives != 5 || pipelined.failed != 1 ||
+        pipelined.success() || pipelined.unreadable.size() != 1 ||
+        pipelined.diagnostics.empty() ||
+        pipelined.diagnostics[0].path != pipeline_files[0] ||
+        pipelined.diagnostics[0].begin.line != 3) {
+      std::cerr << "pipeline did not match the serial loop\n";
+      ok = false;
+    }
+
+    // A sink that throws stops the stages, which are joined before the
+    // exception reaches the caller.
+    struct FailingSink final : ompparser::TextSink {
+      std::string text;
+      void append(std::string_view piece) override {
+        if (!text.empty()) {
+          throw std::runtime_error("sink is full");
+        }
+        text.append(piece);
+      }
+    } failing_sink;
+    bool pipeline_threw = false;
+    try {
+      ompparser::runPipeline(pipeline_files, failing_sink, pipeline_options);
+    } catch (const std::runtime_error &) {
+      pipeline_threw = true;
+    }
+    if (!pipeline_threw ||
+        failing_sink.text !=
+            unparsed_line("#pragma omp parallel private(a)", {})) {
+      std::cerr << "pipeline did not rethrow its sink's exception\n";
+      ok = false;
+    }
+    fs::remove_all(project);
+  }
+
+  {
+    const std::vector<std::string> batch = {
+        "#pragma omp parallel for private(i, j) schedule(static)",
+        "#pragma omp parallel for private(i, j) schedule(static)",
+        "#pragma omp for schedule(static) private(i, j) reduction(+:sum)",
+        "#pragma omp parallel for  schedule(static),\\\n  private(i, j)",
+        "#pragma omp parallel for private(i, j) num_threads(4)",
+        "#pragma omp target map(tofrom: a[0:n]) device(1)",
+        "#pragma omp target map(tofrom: a[0:n])",
+        "#pragma omp parallel for private(i, j) schedule(",
+        "#pragma omp parallel for private(i, j) ordered ordered",
+        "#pragma omp barrier",
+        "#pragma omp barrier"};
+    ompparser::ClauseCache clause_cache;
+    for (const std::string &input : batch) {
+      ompparser::ParseResult cached =
+          ompparser::parseDirective(input, {}, clause_cache);
+      ompparser::ParseResult fresh = ompparser::parseDirective(input);
+      if (cached.success() != fresh.success() ||
+          cached.diagnostics.size() != fresh.diagnostics.size() ||
+          (fresh.success() &&
+           (!ompparser::structurallyEqual(*cached.directive,
+                                          *fresh.directive) ||
+            ompparser::unparse(*cached.directive).text !=
+                ompparser::unparse(*fresh.directive).text))) {
+        std::cerr << "clause cache changed the parse of " << input << "\n";
+        ok = false;
+      }
+    }
+    const ompparser::ClauseCacheStats clause_stats = clause_cache.stats();
+    if (clause_stats.hits < 4 || clause_stats.misses == 0 ||
+        clause_stats.headers < 4 || clause_stats.hitRate() <= 0.0) {
+      std::cerr << "clause cache did not reuse clauses\n";
+      ok = false;
+    }
+    clause_cache.clear();
+    if (clause_cache.stats().entries != 0 ||
+        clause_cache.stats().hits != 0) {
+      std::cerr << "clause cache did not clear\n";
+      ok = false;
+    }
+  }
+
+  const std::string serialized_input =
+      "#pragma omp metadirective when(construct={parallel(score(30): "
+      "private(m))}, device = {arch(score(20): x86)}: ) when(device = "
+      "{arch(arm)}, construct={parallel}:) when (user={condition(n<20)}: "
+      ") default (parallel private(i) shared(m) shared(n))";
+  ompparser::ParseResult serialized_source =
+      ompparser::parseDirective(serialized_input);
+  if (!serialized_source.success()) {
+    std::cerr << "serialized directive did not parse\n";
+    ok = false;
+  } else {
+    const std::string image =
+        ompparser::serialize(*serialized_source.directive);
+    ompparser::ParseResult restored = ompparser::deserialize(image);
+    if (!restored.success() || !restored.directive->isValidated() ||
+        !ompparser::structurallyEqual(*serialized_source.directive,
+                                      *restored.directive) ||
+        ompparser::unparse(*restored.directive).text !=
+            ompparser::unparse(*serialized_source.directive).text ||
+        ompparser::serialize(*restored.directive) != image) {
+      std::cerr << "deserialize did not restore the serialized directive\n";
+      ok = false;
+    }
+    // The language follows the four integers of the header and the
+    // directive kind; 0x7F names no language.
+    std::string bad_language = image;
+    std::size_t language_offset = 4;
+    for (int field = 0; field < 5; ++field) {
+      while ((static_cast<unsigned char>(image[language_offset++]) & 0x80) !=
+             0) {
+      }
+    }
+    bad_language[language_offset] = '\x7F';
+    for (const std::string &damaged :
+         {image.substr(0, image.size() - 1), image + '\0',
+          "OMPS" + image.substr(5), std::string("#pragma omp parallel"),
+          bad_language}) {
+      ompparser::ParseResult rejected = ompparser::deserialize(damaged);
+      if (rejected.directive != nullptr ||
+          !hasDiagnostic(rejected,
+                         ompparser::DiagnosticCode::MalformedSerialization)) {
+        std::cerr << "deserialize accepted a damaged image\n";
+        ok = false;
+      }
+    }
+  }
+
+  {
+    ompparser::DirectiveStoreWriter store_writer;
+    int store_line = 0;
+    for (const char *input :
+         {"#pragma omp target map(tofrom: a, b, c, d) nowait",
+          "#pragma omp target map(tofrom: a, b) map(to: v, w, x, y)",
+          "#pragma omp parallel for schedule(dynamic, 4) private(a)"}) {
+      ompparser::ParseResult stored = ompparser::parseDirective(input);
+      if (!stored.success()) {
+        std::cerr << "directive store input did not parse: " << input << "\n";
+        ok = false;
+        continue;
+      }
+      stored.directive->setLine(++store_line);
+      store_writer.add(*stored.directive, "kernels.c");
+    }
+    std::string image;
+    ompparser::StringSink image_sink(image);
+    store_writer.finish(image_sink);
+    // The store is read in place, so copy it to 8-byte aligned memory as a
+    // mapping of the file would be.
+    std::vector<uint64_t> mapped((image.size() + 7) / 8);
+    std::memcpy(mapped.data(), image.data(), image.size());
+    std::string_view mapped_bytes(
+        reinterpret_cast<const char *>(mapped.data()), image.size());
+    ompparser::DirectiveStoreResult opened =
+        ompparser::openDirectiveStore(mapped_bytes);
+    const ompparser::DirectiveStore &store = opened.store;
+    std::vector<uint32_t> large_tofrom_lines;
+    for (std::size_t d = 0; d < store.directiveCount(); ++d) {
+      if (store.directiveKinds()[d] != OMPD_target) {
+        continue;
+      }
+      for (uint32_t c = store.clauseOffsets()[d];
+           c < store.clauseOffsets()[d + 1]; ++c) {
+        if (store.clauseKinds()[c] == OMPC_map &&
+            store.clauseModifiers(0)[c] == OMPC_MAP_TYPE_tofrom &&
+            store.itemOffsets()[c + 1] - store.itemOffsets()[c] > 3) {
+          large_tofrom_lines.push_back(store.directiveLines()[d]);
+        }
+      }
+    }
+    if (!opened.success() || store_writer.directiveCount() != 0 ||
+        store.directiveCount() != 3 || store.clauseCount() != 6 ||
+        large_tofrom_lines != std::vector<uint32_t>{1} ||
+        store.string(store.directiveFiles()[2]) != "kernels.c" ||
+        store.clauseModifiers(0)[4] != OMPC_SCHEDULE_KIND_dynamic ||
+        store.clauseModifiers(0)[1] != ompparser::NoClauseModifier ||
+        store.string(store.itemSpellings()[store.itemOffsets()[3]]) != "v") {
+      std::cerr << "directive store columns do not match the directives\n";
+      ok = false;
+    }
+    if (ompparser::openDirectiveStore(mapped_bytes.substr(0, 40)).success() ||
+        ompparser::openDirectiveStore(mapped_bytes.substr(8)).success()) {
+      std::cerr << "openDirectiveStore accepted a damaged store\n";
+      ok = false;
+    }
+  }
+
+  const std::string reparse_input =
+      "#pragma omp parallel private(a) num_threads(4), shared(b)";
+  ompparser::ParseResult reparse_base =
+      ompparser::parseDirective(reparse_input);
+  if (!reparse_base.success()) {
+    std::cerr << "reparse base directive did not parse\n";
+    ok = false;
+  } else {
+    const std::vector<ompparser::SourceEdit> reparse_edits = {
+        {44, 1, "n + 1"},
+        {31, 0, " if(c)"},
+        {57, 0, " proc_bind(close)"},
+        {46, 1, ""},
+        {12, 8, "parallel for"},
+        {21, 10, ""}};
+    for (const ompparser::SourceEdit &edit : reparse_edits) {
+      const std::string edited_text =
+          ompparser::applySourceEdits(reparse_input, {edit});
+      ompparser::ParseResult full = ompparser::parseDirective(edited_text);
+      const uint64_t fast_before = ompparser::detail::fastReparses();
+      ompparser::ParseResult incremental =
+          ompparser::reparse(reparse_base, reparse_input, edit);
+      const bool fast = ompparser::detail::fastReparses() != fast_before;
+      if ((edit.offset == 44 || edit.offset == 57) && !fast) {
+        std::cerr << "reparse parsed all of '" << edited_text
+                  << "' again for an edit inside its clauses\n";
+        ok = false;
+      }
+      if (edit.offset == 12 && fast) {
+        std::cerr << "reparse spliced clauses around an edited header\n";
+        ok = false;
+      }
+      if (full.success() != incremental.success() ||
+          (full.success() &&
+           (!ompparser::structurallyEqual(*full.directive,
+                                          *incremental.directive) ||
+            ompparser::unparse(*full.directive).text !=
+                ompparser::unparse(*incremental.directive).text))) {
+        std::cerr << "reparse disagrees with a full parse of '" << edited_text
+                  << "'\n";
+        ok = false;
+      }
+    }
+    ompparser::ParseOptions retain_options;
+    retain_options.retain_source = true;
+    ompparser::ParseResult retained_base =
+        ompparser::parseDirective(reparse_input, retain_options);
+    const uint64_t retained_before = ompparser::detail::fastReparses();
+    ompparser::ParseResult retained_reparse = ompparser::reparse(
+        retained_base, reparse_input, {44, 1, "n + 1"}, retain_options);
+    if (!retained_reparse.success() ||
+        ompparser::detail::fastReparses() == retained_before ||
+        ompparser::unparse(*retained_reparse.directive,
+                           ompparser::UnparseFormat::Verbatim)
+                .text != ompparser::applySourceEdits(reparse_input,
+                                                     {{44, 1, "n + 1"}})) {
+      std::cerr << "reparse lost the retained source of an edited directive\n";
+      ok = false;
+    }
+    bool reparse_range_threw = false;
+    try {
+      ompparser::reparse(reparse_base, reparse_input, {50, 20, ""});
+    } catch (const std::invalid_argument &) {
+      reparse_range_threw = true;
+    }
+    if (!reparse_range_threw) {
+      std::cerr << "out-of-range reparse edit was accepted\n";
+      ok = false;
+    }
+  }
+
   OpenMPDirective null_clause_ast(OMPD_parallel);
   bool null_clause_threw = false;
   try {
@@ -2270,6 +3367,150 @@ int main() {
     ok = false;
   }
 
+  ompparser::ParseResult visited = ompparser::parseDirective(
+      "#pragma omp metadirective "
+      "when(construct={parallel}: target teams map(tofrom: a)) "
+      "otherwise(target map(to: b) private(c))",
+      c_options);
+  if (visited.success()) {
+    NodeCountingVisitor counter;
+    const std::vector<OpenMPDirectiveKind> expected_directives = {
+        OMPD_metadirective, OMPD_parallel, OMPD_target_teams, OMPD_target};
+    if (!counter.traverseDirective(std::as_const(*visited.directive)) ||
+        counter.directives != expected_directives ||
+        counter.map_clauses != 2 || counter.variant_clauses != 2 ||
+        counter.other_clauses != 1) {
+      std::cerr << "recursive IR visitor missed nested directives\n";
+      ok = false;
+    }
+    StoppingVisitor stopper;
+    if (stopper.traverseDirective(*visited.directive) ||
+        stopper.visited_clauses != 1) {
+      std::cerr << "recursive IR visitor did not stop when asked\n";
+      ok = false;
+    }
+  } else {
+    std::cerr << "visitor metadirective failed to parse\n";
+    ok = false;
+  }
+
+  OpenMPEndDirective visited_end;
+  visited_end.setPairedDirective(
+      std::make_unique<OpenMPDirective>(OMPD_parallel));
+  NodeCountingVisitor end_counter;
+  end_counter.traverseDirective(visited_end);
+  if (end_counter.directives !=
+      std::vector<OpenMPDirectiveKind>{OMPD_end, OMPD_parallel}) {
+    std::cerr << "recursive IR visitor missed a paired end directive\n";
+    ok = false;
+  }
+
+  if (visited.success()) {
+    const OpenMPDirective &original = *visited.directive;
+    const std::string original_text = ompparser::unparse(original).text;
+    std::unique_ptr<OpenMPDirective> copy = original.clone();
+    if (!ompparser::structurallyEqual(original, *copy) ||
+        ompparser::hash(original) != ompparser::hash(*copy) ||
+        ompparser::unparse(*copy).text != original_text) {
+      std::cerr << "cloned metadirective is not structurally equal\n";
+      ok = false;
+    }
+    OpenMPWhenClause *copied_when =
+        dynamic_cast<OpenMPWhenClause *>(copy->getClauses(OMPC_when)->front());
+    const std::vector<OpenMPClause *> *copied_maps =
+        copied_when != nullptr && copied_when->getVariantDirective() != nullptr
+            ? copied_when->getVariantDirective()->findClauses(OMPC_map)
+            : nullptr;
+    if (copied_maps == nullptr || copied_maps->empty()) {
+      std::cerr << "cloned metadirective lost its nested variant\n";
+      ok = false;
+    } else {
+      copied_maps->front()->getExpressionItems().front().fragment.spelling =
+          "z";
+      if (ompparser::structurallyEqual(original, *copy) ||
+          ompparser::hash(original) == ompparser::hash(*copy) ||
+          ompparser::unparse(original).text != original_text) {
+        std::cerr << "cloned metadirective shares nested clauses\n";
+        ok = false;
+      }
+    }
+  }
+
+  ompparser::ParseResult compact =
+      ompparser::parseDirective("#pragma omp parallel private(a)", c_options);
+  ompparser::ParseResult spaced =
+      ompparser::parseDirective("#pragma omp parallel  private(a)", c_options);
+  ompparser::ParseResult renamed =
+      ompparser::parseDirective("#pragma omp parallel private(b)", c_options);
+  if (compact.success() && spaced.success() && renamed.success()) {
+    ompparser::StructuralOptions ignore_ranges;
+    ignore_ranges.ignore_source_ranges = true;
+    if (ompparser::structurallyEqual(*compact.directive, *spaced.directive) ||
+        !ompparser::structurallyEqual(*compact.directive, *spaced.directive,
+                                      ignore_ranges) ||
+        ompparser::hash(*compact.directive, ignore_ranges) !=
+            ompparser::hash(*spaced.directive, ignore_ranges) ||
+        ompparser::structurallyEqual(*compact.directive, *renamed.directive,
+                                     ignore_ranges)) {
+      std::cerr << "structural comparison mishandled source ranges\n";
+      ok = false;
+    }
+  } else {
+    std::cerr << "structural comparison inputs failed to parse\n";
+    ok = false;
+  }
+
+  ompparser::ParseResult built =
+      ompparser::DirectiveBuilder(OMPD_target_teams_distribute)
+          .map(OMPC_MAP_TYPE_tofrom, {"a[0:n]", "b"})
+          .collapse("2")
+          .variables(OMPC_private, {"i", "j"})
+          .reduction(OMPC_REDUCTION_IDENTIFIER_plus, {"sum"})
+          .nowait()
+          .build();
+  ompparser::ParseResult reference = ompparser::parseDirective(
+      "#pragma omp target teams distribute map(tofrom: a[0:n], b) "
+      "collapse(2) private(i, j) reduction(+: sum) nowait",
+      c_options);
+  if (built.success() && reference.success()) {
+    ompparser::StructuralOptions ignore_ranges;
+    ignore_ranges.ignore_source_ranges = true;
+    if (!ompparser::structurallyEqual(*built.directive, *reference.directive,
+                                      ignore_ranges) ||
+        ompparser::unparse(*built.directive).text !=
+            ompparser::unparse(*reference.directive).text) {
+      std::cerr << "built directive differs from the parsed directive\n";
+      ok = false;
+    }
+  } else {
+    std::cerr << "directive builder or its reference parse failed\n";
+    ok = false;
+  }
+
+  ompparser::ParseResult misplaced =
+      ompparser::DirectiveBuilder(OMPD_target_teams).collapse("2").build();
+  ompparser::ParseResult repeated = ompparser::DirectiveBuilder(OMPD_parallel)
+                                        .numThreads("2")
+                                        .numThreads("4")
+                                        .build();
+  if (misplaced.success() ||
+      !hasDiagnostic(misplaced, ompparser::DiagnosticCode::InvalidClause) ||
+      repeated.success() ||
+      !hasDiagnostic(repeated, ompparser::DiagnosticCode::DuplicateClause)) {
+    std::cerr << "directive builder accepted an invalid clause\n";
+    ok = false;
+  }
+  bool dedicated_node_threw = false;
+  try {
+    ompparser::DirectiveBuilder critical(OMPD_critical);
+  } catch (const std::invalid_argument &) {
+    dedicated_node_threw = true;
+  }
+  if (!dedicated_node_threw) {
+    std::cerr << "directive builder accepted a dedicated directive node\n";
+    ok = false;
+  }
+
   std::atomic<bool> threads_ok(true);
   std::vector<std::thread> threads;
   for (int thread_index = 0; thread_index < 8; ++thread_index) {
@@ -2297,5 +3538,80 @@ int main() {
     ok = false;
   }
 
+  ompparser::ParseResult shared_parse = ompparser::parseDirective(
+      "#pragma omp parallel for private(a) reduction(+: sum) "
+      "schedule(dynamic, chunk) if(parallel: flag)");
+  if (!shared_parse.success()) {
+    std::cerr << "shared directive failed to parse\n";
+    return 1;
+  }
+  const OpenMPDirective &shared_directive = *shared_parse.directive;
+  const std::string shared_text = ompparser::unparse(shared_directive).text;
+  const std::string shared_dot = ompparser::toDot(shared_directive).text;
+  std::atomic<bool> shared_readers_ok(true);
+  std::vector<std::thread> readers;
+  for (int thread_index = 0; thread_index < 8; ++thread_index) {
+    readers.emplace_back([&]() {
+      for (int iteration = 0; iteration < 100; ++iteration) {
+        std::size_t unowned_fragments = 0;
+        shared_directive.visitHostFragments(
+            [&unowned_fragments](const ompparser::HostFragment &fragment) {
+              if (fragment.clause_kind == OMPC_unknown) {
+                ++unowned_fragments;
+              }
+            });
+        if (unowned_fragments != 0 ||
+            ompparser::unparse(shared_directive).text != shared_text ||
+            ompparser::toDot(shared_directive).text != shared_dot) {
+          shared_readers_ok = false;
+          return;
+        }
+      }
+    });
+  }
+  for (std::thread &reader : readers) {
+    reader.join();
+  }
+  if (!shared_readers_ok) {
+    std::cerr << "concurrent reads of a shared directive diverged\n";
+    ok = false;
+  }
+
+  // Every pair the applicability table lists is set, and nothing else.
+  struct AllowedPair {
+    OpenMPDirectiveKind directive;
+    OpenMPClauseKind clause;
+  };
+  const AllowedPair allowed_pairs[] = {
+#define OPENMP_ALLOWED_CLAUSE(Directive, Clause)                               \
+  {OMPD_##Directive, OMPC_##Clause},
+#include "OpenMPApplicability.def"
+#undef OPENMP_ALLOWED_CLAUSE
+  };
+  std::vector<std::size_t> listed_clauses(ompparser::DirectiveKindCount, 0);
+  bool rows_match = true;
+  for (const AllowedPair &pair : allowed_pairs) {
+    ++listed_clauses[pair.directive];
+    rows_match = rows_match &&
+                 ompparser::allowedClauses(pair.directive).test(pair.clause);
+  }
+  for (std::size_t directive = 0; directive < ompparser::DirectiveKindCount;
+       ++directive) {
+    rows_match = rows_match &&
+                 ompparser::allowedClauses(
+                     static_cast<OpenMPDirectiveKind>(directive))
+                         .count() == listed_clauses[directive];
+  }
+  const ompparser::ClauseSet parallel_for_shared =
+      ompparser::allowedClauses(OMPD_parallel) &
+      ompparser::allowedClauses(OMPD_for);
+  if (!rows_match || !parallel_for_shared.test(OMPC_private) ||
+      parallel_for_shared.test(OMPC_nowait) ||
+      parallel_for_shared.test(OMPC_num_threads) ||
+      ompparser::allowedClauses(OMPD_unknown).any()) {
+    std::cerr << "allowedClauses rows disagree with the applicability table\n";
+    ok = false;
+  }
+
   return ok ? 0 : 1;
 }
@@ -49,6 +49,17 @@ std::string test(OpenMPDirective *node) {
   return node->generatePragmaString();
 }
 
+// Reads a directive back from its serialized form, which must match it and
+// unparse to the same text.
+bool roundTripsSerialized(const OpenMPDirective &directive,
+                          const std::string &text) {
+  ompparser::ParseResult restored =
+      ompparser::deserialize(ompparser::serialize(directive));
+  return restored.success() &&
+         ompparser::structurallyEqual(directive, *restored.directive) &&
+         ompparser::unparse(*restored.directive).text == text;
+}
+
 int openFile(std::ifstream &file, const char *filename) {
   file.exceptions(std::ifstream::failbit | std::ifstream::badbit);
   try {
@@ -179,6 +190,14 @@ int main(int argc, const char *argv[]) {
               ompparser::unparse(*parse_result.directive);
           if (unparse_result.success())
             output_pragma = std::move(unparse_result.text);
+          if (!roundTripsSerialized(*parse_result.directive, output_pragma)) {
+            std::cout << "======================================\n";
+            std::cout << "Line: " << line_no << "\n";
+            std::cout << "SERIALIZATION ROUND TRIP FAILED: " << input_pragma
+                      << "\n";
+            std::cout << "======================================\n";
+            failed_amount += 1;
+          }
         } else if (!is_expected_invalid_case) {
           for (const ompparser::Diagnostic &diagnostic :
                parse_result.diagnostics)
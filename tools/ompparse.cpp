@@ -0,0 +1,453 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// ompparse scans source files, or every C, C++ and Fortran file under a
+// directory, for OpenMP directives and parses them on a pool of threads.
+// Files are handed out to the workers one at a time and their output is
+// written in file order, directories sorted by path, so it does not depend
+// on -j. The exit status is 1 when any directive fails to parse or a file
+// cannot be read.
+//
+//   --format diagnostics  path:line:column: severity: message [Code] for each
+//                         diagnostic (the default)
+//   --format text         path:line: unparsed directive
+//   --format json         one JSON object per directive per line, with the
+//                         toJson form of those that parse
+//   --format dot          one toDotGraph graph per file
+//   --format stats        counts of files, directives, failures and
+//                         directive kinds
+//
+// With --database FILE, ompparse keeps an index of the directives in FILE
+// and instead prints the directives added, removed or changed since the
+// index was last updated, reading only the files that changed; it takes no
+// --format or --language. The exit status is then 1 when any indexed
+// directive fails to parse.
+
+#include "OpenMPIR.h"
+#include "OpenMPParser.h"
+#include "OpenMPPragmaDatabase.h"
+#include "OpenMPPragmaScanner.h"
+#include "OpenMPSchema.h"
+#include "tool_output.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace {
+
+namespace fs = std::filesystem;
+
+using ompparser::Diagnostic;
+
+enum class Format { Diagnostics, Text, Json, Dot, Stats };
+
+struct Settings {
+  Format format = Format::Diagnostics;
+  std::optional<ompparser::BaseLanguage> language;
+  ompparser::ExtensionPolicy extensions =
+      ompparser::ExtensionPolicy::RejectUnknown;
+};
+
+// What one file contributes, filled by a worker and written by the main
+// thread in file order.
+struct FileReport {
+  std::string output;
+  std::string errors;
+  uint64_t directives = 0;
+  uint64_t failures = 0;
+  bool unreadable = false;
+  std::vector<uint64_t> kinds;
+};
+
+// A diagnostic's range is relative to the scanned directive text; its first
+// line is placed at the directive's position in the file.
+void appendDiagnosticLine(std::string &out, const std::string &path,
+                          const ompparser::ScannedPragma &pragma,
+                          const Diagnostic &diagnostic) {
+  const ompparser::SourcePosition &at = diagnostic.range.begin;
+  uint32_t line = pragma.begin.line;
+  uint32_t column = pragma.begin.column;
+  if (at.line > 1) {
+    line += at.line - 1;
+    column = at.column;
+  } else if (at.line == 1 && at.column > 0) {
+    column += at.column - 1;
+  }
+  out += path + ":" + std::to_string(line) + ":" + std::to_string(column) +
+         ": " + ompparser::tools::diagnosticSeverityName(diagnostic.severity) +
+         ": " + diagnostic.message + " [" +
+         ompparser::tools::diagnosticCodeName(diagnostic.code) + "]\n";
+}
+
+FileReport processFile(const std::string &path, const Settings &settings) {
+  FileReport report;
+  std::ifstream file(path, std::ios::binary);
+  if (!file) {
+    report.unreadable = true;
+    report.errors = "ompparse: cannot read " + path + "\n";
+    return report;
+  }
+  std::ostringstream contents;
+  contents << file.rdbuf();
+  const std::string source = contents.str();
+
+  ompparser::ParseOptions options;
+  options.language = settings.language.value_or(
+      ompparser::languageForPath(path).value_or(ompparser::BaseLanguage::C));
+  options.extensions = settings.extensions;
+
+  const std::vector<ompparser::ScannedPragma> pragmas =
+      ompparser::scanPragmas(source, options.language);
+  std::vector<ompparser::ParseResult> results;
+  results.reserve(pragmas.size());
+  if (settings.format == Format::Stats) {
+    report.kinds.assign(ompparser::DirectiveKindCount, 0);
+  }
+
+  for (const ompparser::ScannedPragma &pragma : pragmas) {
+    ompparser::ParseResult result =
+        ompparser::parseDirective(pragma.text, options);
+    ++report.directives;
+    const bool parsed = result.success();
+    if (!parsed && result.diagnostics.empty()) {
+      Diagnostic diagnostic;
+      diagnostic.message = "OpenMP directive did not parse";
+      result.diagnostics.push_back(std::move(diagnostic));
+    }
+    if (!parsed) {
+      ++report.failures;
+    } else if (settings.format == Format::Stats) {
+      ++report.kinds[result.directive->getKind()];
+    }
+
+    switch (settings.format) {
+    case Format::Diagnostics:
+      for (const Diagnostic &diagnostic : result.diagnostics) {
+        appendDiagnosticLine(report.output, path, pragma, diagnostic);
+      }
+      break;
+    case Format::Text:
+    case Format::Dot:
+      for (const Diagnostic &diagnostic : result.diagnostics) {
+        appendDiagnosticLine(report.errors, path, pragma, diagnostic);
+      }
+      if (parsed && settings.format == Format::Text) {
+        report.output += path + ":" + std::to_string(pragma.begin.line) + ": ";
+        ompparser::StringSink sink(report.output);
+        ompparser::unparseTo(*result.directive, sink);
+        report.output.push_back('\n');
+      }
+      break;
+    case Format::Json: {
+      std::string &out = report.output;
+      out += "{\"file\":";
+      ompparser::tools::appendJsonString(out, path);
+      out += ",\"line\":" + std::to_string(pragma.begin.line) +
+             ",\"column\":" + std::to_string(pragma.begin.column) +
+             ",\"text\":";
+      ompparser::tools::appendJsonString(out, pragma.text);
+      out += parsed ? ",\"ok\":true" : ",\"ok\":false";
+      out += ",\"diagnostics\":";
+      ompparser::tools::appendJsonDiagnostics(out, result.diagnostics);
+      if (parsed) {
+        out += ",\"directive\":";
+        ompparser::StringSink sink(out);
+        ompparser::toJson(*result.directive, sink);
+      }
+      out += "}\n";
+      break;
+    }
+    case Format::Stats:
+      break;
+    }
+    results.push_back(std::move(result));
+  }
+
+  if (settings.format == Format::Dot && report.failures < report.directives) {
+    std::vector<const OpenMPDirective *> directives;
+    for (const ompparser::ParseResult &result : results) {
+      if (result.directive) {
+        directives.push_back(result.directive.get());
+      }
+    }
+    report.output += "// " + path + "\n";
+    ompparser::StringSink sink(report.output);
+    ompparser::toDotGraph(directives, sink);
+  }
+  return report;
+}
+
+// Files named on the command line are taken as they are; directories
+// contribute their C, C++ and Fortran files in path order.
+bool collectFiles(const std::vector<std::string> &paths,
+                  std::vector<std::string> &files) {
+  bool ok = true;
+  for (const std::string &path : paths) {
+    std::error_code error;
+    if (!fs::is_directory(path, error)) {
+      files.push_back(path);
+      continue;
+    }
+    std::vector<std::string> found;
+    fs::recursive_directory_iterator walk(
+        path, fs::directory_options::skip_permission_denied, error);
+    for (; !error && walk != fs::recursive_directory_iterator();
+         walk.increment(error)) {
+      const std::string name = walk->path().string();
+      if (walk->is_regular_file(error) &&
+          ompparser::languageForPath(name).has_value()) {
+        found.push_back(name);
+      }
+    }
+    if (error) {
+      std::cerr << "ompparse: cannot list " << path << ": " << error.message()
+                << "\n";
+      ok = false;
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+  }
+  return ok;
+}
+
+void appendChangeLine(std::string &out, const ompparser::PragmaChange &change) {
+  const bool removed = change.kind == ompparser::PragmaChangeKind::Removed;
+  const ompparser::PragmaRecord &record =
+      removed ? change.before : change.after;
+  out += change.path + ":" + std::to_string(record.begin.line) + ": ";
+  switch (change.kind) {
+  case ompparser::PragmaChangeKind::Added:
+    out += "added: " + record.text;
+    break;
+  case ompparser::PragmaChangeKind::Removed:
+    out += "removed: " + record.text;
+    break;
+  case ompparser::PragmaChangeKind::Changed:
+    out += "changed: " + record.text + " (was: " + change.before.text + ")";
+    break;
+  }
+  out.push_back('\n');
+}
+
+// Brings the index in database_path up to date with files and prints what
+// changed. An index that is missing, unreadable or was built with other
+// extension settings is rebuilt from scratch.
+bool updateDatabase(const std::string &database_path,
+                    const std::vector<std::string> &files,
+                    const Settings &settings) {
+  ompparser::PragmaDatabase database(settings.extensions);
+  std::ifstream in(database_path, std::ios::binary);
+  if (in) {
+    const std::string bytes((std::istreambuf_iterator<char>(in)),
+                            std::istreambuf_iterator<char>());
+    ompparser::PragmaDatabaseResult opened =
+        ompparser::openPragmaDatabase(bytes);
+    if (!opened.success()) {
+      std::cerr << "ompparse: rebuilding " << database_path << ": "
+                << opened.diagnostics.front().message << "\n";
+    } else if (opened.database.extensions() == settings.extensions) {
+      database = std::move(opened.database);
+    }
+  }
+
+  const ompparser::PragmaUpdateReport report = database.update(files);
+  std::string out;
+  for (const ompparser::PragmaChange &change : report.changes) {
+    appendChangeLine(out, change);
+  }
+  std::cout << out;
+  for (const std::string &path : report.unreadable) {
+    std::cerr << "ompparse: cannot read " << path << "\n";
+  }
+  std::cerr << "ompparse: " << report.files_checked << " files checked, "
+            << report.files_read << " read, " << report.files_scanned
+            << " scanned, " << report.directives_parsed
+            << " directives parsed\n";
+
+  // Written beside the index and renamed over it, so that an interrupted
+  // run leaves the previous index.
+  const std::string temporary = database_path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+    ompparser::StreamSink sink(file);
+    database.save(sink);
+    file.close();
+    if (!file) {
+      std::cerr << "ompparse: cannot write " << temporary << "\n";
+      return false;
+    }
+  }
+  std::error_code error;
+  fs::rename(temporary, database_path, error);
+  if (error) {
+    std::cerr << "ompparse: cannot write " << database_path << ": "
+              << error.message() << "\n";
+    return false;
+  }
+
+  bool ok = report.unreadable.empty();
+  for (const ompparser::PragmaFile &file : database.files()) {
+    for (const ompparser::PragmaRecord &record : file.pragmas) {
+      ok = ok && record.parsed();
+    }
+  }
+  return ok;
+}
+
+void usage() {
+  std::cerr << "usage: ompparse [-j N] [--format "
+               "diagnostics|text|json|dot|stats]\n"
+               "                [--database FILE] [--language c|c++|fortran] "
+               "[--extensions]\n"
+               "                PATH...\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  std::ios::sync_with_stdio(false);
+  Settings settings;
+  unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+  std::vector<std::string> paths;
+  std::string database_path;
+  bool format_given = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "-j" && has_value) {
+      workers = static_cast<unsigned>(std::max(1L, std::atol(argv[++i])));
+    } else if (arg == "--format" && has_value) {
+      format_given = true;
+      const std::string name = argv[++i];
+      if (name == "diagnostics") {
+        settings.format = Format::Diagnostics;
+      } else if (name == "text") {
+        settings.format = Format::Text;
+      } else if (name == "json") {
+        settings.format = Format::Json;
+      } else if (name == "dot") {
+        settings.format = Format::Dot;
+      } else if (name == "stats") {
+        settings.format = Format::Stats;
+      } else {
+        usage();
+        return 2;
+      }
+    } else if (arg == "--database" && has_value) {
+      database_path = argv[++i];
+    } else if (arg == "--language" && has_value) {
+      settings.language = ompparser::tools::languageByName(argv[++i]);
+      if (!settings.language) {
+        usage();
+        return 2;
+      }
+    } else if (arg == "--extensions") {
+      settings.extensions = ompparser::ExtensionPolicy::AllowRegistered;
+    } else if (arg == "-h" || arg == "--help") {
+      usage();
+      return 0;
+    } else if (!arg.empty() && arg[0] == '-') {
+      usage();
+      return 2;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+  // The index takes each file's language from its name.
+  if (paths.empty() ||
+      ((format_given || settings.language) && !database_path.empty())) {
+    usage();
+    return 2;
+  }
+
+  std::vector<std::string> files;
+  bool ok = collectFiles(paths, files);
+  if (!database_path.empty()) {
+    ok = updateDatabase(database_path, files, settings) && ok;
+    return ok ? 0 : 1;
+  }
+
+  std::vector<FileReport> reports(files.size());
+  std::vector<bool> done(files.size(), false);
+  std::mutex mutex;
+  std::condition_variable finished;
+  std::atomic<std::size_t> next{0};
+  std::vector<std::thread> threads;
+  workers = static_cast<unsigned>(
+      std::min<std::size_t>(workers, std::max<std::size_t>(1, files.size())));
+  for (unsigned i = 0; i < workers; ++i) {
+    threads.emplace_back([&] {
+      for (std::size_t index = next++; index < files.size(); index = next++) {
+        FileReport report = processFile(files[index], settings);
+        std::lock_guard<std::mutex> lock(mutex);
+        reports[index] = std::move(report);
+        done[index] = true;
+        finished.notify_all();
+      }
+    });
+  }
+
+  uint64_t directives = 0;
+  uint64_t failures = 0;
+  std::vector<uint64_t> kinds(ompparser::DirectiveKindCount, 0);
+  for (std::size_t index = 0; index < files.size(); ++index) {
+    FileReport report;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      finished.wait(lock, [&] { return done[index]; });
+      report = std::move(reports[index]);
+    }
+    std::cout << report.output;
+    std::cerr << report.errors;
+    ok = ok && !report.unreadable && report.failures == 0;
+    directives += report.directives;
+    failures += report.failures;
+    for (std::size_t kind = 0; kind < report.kinds.size(); ++kind) {
+      kinds[kind] += report.kinds[kind];
+    }
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  if (settings.format == Format::Stats) {
+    std::cout << "files: " << files.size() << "\ndirectives: " << directives
+              << "\nfailed: " << failures << "\n";
+    std::vector<std::pair<uint64_t, std::string>> counts;
+    for (std::size_t kind = 0; kind < kinds.size(); ++kind) {
+      if (kinds[kind] != 0) {
+        counts.emplace_back(kinds[kind],
+                            ompparser::getDirectiveName(
+                                static_cast<OpenMPDirectiveKind>(kind)));
+      }
+    }
+    std::sort(counts.begin(), counts.end(), [](const auto &a, const auto &b) {
+      return a.first != b.first ? a.first > b.first : a.second < b.second;
+    });
+    for (const auto &[count, name] : counts) {
+      std::cout << name << ": " << count << "\n";
+    }
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,847 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// ompparser-server answers newline-delimited JSON requests, one object per
+// line, on stdin or on each connection to a Unix domain socket:
+//
+//   {"id": 1, "op": "parse", "text": "#pragma omp parallel", "language": "c"}
+//
+// op is parse, validate, unparse, scan or stats. parse, validate and unparse
+// take the directive as text; scan takes a source file as text or path and
+// parses every directive in it. language is c, c++ or fortran (by default
+// that of path for scan, else c), and "extensions": true admits registered
+// extension directives. Each response is one line,
+//
+//   {"id": 1, "ok": true, "diagnostics": [...], "directive": {...}}
+//
+// with diagnostics in the fields of ompparser::Diagnostic, the toJson form
+// of a parsed directive, unparse's "text", or scan's "directives". A request
+// that cannot be read is answered with "error". Requests are served by a
+// pool of workers whose parser state stays warm, through one shared parse
+// cache, so with more than one worker responses may come out of order; the
+// id is echoed to match them.
+//
+// --replay LOG serves a recorded request log, such as stdin captured with
+// tee, through the same workers and reports requests per second.
+
+#include "OpenMPIR.h"
+#include "OpenMPParseCache.h"
+#include "OpenMPParser.h"
+#include "OpenMPPragmaScanner.h"
+#include "tool_output.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+using ompparser::Diagnostic;
+using ompparser::tools::appendJsonDiagnostics;
+using ompparser::tools::appendJsonString;
+using ompparser::tools::hasErrors;
+
+// ---------------------------------------------------------------------------
+// Requests
+
+struct Request {
+  // Raw JSON of the id member, echoed back as it came.
+  std::string id = "null";
+  std::string op;
+  std::string text;
+  bool has_text = false;
+  std::string path;
+  std::string language;
+  bool extensions = false;
+};
+
+// Reads the flat objects requests are written as: string, number, boolean
+// and null members only, of which unknown ones are skipped.
+class RequestParser {
+public:
+  explicit RequestParser(std::string_view text) : text(text) {}
+
+  bool parse(Request &request, std::string &error) {
+    skipSpace();
+    if (!consume('{')) {
+      error = "request is not a JSON object";
+      return false;
+    }
+    skipSpace();
+    if (consume('}')) {
+      return finish(error);
+    }
+    do {
+      skipSpace();
+      std::string name;
+      if (!string(name)) {
+        error = "malformed member name";
+        return false;
+      }
+      skipSpace();
+      if (!consume(':')) {
+        error = "expected ':' after \"" + name + "\"";
+        return false;
+      }
+      skipSpace();
+      if (!member(name, request)) {
+        error = "malformed value of \"" + name + "\"";
+        return false;
+      }
+      skipSpace();
+    } while (consume(','));
+    if (!consume('}')) {
+      error = "expected ',' or '}'";
+      return false;
+    }
+    return finish(error);
+  }
+
+private:
+  bool finish(std::string &error) {
+    skipSpace();
+    if (pos != text.size()) {
+      error = "trailing characters after the request object";
+      return false;
+    }
+    return true;
+  }
+
+  bool member(const std::string &name, Request &request) {
+    if (name == "id") {
+      const std::size_t begin = pos;
+      std::string ignored;
+      if (!(peek('"') ? string(ignored) : scalar())) {
+        return false;
+      }
+      request.id = std::string(text.substr(begin, pos - begin));
+      return true;
+    }
+    if (name == "op") {
+      return string(request.op);
+    }
+    if (name == "text") {
+      request.has_text = true;
+      return string(request.text);
+    }
+    if (name == "path") {
+      return string(request.path);
+    }
+    if (name == "language") {
+      return string(request.language);
+    }
+    if (name == "extensions") {
+      const std::size_t begin = pos;
+      if (!scalar()) {
+        return false;
+      }
+      request.extensions = text.substr(begin, pos - begin) == "true";
+      return true;
+    }
+    std::string ignored;
+    return peek('"') ? string(ignored) : scalar();
+  }
+
+  bool peek(char c) const { return pos < text.size() && text[pos] == c; }
+
+  bool consume(char c) {
+    if (!peek(c)) {
+      return false;
+    }
+    ++pos;
+    return true;
+  }
+
+  void skipSpace() {
+    while (pos < text.size() && (text[pos] == ' ' || text[pos] == '\t' ||
+                                 text[pos] == '\r' || text[pos] == '\n')) {
+      ++pos;
+    }
+  }
+
+  // A JSON number, true, false or null, not run into a following word.
+  bool scalar() {
+    const std::size_t begin = pos;
+    if (!literal("true") && !literal("false") && !literal("null") &&
+        !number()) {
+      pos = begin;
+      return false;
+    }
+    if (pos < text.size() &&
+        (std::isalnum(static_cast<unsigned char>(text[pos])) ||
+         text[pos] == '_' || text[pos] == '.' || text[pos] == '-' ||
+         text[pos] == '+')) {
+      pos = begin;
+      return false;
+    }
+    return true;
+  }
+
+  bool literal(std::string_view word) {
+    if (text.substr(pos, word.size()) != word) {
+      return false;
+    }
+    pos += word.size();
+    return true;
+  }
+
+  bool digits() {
+    const std::size_t begin = pos;
+    while (pos < text.size() &&
+           std::isdigit(static_cast<unsigned char>(text[pos]))) {
+      ++pos;
+    }
+    return pos != begin;
+  }
+
+  // -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)?
+  bool number() {
+    consume('-');
+    if (!consume('0') && !digits()) {
+      return false;
+    }
+    if (consume('.') && !digits()) {
+      return false;
+    }
+    if (consume('e') || consume('E')) {
+      if (!consume('+')) {
+        consume('-');
+      }
+      if (!digits()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool hex4(uint32_t &value) {
+    if (text.size() - pos < 4) {
+      return false;
+    }
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = text[pos++];
+      value <<= 4;
+      if (c >= '0' && c <= '9') {
+        value |= c - '0';
+      } else if (c >= 'a' && c <= 'f') {
+        value |= c - 'a' + 10;
+      } else if (c >= 'A' && c <= 'F') {
+        value |= c - 'A' + 10;
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  static void appendUtf8(std::string &out, uint32_t code) {
+    if (code < 0x80) {
+      out.push_back(static_cast<char>(code));
+    } else if (code < 0x800) {
+      out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else if (code < 0x10000) {
+      out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    } else {
+      out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+      out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+    }
+  }
+
+  bool string(std::string &out) {
+    if (!consume('"')) {
+      return false;
+    }
+    out.clear();
+    while (pos < text.size()) {
+      const char c = text[pos++];
+      if (c == '"') {
+        return true;
+      }
+      if (static_cast<unsigned char>(c) < 0x20) {
+        return false;
+      }
+      if (c != '\\') {
+        out.push_back(c);
+        continue;
+      }
+      if (pos == text.size()) {
+        return false;
+      }
+      switch (text[pos++]) {
+      case '"':
+        out.push_back('"');
+        break;
+      case '\\':
+        out.push_back('\\');
+        break;
+      case '/':
+        out.push_back('/');
+        break;
+      case 'b':
+        out.push_back('\b');
+        break;
+      case 'f':
+        out.push_back('\f');
+        break;
+      case 'n':
+        out.push_back('\n');
+        break;
+      case 'r':
+        out.push_back('\r');
+        break;
+      case 't':
+        out.push_back('\t');
+        break;
+      case 'u': {
+        uint32_t code = 0;
+        if (!hex4(code)) {
+          return false;
+        }
+        if (code >= 0xD800 && code < 0xDC00) {
+          uint32_t low = 0;
+          if (!consume('\\') || !consume('u') || !hex4(low) || low < 0xDC00 ||
+              low >= 0xE000) {
+            return false;
+          }
+          code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+        } else if (code >= 0xDC00 && code < 0xE000) {
+          return false;
+        }
+        appendUtf8(out, code);
+        break;
+      }
+      default:
+        return false;
+      }
+    }
+    return false;
+  }
+
+  std::string_view text;
+  std::size_t pos = 0;
+};
+
+// ---------------------------------------------------------------------------
+// Responses
+
+void appendDiagnostics(std::string &out,
+                       const std::vector<Diagnostic> &diagnostics) {
+  out += ",\"diagnostics\":";
+  appendJsonDiagnostics(out, diagnostics);
+}
+
+// ---------------------------------------------------------------------------
+// Request handling
+
+struct Response {
+  std::string line;
+  // The request could not be read or named no known operation.
+  bool malformed = false;
+};
+
+class Service {
+public:
+  // Without a cache every request is parsed.
+  explicit Service(std::unique_ptr<ompparser::ParseCache> cache)
+      : cache(std::move(cache)) {}
+
+  Response handle(std::string_view line) {
+    ++served;
+    Request request;
+    std::string error;
+    if (!RequestParser(line).parse(request, error)) {
+      return failure(request, error);
+    }
+
+    ompparser::ParseOptions options;
+    if (!languageOption(request, options.language)) {
+      return failure(request, "unknown language \"" + request.language + "\"");
+    }
+    if (request.extensions) {
+      options.extensions = ompparser::ExtensionPolicy::AllowRegistered;
+    }
+
+    Response response;
+    std::string &out = response.line;
+    out = "{\"id\":" + request.id;
+    if (request.op == "scan") {
+      if (!scan(request, options, out, error)) {
+        return failure(request, error);
+      }
+    } else if (request.op == "stats") {
+      stats(out);
+    } else if (request.op == "parse" || request.op == "validate" ||
+               request.op == "unparse") {
+      if (!request.has_text) {
+        return failure(request, request.op + " needs \"text\"");
+      }
+      directive(request, options, out);
+    } else {
+      return failure(request, "unknown op \"" + request.op + "\"");
+    }
+    out += "}\n";
+    return response;
+  }
+
+  uint64_t requestsServed() const { return served; }
+  ompparser::ParseCacheStats cacheStats() const {
+    return cache ? cache->stats() : ompparser::ParseCacheStats();
+  }
+
+private:
+  Response failure(const Request &request, const std::string &error) {
+    Response response;
+    response.line = "{\"id\":" + request.id + ",\"ok\":false,\"error\":";
+    appendJsonString(response.line, error);
+    response.line += "}\n";
+    response.malformed = true;
+    return response;
+  }
+
+  static bool languageOption(const Request &request,
+                             ompparser::BaseLanguage &language) {
+    if (request.language.empty()) {
+      language = ompparser::languageForPath(request.path)
+                     .value_or(ompparser::BaseLanguage::C);
+      return true;
+    }
+    std::optional<ompparser::BaseLanguage> named =
+        ompparser::tools::languageByName(request.language);
+    language = named.value_or(language);
+    return named.has_value();
+  }
+
+  ompparser::ParseResult parse(std::string_view text,
+                               const ompparser::ParseOptions &options) {
+    return cache ? ompparser::parseDirective(text, options, *cache)
+                 : ompparser::parseDirective(text, options);
+  }
+
+  void directive(const Request &request,
+                 const ompparser::ParseOptions &options, std::string &out) {
+    ompparser::ParseResult result = parse(request.text, options);
+    std::vector<Diagnostic> &diagnostics = result.diagnostics;
+    std::string body;
+    if (result.success() && request.op == "parse") {
+      body = ",\"directive\":";
+      ompparser::StringSink sink(body);
+      ompparser::ValidationResult written =
+          ompparser::toJson(*result.directive, sink);
+      diagnostics.insert(diagnostics.end(), written.diagnostics.begin(),
+                         written.diagnostics.end());
+    } else if (result.success() && request.op == "unparse") {
+      ompparser::UnparseResult unparsed = ompparser::unparse(*result.directive);
+      if (unparsed.success()) {
+        body = ",\"text\":";
+        appendJsonString(body, unparsed.text);
+      }
+      diagnostics.insert(diagnostics.end(), unparsed.diagnostics.begin(),
+                         unparsed.diagnostics.end());
+    }
+    const bool ok = result.directive && !hasErrors(diagnostics);
+    out += ok ? ",\"ok\":true" : ",\"ok\":false";
+    appendDiagnostics(out, diagnostics);
+    out += body;
+  }
+
+  bool scan(const Request &request, const ompparser::ParseOptions &options,
+            std::string &out, std::string &error) {
+    std::string source = request.text;
+    if (!request.has_text) {
+      std::ifstream file(request.path, std::ios::binary);
+      if (request.path.empty() || !file) {
+        error = "cannot read \"" + request.path + "\"";
+        return false;
+      }
+      std::ostringstream contents;
+      contents << file.rdbuf();
+      source = contents.str();
+    }
+
+    std::string directives = ",\"directives\":[";
+    bool ok = true;
+    std::vector<ompparser::ScannedPragma> pragmas =
+        ompparser::scanPragmas(source, options.language);
+    for (std::size_t i = 0; i < pragmas.size(); ++i) {
+      const ompparser::ScannedPragma &pragma = pragmas[i];
+      ompparser::ParseResult result = parse(pragma.text, options);
+      ok = ok && result.success();
+      directives += i == 0 ? "{\"line\":" : ",{\"line\":";
+      directives += std::to_string(pragma.begin.line) +
+                    ",\"column\":" + std::to_string(pragma.begin.column) +
+                    ",\"text\":";
+      appendJsonString(directives, pragma.text);
+      directives += result.success() ? ",\"ok\":true" : ",\"ok\":false";
+      appendDiagnostics(directives, result.diagnostics);
+      directives.push_back('}');
+    }
+    directives.push_back(']');
+    out += ok ? ",\"ok\":true" : ",\"ok\":false";
+    out += directives;
+    return true;
+  }
+
+  void stats(std::string &out) {
+    const ompparser::ParseCacheStats stats = cacheStats();
+    out += ",\"ok\":true,\"requests\":" + std::to_string(served.load()) +
+           ",\"cache\":{\"hits\":" + std::to_string(stats.hits) +
+           ",\"misses\":" + std::to_string(stats.misses) +
+           ",\"entries\":" + std::to_string(stats.entries) +
+           ",\"bytes\":" + std::to_string(stats.bytes) + "}";
+  }
+
+  const std::unique_ptr<ompparser::ParseCache> cache;
+  std::atomic<uint64_t> served{0};
+};
+
+// ---------------------------------------------------------------------------
+// Transport
+
+class Output {
+public:
+  virtual ~Output() = default;
+  virtual void write(std::string_view line) = 0;
+};
+
+// Writes whole lines to a file descriptor, closing it when the last
+// response for the connection has been written.
+class FdOutput final : public Output {
+public:
+  FdOutput(int fd, bool owned) : fd(fd), owned(owned) {}
+  ~FdOutput() override {
+    if (owned) {
+      close(fd);
+    }
+  }
+
+  void write(std::string_view line) override {
+    std::lock_guard<std::mutex> lock(mutex);
+    while (!broken && !line.empty()) {
+      const ssize_t written = ::write(fd, line.data(), line.size());
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+      if (written <= 0) {
+        // The client went away; its remaining responses are dropped.
+        broken = true;
+        break;
+      }
+      line.remove_prefix(static_cast<std::size_t>(written));
+    }
+  }
+
+private:
+  int fd;
+  bool owned;
+  bool broken = false;
+  std::mutex mutex;
+};
+
+class DiscardOutput final : public Output {
+public:
+  void write(std::string_view) override {}
+};
+
+struct Job {
+  std::string line;
+  std::shared_ptr<Output> output;
+};
+
+// Bounded so that a client writing faster than the workers parse is held
+// back instead of queueing without limit.
+class JobQueue {
+public:
+  explicit JobQueue(std::size_t capacity) : capacity(capacity) {}
+
+  void push(Job job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_full.wait(lock, [this] { return jobs.size() < capacity; });
+    jobs.push_back(std::move(job));
+    not_empty.notify_one();
+  }
+
+  bool pop(Job &job) {
+    std::unique_lock<std::mutex> lock(mutex);
+    not_empty.wait(lock, [this] { return closed || !jobs.empty(); });
+    if (jobs.empty()) {
+      return false;
+    }
+    job = std::move(jobs.front());
+    jobs.pop_front();
+    not_full.notify_one();
+    return true;
+  }
+
+  void close() {
+    std::lock_guard<std::mutex> lock(mutex);
+    closed = true;
+    not_empty.notify_all();
+  }
+
+private:
+  std::size_t capacity;
+  std::deque<Job> jobs;
+  bool closed = false;
+  std::mutex mutex;
+  std::condition_variable not_empty;
+  std::condition_variable not_full;
+};
+
+class WorkerPool {
+public:
+  WorkerPool(Service &service, unsigned workers)
+      : service(service), queue(workers * 64) {
+    for (unsigned i = 0; i < workers; ++i) {
+      threads.emplace_back([this] { run(); });
+    }
+  }
+  ~WorkerPool() { finish(); }
+
+  void submit(std::string line, std::shared_ptr<Output> output) {
+    queue.push(Job{std::move(line), std::move(output)});
+  }
+
+  // Serves every submitted job, then stops the workers.
+  void finish() {
+    queue.close();
+    for (std::thread &thread : threads) {
+      thread.join();
+    }
+    threads.clear();
+  }
+
+  uint64_t malformedRequests() const { return malformed; }
+
+private:
+  void run() {
+    Job job;
+    while (queue.pop(job)) {
+      Response response = service.handle(job.line);
+      if (response.malformed) {
+        ++malformed;
+      }
+      job.output->write(response.line);
+      job.output.reset();
+    }
+  }
+
+  Service &service;
+  JobQueue queue;
+  std::vector<std::thread> threads;
+  std::atomic<uint64_t> malformed{0};
+};
+
+// Submits each non-blank line read from fd until end of input.
+void serveStream(int fd, WorkerPool &pool, std::shared_ptr<Output> output) {
+  std::string pending;
+  char buffer[65536];
+  for (;;) {
+    const ssize_t count = read(fd, buffer, sizeof(buffer));
+    if (count < 0 && errno == EINTR) {
+      continue;
+    }
+    if (count <= 0) {
+      break;
+    }
+    pending.append(buffer, static_cast<std::size_t>(count));
+    std::size_t begin = 0;
+    for (std::size_t end = pending.find('\n'); end != std::string::npos;
+         end = pending.find('\n', begin)) {
+      if (pending.find_first_not_of(" \t\r", begin) < end) {
+        pool.submit(pending.substr(begin, end - begin), output);
+      }
+      begin = end + 1;
+    }
+    pending.erase(0, begin);
+  }
+  if (pending.find_first_not_of(" \t\r\n") != std::string::npos) {
+    pool.submit(std::move(pending), output);
+  }
+}
+
+int serveSocket(const std::string &path, WorkerPool &pool) {
+  sockaddr_un address{};
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    std::cerr << "ompparser-server: socket path is too long: " << path << "\n";
+    return 1;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+  const int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  unlink(path.c_str());
+  if (listener < 0 ||
+      bind(listener, reinterpret_cast<sockaddr *>(&address),
+           sizeof(address)) != 0 ||
+      listen(listener, SOMAXCONN) != 0) {
+    std::cerr << "ompparser-server: cannot listen on " << path << ": "
+              << std::strerror(errno) << "\n";
+    return 1;
+  }
+  for (;;) {
+    const int client = accept(listener, nullptr, nullptr);
+    if (client < 0) {
+      if (errno == EINTR || errno == ECONNABORTED) {
+        continue;
+      }
+      std::cerr << "ompparser-server: accept failed: " << std::strerror(errno)
+                << "\n";
+      close(listener);
+      return 1;
+    }
+    std::thread([client, &pool] {
+      serveStream(client, pool, std::make_shared<FdOutput>(client, true));
+    }).detach();
+  }
+}
+
+int replay(const std::string &log, unsigned repeat, Service &service,
+           WorkerPool &pool) {
+  std::ifstream input(log);
+  if (!input) {
+    std::cerr << "ompparser-server: cannot read " << log << "\n";
+    return 1;
+  }
+  std::vector<std::string> requests;
+  for (std::string line; std::getline(input, line);) {
+    if (line.find_first_not_of(" \t\r") != std::string::npos) {
+      requests.push_back(line);
+    }
+  }
+
+  auto output = std::make_shared<DiscardOutput>();
+  const auto start = std::chrono::steady_clock::now();
+  for (unsigned round = 0; round < repeat; ++round) {
+    for (const std::string &request : requests) {
+      pool.submit(request, output);
+    }
+  }
+  pool.finish();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  const ompparser::ParseCacheStats stats = service.cacheStats();
+  const uint64_t served = service.requestsServed();
+  std::cout << "replayed " << served << " requests in " << elapsed.count()
+            << " s: "
+            << (elapsed.count() > 0 ? served / elapsed.count() : 0.0)
+            << " requests/s, cache hits " << stats.hits << ", misses "
+            << stats.misses << ", malformed " << pool.malformedRequests()
+            << "\n";
+  return pool.malformedRequests() == 0 ? 0 : 1;
+}
+
+void usage() {
+  std::cerr
+      << "usage: ompparser-server [-j N] [--cache-bytes N] [--shared-cache "
+         "NAME]\n"
+         "                        [--socket PATH | --replay LOG [--repeat "
+         "N]]\n"
+         "Serves NDJSON parse requests on stdin, or on each connection to "
+         "the\n"
+         "Unix domain socket PATH. --replay serves a recorded request log\n"
+         "N times (default 1) and reports requests per second.\n"
+         "--shared-cache keeps the parse cache in the shared-memory object\n"
+         "NAME, shared with other processes, instead of in the server.\n";
+}
+
+} // namespace
+
+int main(int argc, char **argv) {
+  unsigned workers = std::max(1u, std::thread::hardware_concurrency());
+  std::size_t cache_bytes = 64u << 20;
+  std::string shared_cache;
+  std::string socket_path;
+  std::string replay_log;
+  unsigned repeat = 1;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    const bool has_value = i + 1 < argc;
+    if (arg == "-j" && has_value) {
+      workers = static_cast<unsigned>(std::max(1L, std::atol(argv[++i])));
+    } else if (arg == "--cache-bytes" && has_value) {
+      cache_bytes = static_cast<std::size_t>(std::atoll(argv[++i]));
+    } else if (arg == "--shared-cache" && has_value) {
+      shared_cache = argv[++i];
+    } else if (arg == "--socket" && has_value) {
+      socket_path = argv[++i];
+    } else if (arg == "--replay" && has_value) {
+      replay_log = argv[++i];
+    } else if (arg == "--repeat" && has_value) {
+      repeat = static_cast<unsigned>(std::max(1L, std::atol(argv[++i])));
+    } else {
+      usage();
+      return arg == "-h" || arg == "--help" ? 0 : 2;
+    }
+  }
+  if (!socket_path.empty() && !replay_log.empty()) {
+    usage();
+    return 2;
+  }
+
+  // A client that disconnects mid-response must not end the server.
+  std::signal(SIGPIPE, SIG_IGN);
+
+  std::unique_ptr<ompparser::ParseCache> cache;
+  try {
+    if (!shared_cache.empty()) {
+      cache = std::make_unique<ompparser::SharedMemoryParseCache>(shared_cache,
+                                                                  cache_bytes);
+    } else if (cache_bytes != 0) {
+      cache = std::make_unique<ompparser::MemoryParseCache>(cache_bytes);
+    }
+  } catch (const std::system_error &error) {
+    std::cerr << "ompparser-server: " << error.what() << "\n";
+    return 1;
+  }
+
+  Service service(std::move(cache));
+  WorkerPool pool(service, workers);
+  if (!replay_log.empty()) {
+    return replay(replay_log, repeat, service, pool);
+  }
+  if (!socket_path.empty()) {
+    const int status = serveSocket(socket_path, pool);
+    pool.finish();
+    return status;
+  }
+  serveStream(STDIN_FILENO, pool, std::make_shared<FdOutput>(STDOUT_FILENO,
+                                                              false));
+  pool.finish();
+  return 0;
+}
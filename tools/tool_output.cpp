@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+#include "tool_output.h"
+
+#include <algorithm>
+
+namespace ompparser::tools {
+
+void appendJsonString(std::string &out, std::string_view text) {
+  static const char hex[] = "0123456789abcdef";
+  out.push_back('"');
+  for (const char c : text) {
+    switch (c) {
+    case '"':
+      out += "\\\"";
+      break;
+    case '\\':
+      out += "\\\\";
+      break;
+    case '\n':
+      out += "\\n";
+      break;
+    case '\r':
+      out += "\\r";
+      break;
+    case '\t':
+      out += "\\t";
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        out += "\\u00";
+        out.push_back(hex[(c >> 4) & 0xF]);
+        out.push_back(hex[c & 0xF]);
+      } else {
+        out.push_back(c);
+      }
+    }
+  }
+  out.push_back('"');
+}
+
+const char *diagnosticCodeName(DiagnosticCode code) {
+  switch (code) {
+  case DiagnosticCode::NullInput:
+    return "NullInput";
+  case DiagnosticCode::LanguageMismatch:
+    return "LanguageMismatch";
+  case DiagnosticCode::LexicalError:
+    return "LexicalError";
+  case DiagnosticCode::SyntaxError:
+    return "SyntaxError";
+  case DiagnosticCode::DuplicateClause:
+    return "DuplicateClause";
+  case DiagnosticCode::InvalidDirective:
+    return "InvalidDirective";
+  case DiagnosticCode::InvalidClause:
+    return "InvalidClause";
+  case DiagnosticCode::InvalidAst:
+    return "InvalidAst";
+  case DiagnosticCode::UnsupportedExtension:
+    return "UnsupportedExtension";
+  case DiagnosticCode::HostLanguageError:
+    return "HostLanguageError";
+  case DiagnosticCode::InvalidEdit:
+    return "InvalidEdit";
+  case DiagnosticCode::MalformedSerialization:
+    return "MalformedSerialization";
+  }
+  return "unknown";
+}
+
+const char *diagnosticSeverityName(DiagnosticSeverity severity) {
+  switch (severity) {
+  case DiagnosticSeverity::Note:
+    return "note";
+  case DiagnosticSeverity::Warning:
+    return "warning";
+  case DiagnosticSeverity::Error:
+    return "error";
+  }
+  return "unknown";
+}
+
+namespace {
+
+void appendPosition(std::string &out, const SourcePosition &at) {
+  out += "{\"offset\":" + std::to_string(at.offset) +
+         ",\"line\":" + std::to_string(at.line) +
+         ",\"column\":" + std::to_string(at.column) + "}";
+}
+
+} // namespace
+
+void appendJsonDiagnostics(std::string &out,
+                           const std::vector<Diagnostic> &diagnostics) {
+  out.push_back('[');
+  for (std::size_t i = 0; i < diagnostics.size(); ++i) {
+    const Diagnostic &diagnostic = diagnostics[i];
+    out += i == 0 ? "{\"code\":\"" : ",{\"code\":\"";
+    out += diagnosticCodeName(diagnostic.code);
+    out += "\",\"severity\":\"";
+    out += diagnosticSeverityName(diagnostic.severity);
+    out += "\",\"range\":{\"begin\":";
+    appendPosition(out, diagnostic.range.begin);
+    out += ",\"end\":";
+    appendPosition(out, diagnostic.range.end);
+    out += "},\"message\":";
+    appendJsonString(out, diagnostic.message);
+    out.push_back('}');
+  }
+  out.push_back(']');
+}
+
+bool hasErrors(const std::vector<Diagnostic> &diagnostics) {
+  return std::any_of(diagnostics.begin(), diagnostics.end(),
+                     [](const Diagnostic &diagnostic) {
+                       return diagnostic.severity ==
+                              DiagnosticSeverity::Error;
+                     });
+}
+
+std::optional<BaseLanguage> languageByName(std::string_view name) {
+  if (name == "c") {
+    return BaseLanguage::C;
+  }
+  if (name == "c++" || name == "cxx") {
+    return BaseLanguage::CXX;
+  }
+  if (name == "fortran") {
+    return BaseLanguage::Fortran;
+  }
+  return std::nullopt;
+}
+
+} // namespace ompparser::tools
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2018-2026, High Performance Computing Architecture and System
+ * research laboratory at University of North Carolina at Charlotte (HPCAS@UNCC)
+ * and Lawrence Livermore National Security, LLC.
+ *
+ * SPDX-License-Identifier: (BSD-3-Clause)
+ */
+
+// Output helpers shared by the ompparser-server and ompparse executables.
+
+#ifndef OMPPARSER_TOOLS_TOOL_OUTPUT_H
+#define OMPPARSER_TOOLS_TOOL_OUTPUT_H
+
+#include "OpenMPParser.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ompparser::tools {
+
+const char *diagnosticCodeName(DiagnosticCode code);
+const char *diagnosticSeverityName(DiagnosticSeverity severity);
+
+bool hasErrors(const std::vector<Diagnostic> &diagnostics);
+
+// c, c++ (or cxx) and fortran.
+std::optional<BaseLanguage> languageByName(std::string_view name);
+
+// Appends text as a quoted JSON string.
+void appendJsonString(std::string &out, std::string_view text);
+// Appends a JSON array of {"code", "severity", "range": {"begin", "end"},
+// "message"} objects, the fields of Diagnostic.
+void appendJsonDiagnostics(std::string &out,
+                           const std::vector<Diagnostic> &diagnostics);
+
+} // namespace ompparser::tools
+
+#endif // OMPPARSER_TOOLS_TOOL_OUTPUT_H